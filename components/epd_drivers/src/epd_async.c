@@ -0,0 +1,610 @@
+/**
+ * 墨水屏异步刷新
+ * 每个设备一个工作任务, 串行执行排队的刷新请求, 调用方在面板刷新期间
+ * 可以继续渲染下一帧; 工作任务运行期间设备的同步操作被替换为加锁的包装函数,
+ * 同步调用与工作任务通过设备锁轮流占用SPI和BUSY
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "epd_common.h"
+
+#define TAG "EPD_ASYNC"
+
+typedef enum {
+    EPD_ASYNC_JOB_BUFFER,     // 全屏刷新
+    EPD_ASYNC_JOB_PARTIAL,    // 局部刷新
+    EPD_ASYNC_JOB_FLUSH,      // 空操作, 用于等待队列清空
+    EPD_ASYNC_JOB_STOP,       // 退出工作任务
+} epd_async_kind_t;
+
+// 刷新请求
+struct epd_async_job_t {
+    struct epd_async_t *owner;
+    epd_async_kind_t kind;
+    const uint8_t *buffer;
+    epd_update_mode_t mode;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    epd_async_cb_t cb;
+    void *user_ctx;
+    bool has_handle;          // 调用方持有句柄, 由epd_async_wait释放
+    bool in_use;
+    bool finished;            // 工作任务已执行完毕
+    esp_err_t result;
+    SemaphoreHandle_t done;   // 完成时释放
+};
+
+// 工作任务上下文
+struct epd_async_t {
+    epd_device_t *dev;
+    TaskHandle_t task;
+    QueueHandle_t queue;          // 待执行请求 (struct epd_async_job_t *)
+    SemaphoreHandle_t slots;      // 空闲请求槽位计数
+    SemaphoreHandle_t stopped;    // 工作任务退出时释放
+    SemaphoreHandle_t lock;       // 设备锁 (递归), 持有者独占SPI和BUSY
+    epd_device_t ops;             // 启动前的同步操作, 工作任务和包装函数经此调用驱动
+    struct epd_async_job_t jobs[EPD_ASYNC_QUEUE_LEN];
+    struct epd_async_job_t stop_job;
+};
+
+static portMUX_TYPE s_async_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TickType_t epd_async_ticks(uint32_t timeout_ms) {
+    return timeout_ms == EPD_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+// 归还请求槽位
+static void epd_async_release(struct epd_async_job_t *job) {
+    struct epd_async_t *as = job->owner;
+    
+    portENTER_CRITICAL(&s_async_lock);
+    job->in_use = false;
+    portEXIT_CRITICAL(&s_async_lock);
+    
+    xSemaphoreGive(as->slots);
+}
+
+static void epd_async_lock(struct epd_async_t *as) {
+    xSemaphoreTakeRecursive(as->lock, portMAX_DELAY);
+}
+
+static void epd_async_unlock(struct epd_async_t *as) {
+    xSemaphoreGiveRecursive(as->lock);
+}
+
+// 工作任务
+static void epd_async_task(void *arg) {
+    struct epd_async_t *as = (struct epd_async_t *)arg;
+    epd_device_t *dev = as->dev;
+    struct epd_async_job_t *job;
+    
+    for (;;) {
+        if (xQueueReceive(as->queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        
+        if (job->kind == EPD_ASYNC_JOB_STOP) {
+            break;
+        }
+        
+        epd_async_lock(as);
+        switch (job->kind) {
+            case EPD_ASYNC_JOB_BUFFER:
+                job->result = as->ops.display_buffer(dev, job->buffer, job->mode);
+                break;
+            case EPD_ASYNC_JOB_PARTIAL:
+                job->result = as->ops.display_partial(dev, job->buffer,
+                                                      job->x, job->y,
+                                                      job->width, job->height);
+                break;
+            default:
+                job->result = ESP_OK;
+                break;
+        }
+        epd_async_unlock(as);
+        
+        if (job->result != ESP_OK) {
+            ESP_LOGW(TAG, "异步刷新失败: %d", job->result);
+        }
+        
+        if (job->cb) {
+            job->cb(dev, job->result, job->user_ctx);
+        }
+        
+        // 调用方可能已放弃等待 (见epd_async_flush), 此时由工作任务归还槽位
+        portENTER_CRITICAL(&s_async_lock);
+        bool notify = job->has_handle;
+        job->finished = true;
+        portEXIT_CRITICAL(&s_async_lock);
+        
+        if (notify) {
+            xSemaphoreGive(job->done);
+        } else {
+            epd_async_release(job);
+        }
+    }
+    
+    xSemaphoreGive(as->stopped);
+    vTaskDelete(NULL);
+}
+
+// 释放上下文资源
+static void epd_async_free(struct epd_async_t *as) {
+    for (int i = 0; i < EPD_ASYNC_QUEUE_LEN; i++) {
+        if (as->jobs[i].done) {
+            vSemaphoreDelete(as->jobs[i].done);
+        }
+    }
+    if (as->queue) {
+        vQueueDelete(as->queue);
+    }
+    if (as->slots) {
+        vSemaphoreDelete(as->slots);
+    }
+    if (as->stopped) {
+        vSemaphoreDelete(as->stopped);
+    }
+    if (as->lock) {
+        vSemaphoreDelete(as->lock);
+    }
+    free(as);
+}
+
+// ==================== 加锁的同步操作 ====================
+
+// 取设备锁, 返回工作任务上下文
+static struct epd_async_t *epd_async_acquire(epd_device_t *dev) {
+    struct epd_async_t *as = dev->async;
+    epd_async_lock(as);
+    return as;
+}
+
+static esp_err_t epd_async_reset(epd_device_t *dev) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.reset(dev);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_clear(epd_device_t *dev, epd_color_t color) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.clear(dev, color);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_sync_buffer(epd_device_t *dev, const uint8_t *buffer,
+                                       epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_buffer(dev, buffer, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_sync_partial(epd_device_t *dev, const uint8_t *buffer,
+                                        uint16_t x, uint16_t y,
+                                        uint16_t width, uint16_t height) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_partial(dev, buffer, x, y, width, height);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_window(epd_device_t *dev, const uint8_t *framebuffer,
+                                  uint16_t x, uint16_t y,
+                                  uint16_t width, uint16_t height,
+                                  epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_window(dev, framebuffer, x, y, width, height, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_windows(epd_device_t *dev, const uint8_t *framebuffer,
+                                   const epd_rect_t *rects, uint8_t count,
+                                   epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_windows(dev, framebuffer, rects, count, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_planes(epd_device_t *dev, const uint8_t *bw,
+                                  const uint8_t *red, epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_planes(dev, bw, red, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_stream(epd_device_t *dev,
+                                  epd_transport_source_t bw, void *bw_ctx,
+                                  epd_transport_source_t red, void *red_ctx,
+                                  epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_stream(dev, bw, bw_ctx, red, red_ctx, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_bands(epd_device_t *dev, uint16_t band_height,
+                                 epd_band_draw_t draw, void *ctx,
+                                 epd_update_mode_t mode, epd_band_stats_t *stats) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.display_bands(dev, band_height, draw, ctx, mode, stats);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_begin_update(epd_device_t *dev, const uint8_t *buffer,
+                                        epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.begin_update(dev, buffer, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_finish_update(epd_device_t *dev, uint32_t timeout_ms) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.finish_update(dev, timeout_ms);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_refresh(epd_device_t *dev, epd_update_mode_t mode) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.refresh(dev, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_wakeup(epd_device_t *dev) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.wakeup(dev);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_power_on(epd_device_t *dev) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.power_on(dev);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_power_off(epd_device_t *dev) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.power_off(dev);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_invert(epd_device_t *dev, bool invert) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.invert(dev, invert);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_read_temperature(epd_device_t *dev, int8_t *temp_c) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.read_temperature(dev, temp_c);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_set_temp_bands(epd_device_t *dev, const epd_temp_band_t *bands,
+                                          uint8_t count) {
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.set_temp_bands(dev, bands, count);
+    epd_async_unlock(as);
+    return err;
+}
+
+// 以下操作改变后续刷新的前提 (睡眠、方向、显示模式), 排队中的异步刷新须先按原状态完成;
+// 在取锁之前等待, 工作任务执行这些刷新时需要设备锁
+static esp_err_t epd_async_sleep(epd_device_t *dev) {
+    epd_async_flush(dev, EPD_WAIT_FOREVER);
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.sleep(dev);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_set_rotation(epd_device_t *dev, uint8_t rotation) {
+    epd_async_flush(dev, EPD_WAIT_FOREVER);
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.set_rotation(dev, rotation);
+    epd_async_unlock(as);
+    return err;
+}
+
+static esp_err_t epd_async_set_display_mode(epd_device_t *dev, epd_display_mode_t mode) {
+    epd_async_flush(dev, EPD_WAIT_FOREVER);
+    struct epd_async_t *as = epd_async_acquire(dev);
+    esp_err_t err = as->ops.set_display_mode(dev, mode);
+    epd_async_unlock(as);
+    return err;
+}
+
+// 驱动未实现的操作保持为NULL
+#define EPD_ASYNC_WRAP(dev, op, fn) do {                 \
+        if ((dev)->op) {                                 \
+            (dev)->op = (fn);                            \
+        }                                                \
+    } while (0)
+
+static void epd_async_wrap_ops(epd_device_t *dev) {
+    EPD_ASYNC_WRAP(dev, reset, epd_async_reset);
+    EPD_ASYNC_WRAP(dev, clear, epd_async_clear);
+    EPD_ASYNC_WRAP(dev, display_buffer, epd_async_sync_buffer);
+    EPD_ASYNC_WRAP(dev, display_partial, epd_async_sync_partial);
+    EPD_ASYNC_WRAP(dev, display_window, epd_async_window);
+    EPD_ASYNC_WRAP(dev, display_windows, epd_async_windows);
+    EPD_ASYNC_WRAP(dev, display_planes, epd_async_planes);
+    EPD_ASYNC_WRAP(dev, display_stream, epd_async_stream);
+    EPD_ASYNC_WRAP(dev, display_bands, epd_async_bands);
+    EPD_ASYNC_WRAP(dev, begin_update, epd_async_begin_update);
+    EPD_ASYNC_WRAP(dev, finish_update, epd_async_finish_update);
+    EPD_ASYNC_WRAP(dev, refresh, epd_async_refresh);
+    EPD_ASYNC_WRAP(dev, sleep, epd_async_sleep);
+    EPD_ASYNC_WRAP(dev, wakeup, epd_async_wakeup);
+    EPD_ASYNC_WRAP(dev, power_on, epd_async_power_on);
+    EPD_ASYNC_WRAP(dev, power_off, epd_async_power_off);
+    EPD_ASYNC_WRAP(dev, set_rotation, epd_async_set_rotation);
+    EPD_ASYNC_WRAP(dev, invert, epd_async_invert);
+    EPD_ASYNC_WRAP(dev, set_display_mode, epd_async_set_display_mode);
+    EPD_ASYNC_WRAP(dev, read_temperature, epd_async_read_temperature);
+    EPD_ASYNC_WRAP(dev, set_temp_bands, epd_async_set_temp_bands);
+}
+
+static void epd_async_restore_ops(epd_device_t *dev, const epd_device_t *ops) {
+    dev->reset = ops->reset;
+    dev->clear = ops->clear;
+    dev->display_buffer = ops->display_buffer;
+    dev->display_partial = ops->display_partial;
+    dev->display_window = ops->display_window;
+    dev->display_windows = ops->display_windows;
+    dev->display_planes = ops->display_planes;
+    dev->display_stream = ops->display_stream;
+    dev->display_bands = ops->display_bands;
+    dev->begin_update = ops->begin_update;
+    dev->finish_update = ops->finish_update;
+    dev->refresh = ops->refresh;
+    dev->sleep = ops->sleep;
+    dev->wakeup = ops->wakeup;
+    dev->power_on = ops->power_on;
+    dev->power_off = ops->power_off;
+    dev->set_rotation = ops->set_rotation;
+    dev->invert = ops->invert;
+    dev->set_display_mode = ops->set_display_mode;
+    dev->read_temperature = ops->read_temperature;
+    dev->set_temp_bands = ops->set_temp_bands;
+}
+
+// 启动工作任务
+esp_err_t epd_async_start(epd_device_t *dev) {
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (dev->async) {
+        return ESP_OK;
+    }
+    
+    struct epd_async_t *as = calloc(1, sizeof(struct epd_async_t));
+    if (!as) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    as->dev = dev;
+    as->queue = xQueueCreate(EPD_ASYNC_QUEUE_LEN + 1, sizeof(struct epd_async_job_t *));
+    as->slots = xSemaphoreCreateCounting(EPD_ASYNC_QUEUE_LEN, EPD_ASYNC_QUEUE_LEN);
+    as->stopped = xSemaphoreCreateBinary();
+    as->lock = xSemaphoreCreateRecursiveMutex();
+    if (!as->queue || !as->slots || !as->stopped || !as->lock) {
+        epd_async_free(as);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    for (int i = 0; i < EPD_ASYNC_QUEUE_LEN; i++) {
+        as->jobs[i].owner = as;
+        as->jobs[i].done = xSemaphoreCreateBinary();
+        if (!as->jobs[i].done) {
+            epd_async_free(as);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    as->stop_job.owner = as;
+    as->stop_job.kind = EPD_ASYNC_JOB_STOP;
+    as->ops = *dev;
+    
+    if (xTaskCreate(epd_async_task, "epd_async", EPD_ASYNC_TASK_STACK,
+                    as, EPD_ASYNC_TASK_PRIO, &as->task) != pdPASS) {
+        ESP_LOGE(TAG, "创建异步刷新任务失败");
+        epd_async_free(as);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    dev->async = as;
+    epd_async_wrap_ops(dev);
+    return ESP_OK;
+}
+
+// 停止工作任务, 已排队的请求会先执行完
+void epd_async_stop(epd_device_t *dev) {
+    if (!dev || !dev->async) {
+        return;
+    }
+    
+    struct epd_async_t *as = dev->async;
+    struct epd_async_job_t *job = &as->stop_job;
+    
+    xQueueSend(as->queue, &job, portMAX_DELAY);
+    xSemaphoreTake(as->stopped, portMAX_DELAY);
+    
+    epd_async_restore_ops(dev, &as->ops);
+    dev->async = NULL;
+    epd_async_free(as);
+}
+
+// 提交请求
+static esp_err_t epd_async_submit(epd_device_t *dev,
+                                  const struct epd_async_job_t *req,
+                                  epd_async_handle_t *handle, uint32_t timeout_ms) {
+    if (!dev || !dev->async) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    struct epd_async_t *as = dev->async;
+    
+    // 没有空闲槽位时阻塞, 形成背压
+    if (xSemaphoreTake(as->slots, epd_async_ticks(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    struct epd_async_job_t *job = NULL;
+    portENTER_CRITICAL(&s_async_lock);
+    for (int i = 0; i < EPD_ASYNC_QUEUE_LEN; i++) {
+        if (!as->jobs[i].in_use) {
+            job = &as->jobs[i];
+            job->in_use = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_async_lock);
+    
+    if (!job) {
+        xSemaphoreGive(as->slots);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    job->kind = req->kind;
+    job->buffer = req->buffer;
+    job->mode = req->mode;
+    job->x = req->x;
+    job->y = req->y;
+    job->width = req->width;
+    job->height = req->height;
+    job->cb = req->cb;
+    job->user_ctx = req->user_ctx;
+    job->has_handle = (handle != NULL);
+    job->finished = false;
+    job->result = ESP_OK;
+    xSemaphoreTake(job->done, 0);
+    
+    if (handle) {
+        *handle = job;
+    }
+    
+    xQueueSend(as->queue, &job, portMAX_DELAY);
+    return ESP_OK;
+}
+
+// 异步全屏刷新
+esp_err_t epd_async_display_buffer(epd_device_t *dev, const uint8_t *buffer,
+                                   epd_update_mode_t mode,
+                                   epd_async_cb_t cb, void *user_ctx,
+                                   epd_async_handle_t *handle) {
+    if (!dev || !buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_async_job_t req = {
+        .kind = EPD_ASYNC_JOB_BUFFER,
+        .buffer = buffer,
+        .mode = mode,
+        .cb = cb,
+        .user_ctx = user_ctx,
+    };
+    
+    return epd_async_submit(dev, &req, handle, EPD_WAIT_FOREVER);
+}
+
+// 异步局部刷新
+esp_err_t epd_async_display_partial(epd_device_t *dev, const uint8_t *buffer,
+                                    uint16_t x, uint16_t y,
+                                    uint16_t width, uint16_t height,
+                                    epd_async_cb_t cb, void *user_ctx,
+                                    epd_async_handle_t *handle) {
+    if (!dev || !buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_async_job_t req = {
+        .kind = EPD_ASYNC_JOB_PARTIAL,
+        .buffer = buffer,
+        .x = x,
+        .y = y,
+        .width = width,
+        .height = height,
+        .cb = cb,
+        .user_ctx = user_ctx,
+    };
+    
+    return epd_async_submit(dev, &req, handle, EPD_WAIT_FOREVER);
+}
+
+// 等待请求完成并释放句柄, 超时时句柄仍然有效
+esp_err_t epd_async_wait(epd_async_handle_t handle, uint32_t timeout_ms) {
+    if (!handle || !handle->in_use || !handle->has_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (xSemaphoreTake(handle->done, epd_async_ticks(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    esp_err_t result = handle->result;
+    epd_async_release(handle);
+    return result;
+}
+
+// 放弃等待: 请求仍由工作任务执行, 执行完后由工作任务归还槽位
+static void epd_async_detach(struct epd_async_job_t *job) {
+    portENTER_CRITICAL(&s_async_lock);
+    bool finished = job->finished;
+    job->has_handle = false;
+    portEXIT_CRITICAL(&s_async_lock);
+    
+    // 在超时与放弃之间已执行完: 工作任务发出了完成信号, 由这里归还
+    if (finished) {
+        xSemaphoreTake(job->done, 0);
+        epd_async_release(job);
+    }
+}
+
+// 等待之前提交的所有请求执行完毕; 超时包括等待空闲槽位的时间, 超时后不占用槽位
+esp_err_t epd_async_flush(epd_device_t *dev, uint32_t timeout_ms) {
+    struct epd_async_job_t req = {
+        .kind = EPD_ASYNC_JOB_FLUSH,
+    };
+    epd_async_handle_t handle;
+    TickType_t start = xTaskGetTickCount();
+    
+    esp_err_t err = epd_async_submit(dev, &req, &handle, timeout_ms);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    uint32_t remain_ms = timeout_ms;
+    if (timeout_ms != EPD_WAIT_FOREVER) {
+        uint32_t spent_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        remain_ms = spent_ms < timeout_ms ? timeout_ms - spent_ms : 0;
+    }
+    
+    err = epd_async_wait(handle, remain_ms);
+    if (err == ESP_ERR_TIMEOUT) {
+        epd_async_detach(handle);
+    }
+    return err;
+}
@@ -0,0 +1,238 @@
+/**
+ * 墨水屏通用工具函数
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+#include "epd_common.h"
+#include "epd_internal.h"
+
+#define TAG "EPD_COMMON"
+
+// BUSY中断等待器
+struct epd_busy_waiter_t {
+    SemaphoreHandle_t done;    // BUSY下降沿时释放
+    int8_t busy_pin;
+};
+
+// 初始化SPI总线和设备
+esp_err_t epd_spi_init(epd_device_t *dev, spi_host_device_t host, int clock_speed) {
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 已经初始化过则直接返回
+    if (dev->spi_dev) {
+        return ESP_OK;
+    }
+    
+    spi_bus_config_t buscfg = {
+        .mosi_io_num = dev->pins.spi_mosi,
+        .miso_io_num = dev->pins.spi_miso,
+        .sclk_io_num = dev->pins.spi_clk,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = EPD_TRANSPORT_CHUNK_SIZE,
+    };
+    
+    // 总线可能已被同一主机上的其他设备初始化
+    esp_err_t err = spi_bus_initialize(host, &buscfg, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "SPI总线初始化失败: %d", err);
+        return err;
+    }
+    
+    spi_device_interface_config_t devcfg = {
+        .mode = 0,
+        .clock_speed_hz = clock_speed,
+        .spics_io_num = dev->pins.spi_cs,
+        .queue_size = EPD_TRANSPORT_QUEUE_DEPTH,
+        .pre_cb = epd_transport_pre_cb,
+    };
+    
+    err = spi_bus_add_device(host, &devcfg, &dev->spi_dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "添加SPI设备失败: %d", err);
+        return err;
+    }
+    
+    err = epd_transport_init(dev, NULL);
+    if (err != ESP_OK) {
+        spi_bus_remove_device(dev->spi_dev);
+        dev->spi_dev = NULL;
+        return err;
+    }
+    
+    return ESP_OK;
+}
+
+// 毫秒延时
+void epd_delay_ms(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+// 读取BUSY引脚 (高电平表示忙)
+bool epd_is_busy(epd_device_t *dev) {
+    return gpio_get_level(dev->pins.busy_pin) == 1;
+}
+
+// BUSY下降沿中断
+static void IRAM_ATTR epd_busy_isr(void *arg) {
+    struct epd_busy_waiter_t *waiter = (struct epd_busy_waiter_t *)arg;
+    BaseType_t woken = pdFALSE;
+    
+    xSemaphoreGiveFromISR(waiter->done, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// 安装BUSY中断
+esp_err_t epd_busy_init(epd_device_t *dev) {
+    if (!dev || dev->pins.busy_pin < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (dev->busy_waiter) {
+        return ESP_OK;
+    }
+    
+    struct epd_busy_waiter_t *waiter = calloc(1, sizeof(struct epd_busy_waiter_t));
+    if (!waiter) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    waiter->done = xSemaphoreCreateBinary();
+    if (!waiter->done) {
+        free(waiter);
+        return ESP_ERR_NO_MEM;
+    }
+    waiter->busy_pin = dev->pins.busy_pin;
+    
+    // ISR服务可能已由其他设备或应用安装
+    esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "安装GPIO中断服务失败: %d", err);
+        goto fail;
+    }
+    
+    gpio_set_intr_type(waiter->busy_pin, GPIO_INTR_NEGEDGE);
+    err = gpio_isr_handler_add(waiter->busy_pin, epd_busy_isr, waiter);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "注册BUSY中断失败: %d", err);
+        goto fail;
+    }
+    // 仅在等待期间使能中断
+    gpio_intr_disable(waiter->busy_pin);
+    
+    dev->busy_waiter = waiter;
+    return ESP_OK;
+    
+fail:
+    vSemaphoreDelete(waiter->done);
+    free(waiter);
+    return err;
+}
+
+// 卸载BUSY中断
+void epd_busy_deinit(epd_device_t *dev) {
+    if (!dev || !dev->busy_waiter) {
+        return;
+    }
+    
+    struct epd_busy_waiter_t *waiter = dev->busy_waiter;
+    gpio_intr_disable(waiter->busy_pin);
+    gpio_isr_handler_remove(waiter->busy_pin);
+    vSemaphoreDelete(waiter->done);
+    free(waiter);
+    dev->busy_waiter = NULL;
+}
+
+// 等待BUSY释放
+static esp_err_t epd_wait_busy_low(epd_device_t *dev, uint32_t timeout_ms) {
+    if (timeout_ms == 0) {
+        timeout_ms = dev->busy_timeout_ms ? dev->busy_timeout_ms : EPD_BUSY_TIMEOUT_MS;
+    }
+    
+    if (!epd_is_busy(dev)) {
+        return ESP_OK;
+    }
+    
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    struct epd_busy_waiter_t *waiter = dev->busy_waiter;
+    
+    // 未安装中断时退化为逐tick轮询
+    if (!waiter) {
+        while (epd_is_busy(dev)) {
+            if (xTaskGetTickCount() - start >= timeout) {
+                ESP_LOGE(TAG, "BUSY等待超时 (%u ms)", (unsigned)timeout_ms);
+                return ESP_ERR_TIMEOUT;
+            }
+            vTaskDelay(1);
+        }
+        return ESP_OK;
+    }
+    
+    // 清除上一次残留的信号, 使能中断后重新检查电平, 避免错过下降沿
+    xSemaphoreTake(waiter->done, 0);
+    gpio_intr_enable(waiter->busy_pin);
+    
+    esp_err_t err = ESP_OK;
+    while (epd_is_busy(dev)) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout ||
+            xSemaphoreTake(waiter->done, timeout - elapsed) != pdTRUE) {
+            if (epd_is_busy(dev)) {
+                ESP_LOGE(TAG, "BUSY等待超时 (%u ms)", (unsigned)timeout_ms);
+                err = ESP_ERR_TIMEOUT;
+            }
+            break;
+        }
+    }
+    
+    gpio_intr_disable(waiter->busy_pin);
+    return err;
+}
+
+esp_err_t epd_wait_busy(epd_device_t *dev, uint32_t timeout_ms) {
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = epd_wait_busy_low(dev, timeout_ms);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    
+    epd_trace_record(dev, EPD_TRACE_BUSY, 0, start_us, us, 0,
+                     err == ESP_OK ? 0 : EPD_TRACE_FLAG_ERROR);
+    if (dev->profile) {
+        dev->profile->phase_us[EPD_PHASE_BUSY] += us;
+    }
+    return err;
+}
+
+// 发送命令
+void epd_send_command(epd_device_t *dev, uint8_t cmd) {
+    epd_trace_record(dev, EPD_TRACE_CMD, cmd, 0, 0, 0, 0);
+    epd_transport_write(dev, 0, &cmd, 1);
+}
+
+// 发送单字节数据
+void epd_send_data(epd_device_t *dev, uint8_t data) {
+    epd_transport_write(dev, 1, &data, 1);
+}
+
+// 发送数据缓冲区
+void epd_send_data_buffer(epd_device_t *dev, const uint8_t *data, uint32_t length) {
+    epd_transport_send(dev, data, length);
+}
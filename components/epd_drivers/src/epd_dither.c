@@ -0,0 +1,402 @@
+/**
+ * 逐行定点抖动
+ * 误差以1/16像素级为单位保存在int16行中, 每行左右各留2个元素, 扩散时无需边界判断
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+
+#include "epd_common.h"
+#include "epd_framebuffer.h"
+#include "epd_dither.h"
+
+#define TAG "EPD_DITHER"
+
+#define EPD_DITHER_PAD          2
+#define EPD_DITHER_MAX_ROWS     3
+
+struct epd_dither_t {
+    epd_dither_config_t cfg;
+    uint8_t channels;           // 每像素误差通道数: 黑白1, 三色3 (RGB)
+    uint8_t err_rows;           // 误差行数: Floyd-Steinberg 2, Atkinson 3, 其他0
+    uint16_t y;                 // 下一个要处理的行
+    uint8_t *input;             // 一行输入像素
+    int16_t *err[EPD_DITHER_MAX_ROWS];
+    uint8_t *bw_row;            // 流式发送时的输出行
+    uint8_t *red_row;
+    uint16_t row_pos;           // 当前输出行已发送的字节数
+};
+
+// 8x8 Bayer矩阵 (0-63)
+static const uint8_t s_bayer8[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+static inline int32_t epd_dither_clamp(int32_t v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+// 将误差e(像素级)按算法扩散, 三色时stride为3 (按通道交错)
+static inline void epd_dither_spread(const epd_dither_t *d, int32_t x, int32_t e, int stride) {
+    int16_t *e0 = d->err[0];
+    int16_t *e1 = d->err[1];
+    
+    if (d->cfg.method == EPD_DITHER_FLOYD_STEINBERG) {
+        e0[(x + 1) * stride] += e * 7;
+        e1[(x - 1) * stride] += e * 3;
+        e1[x * stride] += e * 5;
+        e1[(x + 1) * stride] += e;
+    } else {
+        int16_t *e2 = d->err[2];
+        e *= 2;
+        e0[(x + 1) * stride] += e;
+        e0[(x + 2) * stride] += e;
+        e1[(x - 1) * stride] += e;
+        e1[x * stride] += e;
+        e1[(x + 1) * stride] += e;
+        e2[x * stride] += e;
+    }
+}
+
+// 误差行前移一行, 最后一行清零
+static void epd_dither_shift_errors(epd_dither_t *d) {
+    if (d->err_rows == 0) {
+        return;
+    }
+    
+    int16_t *first = d->err[0];
+    for (uint8_t i = 0; i + 1 < d->err_rows; i++) {
+        d->err[i] = d->err[i + 1];
+    }
+    d->err[d->err_rows - 1] = first;
+    
+    uint32_t len = ((uint32_t)d->cfg.width + 2 * EPD_DITHER_PAD) * d->channels;
+    memset(first, 0, len * sizeof(int16_t));
+}
+
+// 黑白调色板: 输入已转换为灰度
+static void epd_dither_row_bw(epd_dither_t *d, const uint8_t *gray, uint8_t *bw) {
+    uint16_t w = d->cfg.width;
+    uint8_t acc = 0;
+    
+    switch (d->cfg.method) {
+        case EPD_DITHER_THRESHOLD:
+            for (uint16_t x = 0; x < w; x++) {
+                acc = (acc << 1) | (gray[x] >= 128);
+                if ((x & 7) == 7) {
+                    *bw++ = acc;
+                }
+            }
+            break;
+    
+        case EPD_DITHER_BAYER: {
+            const uint8_t *m = s_bayer8[d->y & 7];
+            for (uint16_t x = 0; x < w; x++) {
+                acc = (acc << 1) | (gray[x] > m[x & 7] * 4 + 2);
+                if ((x & 7) == 7) {
+                    *bw++ = acc;
+                }
+            }
+            break;
+        }
+    
+        default: {
+            // 行首偏移PAD, 扩散到x-1和x+2时不会越界
+            int16_t *err0 = d->err[0];
+            int16_t *err1 = d->err[1];
+            int16_t *err2 = d->err[2];
+            d->err[0] += EPD_DITHER_PAD;
+            d->err[1] += EPD_DITHER_PAD;
+            if (d->err_rows > 2) {
+                d->err[2] += EPD_DITHER_PAD;
+            }
+    
+            for (uint16_t x = 0; x < w; x++) {
+                int32_t v = epd_dither_clamp(gray[x] + ((d->err[0][x] + 8) >> 4));
+                uint8_t white = v >= 128;
+    
+                epd_dither_spread(d, x, v - (white ? 255 : 0), 1);
+                acc = (acc << 1) | white;
+                if ((x & 7) == 7) {
+                    *bw++ = acc;
+                }
+            }
+    
+            d->err[0] = err0;
+            d->err[1] = err1;
+            d->err[2] = err2;
+            break;
+        }
+    }
+}
+
+// 三色调色板: 选取RGB距离最近的黑/白/红, 返回0黑 1白 2红
+static inline uint8_t epd_dither_nearest_bwr(int32_t r, int32_t g, int32_t b) {
+    int32_t gb = g * g + b * b;
+    int32_t ir = 255 - r;
+    int32_t d_black = r * r + gb;
+    int32_t d_red = ir * ir + gb;
+    int32_t d_white = ir * ir + (255 - g) * (255 - g) + (255 - b) * (255 - b);
+    
+    if (d_red < d_black && d_red < d_white) {
+        return 2;
+    }
+    return d_white < d_black ? 1 : 0;
+}
+
+static void epd_dither_row_bwr(epd_dither_t *d, const uint8_t *in, uint8_t *bw, uint8_t *red) {
+    static const uint8_t palette[3][3] = { { 0, 0, 0 }, { 255, 255, 255 }, { 255, 0, 0 } };
+    uint16_t w = d->cfg.width;
+    bool rgb = (d->cfg.format == EPD_DITHER_RGB888);
+    bool diffuse = (d->err_rows > 0);
+    const uint8_t *m = s_bayer8[d->y & 7];
+    uint8_t acc_bw = 0;
+    uint8_t acc_red = 0;
+    
+    int16_t *saved[EPD_DITHER_MAX_ROWS];
+    for (uint8_t i = 0; i < d->err_rows; i++) {
+        saved[i] = d->err[i];
+        d->err[i] += EPD_DITHER_PAD * 3;
+    }
+    
+    for (uint16_t x = 0; x < w; x++) {
+        int32_t c[3];
+        if (rgb) {
+            c[0] = in[x * 3];
+            c[1] = in[x * 3 + 1];
+            c[2] = in[x * 3 + 2];
+        } else {
+            c[0] = c[1] = c[2] = in[x];
+        }
+    
+        if (diffuse) {
+            for (int k = 0; k < 3; k++) {
+                c[k] = epd_dither_clamp(c[k] + ((d->err[0][x * 3 + k] + 8) >> 4));
+            }
+        } else if (d->cfg.method == EPD_DITHER_BAYER) {
+            int32_t bias = 126 - m[x & 7] * 4;
+            for (int k = 0; k < 3; k++) {
+                c[k] = epd_dither_clamp(c[k] + bias);
+            }
+        }
+    
+        uint8_t p = epd_dither_nearest_bwr(c[0], c[1], c[2]);
+    
+        if (diffuse) {
+            for (int k = 0; k < 3; k++) {
+                int16_t *base[EPD_DITHER_MAX_ROWS];
+                for (uint8_t i = 0; i < d->err_rows; i++) {
+                    base[i] = d->err[i];
+                    d->err[i] += k;
+                }
+                epd_dither_spread(d, x, c[k] - palette[p][k], 3);
+                for (uint8_t i = 0; i < d->err_rows; i++) {
+                    d->err[i] = base[i];
+                }
+            }
+        }
+    
+        acc_bw = (acc_bw << 1) | (p != 0);
+        acc_red = (acc_red << 1) | (p == 2);
+        if ((x & 7) == 7) {
+            *bw++ = acc_bw;
+            if (red) {
+                *red++ = acc_red;
+            }
+        }
+    }
+    
+    for (uint8_t i = 0; i < d->err_rows; i++) {
+        d->err[i] = saved[i];
+    }
+}
+
+epd_dither_t *epd_dither_create(const epd_dither_config_t *config) {
+    if (!config || !config->read_row || config->width == 0 || (config->width % 8) ||
+        config->height == 0) {
+        return NULL;
+    }
+    
+    epd_dither_t *d = calloc(1, sizeof(epd_dither_t));
+    if (!d) {
+        ESP_LOGE(TAG, "分配抖动器内存失败");
+        return NULL;
+    }
+    
+    d->cfg = *config;
+    d->channels = (config->palette == EPD_DITHER_PALETTE_BWR) ? 3 : 1;
+    d->err_rows = (config->method == EPD_DITHER_FLOYD_STEINBERG) ? 2 :
+                  (config->method == EPD_DITHER_ATKINSON) ? 3 : 0;
+    
+    uint32_t stride = config->width / 8;
+    uint32_t pixel_bytes = (config->format == EPD_DITHER_RGB888) ? 3 : 1;
+    uint32_t err_len = ((uint32_t)config->width + 2 * EPD_DITHER_PAD) * d->channels;
+    bool ok = true;
+    
+    d->input = malloc((uint32_t)config->width * pixel_bytes);
+    d->bw_row = malloc(stride);
+    d->red_row = malloc(stride);
+    ok = d->input && d->bw_row && d->red_row;
+    
+    for (uint8_t i = 0; ok && i < d->err_rows; i++) {
+        d->err[i] = calloc(err_len, sizeof(int16_t));
+        ok = (d->err[i] != NULL);
+    }
+    
+    if (!ok) {
+        ESP_LOGE(TAG, "分配行缓冲区失败");
+        epd_dither_destroy(d);
+        return NULL;
+    }
+    
+    return d;
+}
+
+void epd_dither_destroy(epd_dither_t *dither) {
+    if (!dither) {
+        return;
+    }
+    
+    for (uint8_t i = 0; i < EPD_DITHER_MAX_ROWS; i++) {
+        free(dither->err[i]);
+    }
+    free(dither->input);
+    free(dither->bw_row);
+    free(dither->red_row);
+    free(dither);
+}
+
+void epd_dither_reset(epd_dither_t *dither) {
+    if (!dither) {
+        return;
+    }
+    
+    uint32_t err_len = ((uint32_t)dither->cfg.width + 2 * EPD_DITHER_PAD) * dither->channels;
+    for (uint8_t i = 0; i < dither->err_rows; i++) {
+        memset(dither->err[i], 0, err_len * sizeof(int16_t));
+    }
+    dither->y = 0;
+}
+
+esp_err_t epd_dither_next_row(epd_dither_t *dither, uint8_t *bw_row, uint8_t *red_row) {
+    if (!dither || !bw_row) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (dither->y >= dither->cfg.height) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    epd_dither_t *d = dither;
+    d->cfg.read_row(d->cfg.ctx, d->y, d->input);
+    
+    if (d->channels == 3) {
+        epd_dither_row_bwr(d, d->input, bw_row, red_row);
+    } else {
+        // RGB输入先就地转换为灰度 (x处的写入总在3x处的读取之后)
+        if (d->cfg.format == EPD_DITHER_RGB888) {
+            for (uint16_t x = 0; x < d->cfg.width; x++) {
+                const uint8_t *p = d->input + x * 3;
+                d->input[x] = (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+            }
+        }
+        epd_dither_row_bw(d, d->input, bw_row);
+        if (red_row) {
+            memset(red_row, 0, d->cfg.width / 8);
+        }
+    }
+    
+    epd_dither_shift_errors(d);
+    d->y++;
+    
+    return ESP_OK;
+}
+
+esp_err_t epd_dither_to_buffer(epd_dither_t *dither, uint8_t *bw, uint8_t *red) {
+    if (!dither || !bw) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint16_t stride = dither->cfg.width / 8;
+    
+    epd_dither_reset(dither);
+    for (uint16_t y = 0; y < dither->cfg.height; y++) {
+        epd_dither_next_row(dither, bw + (uint32_t)y * stride,
+                            red ? red + (uint32_t)y * stride : NULL);
+    }
+    
+    epd_fb_t *fb = epd_fb_from_buffer(bw);
+    if (fb) {
+        epd_fb_mark_dirty(fb, 0, 0, dither->cfg.width, dither->cfg.height);
+    }
+    
+    return ESP_OK;
+}
+
+// 传输数据源: 按需抖动下一行, offset为0时从头开始
+typedef struct {
+    epd_dither_t *dither;
+    bool red;
+} epd_dither_stream_t;
+
+static void epd_dither_source(void *ctx, uint8_t *dst, uint32_t offset, uint32_t length) {
+    epd_dither_stream_t *stream = (epd_dither_stream_t *)ctx;
+    epd_dither_t *d = stream->dither;
+    uint16_t stride = d->cfg.width / 8;
+    
+    if (offset == 0) {
+        epd_dither_reset(d);
+        d->row_pos = stride;
+    }
+    
+    while (length) {
+        if (d->row_pos == stride) {
+            epd_dither_next_row(d, d->bw_row, d->channels == 3 ? d->red_row : NULL);
+            d->row_pos = 0;
+        }
+    
+        uint32_t n = stride - d->row_pos;
+        if (n > length) {
+            n = length;
+        }
+    
+        memcpy(dst, (stream->red ? d->red_row : d->bw_row) + d->row_pos, n);
+        d->row_pos += n;
+        dst += n;
+        length -= n;
+    }
+}
+
+esp_err_t epd_display_dithered(epd_device_t *dev, epd_dither_t *dither,
+                               epd_update_mode_t mode) {
+    if (!dev || !dither) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!dev->display_stream) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if (dither->cfg.width != dev->info.width || dither->cfg.height != dev->info.height) {
+        ESP_LOGE(TAG, "图像尺寸 %dx%d 与屏幕 %dx%d 不符", dither->cfg.width,
+                 dither->cfg.height, dev->info.width, dev->info.height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    epd_dither_stream_t bw = { .dither = dither, .red = false };
+    epd_dither_stream_t red = { .dither = dither, .red = true };
+    
+    if (dither->channels == 3 && dev->info.color_mode == EPD_MODE_3C) {
+        return dev->display_stream(dev, epd_dither_source, &bw, epd_dither_source, &red, mode);
+    }
+    
+    return dev->display_stream(dev, epd_dither_source, &bw, NULL, NULL, mode);
+}
@@ -0,0 +1,454 @@
+/**
+ * 保留模式显示列表
+ * 节点保存在固定数组中, 编号即下标; 修改节点时把新旧包围盒并入损坏区列表,
+ * 提交时逐个损坏区设置帧缓冲区裁剪区, 填充背景后按顺序重绘相交的节点
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_font.h"
+#include "epd_framebuffer.h"
+#include "epd_dlist.h"
+
+#define TAG "EPD_DLIST"
+
+typedef enum {
+    EPD_DL_RECT,
+    EPD_DL_LINE,
+    EPD_DL_CIRCLE,
+    EPD_DL_TEXT,
+    EPD_DL_BITMAP,
+} epd_dl_type_t;
+
+// 显示列表节点
+typedef struct {
+    bool used;
+    bool visible;
+    bool filled;
+    uint8_t type;
+    uint8_t scale;
+    epd_color_t color;
+    uint16_t x;                 // 矩形/文字/位图左上角, 直线起点, 圆心
+    uint16_t y;
+    uint16_t w;                 // 矩形/位图宽度, 直线终点x, 圆半径
+    uint16_t h;                 // 矩形/位图高度, 直线终点y
+    const epd_font_t *font;
+    const uint8_t *bitmap;
+    char text[EPD_DL_TEXT_MAX];
+    epd_rect_t bbox;            // 屏幕内的包围盒, 宽或高为0表示不在屏幕内
+} epd_dl_node_t;
+
+struct epd_dlist_t {
+    epd_fb_t *fb;
+    epd_color_t bg;
+    epd_dl_node_t nodes[EPD_DL_MAX_NODES];
+    epd_rect_t damage[EPD_DL_MAX_DAMAGE];
+    uint8_t damage_count;
+    epd_dlist_stats_t stats;
+};
+
+static bool epd_dl_rect_empty(const epd_rect_t *r) {
+    return r->width == 0 || r->height == 0;
+}
+
+static bool epd_dl_rect_intersects(const epd_rect_t *a, const epd_rect_t *b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+// 相交或相邻
+static bool epd_dl_rect_touches(const epd_rect_t *a, const epd_rect_t *b) {
+    return a->x <= b->x + b->width && b->x <= a->x + a->width &&
+           a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+static epd_rect_t epd_dl_rect_union(const epd_rect_t *a, const epd_rect_t *b) {
+    uint16_t x0 = a->x < b->x ? a->x : b->x;
+    uint16_t y0 = a->y < b->y ? a->y : b->y;
+    uint16_t x1 = (a->x + a->width > b->x + b->width) ? a->x + a->width : b->x + b->width;
+    uint16_t y1 = (a->y + a->height > b->y + b->height) ? a->y + a->height : b->y + b->height;
+    epd_rect_t r = { x0, y0, x1 - x0, y1 - y0 };
+    return r;
+}
+
+// 将闭区间[x0, x1] x [y0, y1]限制在屏幕内
+static epd_rect_t epd_dl_clamp(const epd_dlist_t *dl, int32_t x0, int32_t y0,
+                               int32_t x1, int32_t y1) {
+    epd_rect_t r = { 0, 0, 0, 0 };
+    
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= dl->fb->width) x1 = dl->fb->width - 1;
+    if (y1 >= dl->fb->height) y1 = dl->fb->height - 1;
+    if (x1 < x0 || y1 < y0) {
+        return r;
+    }
+    
+    r.x = x0;
+    r.y = y0;
+    r.width = x1 - x0 + 1;
+    r.height = y1 - y0 + 1;
+    return r;
+}
+
+// 计算节点包围盒 (与对应epd_draw_*函数实际写入的范围一致)
+static epd_rect_t epd_dl_bbox(const epd_dlist_t *dl, const epd_dl_node_t *n) {
+    switch (n->type) {
+    case EPD_DL_RECT:
+    case EPD_DL_BITMAP:
+        return epd_dl_clamp(dl, n->x, n->y, (int32_t)n->x + n->w - 1, (int32_t)n->y + n->h - 1);
+    case EPD_DL_LINE:
+        return epd_dl_clamp(dl, n->x < n->w ? n->x : n->w, n->y < n->h ? n->y : n->h,
+                            n->x > n->w ? n->x : n->w, n->y > n->h ? n->y : n->h);
+    case EPD_DL_CIRCLE:
+        return epd_dl_clamp(dl, (int32_t)n->x - n->w, (int32_t)n->y - n->w,
+                            (int32_t)n->x + n->w, (int32_t)n->y + n->w);
+    case EPD_DL_TEXT: {
+        uint16_t height = 0;
+        uint32_t width = epd_font_measure(n->font, n->text, n->scale, &height);
+        if (width == 0) {
+            epd_rect_t none = { 0, 0, 0, 0 };
+            return none;
+        }
+        return epd_dl_clamp(dl, n->x, n->y, (int32_t)n->x + width - 1,
+                            (int32_t)n->y + height - 1);
+    }
+    default: {
+        epd_rect_t none = { 0, 0, 0, 0 };
+        return none;
+    }
+    }
+}
+
+// 记录损坏区
+static void epd_dl_damage(epd_dlist_t *dl, const epd_rect_t *rect) {
+    if (epd_dl_rect_empty(rect)) {
+        return;
+    }
+    
+    for (uint8_t i = 0; i < dl->damage_count; i++) {
+        if (epd_dl_rect_touches(&dl->damage[i], rect)) {
+            dl->damage[i] = epd_dl_rect_union(&dl->damage[i], rect);
+            return;
+        }
+    }
+    
+    if (dl->damage_count < EPD_DL_MAX_DAMAGE) {
+        dl->damage[dl->damage_count++] = *rect;
+        return;
+    }
+    
+    // 列表已满: 并入使面积增长最小的损坏区
+    uint8_t best = 0;
+    uint32_t best_growth = UINT32_MAX;
+    for (uint8_t i = 0; i < dl->damage_count; i++) {
+        epd_rect_t u = epd_dl_rect_union(&dl->damage[i], rect);
+        uint32_t growth = (uint32_t)u.width * u.height -
+                          (uint32_t)dl->damage[i].width * dl->damage[i].height;
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    dl->damage[best] = epd_dl_rect_union(&dl->damage[best], rect);
+}
+
+// 节点修改前后调用: 旧包围盒和新包围盒都需要重绘
+static void epd_dl_invalidate(epd_dlist_t *dl, epd_dl_node_t *n) {
+    epd_dl_damage(dl, &n->bbox);
+    n->bbox = epd_dl_bbox(dl, n);
+    epd_dl_damage(dl, &n->bbox);
+}
+
+static epd_dl_node_t *epd_dl_get(epd_dlist_t *dl, uint8_t id) {
+    if (!dl || id >= EPD_DL_MAX_NODES || !dl->nodes[id].used) {
+        return NULL;
+    }
+    return &dl->nodes[id];
+}
+
+// 占用空闲节点并记录损坏区
+static esp_err_t epd_dl_insert(epd_dlist_t *dl, const epd_dl_node_t *node, uint8_t *id) {
+    for (uint8_t i = 0; i < EPD_DL_MAX_NODES; i++) {
+        epd_dl_node_t *n = &dl->nodes[i];
+        if (n->used) {
+            continue;
+        }
+    
+        *n = *node;
+        n->used = true;
+        n->visible = true;
+        n->bbox = epd_dl_bbox(dl, n);
+        epd_dl_damage(dl, &n->bbox);
+        if (id) {
+            *id = i;
+        }
+        return ESP_OK;
+    }
+    
+    ESP_LOGW(TAG, "显示列表已满 (%d个节点)", EPD_DL_MAX_NODES);
+    return ESP_ERR_NO_MEM;
+}
+
+static void epd_dl_draw_node(epd_dlist_t *dl, const epd_dl_node_t *n) {
+    uint8_t *buf = dl->fb->buffer;
+    uint16_t width = dl->fb->width;
+    uint16_t height = dl->fb->height;
+    
+    switch (n->type) {
+    case EPD_DL_RECT:
+        epd_draw_rect(buf, width, height, n->x, n->y, n->w, n->h, n->color, n->filled);
+        break;
+    case EPD_DL_LINE:
+        epd_draw_line(buf, width, height, n->x, n->y, n->w, n->h, n->color);
+        break;
+    case EPD_DL_CIRCLE:
+        epd_draw_circle(buf, width, height, n->x, n->y, n->w, n->color, n->filled);
+        break;
+    case EPD_DL_TEXT:
+        epd_font_draw(buf, width, height, n->font, n->text, n->x, n->y, n->color, n->scale);
+        break;
+    case EPD_DL_BITMAP:
+        epd_draw_bitmap(buf, width, height, n->x, n->y, n->bitmap, n->w, n->h, n->color);
+        break;
+    default:
+        break;
+    }
+}
+
+// 创建显示列表
+epd_dlist_t *epd_dlist_create(epd_fb_t *fb, epd_color_t bg) {
+    if (!fb) {
+        return NULL;
+    }
+    
+    epd_dlist_t *dl = calloc(1, sizeof(epd_dlist_t));
+    if (!dl) {
+        return NULL;
+    }
+    
+    dl->fb = fb;
+    dl->bg = bg;
+    
+    // 帧缓冲区原有内容不属于列表, 首次提交重绘整屏
+    epd_rect_t all = { 0, 0, fb->width, fb->height };
+    epd_dl_damage(dl, &all);
+    return dl;
+}
+
+// 销毁显示列表 (帧缓冲区仍由调用方释放)
+void epd_dlist_destroy(epd_dlist_t *dl) {
+    free(dl);
+}
+
+esp_err_t epd_dlist_add_rect(epd_dlist_t *dl, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                             epd_color_t color, bool filled, uint8_t *id) {
+    if (!dl || w == 0 || h == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_dl_node_t n = { .type = EPD_DL_RECT, .color = color, .filled = filled,
+                        .x = x, .y = y, .w = w, .h = h };
+    return epd_dl_insert(dl, &n, id);
+}
+
+esp_err_t epd_dlist_add_line(epd_dlist_t *dl, uint16_t x1, uint16_t y1,
+                             uint16_t x2, uint16_t y2, epd_color_t color, uint8_t *id) {
+    if (!dl) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_dl_node_t n = { .type = EPD_DL_LINE, .color = color,
+                        .x = x1, .y = y1, .w = x2, .h = y2 };
+    return epd_dl_insert(dl, &n, id);
+}
+
+esp_err_t epd_dlist_add_circle(epd_dlist_t *dl, uint16_t cx, uint16_t cy, uint16_t r,
+                               epd_color_t color, bool filled, uint8_t *id) {
+    if (!dl) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_dl_node_t n = { .type = EPD_DL_CIRCLE, .color = color, .filled = filled,
+                        .x = cx, .y = cy, .w = r };
+    return epd_dl_insert(dl, &n, id);
+}
+
+esp_err_t epd_dlist_add_text(epd_dlist_t *dl, const epd_font_t *font, const char *text,
+                             uint16_t x, uint16_t y, epd_color_t color, uint8_t scale,
+                             uint8_t *id) {
+    if (!dl || !font || !text) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_dl_node_t n = { .type = EPD_DL_TEXT, .color = color, .scale = scale,
+                        .x = x, .y = y, .font = font };
+    strncpy(n.text, text, EPD_DL_TEXT_MAX - 1);
+    return epd_dl_insert(dl, &n, id);
+}
+
+esp_err_t epd_dlist_add_bitmap(epd_dlist_t *dl, const uint8_t *bitmap, uint16_t x, uint16_t y,
+                               uint16_t w, uint16_t h, epd_color_t color, uint8_t *id) {
+    if (!dl || !bitmap || w == 0 || h == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_dl_node_t n = { .type = EPD_DL_BITMAP, .color = color, .bitmap = bitmap,
+                        .x = x, .y = y, .w = w, .h = h };
+    return epd_dl_insert(dl, &n, id);
+}
+
+// 修改文字节点内容
+esp_err_t epd_dlist_set_text(epd_dlist_t *dl, uint8_t id, const char *text) {
+    epd_dl_node_t *n = epd_dl_get(dl, id);
+    if (!n || !text || n->type != EPD_DL_TEXT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (strncmp(n->text, text, EPD_DL_TEXT_MAX - 1) == 0) {
+        return ESP_OK;
+    }
+    
+    strncpy(n->text, text, EPD_DL_TEXT_MAX - 1);
+    if (n->visible) {
+        epd_dl_invalidate(dl, n);
+    } else {
+        n->bbox = epd_dl_bbox(dl, n);
+    }
+    return ESP_OK;
+}
+
+esp_err_t epd_dlist_set_color(epd_dlist_t *dl, uint8_t id, epd_color_t color) {
+    epd_dl_node_t *n = epd_dl_get(dl, id);
+    if (!n) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (n->color != color) {
+        n->color = color;
+        if (n->visible) {
+            epd_dl_damage(dl, &n->bbox);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t epd_dlist_set_visible(epd_dlist_t *dl, uint8_t id, bool visible) {
+    epd_dl_node_t *n = epd_dl_get(dl, id);
+    if (!n) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (n->visible != visible) {
+        n->visible = visible;
+        epd_dl_damage(dl, &n->bbox);
+    }
+    return ESP_OK;
+}
+
+esp_err_t epd_dlist_move(epd_dlist_t *dl, uint8_t id, uint16_t x, uint16_t y) {
+    epd_dl_node_t *n = epd_dl_get(dl, id);
+    if (!n) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (n->x == x && n->y == y) {
+        return ESP_OK;
+    }
+    
+    // 直线的终点随起点平移
+    if (n->type == EPD_DL_LINE) {
+        n->w = (uint16_t)((int32_t)n->w + x - n->x);
+        n->h = (uint16_t)((int32_t)n->h + y - n->y);
+    }
+    n->x = x;
+    n->y = y;
+    
+    if (n->visible) {
+        epd_dl_invalidate(dl, n);
+    } else {
+        n->bbox = epd_dl_bbox(dl, n);
+    }
+    return ESP_OK;
+}
+
+esp_err_t epd_dlist_remove(epd_dlist_t *dl, uint8_t id) {
+    epd_dl_node_t *n = epd_dl_get(dl, id);
+    if (!n) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (n->visible) {
+        epd_dl_damage(dl, &n->bbox);
+    }
+    n->used = false;
+    return ESP_OK;
+}
+
+esp_err_t epd_dlist_touch(epd_dlist_t *dl, uint8_t id) {
+    epd_dl_node_t *n = epd_dl_get(dl, id);
+    if (!n) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (n->visible) {
+        epd_dl_damage(dl, &n->bbox);
+    }
+    return ESP_OK;
+}
+
+// 重绘损坏区并提交
+esp_err_t epd_dlist_commit(epd_dlist_t *dl, epd_fb_commit_t *path) {
+    if (!dl) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_fb_t *fb = dl->fb;
+    int64_t t0 = esp_timer_get_time();
+    
+    for (uint8_t d = 0; d < dl->damage_count; d++) {
+        const epd_rect_t *rect = &dl->damage[d];
+    
+        // 裁剪到损坏区: 背景和节点只改写损坏区内的像素, 脏区也不会超出损坏区
+        epd_fb_set_clip(fb, rect);
+        epd_draw_rect(fb->buffer, fb->width, fb->height, rect->x, rect->y,
+                      rect->width, rect->height, dl->bg, true);
+    
+        for (uint8_t i = 0; i < EPD_DL_MAX_NODES; i++) {
+            const epd_dl_node_t *n = &dl->nodes[i];
+            if (!n->used || !n->visible) {
+                continue;
+            }
+            if (!epd_dl_rect_intersects(&n->bbox, rect)) {
+                dl->stats.nodes_skipped++;
+                continue;
+            }
+            epd_dl_draw_node(dl, n);
+            dl->stats.nodes_drawn++;
+        }
+    
+        dl->stats.regions++;
+        dl->stats.pixels_redrawn += (uint32_t)rect->width * rect->height;
+    }
+    
+    epd_fb_set_clip(fb, NULL);
+    dl->damage_count = 0;
+    dl->stats.commits++;
+    dl->stats.last_raster_us = (uint32_t)(esp_timer_get_time() - t0);
+    
+    return epd_fb_commit(fb, path);
+}
+
+// 获取统计
+esp_err_t epd_dlist_get_stats(epd_dlist_t *dl, epd_dlist_stats_t *stats) {
+    if (!dl || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    memcpy(stats, &dl->stats, sizeof(epd_dlist_stats_t));
+    return ESP_OK;
+}
@@ -0,0 +1,378 @@
+/**
+ * 墨水屏绘图函数
+ * 缓冲区格式: 1bpp, 行优先, 每字节高位在左, 位为1表示白色
+ * 托管的三色帧缓冲区另有红色平面, 绘制EPD_COLOR_RED时写入红色平面
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+
+#include "epd_common.h"
+#include "epd_framebuffer.h"
+#include "epd_font.h"
+#include "epd_internal.h"
+
+#define TAG "EPD_DRAW"
+
+// 写单个像素 (不做脏区记录), 裁剪区外的像素忽略
+// 无红色平面时, 除白色外的颜色都画为黑色
+static inline void epd_canvas_put(const epd_canvas_t *cv, int32_t x, int32_t y,
+                                  epd_color_t color) {
+    if (x < cv->clip_x0 || y < cv->clip_y0 || x >= cv->clip_x1 || y >= cv->clip_y1) {
+        return;
+    }
+    
+    uint32_t byte_idx = y * (cv->width / 8) + (x / 8);
+    uint8_t bit_mask = 0x80 >> (x % 8);
+    
+    if (color == EPD_COLOR_WHITE || (color == EPD_COLOR_RED && cv->red)) {
+        cv->bw[byte_idx] |= bit_mask;
+    } else {
+        cv->bw[byte_idx] &= ~bit_mask;
+    }
+    
+    if (cv->red) {
+        if (color == EPD_COLOR_RED) {
+            cv->red[byte_idx] |= bit_mask;
+        } else {
+            cv->red[byte_idx] &= ~bit_mask;
+        }
+    }
+}
+
+// 行填充内核: 将value的位图案写入行内[x0, x1)像素
+// 首尾字节使用边缘掩码, 中间部分按4字节对齐后以32位字整块写入
+static void epd_span_write(uint8_t *row, uint32_t x0, uint32_t x1, uint8_t value) {
+    uint32_t b0 = x0 >> 3;
+    uint32_t b1 = (x1 - 1) >> 3;
+    uint8_t lmask = 0xFF >> (x0 & 7);
+    uint8_t rmask = (uint8_t)(0xFF << (7 - ((x1 - 1) & 7)));
+    
+    if (b0 == b1) {
+        uint8_t mask = lmask & rmask;
+        row[b0] = (row[b0] & ~mask) | (value & mask);
+        return;
+    }
+    
+    row[b0] = (row[b0] & ~lmask) | (value & lmask);
+    b0++;
+    
+    while (b0 < b1 && ((uintptr_t)(row + b0) & 3)) {
+        row[b0++] = value;
+    }
+    
+    uint32_t word = value * 0x01010101u;
+    uint32_t *w = (uint32_t *)(row + b0);
+    while (b0 + 4 <= b1) {
+        *w++ = word;
+        b0 += 4;
+    }
+    
+    while (b0 < b1) {
+        row[b0++] = value;
+    }
+    
+    row[b1] = (row[b1] & ~rmask) | (value & rmask);
+}
+
+// 在画布上填充一段水平像素 [x0, x1), 自动裁剪
+static void epd_canvas_span(const epd_canvas_t *cv, int32_t y, int32_t x0, int32_t x1,
+                            epd_color_t color) {
+    if (y < cv->clip_y0 || y >= cv->clip_y1) {
+        return;
+    }
+    if (x0 < cv->clip_x0) x0 = cv->clip_x0;
+    if (x1 > cv->clip_x1) x1 = cv->clip_x1;
+    if (x0 >= x1) {
+        return;
+    }
+    
+    uint32_t offset = (uint32_t)y * (cv->width / 8);
+    bool white = (color == EPD_COLOR_WHITE || (color == EPD_COLOR_RED && cv->red));
+    
+    epd_span_write(cv->bw + offset, x0, x1, white ? 0xFF : 0x00);
+    if (cv->red) {
+        epd_span_write(cv->red + offset, x0, x1, color == EPD_COLOR_RED ? 0xFF : 0x00);
+    }
+}
+
+// 在画布上画一段垂直线 [y0, y1), 自动裁剪
+static void epd_canvas_vspan(const epd_canvas_t *cv, int32_t x, int32_t y0, int32_t y1,
+                             epd_color_t color) {
+    if (x < cv->clip_x0 || x >= cv->clip_x1) {
+        return;
+    }
+    if (y0 < cv->clip_y0) y0 = cv->clip_y0;
+    if (y1 > cv->clip_y1) y1 = cv->clip_y1;
+    
+    uint16_t stride = cv->width / 8;
+    uint32_t idx = (uint32_t)y0 * stride + (x / 8);
+    uint8_t mask = 0x80 >> (x % 8);
+    bool white = (color == EPD_COLOR_WHITE || (color == EPD_COLOR_RED && cv->red));
+    
+    for (int32_t y = y0; y < y1; y++, idx += stride) {
+        if (white) {
+            cv->bw[idx] |= mask;
+        } else {
+            cv->bw[idx] &= ~mask;
+        }
+        if (cv->red) {
+            if (color == EPD_COLOR_RED) {
+                cv->red[idx] |= mask;
+            } else {
+                cv->red[idx] &= ~mask;
+            }
+        }
+    }
+}
+
+// 将绘制区域(闭区间)记录到托管帧缓冲区的脏区列表
+void epd_canvas_touch(const epd_canvas_t *cv, int32_t x0, int32_t y0,
+                      int32_t x1, int32_t y1) {
+    epd_fb_t *fb = cv->fb;
+    if (!fb) {
+        return;
+    }
+    
+    if (x0 < cv->clip_x0) x0 = cv->clip_x0;
+    if (y0 < cv->clip_y0) y0 = cv->clip_y0;
+    if (x1 >= cv->clip_x1) x1 = cv->clip_x1 - 1;
+    if (y1 >= cv->clip_y1) y1 = cv->clip_y1 - 1;
+    if (x1 < x0 || y1 < y0) {
+        return;
+    }
+    
+    epd_fb_mark_dirty(fb, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+// 画点
+void epd_draw_pixel(uint8_t *buffer, uint16_t width, uint16_t height,
+                   uint16_t x, uint16_t y, epd_color_t color) {
+    if (!buffer || x >= width || y >= height) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    epd_canvas_put(&cv, x, y, color);
+    epd_canvas_touch(&cv, x, y, x, y);
+}
+
+// 画线 (Bresenham)
+void epd_draw_line(uint8_t *buffer, uint16_t width, uint16_t height,
+                  uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, 
+                  epd_color_t color) {
+    if (!buffer) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    
+    int32_t x = x1;
+    int32_t y = y1;
+    int32_t dx = abs((int32_t)x2 - x1);
+    int32_t dy = -abs((int32_t)y2 - y1);
+    int32_t sx = x1 < x2 ? 1 : -1;
+    int32_t sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx + dy;
+    
+    for (;;) {
+        epd_canvas_put(&cv, x, y, color);
+        if (x == x2 && y == y2) {
+            break;
+        }
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+    
+    epd_canvas_touch(&cv,
+                   x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2,
+                   x1 > x2 ? x1 : x2, y1 > y2 ? y1 : y2);
+}
+
+// 画水平线
+void epd_draw_hline(uint8_t *buffer, uint16_t width, uint16_t height,
+                    uint16_t x, uint16_t y, uint16_t w, epd_color_t color) {
+    if (!buffer || w == 0) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    epd_canvas_span(&cv, y, x, (int32_t)x + w, color);
+    epd_canvas_touch(&cv, x, y, (int32_t)x + w - 1, y);
+}
+
+// 画垂直线
+void epd_draw_vline(uint8_t *buffer, uint16_t width, uint16_t height,
+                    uint16_t x, uint16_t y, uint16_t h, epd_color_t color) {
+    if (!buffer || h == 0) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    epd_canvas_vspan(&cv, x, y, (int32_t)y + h, color);
+    epd_canvas_touch(&cv, x, y, x, (int32_t)y + h - 1);
+}
+
+// 画矩形
+void epd_draw_rect(uint8_t *buffer, uint16_t width, uint16_t height,
+                  uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                  epd_color_t color, bool filled) {
+    if (!buffer || w == 0 || h == 0) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    
+    int32_t x_end = (int32_t)x + w;
+    int32_t y_end = (int32_t)y + h;
+    
+    if (filled) {
+        for (int32_t py = y; py < y_end && py < height; py++) {
+            epd_canvas_span(&cv, py, x, x_end, color);
+        }
+    } else {
+        epd_canvas_span(&cv, y, x, x_end, color);
+        epd_canvas_span(&cv, y_end - 1, x, x_end, color);
+        epd_canvas_vspan(&cv, x, y, y_end, color);
+        epd_canvas_vspan(&cv, x_end - 1, y, y_end, color);
+    }
+    
+    epd_canvas_touch(&cv, x, y, x_end - 1, y_end - 1);
+}
+
+// 图案填充: 第r行使用pattern[(y + r) % pattern_rows], 图案按绝对字节位置对齐
+void epd_fill_pattern(uint8_t *buffer, uint16_t width, uint16_t height,
+                      uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint8_t *pattern, uint8_t pattern_rows) {
+    if (!buffer || !pattern || pattern_rows == 0 || w == 0 || h == 0 ||
+        x >= width || y >= height) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    
+    int32_t x0 = x < cv.clip_x0 ? cv.clip_x0 : x;
+    int32_t y0 = y < cv.clip_y0 ? cv.clip_y0 : y;
+    int32_t x_end = (int32_t)x + w > cv.clip_x1 ? cv.clip_x1 : (int32_t)x + w;
+    int32_t y_end = (int32_t)y + h > cv.clip_y1 ? cv.clip_y1 : (int32_t)y + h;
+    uint16_t stride = width / 8;
+    
+    if (x0 >= x_end || y0 >= y_end) {
+        return;
+    }
+    
+    for (int32_t py = y0; py < y_end; py++) {
+        uint32_t offset = (uint32_t)py * stride;
+        epd_span_write(cv.bw + offset, x0, x_end, pattern[py % pattern_rows]);
+        if (cv.red) {
+            epd_span_write(cv.red + offset, x0, x_end, 0x00);
+        }
+    }
+    
+    epd_canvas_touch(&cv, x0, y0, x_end - 1, y_end - 1);
+}
+
+// 画圆 (中点画圆法)
+void epd_draw_circle(uint8_t *buffer, uint16_t width, uint16_t height,
+                    uint16_t x0, uint16_t y0, uint16_t r, 
+                    epd_color_t color, bool filled) {
+    if (!buffer) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    
+    int32_t cx = x0;
+    int32_t cy = y0;
+    int32_t x = r;
+    int32_t y = 0;
+    int32_t err = 1 - x;
+    
+    while (x >= y) {
+        if (filled) {
+            epd_canvas_span(&cv, cy + y, cx - x, cx + x + 1, color);
+            epd_canvas_span(&cv, cy - y, cx - x, cx + x + 1, color);
+            epd_canvas_span(&cv, cy + x, cx - y, cx + y + 1, color);
+            epd_canvas_span(&cv, cy - x, cx - y, cx + y + 1, color);
+        } else {
+            epd_canvas_put(&cv, cx + x, cy + y, color);
+            epd_canvas_put(&cv, cx + y, cy + x, color);
+            epd_canvas_put(&cv, cx - y, cy + x, color);
+            epd_canvas_put(&cv, cx - x, cy + y, color);
+            epd_canvas_put(&cv, cx - x, cy - y, color);
+            epd_canvas_put(&cv, cx - y, cy - x, color);
+            epd_canvas_put(&cv, cx + y, cy - x, color);
+            epd_canvas_put(&cv, cx + x, cy - y, color);
+        }
+    
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+    
+    epd_canvas_touch(&cv, cx - r, cy - r, cx + r, cy + r);
+}
+
+// 绘制单色位图: bitmap为bw x bh的1bpp位图 (每行(bw+7)/8字节, 高位在左),
+// 置位的像素画为color, 其余像素保持不变
+void epd_draw_bitmap(uint8_t *buffer, uint16_t width, uint16_t height,
+                     uint16_t x, uint16_t y, const uint8_t *bitmap,
+                     uint16_t bw, uint16_t bh, epd_color_t color) {
+    if (!buffer || !bitmap || bw == 0 || bh == 0) {
+        return;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    
+    uint16_t src_stride = (bw + 7) / 8;
+    int32_t r0 = cv.clip_y0 > y ? cv.clip_y0 - y : 0;
+    int32_t r1 = (int32_t)y + bh > cv.clip_y1 ? cv.clip_y1 - y : bh;
+    int32_t c0 = cv.clip_x0 > x ? cv.clip_x0 - x : 0;
+    int32_t c1 = (int32_t)x + bw > cv.clip_x1 ? cv.clip_x1 - x : bw;
+    
+    for (int32_t r = r0; r < r1; r++) {
+        const uint8_t *src = bitmap + (uint32_t)r * src_stride;
+        int32_t c = c0;
+        while (c < c1) {
+            // 连续置位的像素合成一段水平填充
+            if (!(src[c >> 3] & (0x80 >> (c & 7)))) {
+                c++;
+                continue;
+            }
+            int32_t start = c;
+            while (c < c1 && (src[c >> 3] & (0x80 >> (c & 7)))) {
+                c++;
+            }
+            epd_canvas_span(&cv, (int32_t)y + r, (int32_t)x + start, (int32_t)x + c, color);
+        }
+    }
+    
+    epd_canvas_touch(&cv, x, y, (int32_t)x + bw - 1, (int32_t)y + bh - 1);
+}
+
+// 绘制文字 (内置5x7等宽字体, scale为放大倍数)
+void epd_draw_text(uint8_t *buffer, uint16_t width, uint16_t height,
+                  const char *text, uint16_t x, uint16_t y,
+                  epd_color_t color, uint8_t scale) {
+    epd_font_draw(buffer, width, height, &epd_font_5x7, text, x, y, color, scale);
+}
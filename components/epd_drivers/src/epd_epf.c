@@ -0,0 +1,212 @@
+/**
+ * EPF压缩帧解码
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+
+#include "epd_common.h"
+#include "epd_epf.h"
+
+#define TAG "EPD_EPF"
+
+static uint16_t epd_epf_read_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t epd_epf_read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 只扫描控制字节, 计算解码后的长度; 数据截断时返回false
+static bool epd_epf_measure(const uint8_t *src, uint32_t len, uint32_t *out_len) {
+    const uint8_t *end = src + len;
+    uint32_t total = 0;
+    
+    while (src < end) {
+        uint8_t c = *src++;
+    
+        if (c < 0x80) {
+            uint32_t n = (uint32_t)c + 1;
+            if ((uint32_t)(end - src) < n) {
+                return false;
+            }
+            src += n;
+            total += n;
+        } else if (c == EPD_EPF_OP_LONG_RUN) {
+            if (end - src < 3) {
+                return false;
+            }
+            total += epd_epf_read_u16(src);
+            src += 3;
+        } else {
+            if (src >= end) {
+                return false;
+            }
+            src++;
+            total += 257 - c;
+        }
+    }
+    
+    *out_len = total;
+    return true;
+}
+
+esp_err_t epd_epf_parse(const uint8_t *data, uint32_t size, epd_epf_info_t *info) {
+    if (!data || !info || size < EPD_EPF_HEADER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (memcmp(data, EPD_EPF_MAGIC, 4) != 0) {
+        ESP_LOGE(TAG, "无效的EPF标识");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    memset(info, 0, sizeof(*info));
+    info->width = epd_epf_read_u16(data + 4);
+    info->height = epd_epf_read_u16(data + 6);
+    info->flags = data[8];
+    info->bw_len = epd_epf_read_u32(data + 12);
+    info->red_len = epd_epf_read_u32(data + 16);
+    
+    uint32_t payload = size - EPD_EPF_HEADER_SIZE;
+    if (info->bw_len > payload || info->red_len > payload - info->bw_len) {
+        ESP_LOGE(TAG, "EPF数据被截断");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    info->bw = data + EPD_EPF_HEADER_SIZE;
+    if (info->flags & EPD_EPF_FLAG_RED) {
+        info->red = info->bw + info->bw_len;
+    }
+    
+    // 预先校验, 流式解码期间无法再报告错误
+    uint32_t plane_size = (uint32_t)info->width * info->height / 8;
+    uint32_t decoded;
+    
+    if (!epd_epf_measure(info->bw, info->bw_len, &decoded) || decoded != plane_size) {
+        ESP_LOGE(TAG, "黑白平面解码长度不符");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    if (info->red &&
+        (!epd_epf_measure(info->red, info->red_len, &decoded) || decoded != plane_size)) {
+        ESP_LOGE(TAG, "红色平面解码长度不符");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    return ESP_OK;
+}
+
+void epd_epf_decoder_init(epd_epf_decoder_t *dec, const uint8_t *src, uint32_t len) {
+    memset(dec, 0, sizeof(*dec));
+    dec->src = src;
+    dec->end = src + len;
+}
+
+uint32_t epd_epf_decode(epd_epf_decoder_t *dec, uint8_t *dst, uint32_t length) {
+    uint32_t produced = 0;
+    
+    while (produced < length) {
+        uint32_t room = length - produced;
+    
+        if (dec->run) {
+            uint32_t n = dec->run < room ? dec->run : room;
+            memset(dst + produced, dec->value, n);
+            dec->run -= n;
+            produced += n;
+            continue;
+        }
+    
+        if (dec->literal) {
+            uint32_t n = dec->literal < room ? dec->literal : room;
+            memcpy(dst + produced, dec->src, n);
+            dec->src += n;
+            dec->literal -= n;
+            produced += n;
+            continue;
+        }
+    
+        if (dec->src >= dec->end) {
+            break;
+        }
+    
+        uint8_t c = *dec->src++;
+        if (c < 0x80) {
+            dec->literal = (uint32_t)c + 1;
+        } else if (c == EPD_EPF_OP_LONG_RUN) {
+            dec->run = epd_epf_read_u16(dec->src);
+            dec->value = dec->src[2];
+            dec->src += 3;
+        } else {
+            dec->run = 257 - c;
+            dec->value = *dec->src++;
+        }
+    }
+    
+    return produced;
+}
+
+void epd_epf_source(void *ctx, uint8_t *dst, uint32_t offset, uint32_t length) {
+    (void)offset;   // 解码器按顺序输出, 传输层总是按偏移递增请求
+    uint32_t n = epd_epf_decode((epd_epf_decoder_t *)ctx, dst, length);
+    
+    // 已通过epd_epf_parse校验的数据不会提前结束, 这里只是保护
+    if (n < length) {
+        memset(dst + n, 0xFF, length - n);
+    }
+}
+
+esp_err_t epd_epf_decode_plane(const uint8_t *src, uint32_t src_len,
+                               uint8_t *dst, uint32_t dst_len) {
+    if (!src || !dst) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint32_t decoded;
+    if (!epd_epf_measure(src, src_len, &decoded) || decoded != dst_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    epd_epf_decoder_t dec;
+    epd_epf_decoder_init(&dec, src, src_len);
+    epd_epf_decode(&dec, dst, dst_len);
+    
+    return ESP_OK;
+}
+
+esp_err_t epd_display_epf(epd_device_t *dev, const uint8_t *data, uint32_t size,
+                          epd_update_mode_t mode) {
+    if (!dev || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!dev->display_stream) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    epd_epf_info_t info;
+    esp_err_t err = epd_epf_parse(data, size, &info);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    if (info.width != dev->info.width || info.height != dev->info.height) {
+        ESP_LOGE(TAG, "帧尺寸 %dx%d 与屏幕 %dx%d 不符",
+                 info.width, info.height, dev->info.width, dev->info.height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    epd_epf_decoder_t bw_dec, red_dec;
+    epd_epf_decoder_init(&bw_dec, info.bw, info.bw_len);
+    
+    if (info.red) {
+        epd_epf_decoder_init(&red_dec, info.red, info.red_len);
+        return dev->display_stream(dev, epd_epf_source, &bw_dec,
+                                   epd_epf_source, &red_dec, mode);
+    }
+    
+    return dev->display_stream(dev, epd_epf_source, &bw_dec, NULL, NULL, mode);
+}
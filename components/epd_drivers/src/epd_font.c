@@ -0,0 +1,558 @@
+/**
+ * 位图字体: 内置字体数据、字形缓存与按行合并绘制
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+#include "epd_common.h"
+#include "epd_font.h"
+#include "epd_internal.h"
+
+#define TAG "EPD_FONT"
+
+// 5x7字体位图 (0x20-0x7E), 每字符7行, 每行1字节, 高位在左
+static const uint8_t s_font5x7_bitmap[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ' '
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20, // !
+    0x50, 0x50, 0x50, 0x00, 0x00, 0x00, 0x00, // "
+    0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50, // #
+    0x20, 0x78, 0xA0, 0x70, 0x28, 0xF0, 0x20, // $
+    0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18, // %
+    0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90, 0x68, // &
+    0x60, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, // '
+    0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10, // (
+    0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40, // )
+    0x00, 0x50, 0x20, 0xF8, 0x20, 0x50, 0x00, // *
+    0x00, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x00, // +
+    0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40, // ,
+    0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, // -
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, // .
+    0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, // /
+    0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70, // 0
+    0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70, // 1
+    0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8, // 2
+    0xF8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70, // 3
+    0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10, // 4
+    0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88, 0x70, // 5
+    0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70, // 6
+    0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40, // 7
+    0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70, // 8
+    0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60, // 9
+    0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, // :
+    0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40, // ;
+    0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, // <
+    0x00, 0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00, // =
+    0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40, // >
+    0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20, // ?
+    0x70, 0x88, 0x08, 0x68, 0xA8, 0xA8, 0x70, // @
+    0x70, 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, // A
+    0xF0, 0x88, 0x88, 0xF0, 0x88, 0x88, 0xF0, // B
+    0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, // C
+    0xE0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xE0, // D
+    0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, // E
+    0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80, // F
+    0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78, // G
+    0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, // H
+    0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, // I
+    0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60, // J
+    0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88, // K
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8, // L
+    0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88, 0x88, // M
+    0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88, // N
+    0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, // O
+    0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80, // P
+    0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68, // Q
+    0xF0, 0x88, 0x88, 0xF0, 0xA0, 0x90, 0x88, // R
+    0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0, // S
+    0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // T
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, // U
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20, // V
+    0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50, // W
+    0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, // X
+    0x88, 0x88, 0x88, 0x50, 0x20, 0x20, 0x20, // Y
+    0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8, // Z
+    0x70, 0x40, 0x40, 0x40, 0x40, 0x40, 0x70, // [
+    0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, // '\\'
+    0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x70, // ]
+    0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00, // ^
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, // _
+    0x40, 0x20, 0x10, 0x00, 0x00, 0x00, 0x00, // `
+    0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78, // a
+    0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0xF0, // b
+    0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70, // c
+    0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78, // d
+    0x00, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70, // e
+    0x30, 0x48, 0x40, 0xE0, 0x40, 0x40, 0x40, // f
+    0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70, // g
+    0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0x88, // h
+    0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70, // i
+    0x10, 0x00, 0x30, 0x10, 0x10, 0x90, 0x60, // j
+    0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90, // k
+    0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, // l
+    0x00, 0x00, 0xD0, 0xA8, 0xA8, 0x88, 0x88, // m
+    0x00, 0x00, 0xB0, 0xC8, 0x88, 0x88, 0x88, // n
+    0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70, // o
+    0x00, 0x00, 0xF0, 0x88, 0xF0, 0x80, 0x80, // p
+    0x00, 0x00, 0x68, 0x98, 0x78, 0x08, 0x08, // q
+    0x00, 0x00, 0xB0, 0xC8, 0x80, 0x80, 0x80, // r
+    0x00, 0x00, 0x70, 0x80, 0x70, 0x08, 0xF0, // s
+    0x40, 0x40, 0xE0, 0x40, 0x40, 0x48, 0x30, // t
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68, // u
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20, // v
+    0x00, 0x00, 0x88, 0x88, 0xA8, 0xA8, 0x50, // w
+    0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88, // x
+    0x00, 0x00, 0x88, 0x88, 0x78, 0x08, 0x70, // y
+    0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8, // z
+    0x10, 0x20, 0x20, 0x40, 0x20, 0x20, 0x10, // {
+    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, // |
+    0x40, 0x20, 0x20, 0x10, 0x20, 0x20, 0x40, // }
+    0x00, 0x00, 0x40, 0xA8, 0x10, 0x00, 0x00, // ~
+};
+
+// 比例字形表: 去掉左右空白列, 字间距1像素, 空格前进3像素
+static const epd_font_glyph_t s_font5x7_prop_glyphs[] = {
+    {   0, 0, 0, 3}, // ' '
+    {   7, 2, 1, 2}, // !
+    {  14, 1, 3, 4}, // "
+    {  21, 0, 5, 6}, // #
+    {  28, 0, 5, 6}, // $
+    {  35, 0, 5, 6}, // %
+    {  42, 0, 5, 6}, // &
+    {  49, 1, 2, 3}, // '
+    {  56, 1, 3, 4}, // (
+    {  63, 1, 3, 4}, // )
+    {  70, 0, 5, 6}, // *
+    {  77, 0, 5, 6}, // +
+    {  84, 1, 2, 3}, // ,
+    {  91, 0, 5, 6}, // -
+    {  98, 1, 2, 3}, // .
+    { 105, 0, 5, 6}, // /
+    { 112, 0, 5, 6}, // 0
+    { 119, 1, 3, 4}, // 1
+    { 126, 0, 5, 6}, // 2
+    { 133, 0, 5, 6}, // 3
+    { 140, 0, 5, 6}, // 4
+    { 147, 0, 5, 6}, // 5
+    { 154, 0, 5, 6}, // 6
+    { 161, 0, 5, 6}, // 7
+    { 168, 0, 5, 6}, // 8
+    { 175, 0, 5, 6}, // 9
+    { 182, 1, 2, 3}, // :
+    { 189, 1, 2, 3}, // ;
+    { 196, 0, 4, 5}, // <
+    { 203, 0, 5, 6}, // =
+    { 210, 1, 4, 5}, // >
+    { 217, 0, 5, 6}, // ?
+    { 224, 0, 5, 6}, // @
+    { 231, 0, 5, 6}, // A
+    { 238, 0, 5, 6}, // B
+    { 245, 0, 5, 6}, // C
+    { 252, 0, 5, 6}, // D
+    { 259, 0, 5, 6}, // E
+    { 266, 0, 5, 6}, // F
+    { 273, 0, 5, 6}, // G
+    { 280, 0, 5, 6}, // H
+    { 287, 1, 3, 4}, // I
+    { 294, 0, 5, 6}, // J
+    { 301, 0, 5, 6}, // K
+    { 308, 0, 5, 6}, // L
+    { 315, 0, 5, 6}, // M
+    { 322, 0, 5, 6}, // N
+    { 329, 0, 5, 6}, // O
+    { 336, 0, 5, 6}, // P
+    { 343, 0, 5, 6}, // Q
+    { 350, 0, 5, 6}, // R
+    { 357, 0, 5, 6}, // S
+    { 364, 0, 5, 6}, // T
+    { 371, 0, 5, 6}, // U
+    { 378, 0, 5, 6}, // V
+    { 385, 0, 5, 6}, // W
+    { 392, 0, 5, 6}, // X
+    { 399, 0, 5, 6}, // Y
+    { 406, 0, 5, 6}, // Z
+    { 413, 1, 3, 4}, // [
+    { 420, 0, 5, 6}, // '\\'
+    { 427, 1, 3, 4}, // ]
+    { 434, 0, 5, 6}, // ^
+    { 441, 0, 5, 6}, // _
+    { 448, 1, 3, 4}, // `
+    { 455, 0, 5, 6}, // a
+    { 462, 0, 5, 6}, // b
+    { 469, 0, 5, 6}, // c
+    { 476, 0, 5, 6}, // d
+    { 483, 0, 5, 6}, // e
+    { 490, 0, 5, 6}, // f
+    { 497, 0, 5, 6}, // g
+    { 504, 0, 5, 6}, // h
+    { 511, 1, 3, 4}, // i
+    { 518, 0, 4, 5}, // j
+    { 525, 0, 4, 5}, // k
+    { 532, 1, 3, 4}, // l
+    { 539, 0, 5, 6}, // m
+    { 546, 0, 5, 6}, // n
+    { 553, 0, 5, 6}, // o
+    { 560, 0, 5, 6}, // p
+    { 567, 0, 5, 6}, // q
+    { 574, 0, 5, 6}, // r
+    { 581, 0, 5, 6}, // s
+    { 588, 0, 5, 6}, // t
+    { 595, 0, 5, 6}, // u
+    { 602, 0, 5, 6}, // v
+    { 609, 0, 5, 6}, // w
+    { 616, 0, 5, 6}, // x
+    { 623, 0, 5, 6}, // y
+    { 630, 0, 5, 6}, // z
+    { 637, 1, 3, 4}, // {
+    { 644, 2, 1, 2}, // |
+    { 651, 1, 3, 4}, // }
+    { 658, 0, 5, 6}, // ~
+};
+
+const epd_font_t epd_font_5x7 = {
+    .name = "5x7",
+    .height = 7,
+    .row_bytes = 1,
+    .first_char = 0x20,
+    .last_char = 0x7E,
+    .default_char = '?',
+    .bitmap = s_font5x7_bitmap,
+    .glyphs = NULL,
+    .fixed_width = 5,
+    .fixed_advance = 6,
+};
+
+const epd_font_t epd_font_5x7_prop = {
+    .name = "5x7-prop",
+    .height = 7,
+    .row_bytes = 1,
+    .first_char = 0x20,
+    .last_char = 0x7E,
+    .default_char = '?',
+    .bitmap = s_font5x7_bitmap,
+    .glyphs = s_font5x7_prop_glyphs,
+};
+
+// 放大后的字形, 行优先, 每行stride字节, 位为1表示笔画
+typedef struct {
+    const epd_font_t *font;     // 为NULL表示空闲
+    uint8_t code;
+    uint8_t scale;
+    uint8_t stride;
+    uint16_t height;
+    uint32_t last_used;
+    uint8_t bits[EPD_FONT_CACHE_GLYPH_BYTES];
+} epd_font_cache_entry_t;
+
+static epd_font_cache_entry_t s_cache[EPD_FONT_CACHE_ENTRIES];
+static uint32_t s_cache_clock;
+static epd_font_cache_stats_t s_cache_stats;
+static portMUX_TYPE s_cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 查找字形, 范围外的字符使用默认字符
+static void epd_font_glyph(const epd_font_t *font, uint8_t *code, epd_font_glyph_t *glyph) {
+    if (*code < font->first_char || *code > font->last_char) {
+        *code = font->default_char;
+    }
+    
+    uint8_t index = *code - font->first_char;
+    if (font->glyphs) {
+        *glyph = font->glyphs[index];
+    } else {
+        glyph->offset = (uint16_t)index * font->height * font->row_bytes;
+        glyph->left = 0;
+        glyph->width = font->fixed_width;
+        glyph->advance = font->fixed_advance;
+    }
+}
+
+// 将字形的一行放大到dst (先清零), 每个笔画像素横向重复scale次
+static void epd_font_scale_row(const uint8_t *src, const epd_font_glyph_t *glyph,
+                               uint8_t scale, uint8_t *dst, uint8_t stride) {
+    memset(dst, 0, stride);
+    
+    for (uint16_t col = 0; col < glyph->width; col++) {
+        uint16_t sx = glyph->left + col;
+        if (!(src[sx / 8] & (0x80 >> (sx % 8)))) {
+            continue;
+        }
+    
+        uint32_t x0 = (uint32_t)col * scale;
+        for (uint32_t x = x0; x < x0 + scale; x++) {
+            dst[x / 8] |= 0x80 >> (x % 8);
+        }
+    }
+}
+
+// 将字形放大到bits, 行优先, 每行stride字节
+static void epd_font_scale_glyph(const epd_font_t *font, const epd_font_glyph_t *glyph,
+                                 uint8_t scale, uint8_t *bits, uint8_t stride) {
+    const uint8_t *src = font->bitmap + glyph->offset;
+    
+    for (uint8_t row = 0; row < font->height; row++, src += font->row_bytes) {
+        uint8_t *dst = bits + (uint32_t)row * scale * stride;
+        epd_font_scale_row(src, glyph, scale, dst, stride);
+        for (uint8_t r = 1; r < scale; r++) {
+            memcpy(dst + (uint32_t)r * stride, dst, stride);
+        }
+    }
+}
+
+// 取得放大后的字形并复制到bits, 位图放不进缓存条目时返回false
+// 缓存由所有任务共享: 锁内只做查找和复制, 放大在锁外进行, 绘制使用调用方的副本
+static bool epd_font_cache_get(const epd_font_t *font, uint8_t code,
+                               const epd_font_glyph_t *glyph, uint8_t scale,
+                               uint8_t *bits, uint8_t stride, uint16_t height) {
+    uint32_t size = (uint32_t)stride * height;
+    
+    if (size > EPD_FONT_CACHE_GLYPH_BYTES) {
+        portENTER_CRITICAL(&s_cache_lock);
+        s_cache_stats.uncached++;
+        portEXIT_CRITICAL(&s_cache_lock);
+        return false;
+    }
+    
+    portENTER_CRITICAL(&s_cache_lock);
+    for (int i = 0; i < EPD_FONT_CACHE_ENTRIES; i++) {
+        epd_font_cache_entry_t *e = &s_cache[i];
+        if (e->font == font && e->code == code && e->scale == scale) {
+            e->last_used = ++s_cache_clock;
+            s_cache_stats.hits++;
+            memcpy(bits, e->bits, size);
+            portEXIT_CRITICAL(&s_cache_lock);
+            return true;
+        }
+    }
+    portEXIT_CRITICAL(&s_cache_lock);
+    
+    epd_font_scale_glyph(font, glyph, scale, bits, stride);
+    
+    // 放大期间其他任务可能已加入同一字形, 此时不再重复占用条目
+    portENTER_CRITICAL(&s_cache_lock);
+    epd_font_cache_entry_t *victim = &s_cache[0];
+    
+    for (int i = 0; i < EPD_FONT_CACHE_ENTRIES; i++) {
+        epd_font_cache_entry_t *e = &s_cache[i];
+        if (e->font == font && e->code == code && e->scale == scale) {
+            victim = NULL;
+            break;
+        }
+        // 优先使用空闲条目, 否则淘汰最久未用的
+        if (victim->font && (!e->font || e->last_used < victim->last_used)) {
+            victim = e;
+        }
+    }
+    
+    s_cache_stats.misses++;
+    if (victim) {
+        if (victim->font) {
+            s_cache_stats.evictions++;
+        } else {
+            s_cache_stats.entries++;
+        }
+    
+        victim->font = font;
+        victim->code = code;
+        victim->scale = scale;
+        victim->stride = stride;
+        victim->height = height;
+        victim->last_used = ++s_cache_clock;
+        memcpy(victim->bits, bits, size);
+    }
+    portEXIT_CRITICAL(&s_cache_lock);
+    
+    return true;
+}
+
+// 合并一个字节的笔画: set为true时置1, 否则清0
+static inline void epd_font_apply(uint8_t *dst, uint8_t ink, bool set) {
+    if (set) {
+        *dst |= ink;
+    } else {
+        *dst &= ~ink;
+    }
+}
+
+// 将一行笔画位合并到平面的一行, x为目标起始像素, limit为行内字节数;
+// cv带裁剪区时逐字节屏蔽裁剪区外的位
+static void epd_font_blit_plane(const epd_canvas_t *cv, uint8_t *row, uint16_t limit,
+                                uint32_t x, const uint8_t *src, uint8_t src_bytes, bool set) {
+    uint32_t b = x >> 3;
+    uint8_t shift = x & 7;
+    
+    if (shift == 0) {
+        // 字节对齐: 逐字节合并
+        for (uint8_t i = 0; i < src_bytes && b + i < limit; i++) {
+            uint8_t ink = src[i];
+            if (cv->clipped) {
+                ink &= epd_canvas_clip_mask(cv, b + i);
+            }
+            epd_font_apply(&row[b + i], ink, set);
+        }
+        return;
+    }
+    
+    // 非对齐: 每次取3个源字节组成大端字, 右移后写出4个目标字节;
+    // 相邻两组在重叠的字节上写入相同的笔画, 合并结果不变
+    for (uint8_t i = 0; i < src_bytes && b + i < limit; i += 3) {
+        uint32_t word = (uint32_t)src[i] << 24;
+        if (i + 1 < src_bytes) {
+            word |= (uint32_t)src[i + 1] << 16;
+        }
+        if (i + 2 < src_bytes) {
+            word |= (uint32_t)src[i + 2] << 8;
+        }
+        word >>= shift;
+    
+        for (uint8_t k = 0; k < 4 && b + i + k < limit; k++) {
+            uint8_t ink = word >> (24 - 8 * k);
+            if (ink && cv->clipped) {
+                ink &= epd_canvas_clip_mask(cv, b + i + k);
+            }
+            if (ink) {
+                epd_font_apply(&row[b + i + k], ink, set);
+            }
+        }
+    }
+}
+
+// 将一行笔画按颜色合并到画布
+static void epd_font_blit_row(const epd_canvas_t *cv, uint32_t x, uint32_t y,
+                              const uint8_t *src, uint8_t src_bytes, epd_color_t color) {
+    if ((int32_t)y < cv->clip_y0 || (int32_t)y >= cv->clip_y1) {
+        return;
+    }
+    
+    uint16_t stride = cv->width / 8;
+    uint32_t offset = y * stride;
+    
+    // 无红色平面时, 除白色外的颜色都画为黑色
+    bool white = (color == EPD_COLOR_WHITE || (color == EPD_COLOR_RED && cv->red));
+    
+    epd_font_blit_plane(cv, cv->bw + offset, stride, x, src, src_bytes, white);
+    if (cv->red) {
+        epd_font_blit_plane(cv, cv->red + offset, stride, x, src, src_bytes,
+                            color == EPD_COLOR_RED);
+    }
+}
+
+static void epd_font_draw_glyph(const epd_canvas_t *cv, const epd_font_t *font,
+                                uint8_t code, const epd_font_glyph_t *glyph,
+                                uint32_t x, uint32_t y, epd_color_t color, uint8_t scale) {
+    uint8_t bits[EPD_FONT_CACHE_GLYPH_BYTES];
+    uint8_t stride = ((uint32_t)glyph->width * scale + 7) / 8;
+    uint16_t height = (uint16_t)font->height * scale;
+    
+    if (epd_font_cache_get(font, code, glyph, scale, bits, stride, height)) {
+        for (uint16_t row = 0; row < height; row++) {
+            epd_font_blit_row(cv, x, y + row, bits + (uint32_t)row * stride, stride, color);
+        }
+        return;
+    }
+    
+    // 大字形: 逐行放大后直接绘制
+    uint8_t line[EPD_FONT_MAX_ROW_BYTES];
+    const uint8_t *src = font->bitmap + glyph->offset;
+    
+    for (uint8_t row = 0; row < font->height; row++, src += font->row_bytes) {
+        epd_font_scale_row(src, glyph, scale, line, stride);
+        for (uint8_t r = 0; r < scale; r++) {
+            epd_font_blit_row(cv, x, y + (uint32_t)row * scale + r, line, stride, color);
+        }
+    }
+}
+
+// 限制放大倍数, 使放大后的字形行不超过EPD_FONT_MAX_ROW_BYTES
+static uint8_t epd_font_clamp_scale(const epd_font_t *font, uint8_t scale) {
+    uint8_t max_width = font->glyphs ? font->row_bytes * 8 : font->fixed_width;
+    
+    if (scale == 0) {
+        scale = 1;
+    }
+    if (max_width && (uint32_t)max_width * scale > EPD_FONT_MAX_ROW_BYTES * 8) {
+        scale = EPD_FONT_MAX_ROW_BYTES * 8 / max_width;
+    }
+    
+    return scale;
+}
+
+uint32_t epd_font_draw(uint8_t *buffer, uint16_t width, uint16_t height,
+                       const epd_font_t *font, const char *text,
+                       uint16_t x, uint16_t y, epd_color_t color, uint8_t scale) {
+    if (!buffer || !font || !text) {
+        return x;
+    }
+    
+    epd_canvas_t cv;
+    epd_canvas_init(&cv, buffer, width, height);
+    
+    scale = epd_font_clamp_scale(font, scale);
+    uint32_t cursor = x;
+    
+    for (const char *p = text; *p; p++) {
+        uint8_t code = (uint8_t)*p;
+        epd_font_glyph_t glyph;
+        epd_font_glyph(font, &code, &glyph);
+    
+        if (glyph.width && cursor < (uint32_t)cv.clip_x1) {
+            epd_font_draw_glyph(&cv, font, code, &glyph, cursor, y, color, scale);
+        }
+    
+        cursor += (uint32_t)glyph.advance * scale;
+    }
+    
+    if (cursor > x) {
+        epd_canvas_touch(&cv, x, y, (int32_t)cursor - 1,
+                         (int32_t)y + font->height * scale - 1);
+    }
+    
+    return cursor;
+}
+
+uint32_t epd_font_measure(const epd_font_t *font, const char *text, uint8_t scale,
+                          uint16_t *height) {
+    if (!font || !text) {
+        return 0;
+    }
+    
+    scale = epd_font_clamp_scale(font, scale);
+    uint32_t cursor = 0;
+    uint32_t extent = 0;
+    
+    for (const char *p = text; *p; p++) {
+        uint8_t code = (uint8_t)*p;
+        epd_font_glyph_t glyph;
+        epd_font_glyph(font, &code, &glyph);
+    
+        // 末尾为空白字形时, 宽度止于最后一个笔画
+        if (glyph.width) {
+            extent = cursor + (uint32_t)glyph.width * scale;
+        }
+        cursor += (uint32_t)glyph.advance * scale;
+    }
+    
+    if (height) {
+        *height = (uint16_t)font->height * scale;
+    }
+    
+    return extent;
+}
+
+void epd_font_cache_clear(void) {
+    portENTER_CRITICAL(&s_cache_lock);
+    for (int i = 0; i < EPD_FONT_CACHE_ENTRIES; i++) {
+        s_cache[i].font = NULL;
+    }
+    s_cache_stats.entries = 0;
+    portEXIT_CRITICAL(&s_cache_lock);
+}
+
+void epd_font_cache_get_stats(epd_font_cache_stats_t *stats) {
+    if (stats) {
+        portENTER_CRITICAL(&s_cache_lock);
+        memcpy(stats, &s_cache_stats, sizeof(epd_font_cache_stats_t));
+        portEXIT_CRITICAL(&s_cache_lock);
+    }
+}
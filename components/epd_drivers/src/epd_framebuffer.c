@@ -0,0 +1,781 @@
+/**
+ * 托管帧缓冲区: 脏区跟踪与刷新路径选择
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_framebuffer.h"
+#include "epd_epf.h"
+#include "epd_internal.h"
+
+#define TAG "EPD_FB"
+
+// 字节列坐标表示的窗口 (闭区间)
+typedef struct {
+    uint16_t bx0;
+    uint16_t bx1;
+    uint16_t y0;
+    uint16_t y1;
+} epd_fb_window_t;
+
+static epd_fb_t *s_registry[EPD_FB_MAX_INSTANCES];
+static epd_fb_t *volatile s_registry_last;   // 最近一次查找命中的项, 连续绘图时免去扫描
+static volatile uint8_t s_registry_count;
+static portMUX_TYPE s_registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define EPD_FB_RETAIN_MAGIC         0x46425254u
+#define EPD_FB_BYTE_NS_DEFAULT      2000  // 尚未测得传输吞吐量时按4MHz SPI估计每字节耗时
+
+// 跨MCU深度睡眠保留的面板内容 (EPF平面编码), 冷启动后内容随机, 以magic和校验和判定有效
+typedef struct {
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint16_t bw_len;
+    uint16_t red_len;          // 0表示没有红色平面
+    uint32_t data_checksum;
+    uint32_t checksum;         // 之前各字段的FNV-1a
+    uint8_t data[EPD_FB_RETAIN_BYTES];
+} epd_fb_retained_t;
+
+static RTC_NOINIT_ATTR epd_fb_retained_t s_retained;
+
+static uint32_t epd_fb_window_bytes(const epd_fb_window_t *w) {
+    return (uint32_t)(w->bx1 - w->bx0 + 1) * (w->y1 - w->y0 + 1);
+}
+
+static void epd_fb_window_union(epd_fb_window_t *dst, const epd_fb_window_t *src) {
+    if (src->bx0 < dst->bx0) dst->bx0 = src->bx0;
+    if (src->bx1 > dst->bx1) dst->bx1 = src->bx1;
+    if (src->y0 < dst->y0) dst->y0 = src->y0;
+    if (src->y1 > dst->y1) dst->y1 = src->y1;
+}
+
+static bool epd_fb_window_overlap(const epd_fb_window_t *a, const epd_fb_window_t *b) {
+    return a->bx0 <= b->bx1 && b->bx0 <= a->bx1 &&
+           a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+// 查找buffer所属的托管帧缓冲区
+epd_fb_t *epd_fb_from_buffer(const uint8_t *buffer) {
+    epd_fb_t *found = NULL;
+    
+    if (!buffer) {
+        return NULL;
+    }
+    
+    // 每个绘图原语都会查找一次: 命中最近项或没有托管帧缓冲区时不进入临界区,
+    // 指针读写是原子的, 销毁帧缓冲区的同时仍在其上绘图本身就是调用方的错误
+    epd_fb_t *last = s_registry_last;
+    if (last && last->buffer == buffer) {
+        return last;
+    }
+    if (s_registry_count == 0) {
+        return NULL;
+    }
+    
+    portENTER_CRITICAL(&s_registry_lock);
+    for (int i = 0; i < EPD_FB_MAX_INSTANCES; i++) {
+        epd_fb_t *fb = s_registry[i];
+        if (fb && fb->buffer == buffer) {
+            found = fb;
+            s_registry_last = fb;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_registry_lock);
+    return found;
+}
+
+// 创建托管帧缓冲区
+epd_fb_t *epd_fb_create(epd_device_t *dev) {
+    if (!dev || dev->info.width == 0 || dev->info.height == 0) {
+        return NULL;
+    }
+    
+    epd_fb_t *fb = calloc(1, sizeof(epd_fb_t));
+    if (!fb) {
+        ESP_LOGE(TAG, "分配帧缓冲区对象失败");
+        return NULL;
+    }
+    
+    fb->dev = dev;
+    fb->width = dev->info.width;
+    fb->height = dev->info.height;
+    fb->stride = dev->info.width / 8;
+    fb->size = (uint32_t)fb->stride * fb->height;
+    fb->full_refresh_percent = EPD_FB_FULL_REFRESH_PERCENT;
+    fb->partial_refresh_us = EPD_FB_PARTIAL_REFRESH_US;
+    
+    // 绘图和打包缓冲区直接用于SPI发送, 分配在DMA内存中;
+    // 设备支持窗口局刷时直接从帧缓冲区收集窗口, 不需要打包缓冲区
+    fb->buffer = heap_caps_malloc(fb->size, MALLOC_CAP_DMA);
+    if (!dev->display_window) {
+        fb->scratch = heap_caps_malloc(fb->size, MALLOC_CAP_DMA);
+    }
+    fb->shadow = malloc(fb->size);
+    if (!fb->buffer || (!dev->display_window && !fb->scratch) || !fb->shadow) {
+        ESP_LOGE(TAG, "分配帧缓冲区内存失败");
+        epd_fb_destroy(fb);
+        return NULL;
+    }
+    
+    memset(fb->buffer, 0xFF, fb->size);
+    
+    // 三色设备: 常驻红色平面及其送屏副本, 刷新时不再临时分配
+    if (dev->info.color_mode == EPD_MODE_3C) {
+        fb->red = heap_caps_malloc(fb->size, MALLOC_CAP_DMA);
+        fb->red_shadow = malloc(fb->size);
+        if (!fb->red || !fb->red_shadow) {
+            ESP_LOGE(TAG, "分配红色平面失败");
+            epd_fb_destroy(fb);
+            return NULL;
+        }
+        memset(fb->red, 0x00, fb->size);
+    }
+    
+    bool registered = false;
+    portENTER_CRITICAL(&s_registry_lock);
+    for (int i = 0; i < EPD_FB_MAX_INSTANCES; i++) {
+        if (!s_registry[i]) {
+            s_registry[i] = fb;
+            s_registry_count++;
+            registered = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_registry_lock);
+    
+    // 未登记的帧缓冲区绘图时不记录脏区, 提交永远不会刷新, 不能交给调用方
+    if (!registered) {
+        ESP_LOGE(TAG, "托管帧缓冲区数量已达上限 %d", EPD_FB_MAX_INSTANCES);
+        epd_fb_destroy(fb);
+        return NULL;
+    }
+    
+    return fb;
+}
+
+// 销毁托管帧缓冲区
+void epd_fb_destroy(epd_fb_t *fb) {
+    if (!fb) {
+        return;
+    }
+    
+    portENTER_CRITICAL(&s_registry_lock);
+    for (int i = 0; i < EPD_FB_MAX_INSTANCES; i++) {
+        if (s_registry[i] == fb) {
+            s_registry[i] = NULL;
+            s_registry_count--;
+        }
+    }
+    if (s_registry_last == fb) {
+        s_registry_last = NULL;
+    }
+    portEXIT_CRITICAL(&s_registry_lock);
+    
+    heap_caps_free(fb->buffer);
+    heap_caps_free(fb->red);
+    heap_caps_free(fb->scratch);
+    free(fb->shadow);
+    free(fb->red_shadow);
+    free(fb);
+}
+
+// 标记脏区
+void epd_fb_mark_dirty(epd_fb_t *fb, uint16_t x, uint16_t y,
+                       uint16_t width, uint16_t height) {
+    if (!fb || width == 0 || height == 0 || x >= fb->width || y >= fb->height) {
+        return;
+    }
+    
+    if (x + width > fb->width) {
+        width = fb->width - x;
+    }
+    if (y + height > fb->height) {
+        height = fb->height - y;
+    }
+    
+    epd_rect_t rect = { x, y, width, height };
+    
+    // 与已有脏区重叠时直接合并
+    for (uint8_t i = 0; i < fb->dirty_count; i++) {
+        epd_rect_t *d = &fb->dirty[i];
+        if (rect.x <= d->x + d->width && d->x <= rect.x + rect.width &&
+            rect.y <= d->y + d->height && d->y <= rect.y + rect.height) {
+            uint16_t x0 = d->x < rect.x ? d->x : rect.x;
+            uint16_t y0 = d->y < rect.y ? d->y : rect.y;
+            uint16_t x1 = (d->x + d->width > rect.x + rect.width) ?
+                          d->x + d->width : rect.x + rect.width;
+            uint16_t y1 = (d->y + d->height > rect.y + rect.height) ?
+                          d->y + d->height : rect.y + rect.height;
+            d->x = x0;
+            d->y = y0;
+            d->width = x1 - x0;
+            d->height = y1 - y0;
+            return;
+        }
+    }
+    
+    if (fb->dirty_count < EPD_FB_MAX_DIRTY) {
+        fb->dirty[fb->dirty_count++] = rect;
+        return;
+    }
+    
+    // 列表已满: 并入使面积增长最小的脏区
+    uint8_t best = 0;
+    uint32_t best_growth = UINT32_MAX;
+    for (uint8_t i = 0; i < fb->dirty_count; i++) {
+        epd_rect_t *d = &fb->dirty[i];
+        uint32_t x0 = d->x < rect.x ? d->x : rect.x;
+        uint32_t y0 = d->y < rect.y ? d->y : rect.y;
+        uint32_t x1 = (d->x + d->width > rect.x + rect.width) ?
+                      d->x + d->width : rect.x + rect.width;
+        uint32_t y1 = (d->y + d->height > rect.y + rect.height) ?
+                      d->y + d->height : rect.y + rect.height;
+        uint32_t growth = (x1 - x0) * (y1 - y0) - (uint32_t)d->width * d->height;
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    
+    epd_rect_t *d = &fb->dirty[best];
+    uint16_t x0 = d->x < rect.x ? d->x : rect.x;
+    uint16_t y0 = d->y < rect.y ? d->y : rect.y;
+    uint16_t x1 = (d->x + d->width > rect.x + rect.width) ? d->x + d->width : rect.x + rect.width;
+    uint16_t y1 = (d->y + d->height > rect.y + rect.height) ? d->y + d->height : rect.y + rect.height;
+    d->x = x0;
+    d->y = y0;
+    d->width = x1 - x0;
+    d->height = y1 - y0;
+}
+
+// 填充整屏
+void epd_fb_clear(epd_fb_t *fb, epd_color_t color) {
+    if (!fb) {
+        return;
+    }
+    
+    if (fb->red) {
+        bool red = (color == EPD_COLOR_RED);
+        memset(fb->buffer, (color == EPD_COLOR_WHITE || red) ? 0xFF : 0x00, fb->size);
+        memset(fb->red, red ? 0xFF : 0x00, fb->size);
+    } else {
+        memset(fb->buffer, color == EPD_COLOR_WHITE ? 0xFF : 0x00, fb->size);
+    }
+    fb->dirty_count = 0;
+    epd_fb_mark_dirty(fb, 0, 0, fb->width, fb->height);
+}
+
+// 设置绘图裁剪区 (限制在屏幕内)
+void epd_fb_set_clip(epd_fb_t *fb, const epd_rect_t *clip) {
+    if (!fb) {
+        return;
+    }
+    
+    if (!clip) {
+        fb->clip_enabled = false;
+        return;
+    }
+    
+    uint32_t x1 = (uint32_t)clip->x + clip->width;
+    uint32_t y1 = (uint32_t)clip->y + clip->height;
+    
+    fb->clip.x = clip->x < fb->width ? clip->x : fb->width;
+    fb->clip.y = clip->y < fb->height ? clip->y : fb->height;
+    fb->clip.width = (x1 < fb->width ? x1 : fb->width) - fb->clip.x;
+    fb->clip.height = (y1 < fb->height ? y1 : fb->height) - fb->clip.y;
+    fb->clip_enabled = true;
+}
+
+// 面板内容未知
+void epd_fb_invalidate(epd_fb_t *fb) {
+    if (fb) {
+        fb->shadow_valid = false;
+    }
+}
+
+// 以EPF平面编码压缩到dst, 超出容量时返回0
+static uint32_t epd_fb_encode_plane(const uint8_t *src, uint32_t len,
+                                    uint8_t *dst, uint32_t capacity) {
+    uint32_t out = 0;
+    uint32_t i = 0;
+    
+    while (i < len) {
+        uint32_t run = 1;
+        while (i + run < len && src[i + run] == src[i] && run < EPD_EPF_MAX_LONG_RUN) {
+            run++;
+        }
+    
+        if (run >= 3) {
+            if (out + 4 > capacity) {
+                return 0;
+            }
+            if (run > EPD_EPF_MAX_SHORT_RUN) {
+                dst[out++] = EPD_EPF_OP_LONG_RUN;
+                dst[out++] = run & 0xFF;
+                dst[out++] = (run >> 8) & 0xFF;
+            } else {
+                dst[out++] = (uint8_t)(257 - run);
+            }
+            dst[out++] = src[i];
+            i += run;
+            continue;
+        }
+    
+        // 字面量段: 直到出现长度>=3的重复或达到128字节
+        uint32_t start = i;
+        while (i < len && i - start < EPD_EPF_MAX_LITERAL) {
+            if (i + 2 < len && src[i] == src[i + 1] && src[i] == src[i + 2]) {
+                break;
+            }
+            i++;
+        }
+    
+        uint32_t n = i - start;
+        if (out + 1 + n > capacity) {
+            return 0;
+        }
+        dst[out++] = (uint8_t)(n - 1);
+        memcpy(dst + out, src + start, n);
+        out += n;
+    }
+    
+    return out;
+}
+
+// 保存最近一次送屏的内容
+esp_err_t epd_fb_retain(epd_fb_t *fb) {
+    if (!fb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_fb_retained_t *r = &s_retained;
+    r->magic = 0;
+    
+    if (!fb->shadow_valid) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    uint32_t bw_len = epd_fb_encode_plane(fb->shadow, fb->size, r->data, EPD_FB_RETAIN_BYTES);
+    uint32_t red_len = 0;
+    if (bw_len && fb->red_shadow) {
+        red_len = epd_fb_encode_plane(fb->red_shadow, fb->size, r->data + bw_len,
+                                      EPD_FB_RETAIN_BYTES - bw_len);
+    }
+    
+    if (!bw_len || (fb->red_shadow && !red_len)) {
+        ESP_LOGW(TAG, "面板内容压缩后超过%d字节, 未保留", EPD_FB_RETAIN_BYTES);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    r->width = fb->width;
+    r->height = fb->height;
+    r->bw_len = (uint16_t)bw_len;
+    r->red_len = (uint16_t)red_len;
+    r->data_checksum = epd_fnv1a(r->data, bw_len + red_len);
+    r->magic = EPD_FB_RETAIN_MAGIC;
+    r->checksum = epd_fnv1a(r, offsetof(epd_fb_retained_t, checksum));
+    
+    ESP_LOGD(TAG, "保留面板内容 %u字节", (unsigned)(bw_len + red_len));
+    return ESP_OK;
+}
+
+// 以保留的内容作为面板当前内容
+esp_err_t epd_fb_restore(epd_fb_t *fb) {
+    if (!fb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const epd_fb_retained_t *r = &s_retained;
+    if (r->magic != EPD_FB_RETAIN_MAGIC ||
+        r->checksum != epd_fnv1a(r, offsetof(epd_fb_retained_t, checksum)) ||
+        (uint32_t)r->bw_len + r->red_len > EPD_FB_RETAIN_BYTES ||
+        r->data_checksum != epd_fnv1a(r->data, r->bw_len + r->red_len)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    if (r->width != fb->width || r->height != fb->height ||
+        (r->red_len != 0) != (fb->red_shadow != NULL)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    esp_err_t err = epd_epf_decode_plane(r->data, r->bw_len, fb->shadow, fb->size);
+    if (err == ESP_OK && fb->red_shadow) {
+        err = epd_epf_decode_plane(r->data + r->bw_len, r->red_len, fb->red_shadow, fb->size);
+    }
+    if (err != ESP_OK) {
+        fb->shadow_valid = false;
+        return err;
+    }
+    
+    memcpy(fb->buffer, fb->shadow, fb->size);
+    if (fb->red) {
+        memcpy(fb->red, fb->red_shadow, fb->size);
+    }
+    fb->dirty_count = 0;
+    fb->shadow_valid = true;
+    return ESP_OK;
+}
+
+// 将窗口收缩到cur与old实际不同的字节范围, 无变化返回false
+static bool epd_fb_shrink_window(const epd_fb_t *fb, const uint8_t *cur_plane,
+                                 const uint8_t *old_plane, epd_fb_window_t *w) {
+    uint16_t top = UINT16_MAX;
+    uint16_t bottom = 0;
+    uint16_t left = UINT16_MAX;
+    uint16_t right = 0;
+    
+    for (uint16_t row = w->y0; row <= w->y1; row++) {
+        const uint8_t *cur = cur_plane + (uint32_t)row * fb->stride;
+        const uint8_t *old = old_plane + (uint32_t)row * fb->stride;
+    
+        if (memcmp(cur + w->bx0, old + w->bx0, w->bx1 - w->bx0 + 1) == 0) {
+            continue;
+        }
+    
+        if (top == UINT16_MAX) {
+            top = row;
+        }
+        bottom = row;
+    
+        for (int32_t bx = w->bx0; bx < left && bx <= w->bx1; bx++) {
+            if (cur[bx] != old[bx]) {
+                left = bx;
+                break;
+            }
+        }
+        for (int32_t bx = w->bx1; bx > right && bx >= w->bx0; bx--) {
+            if (cur[bx] != old[bx]) {
+                right = bx;
+                break;
+            }
+        }
+    }
+    
+    if (top == UINT16_MAX) {
+        return false;
+    }
+    
+    w->bx0 = left;
+    w->bx1 = right;
+    w->y0 = top;
+    w->y1 = bottom;
+    return true;
+}
+
+// 每个窗口的固定开销: 共用一次激活时只是设置RAM区域, 否则每个窗口都要一次局刷激活
+static uint32_t epd_fb_window_cost_us(const epd_fb_t *fb) {
+    return fb->dev->display_windows ? EPD_FB_WINDOW_SETUP_US : fb->partial_refresh_us;
+}
+
+// 发送一个字节的耗时, 取传输层实测吞吐量
+static uint32_t epd_fb_byte_ns(const epd_fb_t *fb) {
+    epd_transport_stats_t stats;
+    
+    if (epd_transport_get_stats(fb->dev, &stats) == ESP_OK && stats.avg_bytes_per_sec) {
+        return 1000000000u / stats.avg_bytes_per_sec;
+    }
+    return EPD_FB_BYTE_NS_DEFAULT;
+}
+
+// 合并窗口: 先合并重叠的窗口, 再合并省下的窗口开销大于多发送字节耗时的窗口对
+static uint8_t epd_fb_merge_windows(const epd_fb_t *fb, epd_fb_window_t *win, uint8_t count) {
+    bool merged = true;
+    int64_t window_ns = (int64_t)epd_fb_window_cost_us(fb) * 1000;
+    int64_t byte_ns = epd_fb_byte_ns(fb);
+    
+    while (merged && count > 1) {
+        merged = false;
+        int best_i = -1;
+        int best_j = -1;
+        int64_t best_gain = 0;
+    
+        for (uint8_t i = 0; i < count && !merged; i++) {
+            for (uint8_t j = i + 1; j < count; j++) {
+                epd_fb_window_t u = win[i];
+                epd_fb_window_union(&u, &win[j]);
+    
+                if (epd_fb_window_overlap(&win[i], &win[j])) {
+                    best_i = i;
+                    best_j = j;
+                    merged = true;
+                    break;
+                }
+    
+                // 合并收益(纳秒) = 少一个窗口的开销 - 多发送的字节耗时
+                int64_t extra = (int64_t)epd_fb_window_bytes(&u) -
+                                epd_fb_window_bytes(&win[i]) - epd_fb_window_bytes(&win[j]);
+                int64_t gain = window_ns - extra * byte_ns;
+                if (gain >= best_gain) {
+                    best_gain = gain;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+    
+        if (best_i >= 0) {
+            epd_fb_window_union(&win[best_i], &win[best_j]);
+            win[best_j] = win[count - 1];
+            count--;
+            merged = true;
+        }
+    }
+    
+    return count;
+}
+
+// 窗口已送屏, 同步到shadow
+static void epd_fb_update_shadow(epd_fb_t *fb, const epd_fb_window_t *w) {
+    uint16_t row_bytes = w->bx1 - w->bx0 + 1;
+    
+    for (uint16_t row = w->y0; row <= w->y1; row++) {
+        uint32_t offset = (uint32_t)row * fb->stride + w->bx0;
+        memcpy(fb->shadow + offset, fb->buffer + offset, row_bytes);
+    }
+}
+
+// 发送单个局刷窗口
+static esp_err_t epd_fb_send_window(epd_fb_t *fb, const epd_fb_window_t *w) {
+    uint16_t row_bytes = w->bx1 - w->bx0 + 1;
+    uint16_t rows = w->y1 - w->y0 + 1;
+    esp_err_t err;
+    
+    if (fb->dev->display_window) {
+        err = fb->dev->display_window(fb->dev, fb->buffer, w->bx0 * 8, w->y0,
+                                      row_bytes * 8, rows, EPD_UPDATE_PARTIAL);
+    } else {
+        for (uint16_t r = 0; r < rows; r++) {
+            uint32_t offset = (uint32_t)(w->y0 + r) * fb->stride + w->bx0;
+            memcpy(fb->scratch + (uint32_t)r * row_bytes, fb->buffer + offset, row_bytes);
+        }
+    
+        err = fb->dev->display_partial(fb->dev, fb->scratch,
+                                       w->bx0 * 8, w->y0,
+                                       row_bytes * 8, rows);
+    }
+    if (err == ESP_OK) {
+        epd_fb_update_shadow(fb, w);
+    }
+    return err;
+}
+
+// 所有窗口写入RAM后只激活一次; 设备不支持时逐个窗口局刷
+static esp_err_t epd_fb_send_windows(epd_fb_t *fb, const epd_fb_window_t *win, uint8_t count) {
+    epd_device_t *dev = fb->dev;
+    int64_t start = esp_timer_get_time();
+    uint8_t activations = count;
+    esp_err_t err = ESP_OK;
+    
+    if (count > 1 && dev->display_windows) {
+        epd_rect_t rects[EPD_FB_MAX_DIRTY];
+        for (uint8_t i = 0; i < count; i++) {
+            rects[i].x = win[i].bx0 * 8;
+            rects[i].y = win[i].y0;
+            rects[i].width = (win[i].bx1 - win[i].bx0 + 1) * 8;
+            rects[i].height = win[i].y1 - win[i].y0 + 1;
+        }
+    
+        err = dev->display_windows(dev, fb->buffer, rects, count, EPD_UPDATE_PARTIAL);
+        if (err == ESP_OK) {
+            for (uint8_t i = 0; i < count; i++) {
+                epd_fb_update_shadow(fb, &win[i]);
+            }
+        }
+        activations = 1;
+    } else {
+        for (uint8_t i = 0; i < count && err == ESP_OK; i++) {
+            err = epd_fb_send_window(fb, &win[i]);
+        }
+    }
+    
+    // 按实测更新一次局刷激活的耗时 (含少量数据传输), 平滑后用于下次的合并决策
+    if (err == ESP_OK) {
+        uint32_t us = (uint32_t)((esp_timer_get_time() - start) / activations);
+        fb->partial_refresh_us = (fb->partial_refresh_us * 3 + us) / 4;
+    }
+    return err;
+}
+
+// 检查脏区内某个平面是否有变化
+static bool epd_fb_plane_changed(const epd_fb_t *fb, const uint8_t *cur, const uint8_t *old) {
+    for (uint8_t i = 0; i < fb->dirty_count; i++) {
+        const epd_rect_t *d = &fb->dirty[i];
+        epd_fb_window_t w = {
+            .bx0 = d->x / 8,
+            .bx1 = (d->x + d->width - 1) / 8,
+            .y0 = d->y,
+            .y1 = d->y + d->height - 1,
+        };
+        if (epd_fb_shrink_window(fb, cur, old, &w)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 三色提交: 面板不支持三色局刷, 有变化时全刷, 未变化的平面不发送
+static esp_err_t epd_fb_commit_planes(epd_fb_t *fb, epd_fb_commit_t *path) {
+    epd_device_t *dev = fb->dev;
+    bool bw_changed = true;
+    bool red_changed = true;
+    esp_err_t err;
+    
+    if (fb->shadow_valid) {
+        bw_changed = epd_fb_plane_changed(fb, fb->buffer, fb->shadow);
+        red_changed = epd_fb_plane_changed(fb, fb->red, fb->red_shadow);
+    }
+    
+    if (!bw_changed && !red_changed) {
+        fb->dirty_count = 0;
+        fb->stats.skipped++;
+        fb->stats.bytes_saved += fb->size * 2;
+        if (path) {
+            *path = EPD_FB_COMMIT_NONE;
+        }
+        return ESP_OK;
+    }
+    
+    if (dev->display_planes) {
+        err = dev->display_planes(dev, bw_changed ? fb->buffer : NULL,
+                                  red_changed ? fb->red : NULL, EPD_UPDATE_FULL);
+    } else {
+        // 驱动不支持双平面时只能显示黑白内容
+        err = dev->display_buffer(dev, fb->buffer, EPD_UPDATE_FULL);
+        bw_changed = true;
+        red_changed = false;
+    }
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "提交失败: %d", err);
+        return err;
+    }
+    
+    if (bw_changed) {
+        memcpy(fb->shadow, fb->buffer, fb->size);
+        fb->stats.bytes_sent += fb->size;
+    } else {
+        fb->stats.bytes_saved += fb->size;
+    }
+    
+    if (red_changed) {
+        memcpy(fb->red_shadow, fb->red, fb->size);
+        fb->stats.bytes_sent += fb->size;
+        fb->stats.red_planes_sent++;
+    } else {
+        fb->stats.bytes_saved += fb->size;
+        fb->stats.red_planes_skipped++;
+    }
+    
+    fb->shadow_valid = true;
+    fb->dirty_count = 0;
+    fb->stats.full_refreshes++;
+    
+    if (path) {
+        *path = EPD_FB_COMMIT_FULL;
+    }
+    return ESP_OK;
+}
+
+// 提交到面板
+esp_err_t epd_fb_commit(epd_fb_t *fb, epd_fb_commit_t *path) {
+    if (!fb || !fb->dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (fb->red) {
+        fb->stats.commits++;
+        return epd_fb_commit_planes(fb, path);
+    }
+    
+    epd_device_t *dev = fb->dev;
+    epd_fb_commit_t taken = EPD_FB_COMMIT_NONE;
+    epd_fb_window_t win[EPD_FB_MAX_DIRTY];
+    uint8_t count = 0;
+    esp_err_t err = ESP_OK;
+    
+    fb->stats.commits++;
+    
+    bool full = !fb->shadow_valid ||
+                !(dev->info.capabilities & EPD_CAP_PARTIAL_REFRESH) ||
+                (!dev->display_partial && !dev->display_window);
+    
+    if (!full) {
+        for (uint8_t i = 0; i < fb->dirty_count; i++) {
+            const epd_rect_t *d = &fb->dirty[i];
+            epd_fb_window_t w = {
+                .bx0 = d->x / 8,
+                .bx1 = (d->x + d->width - 1) / 8,
+                .y0 = d->y,
+                .y1 = d->y + d->height - 1,
+            };
+            if (epd_fb_shrink_window(fb, fb->buffer, fb->shadow, &w)) {
+                win[count++] = w;
+            }
+        }
+    
+        count = epd_fb_merge_windows(fb, win, count);
+    
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            total += epd_fb_window_bytes(&win[i]);
+        }
+    
+        if (count == 0) {
+            taken = EPD_FB_COMMIT_NONE;
+        } else if ((uint64_t)total * 100 >= (uint64_t)fb->size * fb->full_refresh_percent) {
+            full = true;
+        } else {
+            taken = (count == 1) ? EPD_FB_COMMIT_PARTIAL : EPD_FB_COMMIT_MULTI;
+        }
+    }
+    
+    if (full) {
+        taken = EPD_FB_COMMIT_FULL;
+        err = dev->display_buffer(dev, fb->buffer, EPD_UPDATE_FULL);
+        if (err == ESP_OK) {
+            memcpy(fb->shadow, fb->buffer, fb->size);
+            fb->shadow_valid = true;
+            fb->stats.full_refreshes++;
+            fb->stats.bytes_sent += fb->size;
+        }
+    } else if (taken == EPD_FB_COMMIT_NONE) {
+        fb->stats.skipped++;
+        fb->stats.bytes_saved += fb->size;
+    } else {
+        err = epd_fb_send_windows(fb, win, count);
+        if (err == ESP_OK) {
+            uint32_t sent = 0;
+            for (uint8_t i = 0; i < count; i++) {
+                sent += epd_fb_window_bytes(&win[i]);
+            }
+            fb->stats.partial_windows += count;
+            fb->stats.bytes_sent += sent;
+            fb->stats.bytes_saved += fb->size - sent;
+        }
+    }
+    
+    // 失败时保留脏区, 下次提交会根据与shadow的差异重新计算
+    if (err == ESP_OK) {
+        fb->dirty_count = 0;
+    } else {
+        ESP_LOGE(TAG, "提交失败: %d", err);
+    }
+    
+    ESP_LOGD(TAG, "提交: 路径=%d, 窗口数=%u", taken, count);
+    
+    if (path) {
+        *path = taken;
+    }
+    return err;
+}
@@ -0,0 +1,200 @@
+/**
+ * 多屏刷新组
+ * 依次对各面板begin_update (写入RAM并触发刷新), 再按触发顺序finish_update;
+ * 同时刷新的面板达到上限时先等待最早触发的面板完成
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_group.h"
+
+#define TAG "EPD_GROUP"
+
+struct epd_group_t {
+    epd_group_config_t config;
+    epd_device_t *panels[EPD_GROUP_MAX_PANELS];
+    uint8_t count;
+    SemaphoreHandle_t lock;         // 串行化组刷新, 刷新期间组内面板的总线操作只来自持有者
+    epd_group_stats_t stats;
+};
+
+// 等待面板刷新完成并记录结果
+static esp_err_t epd_group_finish(epd_group_t *group, uint8_t index, int64_t start_us) {
+    epd_device_t *dev = group->panels[index];
+    esp_err_t err = dev->finish_update(dev, group->config.busy_timeout_ms);
+    
+    group->stats.refresh_us[index] = (uint32_t)(esp_timer_get_time() - start_us);
+    group->stats.result[index] = err;
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "面板%d刷新失败: %d", index, err);
+        group->stats.errors++;
+    }
+    return err;
+}
+
+// 创建刷新组
+epd_group_t *epd_group_create(const epd_group_config_t *config) {
+    epd_group_t *group = calloc(1, sizeof(epd_group_t));
+    if (!group) {
+        return NULL;
+    }
+    
+    if (config) {
+        group->config = *config;
+    }
+    
+    group->lock = xSemaphoreCreateMutex();
+    if (!group->lock) {
+        free(group);
+        return NULL;
+    }
+    
+    return group;
+}
+
+// 销毁刷新组
+void epd_group_destroy(epd_group_t *group) {
+    if (!group) {
+        return;
+    }
+    
+    vSemaphoreDelete(group->lock);
+    free(group);
+}
+
+// 加入面板
+esp_err_t epd_group_add(epd_group_t *group, epd_device_t *dev, uint8_t *index) {
+    if (!group || !dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!dev->begin_update || !dev->finish_update) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if (group->count >= EPD_GROUP_MAX_PANELS) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    for (uint8_t i = 0; i < group->count; i++) {
+        const epd_pins_t *pins = &group->panels[i]->pins;
+    
+        if (group->panels[i] == dev ||
+            pins->spi_mosi != dev->pins.spi_mosi || pins->spi_clk != dev->pins.spi_clk ||
+            pins->spi_cs == dev->pins.spi_cs || pins->busy_pin == dev->pins.busy_pin) {
+            ESP_LOGE(TAG, "面板引脚与组内面板%d冲突", i);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+    if (index) {
+        *index = group->count;
+    }
+    group->panels[group->count++] = dev;
+    group->stats.count = group->count;
+    xSemaphoreGive(group->lock);
+    
+    return ESP_OK;
+}
+
+// 交错刷新组内面板
+esp_err_t epd_group_display(epd_group_t *group, const uint8_t *const buffers[],
+                            epd_update_mode_t mode) {
+    if (!group || !buffers) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+    
+    epd_group_stats_t *stats = &group->stats;
+    uint8_t max_active = group->config.max_active;
+    uint8_t active[EPD_GROUP_MAX_PANELS];     // 已触发、未完成的面板, 按触发顺序
+    int64_t started[EPD_GROUP_MAX_PANELS];
+    uint8_t head = 0;
+    uint8_t tail = 0;
+    esp_err_t result = ESP_OK;
+    int64_t start_us = esp_timer_get_time();
+    
+    for (uint8_t i = 0; i < group->count; i++) {
+        stats->transfer_us[i] = 0;
+        stats->refresh_us[i] = 0;
+        stats->result[i] = ESP_OK;
+    }
+    
+    for (uint8_t i = 0; i < group->count; i++) {
+        if (!buffers[i]) {
+            continue;
+        }
+    
+        // 达到并发上限: 先等最早触发的面板完成
+        if (max_active && tail - head >= max_active) {
+            uint8_t done = active[head++];
+            esp_err_t err = epd_group_finish(group, done, started[done]);
+            if (result == ESP_OK) {
+                result = err;
+            }
+        }
+    
+        epd_device_t *dev = group->panels[i];
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t err = dev->begin_update(dev, buffers[i], mode);
+        started[i] = esp_timer_get_time();
+        stats->transfer_us[i] = (uint32_t)(started[i] - t0);
+    
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "面板%d写入失败: %d", i, err);
+            stats->result[i] = err;
+            stats->errors++;
+            if (result == ESP_OK) {
+                result = err;
+            }
+            continue;
+        }
+    
+        active[tail++] = i;
+        if ((uint32_t)(tail - head) > stats->max_overlap) {
+            stats->max_overlap = tail - head;
+        }
+    }
+    
+    // 按触发顺序等待其余面板, 先触发的通常先完成
+    while (head < tail) {
+        uint8_t done = active[head++];
+        esp_err_t err = epd_group_finish(group, done, started[done]);
+        if (result == ESP_OK) {
+            result = err;
+        }
+    }
+    
+    stats->updates++;
+    stats->last_us = (uint32_t)(esp_timer_get_time() - start_us);
+    stats->last_serial_us = 0;
+    for (uint8_t i = 0; i < group->count; i++) {
+        stats->last_serial_us += stats->transfer_us[i] + stats->refresh_us[i];
+    }
+    
+    ESP_LOGD(TAG, "组刷新 %u us (逐块约 %u us)",
+             (unsigned)stats->last_us, (unsigned)stats->last_serial_us);
+    
+    xSemaphoreGive(group->lock);
+    return result;
+}
+
+// 获取统计
+esp_err_t epd_group_get_stats(epd_group_t *group, epd_group_stats_t *stats) {
+    if (!group || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+    memcpy(stats, &group->stats, sizeof(epd_group_stats_t));
+    xSemaphoreGive(group->lock);
+    return ESP_OK;
+}
@@ -0,0 +1,143 @@
+/**
+ * 墨水屏驱动组件内部接口 (不对外公开)
+ */
+
+#ifndef __EPD_INTERNAL_H__
+#define __EPD_INTERNAL_H__
+
+#include "epd_common.h"
+#include "epd_framebuffer.h"
+#include "epd_trace.h"
+
+// D/C引脚电平, 通过spi_transaction_t::user传给事务前回调
+typedef struct {
+    int8_t dc_pin;
+    uint8_t level;
+} epd_dc_ctx_t;
+
+// SPI事务前回调: 根据事务的user字段设置D/C引脚
+void epd_transport_pre_cb(spi_transaction_t *trans);
+
+// 以轮询方式发送少量字节 (命令或参数), dc: 0-命令 1-数据
+esp_err_t epd_transport_write(epd_device_t *dev, uint8_t dc,
+                              const uint8_t *data, uint32_t length);
+
+// 刷新策略钩子 (epd_policy.c), 未挂接策略时不做任何事:
+// 驱动触发刷新前以请求的模式和覆盖像素数 (0表示整屏) 取得实际模式, 刷新成功后报告耗时
+epd_update_mode_t epd_policy_select(epd_device_t *dev, epd_update_mode_t mode, uint32_t area);
+void epd_policy_complete(epd_device_t *dev, uint32_t us);
+
+// 记录跟踪事件 (epd_trace.c): start_us为0表示当前时刻, dur_us为0表示瞬时事件;
+// 关闭EPD_TRACE_ENABLE时为空函数, 调用被编译器去除
+#if EPD_TRACE_ENABLE
+void epd_trace_record(const epd_device_t *dev, uint8_t type, uint8_t code,
+                      int64_t start_us, uint32_t dur_us, uint32_t value, uint8_t flags);
+#else
+static inline void epd_trace_record(const epd_device_t *dev, uint8_t type, uint8_t code,
+                                    int64_t start_us, uint32_t dur_us, uint32_t value,
+                                    uint8_t flags) {
+    (void)dev; (void)type; (void)code; (void)start_us; (void)dur_us; (void)value; (void)flags;
+}
+#endif
+
+// RTC内存中保留数据的校验 (FNV-1a), 用于区分冷启动后的随机内容
+static inline uint32_t epd_fnv1a(const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// 字节内位反转表 (epd_rotate.c)
+extern const uint8_t epd_bit_reverse_lut[256];
+
+// 8x8位矩阵转置: 读取src起始的8行(行距stride)各一个字节,
+// out[c]为第c列, 最高位对应第0行
+static inline void epd_transpose8(const uint8_t *src, uint32_t stride, uint8_t out[8]) {
+    uint32_t x = ((uint32_t)src[0] << 24) | ((uint32_t)src[stride] << 16) |
+                 ((uint32_t)src[2 * stride] << 8) | src[3 * stride];
+    uint32_t y = ((uint32_t)src[4 * stride] << 24) | ((uint32_t)src[5 * stride] << 16) |
+                 ((uint32_t)src[6 * stride] << 8) | src[7 * stride];
+    uint32_t t;
+    
+    // 先交换2x2块内的位, 再交换4x4块内的2位组, 最后交换4位组
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+    
+    out[0] = x >> 24;
+    out[1] = x >> 16;
+    out[2] = x >> 8;
+    out[3] = x;
+    out[4] = y >> 24;
+    out[5] = y >> 16;
+    out[6] = y >> 8;
+    out[7] = y;
+}
+
+// 绘图目标: 普通1bpp缓冲区, 或托管帧缓冲区 (三色时带红色平面)
+typedef struct {
+    uint8_t *bw;
+    uint8_t *red;          // 红色平面, 位为1表示红色; 无红色平面时为NULL
+    uint16_t width;
+    uint16_t height;
+    epd_fb_t *fb;          // 所属托管帧缓冲区, 用于记录脏区
+    int32_t clip_x0;       // 可写区域 [clip_x0, clip_x1) x [clip_y0, clip_y1)
+    int32_t clip_y0;
+    int32_t clip_x1;
+    int32_t clip_y1;
+    bool clipped;          // 可写区域小于整个画布
+} epd_canvas_t;
+
+static inline void epd_canvas_init(epd_canvas_t *cv, uint8_t *buffer,
+                                   uint16_t width, uint16_t height) {
+    cv->bw = buffer;
+    cv->width = width;
+    cv->height = height;
+    cv->fb = epd_fb_from_buffer(buffer);
+    cv->red = cv->fb ? cv->fb->red : NULL;
+    cv->clip_x0 = 0;
+    cv->clip_y0 = 0;
+    cv->clip_x1 = width;
+    cv->clip_y1 = height;
+    cv->clipped = false;
+    
+    if (cv->fb && cv->fb->clip_enabled) {
+        const epd_rect_t *c = &cv->fb->clip;
+        cv->clip_x0 = c->x;
+        cv->clip_y0 = c->y;
+        cv->clip_x1 = (int32_t)c->x + c->width < width ? (int32_t)c->x + c->width : width;
+        cv->clip_y1 = (int32_t)c->y + c->height < height ? (int32_t)c->y + c->height : height;
+        cv->clipped = true;
+    }
+}
+
+// 行内第b个字节中位于裁剪区内的位掩码
+static inline uint8_t epd_canvas_clip_mask(const epd_canvas_t *cv, uint32_t b) {
+    int32_t x0 = (int32_t)b * 8;
+    
+    if (x0 >= cv->clip_x1 || x0 + 8 <= cv->clip_x0) {
+        return 0;
+    }
+    
+    uint8_t mask = 0xFF;
+    if (cv->clip_x0 > x0) {
+        mask &= 0xFF >> (cv->clip_x0 - x0);
+    }
+    if (cv->clip_x1 < x0 + 8) {
+        mask &= (uint8_t)(0xFF << (x0 + 8 - cv->clip_x1));
+    }
+    return mask;
+}
+
+// 将绘制区域(闭区间)记录到托管帧缓冲区的脏区列表 (epd_draw.c)
+void epd_canvas_touch(const epd_canvas_t *cv, int32_t x0, int32_t y0,
+                      int32_t x1, int32_t y1);
+
+#endif // __EPD_INTERNAL_H__
@@ -0,0 +1,414 @@
+/**
+ * 双核渲染/发送流水线
+ * 帧在 空闲 -> 渲染中 -> 待发送 -> 发送中 -> 空闲 之间流转, 待发送帧按提交顺序排队;
+ * 空闲帧数和待发送帧数各用一个计数信号量通知对方任务
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_pipeline.h"
+
+#define TAG "EPD_PIPELINE"
+
+typedef enum {
+    EPD_SLOT_FREE,
+    EPD_SLOT_RENDERING,
+    EPD_SLOT_READY,
+    EPD_SLOT_SENDING,
+} epd_slot_state_t;
+
+struct epd_pipeline_t {
+    epd_device_t *dev;
+    epd_pipeline_config_t config;
+    uint8_t count;
+    uint8_t *frames[EPD_PIPELINE_RING_MAX];
+    epd_slot_state_t state[EPD_PIPELINE_RING_MAX];
+    
+    // 待发送队列 (帧下标, 按提交顺序)
+    uint8_t ready[EPD_PIPELINE_RING_MAX];
+    uint8_t ready_head;
+    uint8_t ready_count;
+    
+    SemaphoreHandle_t free_sem;     // 空闲帧计数
+    SemaphoreHandle_t ready_sem;    // 待发送帧计数, 令牌可能多于队列长度 (合并或退出时)
+    SemaphoreHandle_t render_done;  // 渲染任务退出时释放
+    SemaphoreHandle_t tx_done;      // 发送任务退出时释放
+    TaskHandle_t render_task;
+    TaskHandle_t tx_task;
+    volatile bool stopping;
+    bool render_finished;
+    
+    epd_pipeline_stats_t stats;
+    uint64_t render_total_us;
+    uint64_t display_total_us;
+    int64_t first_tx_us;
+    int64_t last_tx_us;
+};
+
+static portMUX_TYPE s_pipeline_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TickType_t epd_pipeline_ticks(uint32_t timeout_ms) {
+    return timeout_ms == EPD_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+// 从待发送队列头部取出一帧, 调用方持有锁; 队列为空返回-1
+static int epd_pipeline_pop_ready(epd_pipeline_t *p) {
+    if (p->ready_count == 0) {
+        return -1;
+    }
+    int slot = p->ready[p->ready_head];
+    p->ready_head = (p->ready_head + 1) % p->count;
+    p->ready_count--;
+    return slot;
+}
+
+// 占用一个空闲帧
+static int epd_pipeline_claim_free(epd_pipeline_t *p) {
+    int slot = -1;
+    
+    portENTER_CRITICAL(&s_pipeline_lock);
+    for (int i = 0; i < p->count; i++) {
+        if (p->state[i] == EPD_SLOT_FREE) {
+            p->state[i] = EPD_SLOT_RENDERING;
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_pipeline_lock);
+    
+    return slot;
+}
+
+// 按策略获取渲染用的帧, 本周期放弃渲染或正在停止时返回-1
+static int epd_pipeline_acquire(epd_pipeline_t *p) {
+    if (xSemaphoreTake(p->free_sem, 0) == pdTRUE) {
+        return epd_pipeline_claim_free(p);
+    }
+    
+    if (p->config.policy == EPD_PIPELINE_DROP && p->config.period_ms > 0) {
+        portENTER_CRITICAL(&s_pipeline_lock);
+        p->stats.dropped++;
+        portEXIT_CRITICAL(&s_pipeline_lock);
+        return -1;
+    }
+    
+    if (p->config.policy == EPD_PIPELINE_COALESCE) {
+        // 收回最早的待发送帧; 它的令牌如果已被发送任务取走, 发送任务会看到空队列
+        portENTER_CRITICAL(&s_pipeline_lock);
+        int slot = epd_pipeline_pop_ready(p);
+        if (slot >= 0) {
+            p->state[slot] = EPD_SLOT_RENDERING;
+            p->stats.coalesced++;
+        }
+        portEXIT_CRITICAL(&s_pipeline_lock);
+    
+        if (slot >= 0) {
+            xSemaphoreTake(p->ready_sem, 0);
+            return slot;
+        }
+    }
+    
+    // 背压: 等待发送任务空出一帧
+    portENTER_CRITICAL(&s_pipeline_lock);
+    p->stats.render_waits++;
+    portEXIT_CRITICAL(&s_pipeline_lock);
+    
+    xSemaphoreTake(p->free_sem, portMAX_DELAY);
+    if (p->stopping) {
+        return -1;
+    }
+    return epd_pipeline_claim_free(p);
+}
+
+// 渲染任务
+static void epd_pipeline_render_task(void *arg) {
+    epd_pipeline_t *p = (epd_pipeline_t *)arg;
+    const epd_pipeline_config_t *cfg = &p->config;
+    uint32_t seq = 0;
+    TickType_t next_wake = xTaskGetTickCount();
+    
+    p->stats.render_core = xPortGetCoreID();
+    
+    while (!p->stopping && (cfg->max_frames == 0 || seq < cfg->max_frames)) {
+        if (cfg->period_ms > 0) {
+            TickType_t now = xTaskGetTickCount();
+            if ((int32_t)(next_wake - now) > 0) {
+                vTaskDelay(next_wake - now);
+            } else {
+                next_wake = now;
+            }
+            next_wake += pdMS_TO_TICKS(cfg->period_ms);
+            if (p->stopping) {
+                break;
+            }
+        }
+    
+        int slot = epd_pipeline_acquire(p);
+        if (slot < 0) {
+            continue;
+        }
+    
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = cfg->render(cfg->ctx, p->frames[slot], seq);
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    
+        portENTER_CRITICAL(&s_pipeline_lock);
+        if (err == ESP_OK) {
+            p->state[slot] = EPD_SLOT_READY;
+            p->ready[(p->ready_head + p->ready_count) % p->count] = slot;
+            p->ready_count++;
+            p->stats.rendered++;
+            p->render_total_us += elapsed_us;
+        } else {
+            p->state[slot] = EPD_SLOT_FREE;
+            if (err != ESP_ERR_NOT_FINISHED) {
+                p->stats.render_errors++;
+            }
+        }
+        portEXIT_CRITICAL(&s_pipeline_lock);
+    
+        if (err == ESP_OK) {
+            xSemaphoreGive(p->ready_sem);
+            seq++;
+        } else {
+            xSemaphoreGive(p->free_sem);
+            if (err != ESP_ERR_NOT_FINISHED) {
+                ESP_LOGW(TAG, "第%u帧渲染失败: %d", (unsigned)seq, err);
+            }
+            if (cfg->period_ms == 0) {
+                // 没有渲染周期时让出CPU, 避免空转
+                vTaskDelay(1);
+            }
+        }
+    }
+    
+    // 额外的令牌唤醒发送任务, 它发完剩余的帧后退出
+    portENTER_CRITICAL(&s_pipeline_lock);
+    p->render_finished = true;
+    portEXIT_CRITICAL(&s_pipeline_lock);
+    xSemaphoreGive(p->ready_sem);
+    
+    xSemaphoreGive(p->render_done);
+    vTaskDelete(NULL);
+}
+
+// 发送任务
+static void epd_pipeline_tx_task(void *arg) {
+    epd_pipeline_t *p = (epd_pipeline_t *)arg;
+    epd_device_t *dev = p->dev;
+    
+    p->stats.tx_core = xPortGetCoreID();
+    
+    for (;;) {
+        if (xSemaphoreTake(p->ready_sem, 0) != pdTRUE) {
+            portENTER_CRITICAL(&s_pipeline_lock);
+            if (p->stats.displayed > 0) {
+                p->stats.tx_starved++;
+            }
+            portEXIT_CRITICAL(&s_pipeline_lock);
+            xSemaphoreTake(p->ready_sem, portMAX_DELAY);
+        }
+    
+        portENTER_CRITICAL(&s_pipeline_lock);
+        int slot = epd_pipeline_pop_ready(p);
+        bool finished = p->render_finished;
+        if (slot >= 0) {
+            p->state[slot] = EPD_SLOT_SENDING;
+        }
+        portEXIT_CRITICAL(&s_pipeline_lock);
+    
+        if (slot < 0) {
+            if (finished) {
+                break;
+            }
+            continue;
+        }
+    
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = dev->display_buffer(dev, p->frames[slot], p->config.mode);
+        int64_t end_us = esp_timer_get_time();
+    
+        portENTER_CRITICAL(&s_pipeline_lock);
+        if (err == ESP_OK) {
+            if (p->stats.displayed == 0) {
+                p->first_tx_us = start_us;
+            }
+            p->stats.displayed++;
+            p->display_total_us += (uint64_t)(end_us - start_us);
+            p->last_tx_us = end_us;
+        } else {
+            p->stats.display_errors++;
+        }
+        p->state[slot] = EPD_SLOT_FREE;
+        portEXIT_CRITICAL(&s_pipeline_lock);
+    
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "刷新失败: %d", err);
+        }
+        xSemaphoreGive(p->free_sem);
+    }
+    
+    xSemaphoreGive(p->tx_done);
+    vTaskDelete(NULL);
+}
+
+// 释放上下文资源并归还帧缓冲区
+static void epd_pipeline_free(epd_pipeline_t *p) {
+    for (int i = 0; i < p->count; i++) {
+        if (p->frames[i]) {
+            epd_pool_return(p->dev, p->frames[i]);
+        }
+    }
+    if (p->free_sem) {
+        vSemaphoreDelete(p->free_sem);
+    }
+    if (p->ready_sem) {
+        vSemaphoreDelete(p->ready_sem);
+    }
+    if (p->render_done) {
+        vSemaphoreDelete(p->render_done);
+    }
+    if (p->tx_done) {
+        vSemaphoreDelete(p->tx_done);
+    }
+    free(p);
+}
+
+// 启动流水线
+esp_err_t epd_pipeline_start(epd_device_t *dev, const epd_pipeline_config_t *config,
+                             epd_pipeline_t **pipeline) {
+    if (!dev || !config || !config->render || !pipeline ||
+        config->ring_size == 1 || config->ring_size > EPD_PIPELINE_RING_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!dev->pool) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    epd_pipeline_t *p = calloc(1, sizeof(epd_pipeline_t));
+    if (!p) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    p->dev = dev;
+    p->config = *config;
+    p->count = config->ring_size ? config->ring_size : 2;
+    p->stats.render_core = -1;
+    p->stats.tx_core = -1;
+    
+    // 帧环整个运行期间占用池中的缓冲区, 运行时不再分配内存
+    for (int i = 0; i < p->count; i++) {
+        p->frames[i] = epd_pool_borrow(dev, 0);
+        if (!p->frames[i]) {
+            ESP_LOGE(TAG, "帧缓冲池中没有%d个空闲缓冲区", p->count);
+            epd_pipeline_free(p);
+            return ESP_ERR_NO_MEM;
+        }
+        p->state[i] = EPD_SLOT_FREE;
+    }
+    
+    p->free_sem = xSemaphoreCreateCounting(p->count + 1, p->count);
+    p->ready_sem = xSemaphoreCreateCounting(p->count + 1, 0);
+    p->render_done = xSemaphoreCreateBinary();
+    p->tx_done = xSemaphoreCreateBinary();
+    if (!p->free_sem || !p->ready_sem || !p->render_done || !p->tx_done) {
+        epd_pipeline_free(p);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    if (xTaskCreatePinnedToCore(epd_pipeline_tx_task, "epd_tx", EPD_PIPELINE_TASK_STACK,
+                                p, EPD_PIPELINE_TASK_PRIO, &p->tx_task,
+                                EPD_PIPELINE_TX_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "创建发送任务失败");
+        epd_pipeline_free(p);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    if (xTaskCreatePinnedToCore(epd_pipeline_render_task, "epd_render", EPD_PIPELINE_TASK_STACK,
+                                p, EPD_PIPELINE_TASK_PRIO, &p->render_task,
+                                EPD_PIPELINE_RENDER_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "创建渲染任务失败");
+        // 让发送任务看到渲染已结束并退出
+        p->render_finished = true;
+        xSemaphoreGive(p->ready_sem);
+        xSemaphoreTake(p->tx_done, portMAX_DELAY);
+        epd_pipeline_free(p);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ESP_LOGI(TAG, "流水线启动: %d帧, 渲染核%d, 发送核%d",
+             p->count, EPD_PIPELINE_RENDER_CORE, EPD_PIPELINE_TX_CORE);
+    
+    *pipeline = p;
+    return ESP_OK;
+}
+
+// 等待所有帧显示完毕
+esp_err_t epd_pipeline_wait_idle(epd_pipeline_t *pipeline, uint32_t timeout_ms) {
+    if (!pipeline) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (xSemaphoreTake(pipeline->tx_done, epd_pipeline_ticks(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    // 放回信号, 供epd_pipeline_stop使用
+    xSemaphoreGive(pipeline->tx_done);
+    return ESP_OK;
+}
+
+// 停止流水线
+void epd_pipeline_stop(epd_pipeline_t *pipeline) {
+    if (!pipeline) {
+        return;
+    }
+    
+    epd_pipeline_t *p = pipeline;
+    
+    // 唤醒可能在等待空闲帧的渲染任务
+    p->stopping = true;
+    xSemaphoreGive(p->free_sem);
+    xSemaphoreTake(p->render_done, portMAX_DELAY);
+    xSemaphoreTake(p->tx_done, portMAX_DELAY);
+    
+    epd_pipeline_stats_t stats;
+    epd_pipeline_get_stats(p, &stats);
+    ESP_LOGI(TAG, "流水线停止: 显示%u帧, 丢弃%u, 合并%u, %u.%02u次/秒",
+             (unsigned)stats.displayed, (unsigned)stats.dropped,
+             (unsigned)stats.coalesced, (unsigned)(stats.updates_x100 / 100),
+             (unsigned)(stats.updates_x100 % 100));
+    
+    epd_pipeline_free(p);
+}
+
+// 获取统计
+esp_err_t epd_pipeline_get_stats(epd_pipeline_t *pipeline, epd_pipeline_stats_t *stats) {
+    if (!pipeline || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    epd_pipeline_t *p = pipeline;
+    
+    portENTER_CRITICAL(&s_pipeline_lock);
+    *stats = p->stats;
+    uint64_t render_total_us = p->render_total_us;
+    uint64_t display_total_us = p->display_total_us;
+    int64_t span_us = p->last_tx_us - p->first_tx_us;
+    portEXIT_CRITICAL(&s_pipeline_lock);
+    
+    stats->avg_render_us = stats->rendered ?
+        (uint32_t)(render_total_us / stats->rendered) : 0;
+    stats->avg_display_us = stats->displayed ?
+        (uint32_t)(display_total_us / stats->displayed) : 0;
+    stats->updates_x100 = (stats->displayed && span_us > 0) ?
+        (uint32_t)((uint64_t)stats->displayed * 100000000ULL / (uint64_t)span_us) : 0;
+    return ESP_OK;
+}
@@ -0,0 +1,221 @@
+/**
+ * 刷新策略: 残影预算与全刷插入
+ * 驱动在触发刷新前调用epd_policy_select决定实际模式, 刷新完成后调用epd_policy_complete记账
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_policy.h"
+#include "epd_internal.h"
+
+#define TAG "EPD_POLICY"
+
+struct epd_policy_t {
+    epd_policy_config_t config;
+    uint32_t screen_pixels;
+    portMUX_TYPE lock;
+    bool pending;               // select之后、complete之前
+    bool idle_refresh;          // 当前刷新由epd_policy_service发起
+    epd_update_mode_t mode;     // select选定的模式
+    uint32_t area;              // 本次刷新覆盖的像素数
+    uint64_t debt_pixels;       // 自上次全刷以来局刷累计覆盖的像素数
+    int64_t last_update_us;
+    uint64_t full_total_us;
+    uint64_t partial_total_us;
+    epd_policy_stats_t stats;
+};
+
+void epd_policy_default_config(epd_policy_config_t *config) {
+    if (!config) {
+        return;
+    }
+    
+    config->max_partials = EPD_POLICY_MAX_PARTIALS;
+    config->max_area_percent = EPD_POLICY_MAX_AREA_PERCENT;
+    config->idle_full_ms = EPD_POLICY_IDLE_FULL_MS;
+}
+
+esp_err_t epd_policy_attach(epd_device_t *dev, const epd_policy_config_t *config) {
+    if (!dev || dev->info.width == 0 || dev->info.height == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_policy_t *policy = dev->policy;
+    if (!policy) {
+        policy = calloc(1, sizeof(struct epd_policy_t));
+        if (!policy) {
+            return ESP_ERR_NO_MEM;
+        }
+        policy->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    }
+    
+    epd_policy_config_t cfg;
+    if (config) {
+        cfg = *config;
+    } else {
+        epd_policy_default_config(&cfg);
+    }
+    
+    portENTER_CRITICAL(&policy->lock);
+    policy->config = cfg;
+    policy->screen_pixels = (uint32_t)dev->info.width * dev->info.height;
+    policy->pending = false;
+    policy->idle_refresh = false;
+    policy->debt_pixels = 0;
+    policy->last_update_us = esp_timer_get_time();
+    policy->full_total_us = 0;
+    policy->partial_total_us = 0;
+    memset(&policy->stats, 0, sizeof(epd_policy_stats_t));
+    portEXIT_CRITICAL(&policy->lock);
+    
+    dev->policy = policy;
+    return ESP_OK;
+}
+
+void epd_policy_detach(epd_device_t *dev) {
+    if (!dev || !dev->policy) {
+        return;
+    }
+    
+    free(dev->policy);
+    dev->policy = NULL;
+}
+
+// 选择实际刷新模式: 本次局刷/快刷会超出残影预算时升级为全刷
+epd_update_mode_t epd_policy_select(epd_device_t *dev, epd_update_mode_t mode, uint32_t area) {
+    struct epd_policy_t *p = dev->policy;
+    if (!p) {
+        return mode;
+    }
+    
+    if (area == 0 || area > p->screen_pixels) {
+        area = p->screen_pixels;
+    }
+    
+    portENTER_CRITICAL(&p->lock);
+    if (mode != EPD_UPDATE_FULL) {
+        const epd_policy_config_t *cfg = &p->config;
+        bool over_count = cfg->max_partials && p->stats.since_full >= cfg->max_partials;
+        bool over_area = cfg->max_area_percent &&
+                         (p->debt_pixels + area) * 100 >
+                         (uint64_t)cfg->max_area_percent * p->screen_pixels;
+        if (over_count || over_area) {
+            mode = EPD_UPDATE_FULL;
+            p->stats.promoted++;
+        }
+    }
+    p->mode = mode;
+    p->area = area;
+    p->pending = true;
+    portEXIT_CRITICAL(&p->lock);
+    
+    if (mode == EPD_UPDATE_FULL && p->stats.since_full) {
+        ESP_LOGD(TAG, "%u次局刷后插入全刷", (unsigned)p->stats.since_full);
+    }
+    return mode;
+}
+
+// 刷新完成: 更新残影预算和耗时统计
+void epd_policy_complete(epd_device_t *dev, uint32_t us) {
+    struct epd_policy_t *p = dev->policy;
+    if (!p) {
+        return;
+    }
+    
+    portENTER_CRITICAL(&p->lock);
+    if (p->pending) {
+        epd_policy_stats_t *stats = &p->stats;
+    
+        if (p->mode == EPD_UPDATE_FULL) {
+            stats->full++;
+            if (p->idle_refresh) {
+                stats->idle_full++;
+            }
+            stats->since_full = 0;
+            p->debt_pixels = 0;
+            p->full_total_us += us;
+            stats->avg_full_us = (uint32_t)(p->full_total_us / stats->full);
+        } else {
+            if (p->mode == EPD_UPDATE_FAST) {
+                stats->fast++;
+            } else {
+                stats->partial++;
+            }
+            stats->since_full++;
+            p->debt_pixels += p->area;
+            p->partial_total_us += us;
+            stats->avg_partial_us = (uint32_t)(p->partial_total_us /
+                                               (stats->partial + stats->fast));
+            // 尚未测得全刷耗时前不计入节省
+            if (stats->avg_full_us > us) {
+                stats->saved_us += stats->avg_full_us - us;
+            }
+        }
+    
+        stats->area_percent = (uint32_t)(p->debt_pixels * 100 / p->screen_pixels);
+        p->last_update_us = esp_timer_get_time();
+        p->pending = false;
+    }
+    portEXIT_CRITICAL(&p->lock);
+}
+
+// 空闲补刷
+esp_err_t epd_policy_service(epd_device_t *dev, bool *refreshed) {
+    if (refreshed) {
+        *refreshed = false;
+    }
+    
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_policy_t *p = dev->policy;
+    if (!p) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!dev->refresh) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    portENTER_CRITICAL(&p->lock);
+    bool due = p->config.idle_full_ms && p->stats.since_full > 0 &&
+               esp_timer_get_time() - p->last_update_us >= (int64_t)p->config.idle_full_ms * 1000;
+    portEXIT_CRITICAL(&p->lock);
+    
+    if (!due) {
+        return ESP_OK;
+    }
+    
+    ESP_LOGD(TAG, "空闲补刷, 清除%u次局刷的残影", (unsigned)p->stats.since_full);
+    
+    p->idle_refresh = true;
+    esp_err_t err = dev->refresh(dev, EPD_UPDATE_FULL);
+    p->idle_refresh = false;
+    
+    if (err == ESP_OK && refreshed) {
+        *refreshed = true;
+    }
+    return err;
+}
+
+esp_err_t epd_policy_get_stats(epd_device_t *dev, epd_policy_stats_t *stats) {
+    if (!dev || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_policy_t *p = dev->policy;
+    if (!p) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    portENTER_CRITICAL(&p->lock);
+    memcpy(stats, &p->stats, sizeof(epd_policy_stats_t));
+    portEXIT_CRITICAL(&p->lock);
+    return ESP_OK;
+}
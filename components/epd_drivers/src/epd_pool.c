@@ -0,0 +1,188 @@
+/**
+ * 帧缓冲池: 设备初始化时一次性分配DMA内存中的整屏平面缓冲区,
+ * 刷新路径只借用/归还, 不再进行堆操作
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "epd_common.h"
+
+#define TAG "EPD_POOL"
+
+struct epd_pool_t {
+    uint32_t buffer_size;
+    uint8_t count;
+    uint32_t free_mask;                 // 第i位为1表示buffers[i]空闲
+    SemaphoreHandle_t available;        // 空闲缓冲区计数
+    portMUX_TYPE lock;
+    epd_pool_stats_t stats;
+    uint8_t *buffers[EPD_POOL_MAX_BUFFERS];
+};
+
+static void epd_pool_free(struct epd_pool_t *pool) {
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->buffers[i]) {
+            heap_caps_free(pool->buffers[i]);
+        }
+    }
+    
+    if (pool->available) {
+        vSemaphoreDelete(pool->available);
+    }
+    
+    free(pool);
+}
+
+esp_err_t epd_pool_init(epd_device_t *dev, uint8_t count) {
+    if (!dev || count == 0 || count > EPD_POOL_MAX_BUFFERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 重复初始化 (如唤醒后再次init) 时沿用已有的池
+    if (dev->pool) {
+        return ESP_OK;
+    }
+    
+    struct epd_pool_t *pool = calloc(1, sizeof(struct epd_pool_t));
+    if (!pool) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 缓冲区大小与旋转无关, 按整屏单平面分配
+    pool->buffer_size = (uint32_t)dev->info.width * dev->info.height / 8;
+    pool->count = count;
+    pool->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    
+    for (int i = 0; i < count; i++) {
+        pool->buffers[i] = heap_caps_malloc(pool->buffer_size, MALLOC_CAP_DMA);
+        if (!pool->buffers[i]) {
+            ESP_LOGE(TAG, "分配第%d个帧缓冲区失败 (%lu字节)",
+                     i, (unsigned long)pool->buffer_size);
+            epd_pool_free(pool);
+            return ESP_ERR_NO_MEM;
+        }
+        pool->free_mask |= 1u << i;
+    }
+    
+    pool->available = xSemaphoreCreateCounting(count, count);
+    if (!pool->available) {
+        epd_pool_free(pool);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 池结构体、各缓冲区和信号量, 之后借用/归还不再分配
+    pool->stats.heap_allocs = count + 2;
+    
+    dev->pool = pool;
+    ESP_LOGI(TAG, "帧缓冲池: %d x %lu字节", count, (unsigned long)pool->buffer_size);
+    
+    return ESP_OK;
+}
+
+void epd_pool_deinit(epd_device_t *dev) {
+    if (!dev || !dev->pool) {
+        return;
+    }
+    
+    struct epd_pool_t *pool = dev->pool;
+    if (pool->stats.in_use) {
+        ESP_LOGW(TAG, "仍有%d个缓冲区未归还", pool->stats.in_use);
+    }
+    
+    dev->pool = NULL;
+    epd_pool_free(pool);
+}
+
+uint8_t *epd_pool_borrow(epd_device_t *dev, uint32_t timeout_ms) {
+    if (!dev || !dev->pool) {
+        return NULL;
+    }
+    
+    struct epd_pool_t *pool = dev->pool;
+    TickType_t ticks = (timeout_ms == EPD_WAIT_FOREVER) ? portMAX_DELAY
+                                                        : pdMS_TO_TICKS(timeout_ms);
+    
+    if (xSemaphoreTake(pool->available, ticks) != pdTRUE) {
+        portENTER_CRITICAL(&pool->lock);
+        pool->stats.timeouts++;
+        portEXIT_CRITICAL(&pool->lock);
+        ESP_LOGW(TAG, "借用帧缓冲区超时");
+        return NULL;
+    }
+    
+    // 信号量保证至少有一个空闲位
+    uint8_t *buf = NULL;
+    
+    portENTER_CRITICAL(&pool->lock);
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->free_mask & (1u << i)) {
+            pool->free_mask &= ~(1u << i);
+            buf = pool->buffers[i];
+            break;
+        }
+    }
+    pool->stats.borrows++;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak_in_use) {
+        pool->stats.peak_in_use = pool->stats.in_use;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+    
+    return buf;
+}
+
+esp_err_t epd_pool_return(epd_device_t *dev, uint8_t *buffer) {
+    if (!dev || !dev->pool || !buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_pool_t *pool = dev->pool;
+    int index = -1;
+    
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->buffers[i] == buffer) {
+            index = i;
+            break;
+        }
+    }
+    
+    if (index < 0) {
+        ESP_LOGE(TAG, "归还的缓冲区不属于该池");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&pool->lock);
+    if (pool->free_mask & (1u << index)) {
+        portEXIT_CRITICAL(&pool->lock);
+        ESP_LOGE(TAG, "缓冲区被重复归还");
+        return ESP_ERR_INVALID_STATE;
+    }
+    pool->free_mask |= 1u << index;
+    pool->stats.returns++;
+    pool->stats.in_use--;
+    portEXIT_CRITICAL(&pool->lock);
+    
+    xSemaphoreGive(pool->available);
+    return ESP_OK;
+}
+
+esp_err_t epd_pool_get_stats(epd_device_t *dev, epd_pool_stats_t *stats) {
+    if (!dev || !dev->pool || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_pool_t *pool = dev->pool;
+    
+    portENTER_CRITICAL(&pool->lock);
+    memcpy(stats, &pool->stats, sizeof(epd_pool_stats_t));
+    portEXIT_CRITICAL(&pool->lock);
+    
+    stats->buffer_size = pool->buffer_size;
+    stats->count = pool->count;
+    return ESP_OK;
+}
@@ -0,0 +1,150 @@
+/**
+ * 刷新性能分析实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_profile.h"
+
+#define TAG "EPD_PROFILE"
+
+static const char *s_phase_names[EPD_PHASE_MAX] = {
+    "命令设置",
+    "RAM写入",
+    "BUSY等待",
+    "总计",
+};
+
+const char* epd_phase_name(epd_phase_t phase) {
+    return phase < EPD_PHASE_MAX ? s_phase_names[phase] : "?";
+}
+
+// 开始计时, 传输层和BUSY等待会把各自耗时累加到sample中
+esp_err_t epd_profile_begin(epd_device_t *dev, epd_profile_sample_t *sample) {
+    if (!dev || !sample) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (dev->profile) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    memset(sample, 0, sizeof(*sample));
+    sample->start_us = esp_timer_get_time();
+    dev->profile = sample;
+    
+    return ESP_OK;
+}
+
+// 结束计时, 未被单独计量的时间计入命令设置阶段
+void epd_profile_end(epd_device_t *dev) {
+    if (!dev || !dev->profile) {
+        return;
+    }
+    
+    epd_profile_sample_t *sample = dev->profile;
+    dev->profile = NULL;
+    
+    uint32_t total = (uint32_t)(esp_timer_get_time() - sample->start_us);
+    uint32_t measured = sample->phase_us[EPD_PHASE_RAM_WRITE] +
+                        sample->phase_us[EPD_PHASE_BUSY];
+    
+    sample->phase_us[EPD_PHASE_TOTAL] = total;
+    sample->phase_us[EPD_PHASE_SETUP] = total > measured ? total - measured : 0;
+}
+
+static int epd_profile_cmp(const void *a, const void *b) {
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+// 最近秩法求百分位, values需已排序
+static uint32_t epd_profile_percentile(const uint32_t *values, uint32_t count,
+                                       uint32_t percent) {
+    uint32_t rank = (count * percent + 99) / 100;
+    return values[rank ? rank - 1 : 0];
+}
+
+esp_err_t epd_profile_run(epd_device_t *dev, const uint8_t *buffer,
+                          epd_update_mode_t mode, uint32_t iterations,
+                          epd_profile_report_t *report) {
+    if (!dev || !dev->display_buffer || !buffer || !report ||
+        iterations == 0 || iterations > EPD_PROFILE_MAX_ITERATIONS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 排队中的异步刷新会混入计时, 先等待其完成
+    if (dev->async) {
+        esp_err_t err = epd_async_flush(dev, EPD_WAIT_FOREVER);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    
+    memset(report, 0, sizeof(*report));
+    report->mode = mode;
+    
+    esp_err_t err = ESP_OK;
+    epd_profile_sample_t sample;
+    
+    for (uint32_t i = 0; i < iterations; i++) {
+        err = epd_profile_begin(dev, &sample);
+        if (err != ESP_OK) {
+            break;
+        }
+    
+        err = dev->display_buffer(dev, buffer, mode);
+        epd_profile_end(dev);
+    
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "第%u次刷新失败: %d", (unsigned)i, err);
+            break;
+        }
+    
+        for (int p = 0; p < EPD_PHASE_MAX; p++) {
+            report->samples_us[p][i] = sample.phase_us[p];
+        }
+        report->ram_bytes = sample.ram_bytes;
+        report->iterations++;
+    }
+    
+    uint32_t n = report->iterations;
+    for (int p = 0; p < EPD_PHASE_MAX && n > 0; p++) {
+        uint32_t *v = report->samples_us[p];
+        qsort(v, n, sizeof(uint32_t), epd_profile_cmp);
+    
+        report->phase[p].min_us = v[0];
+        report->phase[p].median_us = epd_profile_percentile(v, n, 50);
+        report->phase[p].p95_us = epd_profile_percentile(v, n, 95);
+        report->phase[p].max_us = v[n - 1];
+    }
+    
+    uint32_t ram_us = report->phase[EPD_PHASE_RAM_WRITE].median_us;
+    report->spi_bytes_per_sec = ram_us ?
+        (uint32_t)((uint64_t)report->ram_bytes * 1000000 / ram_us) : 0;
+    
+    return err;
+}
+
+void epd_profile_log(const epd_profile_report_t *report) {
+    if (!report) {
+        return;
+    }
+    
+    ESP_LOGI(TAG, "刷新模式 %d, %u次迭代, 每次写入 %u 字节",
+             report->mode, (unsigned)report->iterations, (unsigned)report->ram_bytes);
+    
+    for (int p = 0; p < EPD_PHASE_MAX; p++) {
+        const epd_profile_stat_t *st = &report->phase[p];
+        ESP_LOGI(TAG, "  %-8s 最小 %7u us  中位 %7u us  P95 %7u us  最大 %7u us",
+                 epd_phase_name(p), (unsigned)st->min_us, (unsigned)st->median_us,
+                 (unsigned)st->p95_us, (unsigned)st->max_us);
+    }
+    
+    ESP_LOGI(TAG, "  有效SPI吞吐量: %u 字节/秒", (unsigned)report->spi_bytes_per_sec);
+}
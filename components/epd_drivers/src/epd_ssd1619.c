@@ -5,17 +5,31 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
 
 #include "epd_common.h"
 #include "epd_ssd1619.h"
+#include "epd_policy.h"
+#include "epd_internal.h"
 
 #define TAG "EPD_SSD1619"
 
+// SPI配置 (未在sdkconfig中定义时使用默认值)
+#ifndef CONFIG_EPD_SPI_HOST
+#define CONFIG_EPD_SPI_HOST     SPI2_HOST
+#endif
+#ifndef CONFIG_EPD_SPI_SPEED
+#define CONFIG_EPD_SPI_SPEED    4000000
+#endif
+
 // SSD1619命令定义
 #define SSD1619_CMD_DRIVER_OUTPUT_CONTROL        0x01
 #define SSD1619_CMD_GATE_VOLTAGE                 0x03
@@ -26,7 +40,9 @@
 #define SSD1619_CMD_DEEP_SLEEP                   0x10
 #define SSD1619_CMD_DATA_ENTRY_MODE              0x11
 #define SSD1619_CMD_SW_RESET                     0x12
-#define SSD1619_CMD_TEMP_SENSOR                  0x1A
+#define SSD1619_CMD_TEMP_SENSOR_SELECT           0x18
+#define SSD1619_CMD_TEMP_WRITE                   0x1A
+#define SSD1619_CMD_TEMP_READ                    0x1B
 #define SSD1619_CMD_MASTER_ACTIVATION            0x20
 #define SSD1619_CMD_DISP_UPDATE_CTRL1            0x21
 #define SSD1619_CMD_DISP_UPDATE_CTRL2            0x22
@@ -36,20 +52,170 @@
 #define SSD1619_CMD_VCOM_SENSE                   0x28
 #define SSD1619_CMD_VCOM_DURATION                0x29
 #define SSD1619_CMD_VCOM_SETTING                 0x2C
+#define SSD1619_CMD_WRITE_LUT                    0x32
 #define SSD1619_CMD_BORDER_WAVEFORM              0x3C
 #define SSD1619_CMD_RAM_X_START_END              0x44
 #define SSD1619_CMD_RAM_Y_START_END              0x45
 #define SSD1619_CMD_RAM_X_COUNTER                0x4E
 #define SSD1619_CMD_RAM_Y_COUNTER                0x4F
 
+// 0x22更新控制
+#define SSD1619_CTRL_LOAD_TEMP                   0xA1    // 测量温度, 不刷新
+#define SSD1619_CTRL_LOAD_LUT                    0x91    // 按温度寄存器从OTP装载LUT, 不刷新
+#define SSD1619_CTRL_CUSTOM_LUT                  0xC7    // 使用已写入的LUT刷新
+
+// 波形LUT (30字节): 前20字节为各相位的电压选择, 每字节含"旧→新"四种转换
+// (00/01/10/11, 各2位, 00 GND, 01 VSH, 10 VSL), 后10字节为相位时长(帧),
+// 每字节两个相位, 低4位在前
+#define SSD1619_LUT_SIZE                         30
+
+// 灰度脉冲长度(帧), 越大灰阶越深
+#ifndef SSD1619_GRAY_PULSE_FRAMES
+#define SSD1619_GRAY_PULSE_FRAMES                4
+#endif
+
+// 灰度脉冲LUT: 新数据为0的像素在相位0接收一个短黑脉冲, 其余像素保持不动
+static const uint8_t s_lut_gray_pulse[SSD1619_LUT_SIZE] = {
+    0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    SSD1619_GRAY_PULSE_FRAMES, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// 默认温度区间: 均使用OTP波形, 低温下波形更长, 放宽BUSY超时
+static const epd_temp_band_t s_default_temp_bands[] = {
+    { .min_c = -40, .lut_temp_c = 0,  .busy_timeout_ms = 2 * EPD_BUSY_TIMEOUT_MS },
+    { .min_c = 5,   .lut_temp_c = 10 },
+    { .min_c = 15,  .lut_temp_c = 25 },
+    { .min_c = 30,  .lut_temp_c = 40 },
+};
+
+// 4级灰度的各次激活: 灰度不低于阈值的像素写为白。第一次使用OTP全刷波形得到
+// 只有纯黑的底图, 之后的脉冲作用于阈值以下的像素: 灰度1接收两个脉冲, 灰度2接收一个
+static const struct {
+    uint8_t threshold;
+    bool pulse;
+} s_gray_passes[] = {
+    { 1, false },
+    { 3, true },
+    { 2, true },
+};
+#define SSD1619_GRAY_PASSES  (sizeof(s_gray_passes) / sizeof(s_gray_passes[0]))
+
+// 硬件复位脉冲宽度, 复位后以BUSY变低判断就绪
+#ifndef SSD1619_RESET_PULSE_MS
+#define SSD1619_RESET_PULSE_MS                   10
+#endif
+
+// 跨MCU深度睡眠保留的控制器配置: 放在RTC内存中, 冷启动后内容随机, 以magic和校验和判定有效
+#ifndef SSD1619_RETAIN_SLOTS
+#define SSD1619_RETAIN_SLOTS                     2       // 可保留配置的面板数量, 以CS引脚区分
+#endif
+#define SSD1619_RETAIN_MAGIC                     0x53313631u
+
+typedef struct {
+    uint32_t magic;
+    uint16_t native_width;
+    uint16_t native_height;
+    int8_t spi_cs;
+    uint8_t color_mode;
+    uint8_t rotation;
+    int8_t temp_override;
+    bool red_ram_clear;
+    uint32_t checksum;         // 之前各字段的FNV-1a
+} ssd1619_retained_t;
+
+static RTC_NOINIT_ATTR ssd1619_retained_t s_retained[SSD1619_RETAIN_SLOTS];
+
 // 私有数据结构
 typedef struct {
-    uint8_t lut_full[30];      // 全刷LUT
-    uint8_t lut_partial[30];   // 局刷LUT
-    uint8_t rotation;          // 旋转角度
+    const uint8_t *lut;        // 当前写入的自定义LUT, NULL表示使用OTP波形
+    epd_display_mode_t display_mode;
+    epd_refresh_cost_t cost[EPD_DISPLAY_MODE_MAX];
+    uint64_t cost_total_us[EPD_DISPLAY_MODE_MAX];
+    epd_temp_band_t bands[EPD_TEMP_MAX_BANDS];  // 温度区间表
+    uint8_t band_count;
+    int8_t band;               // 当前已装载波形的区间, -1表示未装载
+    epd_temp_band_stats_t band_stats[EPD_TEMP_MAX_BANDS];
+    uint64_t band_total_us[EPD_TEMP_MAX_BANDS];
+    int8_t temp_c;             // 最近一次温度读数
+    int8_t temp_override;      // 外部提供的温度, EPD_TEMP_AUTO表示测量
+    bool temp_valid;
+    int64_t temp_read_us;      // 读数时间
+    uint8_t rotation;          // 旋转角度 (0-3, 顺时针90度为单位)
+    uint16_t native_width;     // 控制器RAM方向的宽度(像素), 不随旋转变化
+    uint16_t native_height;    // 控制器RAM方向的高度(像素)
+    uint8_t *rot_bw;           // 90/270度: 原生方向黑白缓冲区, 同时作为RAM内容的镜像
+    bool rot_bw_valid;         // rot_bw与黑白RAM一致; 不经镜像的写入会使其失效
+    uint8_t *rot_red;          // 90/270度: 原生方向红色缓冲区 (仅三色屏)
+    uint8_t *band_buf;         // 条带渲染缓冲区 (三色屏时后半为红色条带)
+    uint32_t band_buf_size;
     bool initialized;          // 初始化标志
+    bool update_pending;       // begin_update已触发刷新, 等待finish_update
+    int64_t update_start_us;   // 分段刷新: 整个调用的起始时间
+    int64_t activate_us;       // 分段刷新: 主激活时间
+    epd_update_mode_t refresh_mode;  // 正在进行的刷新的实际模式 (跟踪事件)
+    uint32_t refresh_area;
+    uint64_t update_start_bytes;
+    uint32_t update_area;      // 下一次刷新覆盖的像素数 (刷新策略记账), 0表示整屏
+    bool red_ram_clear;        // 红色RAM已知为全0, 无需重复清空
 } ssd1619_priv_t;
 
+// 驱动内部函数, 通过epd_device_t函数表对外提供
+static esp_err_t ssd1619_init(epd_device_t *dev);
+static esp_err_t ssd1619_deinit(epd_device_t *dev);
+static esp_err_t ssd1619_reset(epd_device_t *dev);
+static esp_err_t ssd1619_clear(epd_device_t *dev, epd_color_t color);
+static esp_err_t ssd1619_display_buffer(epd_device_t *dev, const uint8_t *buffer,
+                                        epd_update_mode_t mode);
+static esp_err_t ssd1619_display_planes(epd_device_t *dev, const uint8_t *bw,
+                                        const uint8_t *red, epd_update_mode_t mode);
+static esp_err_t ssd1619_display_bands(epd_device_t *dev, uint16_t band_height,
+                                        epd_band_draw_t draw, void *ctx,
+                                        epd_update_mode_t mode, epd_band_stats_t *stats);
+static esp_err_t ssd1619_begin_update(epd_device_t *dev, const uint8_t *buffer,
+                                       epd_update_mode_t mode);
+static esp_err_t ssd1619_finish_update(epd_device_t *dev, uint32_t timeout_ms);
+static esp_err_t ssd1619_refresh(epd_device_t *dev, epd_update_mode_t mode);
+static esp_err_t ssd1619_display_stream(epd_device_t *dev,
+                                        epd_transport_source_t bw, void *bw_ctx,
+                                        epd_transport_source_t red, void *red_ctx,
+                                        epd_update_mode_t mode);
+static esp_err_t ssd1619_display_partial(epd_device_t *dev, const uint8_t *buffer,
+                                         uint16_t x, uint16_t y,
+                                         uint16_t width, uint16_t height);
+static esp_err_t ssd1619_display_window(epd_device_t *dev, const uint8_t *framebuffer,
+                                        uint16_t x, uint16_t y,
+                                        uint16_t width, uint16_t height,
+                                        epd_update_mode_t mode);
+static esp_err_t ssd1619_display_windows(epd_device_t *dev, const uint8_t *framebuffer,
+                                         const epd_rect_t *rects, uint8_t count,
+                                         epd_update_mode_t mode);
+static esp_err_t ssd1619_sleep(epd_device_t *dev);
+static esp_err_t ssd1619_wakeup(epd_device_t *dev);
+static esp_err_t ssd1619_resume(epd_device_t *dev);
+static esp_err_t ssd1619_power_on(epd_device_t *dev);
+static esp_err_t ssd1619_power_off(epd_device_t *dev);
+static esp_err_t ssd1619_set_rotation(epd_device_t *dev, uint8_t rotation);
+static esp_err_t ssd1619_invert(epd_device_t *dev, bool invert);
+static esp_err_t ssd1619_get_info(epd_device_t *dev, epd_info_t *info);
+static esp_err_t ssd1619_set_display_mode(epd_device_t *dev, epd_display_mode_t mode);
+static esp_err_t ssd1619_get_refresh_cost(epd_device_t *dev, epd_display_mode_t mode,
+                                          epd_refresh_cost_t *cost);
+static esp_err_t ssd1619_read_temperature(epd_device_t *dev, int8_t *temp_c);
+static esp_err_t ssd1619_set_temperature(epd_device_t *dev, int8_t temp_c);
+static esp_err_t ssd1619_set_temp_bands(epd_device_t *dev, const epd_temp_band_t *bands,
+                                        uint8_t count);
+static esp_err_t ssd1619_get_temp_band_stats(epd_device_t *dev, uint8_t band,
+                                             epd_temp_band_stats_t *stats);
+static esp_err_t ssd1619_send_init_sequence(epd_device_t *dev);
+static void ssd1619_update_temp_cap(epd_device_t *dev);
+static void ssd1619_config_list(epd_device_t *dev, epd_cmd_list_t *list);
+static void ssd1619_retain_clear(epd_device_t *dev);
+static esp_err_t ssd1619_display_gray(epd_device_t *dev, const uint8_t *gray);
+static void ssd1619_set_memory_area(epd_cmd_list_t *list, uint16_t x_start, uint16_t y_start,
+                                    uint16_t x_end, uint16_t y_end);
+static void ssd1619_set_memory_pointer(epd_cmd_list_t *list, uint16_t x, uint16_t y);
+
 // 创建SSD1619设备实例
 epd_device_t* epd_ssd1619_create(const epd_pins_t *pins, 
                                  uint16_t width, 
@@ -74,14 +240,25 @@ epd_device_t* epd_ssd1619_create(const epd_pins_t *pins,
     dev->info.width = width;
     dev->info.height = height;
     dev->info.color_mode = color_mode;
-    dev->info.capabilities = EPD_CAP_PARTIAL_REFRESH | EPD_CAP_POWER_CONTROL;
+    dev->info.capabilities = EPD_CAP_PARTIAL_REFRESH | EPD_CAP_POWER_CONTROL |
+                             EPD_CAP_ROTATION;
+    // 灰度脉冲波形只适用于黑白屏, 三色屏的波形还要驱动红色粒子
+    if (color_mode == EPD_MODE_1C) {
+        dev->info.capabilities |= EPD_CAP_GRAYSCALE;
+    }
     dev->info.version = 0x0100;
     
+    priv->native_width = width;
+    priv->native_height = height;
+    priv->temp_override = EPD_TEMP_AUTO;
+    
     // 保存引脚配置
     memcpy(&dev->pins, pins, sizeof(epd_pins_t));
     
     // 设置私有数据
     dev->priv = priv;
+    ssd1619_update_temp_cap(dev);
+    ssd1619_set_temp_bands(dev, NULL, 0);
     
     // 设置函数指针
     dev->init = ssd1619_init;
@@ -90,28 +267,36 @@ epd_device_t* epd_ssd1619_create(const epd_pins_t *pins,
     dev->clear = ssd1619_clear;
     dev->display_buffer = ssd1619_display_buffer;
     dev->display_partial = ssd1619_display_partial;
+    dev->display_window = ssd1619_display_window;
+    dev->display_windows = ssd1619_display_windows;
+    dev->display_planes = ssd1619_display_planes;
+    dev->display_stream = ssd1619_display_stream;
+    dev->display_bands = ssd1619_display_bands;
+    dev->begin_update = ssd1619_begin_update;
+    dev->finish_update = ssd1619_finish_update;
+    dev->refresh = ssd1619_refresh;
+    dev->display_buffer_async = epd_async_display_buffer;
+    dev->display_partial_async = epd_async_display_partial;
     dev->sleep = ssd1619_sleep;
     dev->wakeup = ssd1619_wakeup;
+    dev->resume = ssd1619_resume;
     dev->power_on = ssd1619_power_on;
     dev->power_off = ssd1619_power_off;
     dev->set_rotation = ssd1619_set_rotation;
     dev->invert = ssd1619_invert;
     dev->get_info = ssd1619_get_info;
+    dev->set_display_mode = ssd1619_set_display_mode;
+    dev->get_refresh_cost = ssd1619_get_refresh_cost;
+    dev->read_temperature = ssd1619_read_temperature;
+    dev->set_temperature = ssd1619_set_temperature;
+    dev->set_temp_bands = ssd1619_set_temp_bands;
+    dev->get_temp_band_stats = ssd1619_get_temp_band_stats;
     
     return dev;
 }
 
-// 初始化函数
-static esp_err_t ssd1619_init(epd_device_t *dev) {
-    if (!dev || !dev->priv) {
-        return ESP_ERR_INVALID_ARG;
-    }
-    
-    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
-    
-    ESP_LOGI(TAG, "初始化SSD1619，分辨率: %dx%d", 
-             dev->info.width, dev->info.height);
-    
+// 初始化MCU侧资源: SPI、帧缓冲池、刷新策略、GPIO和BUSY中断, 已存在的资源保留
+static esp_err_t ssd1619_init_host(epd_device_t *dev) {
     // 初始化SPI
     esp_err_t err = epd_spi_init(dev, CONFIG_EPD_SPI_HOST, CONFIG_EPD_SPI_SPEED);
     if (err != ESP_OK) {
@@ -119,6 +304,24 @@ static esp_err_t ssd1619_init(epd_device_t *dev) {
         return err;
     }
     
+    // 帧缓冲池, 刷新路径只借用不再分配; 只用条带渲染的大尺寸面板可以不创建
+    if (EPD_POOL_BUFFERS > 0) {
+        err = epd_pool_init(dev, EPD_POOL_BUFFERS);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "分配帧缓冲池失败: %d", err);
+            return err;
+        }
+    }
+    
+    // 刷新策略: 局刷累积到残影预算后自动插入全刷; 重复初始化时保留已有配置和预算
+    if (EPD_POLICY_ENABLE && !dev->policy) {
+        err = epd_policy_attach(dev, NULL);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "创建刷新策略失败: %d", err);
+            return err;
+        }
+    }
+    
     // 初始化GPIO
     gpio_set_direction(dev->pins.dc_pin, GPIO_MODE_OUTPUT);
     gpio_set_direction(dev->pins.rst_pin, GPIO_MODE_OUTPUT);
@@ -129,11 +332,54 @@ static esp_err_t ssd1619_init(epd_device_t *dev) {
         gpio_set_level(dev->pins.pwr_en_pin, 1);
     }
     
+    // BUSY中断, 失败时退化为轮询等待
+    if (epd_busy_init(dev) != ESP_OK) {
+        ESP_LOGW(TAG, "BUSY中断不可用, 使用轮询等待");
+    }
+    
+    return ESP_OK;
+}
+
+// 初始化函数
+static esp_err_t ssd1619_init(epd_device_t *dev) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    ESP_LOGI(TAG, "初始化SSD1619，分辨率: %dx%d", 
+             dev->info.width, dev->info.height);
+    
+    esp_err_t err = ssd1619_init_host(dev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
     // 硬件复位
     dev->reset(dev);
+    ssd1619_retain_clear(dev);
+    
+    // 软复位后RAM内容未知, 需要重新测量温度并装载波形
+    priv->red_ram_clear = false;
+    priv->rot_bw_valid = false;
+    priv->lut = NULL;
+    priv->band = -1;
+    priv->temp_valid = false;
     
     // 发送初始化序列
-    ssd1619_send_init_sequence(dev);
+    err = ssd1619_send_init_sequence(dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "初始化序列失败: %d", err);
+        return err;
+    }
+    
+    // 异步刷新工作任务, 负责SPI传输和BUSY等待
+    err = epd_async_start(dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动异步刷新任务失败: %d", err);
+        return err;
+    }
     
     priv->initialized = true;
     ESP_LOGI(TAG, "SSD1619初始化完成");
@@ -142,309 +388,1622 @@ static esp_err_t ssd1619_init(epd_device_t *dev) {
 }
 
 // 发送初始化序列
-static void ssd1619_send_init_sequence(epd_device_t *dev) {
+static esp_err_t ssd1619_send_init_sequence(epd_device_t *dev) {
     // 软复位
     epd_send_command(dev, SSD1619_CMD_SW_RESET);
     epd_delay_ms(10);
     
     // 等待就绪
-    while (epd_is_busy(dev)) {
-        vTaskDelay(1);
+    esp_err_t err = epd_wait_busy(dev, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    epd_cmd_list_t list;
+    epd_cmd_list_init(&list);
+    ssd1619_config_list(dev, &list);
+    
+    // 设置显示更新控制
+    epd_cmd_list_cmd(&list, SSD1619_CMD_DISP_UPDATE_CTRL2);
+    epd_cmd_list_data(&list, 0xC0);
+    
+    // 主激活
+    epd_cmd_list_cmd(&list, SSD1619_CMD_MASTER_ACTIVATION);
+    
+    err = epd_cmd_list_send(dev, &list);
+    if (err != ESP_OK) {
+        return err;
     }
     
+    // 等待就绪
+    return epd_wait_busy(dev, 0);
+}
+
+// 控制器配置命令 (复位后寄存器恢复为默认值, 初始化和唤醒时发送)
+static void ssd1619_config_list(epd_device_t *dev, epd_cmd_list_t *list) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
     // 设置驱动输出控制
-    epd_send_command(dev, SSD1619_CMD_DRIVER_OUTPUT_CONTROL);
-    epd_send_data(dev, (dev->info.height - 1) & 0xFF);
-    epd_send_data(dev, ((dev->info.height - 1) >> 8) & 0xFF);
-    epd_send_data(dev, 0x00);  // GD = 0, SM = 0, TB = 0
+    epd_cmd_list_cmd(list, SSD1619_CMD_DRIVER_OUTPUT_CONTROL);
+    epd_cmd_list_data_u16(list, priv->native_height - 1);
+    epd_cmd_list_data(list, 0x00);  // GD = 0, SM = 0, TB = 0
     
     // 设置数据入口模式
-    epd_send_command(dev, SSD1619_CMD_DATA_ENTRY_MODE);
-    epd_send_data(dev, 0x03);  // X增量, Y增量
+    epd_cmd_list_cmd(list, SSD1619_CMD_DATA_ENTRY_MODE);
+    epd_cmd_list_data(list, 0x03);  // X增量, Y增量
     
     // 设置RAM地址
-    ssd1619_set_memory_area(dev, 0, 0, dev->info.width - 1, dev->info.height - 1);
-    ssd1619_set_memory_pointer(dev, 0, 0);
+    ssd1619_set_memory_area(list, 0, 0, priv->native_width - 1, priv->native_height - 1);
+    ssd1619_set_memory_pointer(list, 0, 0);
     
     // 设置边框波形
-    epd_send_command(dev, SSD1619_CMD_BORDER_WAVEFORM);
-    epd_send_data(dev, 0x05);
-    
-    // 设置温度传感器
-    epd_send_command(dev, SSD1619_CMD_TEMP_SENSOR);
-    epd_send_data(dev, 0x80);  // 内部温度传感器
-    
-    // 设置显示更新控制
-    epd_send_command(dev, SSD1619_CMD_DISP_UPDATE_CTRL2);
-    epd_send_data(dev, 0xC0);
+    epd_cmd_list_cmd(list, SSD1619_CMD_BORDER_WAVEFORM);
+    epd_cmd_list_data(list, 0x05);
     
-    // 主激活
-    epd_send_command(dev, SSD1619_CMD_MASTER_ACTIVATION);
-    
-    // 等待就绪
-    while (epd_is_busy(dev)) {
-        vTaskDelay(1);
-    }
+    // 选择内部温度传感器
+    epd_cmd_list_cmd(list, SSD1619_CMD_TEMP_SENSOR_SELECT);
+    epd_cmd_list_data(list, 0x80);
 }
 
 // 设置内存区域
-static void ssd1619_set_memory_area(epd_device_t *dev, 
+static void ssd1619_set_memory_area(epd_cmd_list_t *list, 
                                     uint16_t x_start, uint16_t y_start,
                                     uint16_t x_end, uint16_t y_end) {
     // 设置X范围
-    epd_send_command(dev, SSD1619_CMD_RAM_X_START_END);
-    epd_send_data(dev, (x_start >> 3) & 0xFF);
-    epd_send_data(dev, (x_end >> 3) & 0xFF);
+    epd_cmd_list_cmd(list, SSD1619_CMD_RAM_X_START_END);
+    epd_cmd_list_data(list, (x_start >> 3) & 0xFF);
+    epd_cmd_list_data(list, (x_end >> 3) & 0xFF);
     
     // 设置Y范围
-    epd_send_command(dev, SSD1619_CMD_RAM_Y_START_END);
-    epd_send_data(dev, y_start & 0xFF);
-    epd_send_data(dev, (y_start >> 8) & 0xFF);
-    epd_send_data(dev, y_end & 0xFF);
-    epd_send_data(dev, (y_end >> 8) & 0xFF);
+    epd_cmd_list_cmd(list, SSD1619_CMD_RAM_Y_START_END);
+    epd_cmd_list_data_u16(list, y_start);
+    epd_cmd_list_data_u16(list, y_end);
 }
 
 // 设置内存指针
-static void ssd1619_set_memory_pointer(epd_device_t *dev, 
+static void ssd1619_set_memory_pointer(epd_cmd_list_t *list, 
                                        uint16_t x, uint16_t y) {
     // 设置X指针
-    epd_send_command(dev, SSD1619_CMD_RAM_X_COUNTER);
-    epd_send_data(dev, (x >> 3) & 0xFF);
+    epd_cmd_list_cmd(list, SSD1619_CMD_RAM_X_COUNTER);
+    epd_cmd_list_data(list, (x >> 3) & 0xFF);
     
     // 设置Y指针
-    epd_send_command(dev, SSD1619_CMD_RAM_Y_COUNTER);
-    epd_send_data(dev, y & 0xFF);
-    epd_send_data(dev, (y >> 8) & 0xFF);
+    epd_cmd_list_cmd(list, SSD1619_CMD_RAM_Y_COUNTER);
+    epd_cmd_list_data_u16(list, y);
 }
 
-// 清屏
-static esp_err_t ssd1619_clear(epd_device_t *dev, epd_color_t color) {
-    if (!dev || !dev->priv) {
-        return ESP_ERR_INVALID_ARG;
+// 设置RAM窗口并开始写入: (x, y, w, h)为原生坐标, x和w按8像素对齐
+// reverse为true时使用X、Y递减的数据入口模式, 从窗口右下角开始写入 (180度旋转)
+// 整个窗口设置编码为一个命令列表, 写RAM命令紧随其后
+static esp_err_t ssd1619_begin_ram_write(epd_device_t *dev, uint8_t cmd,
+                                         uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                         bool reverse) {
+    uint16_t x_end = x + w - 1;
+    uint16_t y_end = y + h - 1;
+    epd_cmd_list_t list;
+    
+    // 任何黑白RAM写入都先使镜像失效, 经镜像写入的路径在成功后再标记为一致
+    if (cmd == SSD1619_CMD_WRITE_RAM_BW) {
+        ((ssd1619_priv_t *)dev->priv)->rot_bw_valid = false;
     }
     
-    ESP_LOGI(TAG, "清屏，颜色: %d", color);
-    
-    uint8_t fill_value = (color == EPD_COLOR_WHITE) ? 0xFF : 0x00;
-    uint32_t buffer_size = dev->info.width * dev->info.height / 8;
-    uint8_t *buffer = malloc(buffer_size);
+    epd_cmd_list_init(&list);
+    epd_cmd_list_cmd(&list, SSD1619_CMD_DATA_ENTRY_MODE);
+    epd_cmd_list_data(&list, reverse ? 0x00 : 0x03);
     
-    if (!buffer) {
-        return ESP_ERR_NO_MEM;
+    if (reverse) {
+        ssd1619_set_memory_area(&list, x_end, y_end, x, y);
+        ssd1619_set_memory_pointer(&list, x_end, y_end);
+    } else {
+        ssd1619_set_memory_area(&list, x, y, x_end, y_end);
+        ssd1619_set_memory_pointer(&list, x, y);
     }
     
-    memset(buffer, fill_value, buffer_size);
+    epd_cmd_list_cmd(&list, cmd);
     
-    esp_err_t err = dev->display_buffer(dev, buffer, EPD_UPDATE_FULL);
+    return epd_cmd_list_send(dev, &list);
+}
+
+// 跨步窗口数据源: 从较宽的源缓冲区中按行收集窗口字节,
+// reverse时逐字节位反转, 配合递减入口模式实现180度旋转
+typedef struct {
+    const uint8_t *base;        // 窗口首行首字节
+    uint16_t stride;            // 源缓冲区每行字节数
+    uint16_t row_bytes;         // 窗口每行字节数
+    bool reverse;
+} ssd1619_window_src_t;
+
+static void ssd1619_window_source(void *ctx, uint8_t *dst, uint32_t offset, uint32_t length) {
+    const ssd1619_window_src_t *win = (const ssd1619_window_src_t *)ctx;
+    uint32_t row = offset / win->row_bytes;
+    uint32_t col = offset % win->row_bytes;
+    
+    while (length) {
+        uint32_t n = win->row_bytes - col;
+        if (n > length) {
+            n = length;
+        }
     
-    free(buffer);
-    return err;
+        const uint8_t *src = win->base + row * win->stride + col;
+        if (win->reverse) {
+            for (uint32_t i = 0; i < n; i++) {
+                dst[i] = epd_bit_reverse_lut[src[i]];
+            }
+        } else {
+            memcpy(dst, src, n);
+        }
+    
+        dst += n;
+        length -= n;
+        row++;
+        col = 0;
+    }
 }
 
-// 显示缓冲区
-static esp_err_t ssd1619_display_buffer(epd_device_t *dev, 
-                                        const uint8_t *buffer,
-                                        epd_update_mode_t mode) {
-    if (!dev || !buffer) {
-        return ESP_ERR_INVALID_ARG;
+// 发送窗口数据: 所有行合并为一次流式传输, 行连续且无需变换时直接DMA发送
+static esp_err_t ssd1619_send_window(epd_device_t *dev, const uint8_t *base,
+                                     uint16_t stride, uint16_t row_bytes, uint16_t rows,
+                                     bool reverse) {
+    uint32_t size = (uint32_t)row_bytes * rows;
+    
+    if (!reverse && row_bytes == stride) {
+        return epd_transport_send(dev, base, size);
     }
     
-    // 设置内存区域
-    ssd1619_set_memory_area(dev, 0, 0, dev->info.width - 1, dev->info.height - 1);
-    ssd1619_set_memory_pointer(dev, 0, 0);
-    
-    // 发送黑白数据
-    epd_send_command(dev, SSD1619_CMD_WRITE_RAM_BW);
-    epd_send_data_buffer(dev, buffer, dev->info.width * dev->info.height / 8);
+    ssd1619_window_src_t win = {
+        .base = base,
+        .stride = stride,
+        .row_bytes = row_bytes,
+        .reverse = reverse,
+    };
+    return epd_transport_send_from(dev, size, ssd1619_window_source, &win);
+}
+
+// 按当前旋转角度发送一个整屏平面, native为90/270度时使用的原生方向缓冲区
+static esp_err_t ssd1619_send_plane(epd_device_t *dev, const uint8_t *plane,
+                                    uint8_t *native, uint32_t size) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
     
-    // 如果是三色屏，发送红色数据
-    if (dev->info.color_mode == EPD_MODE_3C) {
-        // 对于三色屏，需要分别发送黑白和红色数据
-        // 这里简化处理，将红色数据置零
-        uint32_t buffer_size = dev->info.width * dev->info.height / 8;
-        uint8_t *red_buffer = calloc(1, buffer_size);
-        if (red_buffer) {
-            epd_send_command(dev, SSD1619_CMD_WRITE_RAM_RED);
-            epd_send_data_buffer(dev, red_buffer, buffer_size);
-            free(red_buffer);
+    switch (priv->rotation) {
+        case 2: {
+            uint16_t stride = priv->native_width / 8;
+            return ssd1619_send_window(dev, plane, stride, stride, priv->native_height, true);
+        }
+        case 1:
+        case 3: {
+            esp_err_t err = epd_rotate_buffer(plane, dev->info.width, dev->info.height,
+                                              native, priv->rotation);
+            if (err != ESP_OK) {
+                return err;
+            }
+            return epd_transport_send(dev, native, size);
         }
+        default:
+            return epd_transport_send(dev, plane, size);
     }
+}
+
+// 按更新控制字激活, 不等待BUSY
+static esp_err_t ssd1619_trigger(epd_device_t *dev, uint8_t ctrl) {
+    epd_cmd_list_t list;
+    epd_cmd_list_init(&list);
+    epd_cmd_list_add(&list, SSD1619_CMD_DISP_UPDATE_CTRL2, &ctrl, 1);
+    epd_cmd_list_cmd(&list, SSD1619_CMD_MASTER_ACTIVATION);
+    
+    return epd_cmd_list_send(dev, &list);
+}
+
+// 等待激活完成, timeout_ms为0时使用当前温度区间的超时 (低温区间的波形更长)
+static esp_err_t ssd1619_wait_activation(epd_device_t *dev, uint32_t timeout_ms) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
     
-    // 触发更新
-    epd_send_command(dev, SSD1619_CMD_DISP_UPDATE_CTRL2);
-    
-    switch (mode) {
-        case EPD_UPDATE_FULL:
-            epd_send_data(dev, 0xC7);  // 全刷
-            break;
-        case EPD_UPDATE_PARTIAL:
-            epd_send_data(dev, 0x04);  // 局刷
-            break;
-        case EPD_UPDATE_FAST:
-            epd_send_data(dev, 0x0C);  // 快速刷新
-            break;
+    if (timeout_ms == 0 && priv->band >= 0) {
+        timeout_ms = priv->bands[priv->band].busy_timeout_ms;
+    }
+    return epd_wait_busy(dev, timeout_ms);
+}
+
+// 按更新控制字激活并等待完成
+static esp_err_t ssd1619_activate(epd_device_t *dev, uint8_t ctrl) {
+    esp_err_t err = ssd1619_trigger(dev, ctrl);
+    if (err != ESP_OK) {
+        return err;
     }
     
-    epd_send_command(dev, SSD1619_CMD_MASTER_ACTIVATION);
+    return ssd1619_wait_activation(dev, 0);
+}
+
+// 写入自定义LUT, 与当前LUT相同时跳过
+static esp_err_t ssd1619_load_lut(epd_device_t *dev, const uint8_t *lut) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
     
-    // 等待刷新完成
-    while (epd_is_busy(dev)) {
-        vTaskDelay(10);
+    if (priv->lut == lut) {
+        return ESP_OK;
     }
     
-    return ESP_OK;
+    epd_cmd_list_t list;
+    epd_cmd_list_init(&list);
+    epd_cmd_list_add(&list, SSD1619_CMD_WRITE_LUT, lut, SSD1619_LUT_SIZE);
+    
+    esp_err_t err = epd_cmd_list_send(dev, &list);
+    priv->lut = (err == ESP_OK) ? lut : NULL;
+    return err;
 }
 
-// 局部显示
-static esp_err_t ssd1619_display_partial(epd_device_t *dev, 
-                                         const uint8_t *buffer,
-                                         uint16_t x, uint16_t y,
-                                         uint16_t width, uint16_t height) {
-    if (!dev || !buffer) {
-        return ESP_ERR_INVALID_ARG;
+// 测量控制器温度: 12位补码, 单位1/16摄氏度, 高8位在第一个字节
+static esp_err_t ssd1619_sense_temperature(epd_device_t *dev, int8_t *temp_c) {
+    if (dev->pins.spi_miso < 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    esp_err_t err = ssd1619_activate(dev, SSD1619_CTRL_LOAD_TEMP);
+    if (err != ESP_OK) {
+        return err;
     }
     
-    // 计算字节边界
-    uint16_t x_start = x;
-    uint16_t x_end = x + width - 1;
-    uint16_t y_start = y;
-    uint16_t y_end = y + height - 1;
+    uint8_t raw[2];
+    epd_cmd_list_t list;
+    epd_cmd_list_init(&list);
+    epd_cmd_list_cmd(&list, SSD1619_CMD_TEMP_READ);
     
-    // 设置局部区域
-    ssd1619_set_memory_area(dev, x_start, y_start, x_end, y_end);
-    ssd1619_set_memory_pointer(dev, x_start, y_start);
+    err = epd_cmd_list_send(dev, &list);
+    if (err == ESP_OK) {
+        err = epd_transport_read(dev, raw, sizeof(raw));
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
     
-    // 发送数据
-    epd_send_command(dev, SSD1619_CMD_WRITE_RAM_BW);
+    // 整数部分即第一个字节, 小数部分舍去
+    *temp_c = (int8_t)raw[0];
+    return ESP_OK;
+}
+
+// 温度补偿能力: 能从控制器读回温度 (0x1B需要MISO), 或已提供外部温度时才声明;
+// 否则波形始终按EPD_TEMP_DEFAULT_C选择, 实际并未补偿
+static void ssd1619_update_temp_cap(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
     
-    // 只发送需要更新的部分
-    uint16_t bytes_per_line = width / 8;
-    if (width % 8) bytes_per_line++;
+    if (dev->pins.spi_miso >= 0 || priv->temp_override != EPD_TEMP_AUTO) {
+        dev->info.capabilities |= EPD_CAP_TEMP_COMPENSATION;
+    } else {
+        dev->info.capabilities &= ~EPD_CAP_TEMP_COMPENSATION;
+    }
+}
+
+// 当前使用的温度: 外部读数优先, 否则使用有效期内的测量值
+static int8_t ssd1619_current_temperature(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
     
-    for (uint16_t row = 0; row < height; row++) {
-        epd_send_data_buffer(dev, buffer + row * bytes_per_line, bytes_per_line);
+    if (priv->temp_override != EPD_TEMP_AUTO) {
+        return priv->temp_override;
     }
     
-    // 触发局部更新
-    epd_send_command(dev, SSD1619_CMD_DISP_UPDATE_CTRL2);
-    epd_send_data(dev, 0x04);  // 局刷模式
-    epd_send_command(dev, SSD1619_CMD_MASTER_ACTIVATION);
+    int64_t now = esp_timer_get_time();
+    if (priv->temp_valid &&
+        now - priv->temp_read_us < (int64_t)EPD_TEMP_READ_INTERVAL_MS * 1000) {
+        return priv->temp_c;
+    }
     
-    // 等待完成
-    while (epd_is_busy(dev)) {
-        vTaskDelay(10);
+    int8_t temp;
+    esp_err_t err = ssd1619_sense_temperature(dev, &temp);
+    if (err != ESP_OK) {
+        // 读数失败时沿用上次读数, 从未读到时使用默认温度, 同样在有效期内不再重试
+        if (!priv->temp_valid) {
+            ESP_LOGW(TAG, "无法读取温度 (%d), 假定为%d度", err, EPD_TEMP_DEFAULT_C);
+            priv->temp_c = EPD_TEMP_DEFAULT_C;
+        }
+        temp = priv->temp_c;
     }
     
-    return ESP_OK;
+    priv->temp_c = temp;
+    priv->temp_valid = true;
+    priv->temp_read_us = now;
+    return temp;
 }
 
-// 进入睡眠
-static esp_err_t ssd1619_sleep(epd_device_t *dev) {
-    if (!dev) {
-        return ESP_ERR_INVALID_ARG;
+// 按温度选择区间, 与当前已装载的波形不同时重新装载:
+// 区间定义了LUT时直接写入, 否则写入代表温度后由控制器从OTP装载
+static esp_err_t ssd1619_prepare_waveform(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    int8_t temp = ssd1619_current_temperature(dev);
+    int8_t prev = priv->band;
+    int8_t band = 0;
+    
+    while (band + 1 < priv->band_count && temp >= priv->bands[band + 1].min_c) {
+        band++;
     }
     
-    ESP_LOGI(TAG, "进入睡眠模式");
+    const epd_temp_band_t *b = &priv->bands[band];
+    
+    // 灰度等自定义LUT会替换区间波形, 此时即使区间未变也要重新装载
+    if (band == prev && priv->lut == b->lut) {
+        return ESP_OK;
+    }
     
-    epd_send_command(dev, SSD1619_CMD_DEEP_SLEEP);
-    epd_send_data(dev, 0x01);  // 进入深度睡眠
+    esp_err_t err;
+    if (b->lut) {
+        err = ssd1619_load_lut(dev, b->lut);
+    } else {
+        epd_cmd_list_t list;
+        epd_cmd_list_init(&list);
+        epd_cmd_list_cmd(&list, SSD1619_CMD_TEMP_WRITE);
+        epd_cmd_list_data(&list, (uint8_t)b->lut_temp_c);
+        epd_cmd_list_data(&list, 0x00);
+    
+        // 装载期间即使用该区间的BUSY超时
+        err = epd_cmd_list_send(dev, &list);
+        priv->band = band;
+        if (err == ESP_OK) {
+            err = ssd1619_activate(dev, SSD1619_CTRL_LOAD_LUT);
+        }
+        priv->lut = NULL;
+    }
     
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+    if (err != ESP_OK) {
+        priv->band = -1;
+        return err;
+    }
     
+    if (prev != band) {
+        ESP_LOGI(TAG, "温度%d度, 切换到区间%d (>=%d度)", temp, band, b->min_c);
+    }
+    priv->band = band;
+    priv->band_stats[band].lut_loads++;
     return ESP_OK;
 }
 
-// 唤醒
-static esp_err_t ssd1619_wakeup(epd_device_t *dev) {
-    if (!dev) {
-        return ESP_ERR_INVALID_ARG;
+// 装载波形并触发刷新, 不等待BUSY
+static esp_err_t ssd1619_start_update(epd_device_t *dev, epd_update_mode_t mode) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    uint8_t ctrl = 0xC7;  // 全刷
+    
+    // 灰度的多次激活不计入残影预算
+    if (priv->display_mode == EPD_DISPLAY_1BPP) {
+        mode = epd_policy_select(dev, mode, priv->update_area);
     }
+    priv->refresh_mode = mode;
+    priv->refresh_area = priv->update_area;
+    priv->update_area = 0;
     
-    // 硬件复位唤醒
-    dev->reset(dev);
+    switch (mode) {
+        case EPD_UPDATE_FULL:
+            ctrl = 0xC7;  // 全刷
+            break;
+        case EPD_UPDATE_PARTIAL:
+            ctrl = 0x04;  // 局刷
+            break;
+        case EPD_UPDATE_FAST:
+            ctrl = 0x0C;  // 快速刷新
+            break;
+    }
     
-    // 重新初始化
-    return dev->init(dev);
-}
-
-// 复位
-static esp_err_t ssd1619_reset(epd_device_t *dev) {
-    if (!dev) {
-        return ESP_ERR_INVALID_ARG;
+    esp_err_t err = ssd1619_prepare_waveform(dev);
+    if (err != ESP_OK) {
+        return err;
     }
     
-    ESP_LOGI(TAG, "硬件复位");
+    priv->activate_us = esp_timer_get_time();
+    return ssd1619_trigger(dev, ctrl);
+}
+
+// 等待刷新完成, 按温度区间统计刷新耗时
+static esp_err_t ssd1619_complete_update(epd_device_t *dev, uint32_t timeout_ms) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    esp_err_t err = ssd1619_wait_activation(dev, timeout_ms);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - priv->activate_us);
     
-    // 拉低复位引脚
-    gpio_set_level(dev->pins.rst_pin, 0);
-    epd_delay_ms(10);
+    epd_trace_record(dev, EPD_TRACE_REFRESH, priv->refresh_mode, priv->activate_us, us,
+                     priv->refresh_area, err == ESP_OK ? 0 : EPD_TRACE_FLAG_ERROR);
+    if (err != ESP_OK) {
+        return err;
+    }
     
-    // 拉高复位引脚
-    gpio_set_level(dev->pins.rst_pin, 1);
-    epd_delay_ms(10);
+    epd_temp_band_stats_t *stats = &priv->band_stats[priv->band];
     
-    // 等待就绪
-    epd_delay_ms(100);
+    stats->refreshes++;
+    stats->last_us = us;
+    if (us > stats->max_us) {
+        stats->max_us = us;
+    }
+    priv->band_total_us[priv->band] += us;
+    stats->avg_us = (uint32_t)(priv->band_total_us[priv->band] / stats->refreshes);
     
+    epd_policy_complete(dev, us);
     return ESP_OK;
 }
 
-// 电源控制
-static esp_err_t ssd1619_power_on(epd_device_t *dev) {
-    // SSD1619通过复位唤醒
-    return ssd1619_reset(dev);
+// 触发刷新并等待完成
+static esp_err_t ssd1619_update(epd_device_t *dev, epd_update_mode_t mode) {
+    esp_err_t err = ssd1619_start_update(dev, mode);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    return ssd1619_complete_update(dev, 0);
 }
 
-static esp_err_t ssd1619_power_off(epd_device_t *dev) {
-    return ssd1619_sleep(dev);
+// 清空红色RAM (已知为0时跳过), 直接由传输层发送0, 无需分配整屏的红色缓冲区
+static esp_err_t ssd1619_clear_red_ram(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (priv->red_ram_clear) {
+        return ESP_OK;
+    }
+    
+    esp_err_t err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_RED, 0, 0,
+                                            priv->native_width, priv->native_height, false);
+    if (err == ESP_OK) {
+        err = epd_transport_fill(dev, 0x00, priv->native_width * priv->native_height / 8);
+    }
+    priv->red_ram_clear = (err == ESP_OK);
+    return err;
 }
 
-// 设置旋转
-static esp_err_t ssd1619_set_rotation(epd_device_t *dev, uint8_t rotation) {
-    if (!dev || !dev->priv) {
-        return ESP_ERR_INVALID_ARG;
+// 写入整屏RAM: bw/red为NULL时保留对应RAM的现有内容,
+// clear_red为true时将红色RAM清零 (已知为0时跳过)
+static esp_err_t ssd1619_write_frame(epd_device_t *dev, const uint8_t *bw,
+                                     const uint8_t *red, bool clear_red) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    uint16_t nw = priv->native_width;
+    uint16_t nh = priv->native_height;
+    uint32_t plane_size = nw * nh / 8;
+    bool reverse = (priv->rotation == 2);
+    esp_err_t err = ESP_OK;
+    
+    // 发送黑白数据
+    if (bw) {
+        err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_BW, 0, 0, nw, nh, reverse);
+        if (err == ESP_OK) {
+            err = ssd1619_send_plane(dev, bw, priv->rot_bw, plane_size);
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+        // 90/270度时整屏数据经rot_bw转置后发送, 镜像与RAM一致
+        priv->rot_bw_valid = (priv->rotation & 1) != 0;
     }
     
-    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
-    priv->rotation = rotation % 4;
+    if (dev->info.color_mode != EPD_MODE_3C) {
+        return ESP_OK;
+    }
     
-    // 根据旋转角度调整宽高
-    if (rotation & 1) {
-        // 旋转90或270度，交换宽高
-        uint16_t temp = dev->info.width;
-        dev->info.width = dev->info.height;
-        dev->info.height = temp;
+    if (red) {
+        err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_RED, 0, 0, nw, nh, reverse);
+        if (err == ESP_OK) {
+            err = ssd1619_send_plane(dev, red, priv->rot_red, plane_size);
+        }
+        priv->red_ram_clear = false;
+    } else if (clear_red) {
+        err = ssd1619_clear_red_ram(dev);
     }
     
-    return ESP_OK;
-}
-
-// 反色显示
-static esp_err_t ssd1619_invert(epd_device_t *dev, bool invert) {
-    // SSD1619不支持硬件反色，需要在软件层处理
-    return ESP_OK;
+    return err;
 }
 
-// 获取设备信息
-static esp_err_t ssd1619_get_info(epd_device_t *dev, epd_info_t *info) {
-    if (!dev || !info) {
-        return ESP_ERR_INVALID_ARG;
+// 记录一次整屏刷新的耗时和RAM写入量
+static void ssd1619_record_cost(epd_device_t *dev, int64_t start_us, uint64_t start_bytes,
+                                uint8_t passes) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    epd_display_mode_t mode = priv->display_mode;
+    epd_refresh_cost_t *cost = &priv->cost[mode];
+    epd_transport_stats_t stats;
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    
+    if (epd_transport_get_stats(dev, &stats) == ESP_OK) {
+        cost->ram_bytes = (uint32_t)(stats.total_bytes - start_bytes);
+    }
+    
+    cost->passes = passes;
+    cost->refreshes++;
+    cost->last_us = us;
+    if (us > cost->max_us) {
+        cost->max_us = us;
+    }
+    priv->cost_total_us[mode] += us;
+    cost->avg_us = (uint32_t)(priv->cost_total_us[mode] / cost->refreshes);
+    
+    epd_trace_record(dev, EPD_TRACE_DISPLAY, priv->refresh_mode, start_us, us,
+                     cost->ram_bytes, 0);
+}
+
+// 显示缓冲区 (三色屏上红色平面视为全空), GRAY4模式下为每像素2位的灰度缓冲区
+static esp_err_t ssd1619_display_buffer(epd_device_t *dev, 
+                                        const uint8_t *buffer,
+                                        epd_update_mode_t mode) {
+    if (!dev || !dev->priv || !buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    epd_transport_stats_t stats = { 0 };
+    int64_t start = esp_timer_get_time();
+    esp_err_t err;
+    
+    epd_transport_get_stats(dev, &stats);
+    
+    if (priv->display_mode == EPD_DISPLAY_GRAY4) {
+        err = ssd1619_display_gray(dev, buffer);
+        if (err == ESP_OK) {
+            ssd1619_record_cost(dev, start, stats.total_bytes, SSD1619_GRAY_PASSES);
+        }
+        return err;
+    }
+    
+    err = ssd1619_write_frame(dev, buffer, NULL, true);
+    if (err == ESP_OK) {
+        err = ssd1619_update(dev, mode);
+    }
+    if (err == ESP_OK) {
+        ssd1619_record_cost(dev, start, stats.total_bytes, 1);
+    }
+    
+    return err;
+}
+
+// 条带渲染: 每个条带绘制后立即写入对应的RAM窗口, 只需要一个条带的缓冲区
+static esp_err_t ssd1619_display_bands(epd_device_t *dev, uint16_t band_height,
+                                       epd_band_draw_t draw, void *ctx,
+                                       epd_update_mode_t mode, epd_band_stats_t *stats) {
+    if (!dev || !dev->priv || !draw) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (priv->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 90/270度时逻辑行对应RAM的列, 无法按行窗口写入
+    if (priv->rotation & 1) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    uint16_t nw = priv->native_width;
+    uint16_t nh = priv->native_height;
+    uint16_t stride = nw / 8;
+    bool three_color = (dev->info.color_mode == EPD_MODE_3C);
+    bool reverse = (priv->rotation == 2);
+    
+    if (band_height == 0) {
+        band_height = EPD_BAND_HEIGHT;
+    }
+    if (band_height > nh) {
+        band_height = nh;
+    }
+    
+    uint32_t band_bytes = (uint32_t)stride * band_height;
+    uint32_t buffer_bytes = three_color ? band_bytes * 2 : band_bytes;
+    
+    // 条带缓冲区在设备内重用, 只在需要更高的条带时重新分配
+    if (priv->band_buf_size < buffer_bytes) {
+        heap_caps_free(priv->band_buf);
+        priv->band_buf = heap_caps_malloc(buffer_bytes, MALLOC_CAP_DMA);
+        priv->band_buf_size = priv->band_buf ? buffer_bytes : 0;
+        if (!priv->band_buf) {
+            ESP_LOGE(TAG, "分配条带缓冲区失败 (%u字节)", (unsigned)buffer_bytes);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    uint8_t *bw = priv->band_buf;
+    uint8_t *red = three_color ? priv->band_buf + band_bytes : NULL;
+    epd_band_stats_t st = {
+        .band_height = band_height,
+        .buffer_bytes = buffer_bytes,
+        .frame_bytes = (uint32_t)stride * nh * (three_color ? 2 : 1),
+    };
+    uint64_t ram_bytes = 0;
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+    
+    for (uint16_t y0 = 0; y0 < nh; y0 += band_height) {
+        uint16_t rows = (nh - y0 < band_height) ? nh - y0 : band_height;
+        uint32_t size = (uint32_t)stride * rows;
+    
+        memset(bw, 0xFF, size);
+        if (red) {
+            memset(red, 0x00, size);
+        }
+    
+        int64_t t0 = esp_timer_get_time();
+        err = draw(ctx, bw, red, y0, rows);
+        int64_t t1 = esp_timer_get_time();
+        st.draw_us += (uint32_t)(t1 - t0);
+        if (err != ESP_OK) {
+            break;
+        }
+    
+        // 180度时逻辑条带位于RAM底部, 与整屏写入一样从窗口右下角递减写入
+        uint16_t ny = reverse ? nh - y0 - rows : y0;
+        err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_BW, 0, ny, nw, rows, reverse);
+        if (err == ESP_OK) {
+            err = ssd1619_send_window(dev, bw, stride, stride, rows, reverse);
+        }
+        if (err == ESP_OK && red) {
+            priv->red_ram_clear = false;
+            err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_RED, 0, ny, nw, rows,
+                                          reverse);
+            if (err == ESP_OK) {
+                err = ssd1619_send_window(dev, red, stride, stride, rows, reverse);
+            }
+        }
+        st.transfer_us += (uint32_t)(esp_timer_get_time() - t1);
+        if (err != ESP_OK) {
+            break;
+        }
+    
+        ram_bytes += red ? size * 2 : size;
+        st.bands++;
+    }
+    
+    if (err == ESP_OK) {
+        err = ssd1619_update(dev, mode);
+    } else {
+        ESP_LOGW(TAG, "条带渲染在第%u个条带中止: %d", st.bands, err);
+    }
+    
+    st.total_us = (uint32_t)(esp_timer_get_time() - start);
+    st.bytes_per_sec = st.transfer_us ?
+        (uint32_t)(ram_bytes * 1000000 / st.transfer_us) : 0;
+    if (stats) {
+        *stats = st;
+    }
+    
+    return err;
+}
+
+// 分段刷新第一步: 写入RAM并触发刷新, 面板刷新期间总线可供其他设备使用
+static esp_err_t ssd1619_begin_update(epd_device_t *dev, const uint8_t *buffer,
+                                      epd_update_mode_t mode) {
+    if (!dev || !dev->priv || !buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    // 灰度需要多次激活, 无法拆分
+    if (priv->update_pending || priv->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    epd_transport_stats_t stats = { 0 };
+    epd_transport_get_stats(dev, &stats);
+    priv->update_start_us = esp_timer_get_time();
+    priv->update_start_bytes = stats.total_bytes;
+    
+    esp_err_t err = ssd1619_write_frame(dev, buffer, NULL, true);
+    if (err == ESP_OK) {
+        err = ssd1619_start_update(dev, mode);
+    }
+    priv->update_pending = (err == ESP_OK);
+    
+    return err;
+}
+
+// 分段刷新第二步: 等待BUSY结束
+static esp_err_t ssd1619_finish_update(epd_device_t *dev, uint32_t timeout_ms) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (!priv->update_pending) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t err = ssd1619_complete_update(dev, timeout_ms);
+    if (err == ESP_ERR_TIMEOUT && timeout_ms != 0) {
+        // 调用方指定的超时: 面板仍在刷新, 可以再次等待
+        return err;
+    }
+    
+    priv->update_pending = false;
+    if (err == ESP_OK) {
+        ssd1619_record_cost(dev, priv->update_start_us, priv->update_start_bytes, 1);
+    }
+    return err;
+}
+
+// 以RAM中的现有内容刷新 (局刷只改写窗口, 黑白RAM始终保存完整的当前图像)
+static esp_err_t ssd1619_refresh(epd_device_t *dev, epd_update_mode_t mode) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (!priv->initialized || priv->update_pending ||
+        priv->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    return ssd1619_update(dev, mode);
+}
+
+// 清屏: 纯色整屏与旋转无关, 由传输层直接填充, 不需要帧缓冲区
+static esp_err_t ssd1619_clear(epd_device_t *dev, epd_color_t color) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    ESP_LOGI(TAG, "清屏，颜色: %d", color);
+    
+    uint8_t fill_value = (color == EPD_COLOR_WHITE) ? 0xFF : 0x00;
+    
+    esp_err_t err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_BW, 0, 0,
+                                            priv->native_width, priv->native_height, false);
+    if (err == ESP_OK) {
+        err = epd_transport_fill(dev, fill_value,
+                                 priv->native_width * priv->native_height / 8);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    // 纯色与方向无关, 镜像同步填充
+    if (priv->rot_bw) {
+        memset(priv->rot_bw, fill_value, priv->native_width * priv->native_height / 8);
+        priv->rot_bw_valid = true;
+    }
+    
+    if (dev->info.color_mode == EPD_MODE_3C) {
+        err = ssd1619_clear_red_ram(dev);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    
+    return ssd1619_update(dev, EPD_UPDATE_FULL);
+}
+
+// 双平面显示, 为NULL的平面保留RAM中的现有内容
+static esp_err_t ssd1619_display_planes(epd_device_t *dev,
+                                        const uint8_t *bw,
+                                        const uint8_t *red,
+                                        epd_update_mode_t mode) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (((ssd1619_priv_t *)dev->priv)->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t err = ssd1619_write_frame(dev, bw, red, false);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    return ssd1619_update(dev, mode);
+}
+
+// 180度流式发送: 先由原数据源生成, 再逐字节位反转
+typedef struct {
+    epd_transport_source_t source;
+    void *ctx;
+} ssd1619_stream_ctx_t;
+
+static void ssd1619_reverse_stream_source(void *ctx, uint8_t *dst,
+                                          uint32_t offset, uint32_t length) {
+    ssd1619_stream_ctx_t *stream = (ssd1619_stream_ctx_t *)ctx;
+    
+    stream->source(stream->ctx, dst, offset, length);
+    for (uint32_t i = 0; i < length; i++) {
+        dst[i] = epd_bit_reverse_lut[dst[i]];
+    }
+}
+
+static esp_err_t ssd1619_stream_plane(epd_device_t *dev, uint8_t cmd,
+                                      epd_transport_source_t source, void *ctx) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    uint16_t nw = priv->native_width;
+    uint16_t nh = priv->native_height;
+    uint32_t plane_size = nw * nh / 8;
+    
+    bool reverse = (priv->rotation == 2);
+    
+    esp_err_t err = ssd1619_begin_ram_write(dev, cmd, 0, 0, nw, nh, reverse);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    if (reverse) {
+        ssd1619_stream_ctx_t stream = { .source = source, .ctx = ctx };
+        return epd_transport_send_from(dev, plane_size, ssd1619_reverse_stream_source, &stream);
+    }
+    
+    return epd_transport_send_from(dev, plane_size, source, ctx);
+}
+
+// 流式显示, 数据源按逻辑方向顺序生成字节
+static esp_err_t ssd1619_display_stream(epd_device_t *dev,
+                                        epd_transport_source_t bw, void *bw_ctx,
+                                        epd_transport_source_t red, void *red_ctx,
+                                        epd_update_mode_t mode) {
+    if (!dev || !dev->priv || !bw) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (priv->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 90/270度需要整屏转置, 无法逐字节流式发送
+    if (priv->rotation & 1) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    esp_err_t err = ssd1619_stream_plane(dev, SSD1619_CMD_WRITE_RAM_BW, bw, bw_ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    if (dev->info.color_mode == EPD_MODE_3C) {
+        if (red) {
+            err = ssd1619_stream_plane(dev, SSD1619_CMD_WRITE_RAM_RED, red, red_ctx);
+            priv->red_ram_clear = false;
+        } else {
+            err = ssd1619_clear_red_ram(dev);
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    
+    return ssd1619_update(dev, mode);
+}
+
+// 灰度位平面数据源: 由2bpp缓冲区按阈值生成1bpp字节, 灰度不低于阈值为白
+typedef struct {
+    const uint8_t *gray;
+    uint8_t threshold;
+} ssd1619_gray_src_t;
+
+static void ssd1619_gray_source(void *ctx, uint8_t *dst, uint32_t offset, uint32_t length) {
+    const ssd1619_gray_src_t *src = (const ssd1619_gray_src_t *)ctx;
+    const uint8_t *in = src->gray + offset * 2;
+    uint8_t t = src->threshold;
+    
+    for (uint32_t i = 0; i < length; i++, in += 2) {
+        uint8_t out = 0;
+        for (int b = 0; b < 2; b++) {
+            for (int shift = 6; shift >= 0; shift -= 2) {
+                out = (out << 1) | (((in[b] >> shift) & 0x03) >= t);
+            }
+        }
+        dst[i] = out;
+    }
+}
+
+// 4级灰度: 每次激活前由灰度缓冲区直接流式生成对应的位平面写入黑白RAM,
+// 不需要额外的1bpp缓冲区; 最后一次激活后自定义LUT保持生效, 下次普通刷新前恢复
+static esp_err_t ssd1619_display_gray(epd_device_t *dev, const uint8_t *gray) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (priv->rotation & 1) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    ssd1619_gray_src_t src = { .gray = gray };
+    
+    for (size_t i = 0; i < SSD1619_GRAY_PASSES; i++) {
+        src.threshold = s_gray_passes[i].threshold;
+    
+        esp_err_t err = ssd1619_stream_plane(dev, SSD1619_CMD_WRITE_RAM_BW,
+                                             ssd1619_gray_source, &src);
+        if (err != ESP_OK) {
+            return err;
+        }
+    
+        if (s_gray_passes[i].pulse) {
+            err = ssd1619_load_lut(dev, s_lut_gray_pulse);
+            if (err == ESP_OK) {
+                err = ssd1619_activate(dev, SSD1619_CTRL_CUSTOM_LUT);
+            }
+        } else {
+            err = ssd1619_update(dev, EPD_UPDATE_FULL);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "灰度第%d次激活失败: %d", (int)i + 1, err);
+            return err;
+        }
+    }
+    
+    return ESP_OK;
+}
+
+// 逻辑像素(lx, ly)映射到原生方向镜像, 值取src第sx位
+static inline void ssd1619_rotate_pixel(ssd1619_priv_t *priv, const uint8_t *src, uint16_t sx,
+                                        uint16_t lx, uint16_t ly) {
+    uint16_t dst_stride = priv->native_width / 8;
+    uint16_t px, py;
+    
+    if (priv->rotation == 1) {
+        px = priv->native_width - 1 - ly;
+        py = lx;
+    } else {
+        px = ly;
+        py = priv->native_height - 1 - lx;
+    }
+    
+    uint8_t *dst = priv->rot_bw + py * dst_stride + px / 8;
+    uint8_t mask = 0x80 >> (px % 8);
+    if (src[sx / 8] & (0x80 >> (sx % 8))) {
+        *dst |= mask;
+    } else {
+        *dst &= ~mask;
+    }
+}
+
+// 90/270度局刷: 将逻辑矩形写入原生方向镜像, 返回覆盖它的原生窗口(x按字节对齐)
+// src指向矩形首行, 矩形第一列位于每行的第src_x位
+static void ssd1619_rotate_rect(epd_device_t *dev, const uint8_t *src_rows,
+                                uint16_t src_stride, uint16_t src_x,
+                                uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                                uint16_t *nx, uint16_t *ny, uint16_t *nw, uint16_t *nh) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    uint16_t dst_stride = priv->native_width / 8;
+    
+    // 逻辑行和源列都按8对齐的内部区域以8x8块转置, 每块对应镜像中的8个整字节;
+    // [r0, r1) x [c0, c1) 为内部区域在矩形内的偏移, 其余边缘逐像素映射
+    uint16_t r0 = (8 - y % 8) % 8;
+    uint16_t c0 = (8 - src_x % 8) % 8;
+    uint16_t r1 = height > r0 ? r0 + (height - r0) / 8 * 8 : r0;
+    uint16_t c1 = width > c0 ? c0 + (width - c0) / 8 * 8 : c0;
+    uint8_t block[8];
+    
+    for (uint16_t row = r0; row < r1; row += 8) {
+        uint16_t ly = y + row;
+        const uint8_t *src = src_rows + row * src_stride + (src_x + c0) / 8;
+    
+        for (uint16_t col = c0; col < c1; col += 8, src++) {
+            uint16_t lx = x + col;
+            epd_transpose8(src, src_stride, block);
+    
+            // block[c]为逻辑第lx+c列的8个像素, 最高位为第ly行
+            for (uint16_t c = 0; c < 8; c++) {
+                if (priv->rotation == 1) {
+                    priv->rot_bw[(lx + c) * dst_stride + (priv->native_width - 8 - ly) / 8] =
+                        epd_bit_reverse_lut[block[c]];
+                } else {
+                    priv->rot_bw[(priv->native_height - 1 - lx - c) * dst_stride + ly / 8] =
+                        block[c];
+                }
+            }
+        }
+    }
+    
+    for (uint16_t row = 0; row < height; row++) {
+        const uint8_t *src = src_rows + row * src_stride;
+        bool inner_row = row >= r0 && row < r1;
+    
+        for (uint16_t col = 0; col < width; col++) {
+            if (inner_row && col == c0 && c1 > c0) {
+                col = c1 - 1;
+                continue;
+            }
+            ssd1619_rotate_pixel(priv, src, src_x + col, x + col, y + row);
+        }
+    }
+    
+    uint16_t px0 = (priv->rotation == 1) ? priv->native_width - (y + height) : y;
+    uint16_t py0 = (priv->rotation == 1) ? x : priv->native_height - (x + width);
+    uint16_t bx0 = px0 / 8;
+    uint16_t bx1 = (px0 + height - 1) / 8;
+    
+    *nx = bx0 * 8;
+    *ny = py0;
+    *nw = (bx1 - bx0 + 1) * 8;
+    *nh = width;
+}
+
+// 90/270度时镜像失效 (其他路径写过黑白RAM), 原生窗口中矩形以外的位无法确定
+static bool ssd1619_mirror_stale(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    return (priv->rotation & 1) && !priv->rot_bw_valid;
+}
+
+// 写入逻辑矩形(x, y, width, height)到黑白RAM, 按当前旋转映射到原生窗口
+// src指向矩形首行, 每行src_stride字节, 矩形第一列位于每行的第src_x位
+static esp_err_t ssd1619_write_window(epd_device_t *dev, const uint8_t *src,
+                                      uint16_t src_stride, uint16_t src_x,
+                                      uint16_t x, uint16_t y,
+                                      uint16_t width, uint16_t height) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    uint16_t row_bytes = (width + 7) / 8;
+    esp_err_t err;
+    
+    if (priv->rotation == 2) {
+        // 180度: 窗口映射到屏幕对角, 以递减入口模式按原顺序发送
+        if ((x % 8) || (width % 8) || (src_x % 8)) {
+            ESP_LOGE(TAG, "180度局刷要求x和宽度为8的倍数");
+            return ESP_ERR_INVALID_ARG;
+        }
+    
+        err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_BW,
+                                      priv->native_width - x - width,
+                                      priv->native_height - y - height,
+                                      width, height, true);
+        if (err != ESP_OK) {
+            return err;
+        }
+        return ssd1619_send_window(dev, src + src_x / 8, src_stride, row_bytes, height, true);
+    }
+    
+    if (priv->rotation & 1) {
+        // 90/270度: 更新镜像后从镜像中发送覆盖该区域的原生窗口
+        uint16_t nx, ny, nw, nh;
+        bool valid = priv->rot_bw_valid;
+        ssd1619_rotate_rect(dev, src, src_stride, src_x, x, y, width, height,
+                            &nx, &ny, &nw, &nh);
+    
+        // 镜像失效时只有原生窗口恰好等于矩形 (无需补齐的位) 才能写入
+        if (!valid && nw != height) {
+            ESP_LOGE(TAG, "RAM镜像已失效, 90/270度局刷需先整屏刷新");
+            return ESP_ERR_INVALID_STATE;
+        }
+    
+        uint16_t stride = priv->native_width / 8;
+        err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_BW, nx, ny, nw, nh, false);
+        if (err == ESP_OK) {
+            err = ssd1619_send_window(dev, priv->rot_bw + ny * stride + nx / 8,
+                                      stride, nw / 8, nh, false);
+        }
+        priv->rot_bw_valid = valid && err == ESP_OK;
+        return err;
+    }
+    
+    err = ssd1619_begin_ram_write(dev, SSD1619_CMD_WRITE_RAM_BW, x, y, width, height, false);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return ssd1619_send_window(dev, src + src_x / 8, src_stride, row_bytes, height, false);
+}
+
+// 窗口局刷的跟踪事件, value为刷新覆盖的像素数
+static void ssd1619_trace_window(epd_device_t *dev, int64_t start_us, esp_err_t err) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    epd_trace_record(dev, EPD_TRACE_DISPLAY, priv->refresh_mode, start_us,
+                     (uint32_t)(esp_timer_get_time() - start_us), priv->refresh_area,
+                     err == ESP_OK ? 0 : EPD_TRACE_FLAG_ERROR);
+}
+
+// 局部显示, buffer为紧密排列的窗口数据
+static esp_err_t ssd1619_display_partial(epd_device_t *dev, 
+                                         const uint8_t *buffer,
+                                         uint16_t x, uint16_t y,
+                                         uint16_t width, uint16_t height) {
+    if (!dev || !dev->priv || !buffer || width == 0 || height == 0 ||
+        x + width > dev->info.width || y + height > dev->info.height) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (((ssd1619_priv_t *)dev->priv)->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = ssd1619_write_window(dev, buffer, (width + 7) / 8, 0,
+                                         x, y, width, height);
+    if (err == ESP_OK) {
+        // 触发局部更新
+        ((ssd1619_priv_t *)dev->priv)->update_area = (uint32_t)width * height;
+        err = ssd1619_update(dev, EPD_UPDATE_PARTIAL);
+    }
+    
+    ssd1619_trace_window(dev, start, err);
+    return err;
+}
+
+// 将整屏缓冲区中的矩形向外扩展到字节边界后写入黑白RAM, 返回写入的像素数
+static esp_err_t ssd1619_write_fb_window(epd_device_t *dev, const uint8_t *framebuffer,
+                                         uint16_t x, uint16_t y,
+                                         uint16_t width, uint16_t height, uint32_t *area) {
+    uint16_t stride = dev->info.width / 8;
+    uint16_t x0 = x & ~7u;
+    uint16_t x1 = (x + width + 7) & ~7u;
+    if (x1 > dev->info.width) {
+        x1 = dev->info.width;
+    }
+    
+    *area = (uint32_t)(x1 - x0) * height;
+    return ssd1619_write_window(dev, framebuffer + (uint32_t)y * stride, stride, x0,
+                                x0, y, x1 - x0, height);
+}
+
+// 窗口局刷: framebuffer为整屏缓冲区, 矩形向外扩展到字节边界,
+// 各行直接从帧缓冲区收集后一次流式发送, 不需要打包子缓冲区
+static esp_err_t ssd1619_display_window(epd_device_t *dev, const uint8_t *framebuffer,
+                                        uint16_t x, uint16_t y,
+                                        uint16_t width, uint16_t height,
+                                        epd_update_mode_t mode) {
+    if (!dev || !dev->priv || !framebuffer || width == 0 || height == 0 ||
+        x + width > dev->info.width || y + height > dev->info.height) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (((ssd1619_priv_t *)dev->priv)->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    uint32_t area;
+    esp_err_t err;
+    if (ssd1619_mirror_stale(dev)) {
+        // 整屏写入黑白RAM并重建镜像, 刷新仍为局刷
+        err = ssd1619_write_frame(dev, framebuffer, NULL, false);
+        area = (uint32_t)dev->info.width * dev->info.height;
+    } else {
+        err = ssd1619_write_fb_window(dev, framebuffer, x, y, width, height, &area);
+    }
+    if (err == ESP_OK) {
+        ((ssd1619_priv_t *)dev->priv)->update_area = area;
+        err = ssd1619_update(dev, mode);
+    }
+    
+    ssd1619_trace_window(dev, start, err);
+    return err;
+}
+
+// 多窗口局刷: 所有窗口写入RAM后只激活一次, 窗口外的RAM内容与面板一致, 不受影响
+static esp_err_t ssd1619_display_windows(epd_device_t *dev, const uint8_t *framebuffer,
+                                         const epd_rect_t *rects, uint8_t count,
+                                         epd_update_mode_t mode) {
+    if (!dev || !dev->priv || !framebuffer || !rects || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        const epd_rect_t *r = &rects[i];
+        if (r->width == 0 || r->height == 0 ||
+            r->x + r->width > dev->info.width || r->y + r->height > dev->info.height) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    if (((ssd1619_priv_t *)dev->priv)->display_mode != EPD_DISPLAY_1BPP) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    uint32_t total = 0;
+    esp_err_t err = ESP_OK;
+    if (ssd1619_mirror_stale(dev)) {
+        err = ssd1619_write_frame(dev, framebuffer, NULL, false);
+        total = (uint32_t)dev->info.width * dev->info.height;
+        count = 0;
+    }
+    for (uint8_t i = 0; i < count && err == ESP_OK; i++) {
+        uint32_t area;
+        err = ssd1619_write_fb_window(dev, framebuffer, rects[i].x, rects[i].y,
+                                      rects[i].width, rects[i].height, &area);
+        total += area;
+    }
+    if (err == ESP_OK) {
+        ((ssd1619_priv_t *)dev->priv)->update_area = total;
+        err = ssd1619_update(dev, mode);
+    }
+    
+    ssd1619_trace_window(dev, start, err);
+    return err;
+}
+
+// 保留配置所在的槽位, 按CS引脚区分同一总线上的多块面板; 没有空槽位时覆盖第一个
+static ssd1619_retained_t *ssd1619_retain_slot(epd_device_t *dev, bool *valid) {
+    ssd1619_retained_t *free_slot = NULL;
+    
+    for (int i = 0; i < SSD1619_RETAIN_SLOTS; i++) {
+        ssd1619_retained_t *slot = &s_retained[i];
+        bool ok = slot->magic == SSD1619_RETAIN_MAGIC &&
+                  slot->checksum == epd_fnv1a(slot, offsetof(ssd1619_retained_t, checksum));
+        if (ok && slot->spi_cs == dev->pins.spi_cs) {
+            *valid = true;
+            return slot;
+        }
+        if (!ok && !free_slot) {
+            free_slot = slot;
+        }
+    }
+    
+    *valid = false;
+    return free_slot ? free_slot : &s_retained[0];
+}
+
+// 睡眠前把恢复所需的配置写入RTC内存
+static void ssd1619_retain_save(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    bool valid;
+    ssd1619_retained_t *slot = ssd1619_retain_slot(dev, &valid);
+    
+    ssd1619_retained_t state;
+    memset(&state, 0, sizeof(state));
+    state.magic = SSD1619_RETAIN_MAGIC;
+    state.native_width = priv->native_width;
+    state.native_height = priv->native_height;
+    state.spi_cs = dev->pins.spi_cs;
+    state.color_mode = dev->info.color_mode;
+    state.rotation = priv->rotation;
+    state.temp_override = priv->temp_override;
+    state.red_ram_clear = priv->red_ram_clear;
+    state.checksum = epd_fnv1a(&state, offsetof(ssd1619_retained_t, checksum));
+    *slot = state;
+}
+
+// 作废保留的配置 (完整初始化后面板状态以本次启动为准)
+static void ssd1619_retain_clear(epd_device_t *dev) {
+    bool valid;
+    ssd1619_retained_t *slot = ssd1619_retain_slot(dev, &valid);
+    if (valid) {
+        memset(slot, 0, sizeof(ssd1619_retained_t));
+    }
+}
+
+// 从深度睡眠恢复控制器: 深度睡眠模式1保留RAM, 只需复位并重发寄存器配置,
+// 不做软复位和初始化激活; 复位后以BUSY变低判断就绪, 不再固定等待
+static esp_err_t ssd1619_resume_panel(epd_device_t *dev) {
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    gpio_set_level(dev->pins.rst_pin, 0);
+    epd_delay_ms(SSD1619_RESET_PULSE_MS);
+    gpio_set_level(dev->pins.rst_pin, 1);
+    
+    esp_err_t err = epd_wait_busy(dev, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    // 复位清除了自定义LUT和温度寄存器
+    priv->lut = NULL;
+    priv->band = -1;
+    
+    epd_cmd_list_t list;
+    epd_cmd_list_init(&list);
+    ssd1619_config_list(dev, &list);
+    return epd_cmd_list_send(dev, &list);
+}
+
+// 进入睡眠
+static esp_err_t ssd1619_sleep(epd_device_t *dev) {
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ESP_LOGI(TAG, "进入睡眠模式");
+    
+    if (dev->priv) {
+        ssd1619_retain_save(dev);
+    }
+    
+    static const uint8_t mode = 0x01;  // 进入深度睡眠, 保留RAM
+    epd_cmd_list_t list;
+    epd_cmd_list_init(&list);
+    epd_cmd_list_add(&list, SSD1619_CMD_DEEP_SLEEP, &mode, 1);
+    epd_cmd_list_send(dev, &list);
+    
+    vTaskDelay(100 / portTICK_PERIOD_MS);
+    
+    return ESP_OK;
+}
+
+// 唤醒: 已初始化时SPI、GPIO和驱动状态都还在, 只恢复控制器
+static esp_err_t ssd1619_wakeup(epd_device_t *dev) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    if (!priv->initialized) {
+        return dev->init(dev);
+    }
+    
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = ssd1619_resume_panel(dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "唤醒失败: %d", err);
+        return err;
+    }
+    
+    ESP_LOGI(TAG, "唤醒完成, 耗时%lldus", (long long)(esp_timer_get_time() - start));
+    return ESP_OK;
+}
+
+// MCU深度睡眠后的恢复: RTC内存中有本面板睡眠前保存的配置时跳过完整初始化,
+// 面板RAM保持睡眠前的内容; 否则退化为dev->init
+static esp_err_t ssd1619_resume(epd_device_t *dev) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    if (priv->initialized) {
+        return ssd1619_wakeup(dev);
+    }
+    
+    bool valid;
+    ssd1619_retained_t *slot = ssd1619_retain_slot(dev, &valid);
+    
+    // 面板电源被切断时RAM已丢失; 90/270度的RAM镜像不在RTC内存中, 无法继续局刷
+    if (!valid || dev->pins.pwr_en_pin >= 0 || (slot->rotation & 1) ||
+        slot->native_width != priv->native_width ||
+        slot->native_height != priv->native_height ||
+        slot->color_mode != dev->info.color_mode) {
+        ESP_LOGI(TAG, "没有可用的保留配置, 完整初始化");
+        return dev->init(dev);
+    }
+    
+    int64_t start = esp_timer_get_time();
+    
+    esp_err_t err = ssd1619_init_host(dev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    ssd1619_set_rotation(dev, slot->rotation);
+    priv->temp_override = slot->temp_override;
+    priv->red_ram_clear = slot->red_ram_clear;
+    priv->temp_valid = false;
+    
+    err = ssd1619_resume_panel(dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "恢复失败, 完整初始化: %d", err);
+        return dev->init(dev);
+    }
+    
+    err = epd_async_start(dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动异步刷新任务失败: %d", err);
+        return err;
+    }
+    
+    // 保留配置只用一次, 之后的睡眠会重新保存
+    memset(slot, 0, sizeof(ssd1619_retained_t));
+    priv->initialized = true;
+    
+    ESP_LOGI(TAG, "从深度睡眠恢复, 耗时%lldus", (long long)(esp_timer_get_time() - start));
+    return ESP_OK;
+}
+
+// 复位
+static esp_err_t ssd1619_reset(epd_device_t *dev) {
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ESP_LOGI(TAG, "硬件复位");
+    epd_trace_record(dev, EPD_TRACE_RESET, 0, 0, 0, 0, 0);
+    
+    // 拉低复位引脚
+    gpio_set_level(dev->pins.rst_pin, 0);
+    epd_delay_ms(10);
+    
+    // 拉高复位引脚
+    gpio_set_level(dev->pins.rst_pin, 1);
+    epd_delay_ms(10);
+    
+    // 等待就绪 (BUSY变低), 不再固定等待
+    return epd_wait_busy(dev, 0);
+}
+
+// 电源控制
+static esp_err_t ssd1619_power_on(epd_device_t *dev) {
+    // SSD1619通过复位唤醒
+    return ssd1619_reset(dev);
+}
+
+static esp_err_t ssd1619_power_off(epd_device_t *dev) {
+    return ssd1619_sleep(dev);
+}
+
+// 设置旋转
+static esp_err_t ssd1619_set_rotation(epd_device_t *dev, uint8_t rotation) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    uint32_t plane_size = priv->native_width * priv->native_height / 8;
+    rotation %= 4;
+    
+    // 8x8块转置要求两个方向都按字节对齐
+    if ((rotation & 1) && ((priv->native_width % 8) || (priv->native_height % 8))) {
+        ESP_LOGE(TAG, "90/270度旋转要求宽高为8的倍数");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    if ((rotation & 1) && !priv->rot_bw) {
+        priv->rot_bw = heap_caps_malloc(plane_size, MALLOC_CAP_DMA);
+        if (!priv->rot_bw) {
+            return ESP_ERR_NO_MEM;
+        }
+        // 整屏写入或清屏之后镜像才与RAM一致
+        priv->rot_bw_valid = false;
+    }
+    
+    if ((rotation & 1) && dev->info.color_mode == EPD_MODE_3C && !priv->rot_red) {
+        priv->rot_red = heap_caps_malloc(plane_size, MALLOC_CAP_DMA);
+        if (!priv->rot_red) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    priv->rotation = rotation;
+    
+    // 对外的宽高为旋转后的逻辑尺寸, 控制器RAM始终按原生方向寻址
+    if (rotation & 1) {
+        dev->info.width = priv->native_height;
+        dev->info.height = priv->native_width;
+    } else {
+        dev->info.width = priv->native_width;
+        dev->info.height = priv->native_height;
+    }
+    
+    return ESP_OK;
+}
+
+// 反色显示
+static esp_err_t ssd1619_invert(epd_device_t *dev, bool invert) {
+    // SSD1619不支持硬件反色，需要在软件层处理
+    (void)dev;
+    (void)invert;
+    return ESP_OK;
+}
+
+// 获取设备信息
+static esp_err_t ssd1619_get_info(epd_device_t *dev, epd_info_t *info) {
+    if (!dev || !info) {
+        return ESP_ERR_INVALID_ARG;
     }
     
     memcpy(info, &dev->info, sizeof(epd_info_t));
     return ESP_OK;
 }
 
+// 设置显示模式
+static esp_err_t ssd1619_set_display_mode(epd_device_t *dev, epd_display_mode_t mode) {
+    if (!dev || !dev->priv || mode >= EPD_DISPLAY_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (mode == EPD_DISPLAY_GRAY4 && !(dev->info.capabilities & EPD_CAP_GRAYSCALE)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    priv->display_mode = mode;
+    ESP_LOGI(TAG, "显示模式: %s", mode == EPD_DISPLAY_GRAY4 ? "4级灰度" : "1bpp");
+    
+    return ESP_OK;
+}
+
+// 获取整屏刷新代价
+static esp_err_t ssd1619_get_refresh_cost(epd_device_t *dev, epd_display_mode_t mode,
+                                          epd_refresh_cost_t *cost) {
+    if (!dev || !dev->priv || !cost || mode >= EPD_DISPLAY_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    memcpy(cost, &priv->cost[mode], sizeof(epd_refresh_cost_t));
+    return ESP_OK;
+}
+
+// 立即测量温度 (外部读数生效时返回该读数)
+static esp_err_t ssd1619_read_temperature(epd_device_t *dev, int8_t *temp_c) {
+    if (!dev || !dev->priv || !temp_c) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    if (priv->temp_override != EPD_TEMP_AUTO) {
+        *temp_c = priv->temp_override;
+        return ESP_OK;
+    }
+    
+    esp_err_t err = ssd1619_sense_temperature(dev, temp_c);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    priv->temp_c = *temp_c;
+    priv->temp_valid = true;
+    priv->temp_read_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+// 以外部读数代替测量
+static esp_err_t ssd1619_set_temperature(epd_device_t *dev, int8_t temp_c) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    priv->temp_override = temp_c;
+    if (temp_c == EPD_TEMP_AUTO) {
+        priv->temp_valid = false;
+    }
+    ssd1619_update_temp_cap(dev);
+    return ESP_OK;
+}
+
+// 设置温度区间表, 统计随之清零, 下次刷新时重新装载波形
+static esp_err_t ssd1619_set_temp_bands(epd_device_t *dev, const epd_temp_band_t *bands,
+                                        uint8_t count) {
+    if (!dev || !dev->priv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!bands) {
+        bands = s_default_temp_bands;
+        count = sizeof(s_default_temp_bands) / sizeof(s_default_temp_bands[0]);
+    }
+    
+    if (count == 0 || count > EPD_TEMP_MAX_BANDS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    for (uint8_t i = 1; i < count; i++) {
+        if (bands[i].min_c <= bands[i - 1].min_c) {
+            ESP_LOGE(TAG, "温度区间须按下限升序排列");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    
+    memcpy(priv->bands, bands, count * sizeof(epd_temp_band_t));
+    priv->band_count = count;
+    priv->band = -1;
+    memset(priv->band_stats, 0, sizeof(priv->band_stats));
+    memset(priv->band_total_us, 0, sizeof(priv->band_total_us));
+    for (uint8_t i = 0; i < count; i++) {
+        priv->band_stats[i].min_c = bands[i].min_c;
+    }
+    
+    return ESP_OK;
+}
+
+static esp_err_t ssd1619_get_temp_band_stats(epd_device_t *dev, uint8_t band,
+                                             epd_temp_band_stats_t *stats) {
+    if (!dev || !dev->priv || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+    if (band >= priv->band_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    memcpy(stats, &priv->band_stats[band], sizeof(epd_temp_band_stats_t));
+    return ESP_OK;
+}
+
 // 反初始化
 static esp_err_t ssd1619_deinit(epd_device_t *dev) {
     if (!dev) {
         return ESP_ERR_INVALID_ARG;
     }
     
+    // 等待排队的异步刷新完成
+    epd_async_stop(dev);
+    
     // 进入睡眠
     ssd1619_sleep(dev);
     
-    // 释放SPI设备
+    // 释放BUSY中断、传输层和SPI设备
+    epd_busy_deinit(dev);
+    epd_transport_deinit(dev);
+    epd_pool_deinit(dev);
+    epd_policy_detach(dev);
     if (dev->spi_dev) {
         spi_bus_remove_device(dev->spi_dev);
         dev->spi_dev = NULL;
@@ -452,6 +2011,10 @@ static esp_err_t ssd1619_deinit(epd_device_t *dev) {
     
     // 释放私有数据
     if (dev->priv) {
+        ssd1619_priv_t *priv = (ssd1619_priv_t *)dev->priv;
+        heap_caps_free(priv->rot_bw);
+        heap_caps_free(priv->rot_red);
+        heap_caps_free(priv->band_buf);
         free(dev->priv);
         dev->priv = NULL;
     }
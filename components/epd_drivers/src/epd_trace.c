@@ -0,0 +1,183 @@
+/**
+ * 二进制跟踪环
+ * 所有设备共用一个环, 事件以设备的CS引脚区分; 跨度事件在结束时写入
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_trace.h"
+#include "epd_internal.h"
+
+#if EPD_TRACE_ENABLE
+
+#if (EPD_TRACE_CAPACITY & (EPD_TRACE_CAPACITY - 1)) != 0
+#error "EPD_TRACE_CAPACITY须为2的幂"
+#endif
+
+static epd_trace_event_t s_ring[EPD_TRACE_CAPACITY];
+static uint32_t s_head;             // 已记录的事件总数, 低位为写入位置
+static uint32_t s_tail;             // 清空时的s_head, 之前的事件不再导出
+static bool s_enabled = true;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void epd_trace_record(const epd_device_t *dev, uint8_t type, uint8_t code,
+                      int64_t start_us, uint32_t dur_us, uint32_t value, uint8_t flags) {
+    if (!s_enabled) {
+        return;
+    }
+    
+    if (start_us == 0) {
+        start_us = esp_timer_get_time();
+    }
+    
+    portENTER_CRITICAL(&s_lock);
+    epd_trace_event_t *e = &s_ring[s_head & (EPD_TRACE_CAPACITY - 1)];
+    e->ts_us = (uint32_t)start_us;
+    e->dur_us = dur_us;
+    e->value = value;
+    e->type = type;
+    e->code = code;
+    e->dev = dev ? dev->pins.spi_cs : -1;
+    e->flags = flags;
+    s_head++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void epd_trace_mark(uint8_t code, uint32_t value) {
+    epd_trace_record(NULL, EPD_TRACE_MARK, code, 0, 0, value, 0);
+}
+
+void epd_trace_set_enabled(bool enabled) {
+    s_enabled = enabled;
+}
+
+void epd_trace_clear(void) {
+    portENTER_CRITICAL(&s_lock);
+    s_tail = s_head;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// 环中有效事件的范围 [first, s_head)
+static uint32_t epd_trace_first(uint32_t *dropped) {
+    uint32_t first = s_tail;
+    uint32_t lost = 0;
+    
+    if (s_head - first > EPD_TRACE_CAPACITY) {
+        lost = s_head - first - EPD_TRACE_CAPACITY;
+        first = s_head - EPD_TRACE_CAPACITY;
+    }
+    if (dropped) {
+        *dropped = lost;
+    }
+    return first;
+}
+
+uint32_t epd_trace_snapshot(epd_trace_event_t *events, uint32_t max, uint32_t *dropped) {
+    if (!events || max == 0) {
+        if (dropped) {
+            *dropped = 0;
+        }
+        return 0;
+    }
+    
+    portENTER_CRITICAL(&s_lock);
+    uint32_t first = epd_trace_first(dropped);
+    uint32_t count = s_head - first;
+    
+    // 只保留最近的max个
+    if (count > max) {
+        first += count - max;
+        count = max;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        events[i] = s_ring[(first + i) & (EPD_TRACE_CAPACITY - 1)];
+    }
+    portEXIT_CRITICAL(&s_lock);
+    
+    return count;
+}
+
+// 小端编码, 与主机工具约定的导出格式
+static void epd_trace_encode(const epd_trace_event_t *e, uint8_t *out) {
+    const uint32_t words[3] = { e->ts_us, e->dur_us, e->value };
+    
+    for (int w = 0; w < 3; w++) {
+        for (int b = 0; b < 4; b++) {
+            out[w * 4 + b] = (words[w] >> (8 * b)) & 0xFF;
+        }
+    }
+    out[12] = e->type;
+    out[13] = e->code;
+    out[14] = (uint8_t)e->dev;
+    out[15] = e->flags;
+}
+
+esp_err_t epd_trace_dump(FILE *out) {
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 暂停记录, 之后直接读环, 不需要整环的拷贝
+    bool was_enabled = s_enabled;
+    s_enabled = false;
+    
+    portENTER_CRITICAL(&s_lock);
+    uint32_t dropped;
+    uint32_t first = epd_trace_first(&dropped);
+    uint32_t head = s_head;
+    portEXIT_CRITICAL(&s_lock);
+    
+    fprintf(out, EPD_TRACE_DUMP_PREFIX "_BEGIN v1 count=%u dropped=%u\n",
+            (unsigned)(head - first), (unsigned)dropped);
+    
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = first; i != head; i++) {
+        uint8_t bytes[EPD_TRACE_EVENT_SIZE];
+        char line[EPD_TRACE_EVENT_SIZE * 2 + 1];
+    
+        epd_trace_encode(&s_ring[i & (EPD_TRACE_CAPACITY - 1)], bytes);
+        for (int b = 0; b < EPD_TRACE_EVENT_SIZE; b++) {
+            snprintf(line + b * 2, 3, "%02x", bytes[b]);
+            hash = (hash ^ bytes[b]) * 16777619u;
+        }
+        fprintf(out, EPD_TRACE_DUMP_PREFIX " %s\n", line);
+    }
+    
+    fprintf(out, EPD_TRACE_DUMP_PREFIX "_END fnv=%08x\n", (unsigned)hash);
+    fflush(out);
+    
+    s_enabled = was_enabled;
+    return ESP_OK;
+}
+
+#else // EPD_TRACE_ENABLE
+
+void epd_trace_mark(uint8_t code, uint32_t value) {
+    (void)code;
+    (void)value;
+}
+
+void epd_trace_set_enabled(bool enabled) {
+    (void)enabled;
+}
+
+void epd_trace_clear(void) {
+}
+
+uint32_t epd_trace_snapshot(epd_trace_event_t *events, uint32_t max, uint32_t *dropped) {
+    (void)events;
+    (void)max;
+    if (dropped) {
+        *dropped = 0;
+    }
+    return 0;
+}
+
+esp_err_t epd_trace_dump(FILE *out) {
+    (void)out;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // EPD_TRACE_ENABLE
@@ -0,0 +1,462 @@
+/**
+ * 墨水屏SPI传输层
+ * 大块数据切分为DMA事务, 多个事务同时排队并使用轮换弹跳缓冲区,
+ * 在DMA发送当前块的同时准备下一块, 使总线在整帧发送期间保持忙碌
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+#include "epd_common.h"
+#include "epd_internal.h"
+
+#define TAG "EPD_TRANSPORT"
+
+// 传输层私有数据
+struct epd_transport_t {
+    spi_device_handle_t spi;
+    uint32_t chunk_size;
+    uint8_t depth;
+    uint8_t *bounce[EPD_TRANSPORT_MAX_DEPTH];       // 弹跳缓冲区 (DMA内存)
+    uint8_t *cmd_scratch;                           // 命令列表长参数段缓冲区 (DMA内存)
+    spi_transaction_t trans[EPD_TRANSPORT_MAX_DEPTH];
+    epd_dc_ctx_t dc_cmd;
+    epd_dc_ctx_t dc_data;
+    epd_transport_stats_t stats;
+};
+
+// 事务前回调, 在ISR上下文中执行
+void IRAM_ATTR epd_transport_pre_cb(spi_transaction_t *trans) {
+    const epd_dc_ctx_t *dc = (const epd_dc_ctx_t *)trans->user;
+    if (dc) {
+        gpio_set_level(dc->dc_pin, dc->level);
+    }
+}
+
+// 初始化传输层
+esp_err_t epd_transport_init(epd_device_t *dev, const epd_transport_config_t *config) {
+    if (!dev || !dev->spi_dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (dev->transport) {
+        return ESP_OK;
+    }
+    
+    struct epd_transport_t *tp = calloc(1, sizeof(struct epd_transport_t));
+    if (!tp) {
+        ESP_LOGE(TAG, "分配传输层内存失败");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    tp->spi = dev->spi_dev;
+    tp->chunk_size = (config && config->chunk_size) ? config->chunk_size
+                                                    : EPD_TRANSPORT_CHUNK_SIZE;
+    tp->depth = (config && config->queue_depth) ? config->queue_depth
+                                                : EPD_TRANSPORT_QUEUE_DEPTH;
+    if (tp->depth > EPD_TRANSPORT_MAX_DEPTH) {
+        tp->depth = EPD_TRANSPORT_MAX_DEPTH;
+    }
+    // 不超过总线的max_transfer_sz, DMA要求按字对齐且至少一个字
+    if (tp->chunk_size > EPD_TRANSPORT_CHUNK_SIZE) {
+        tp->chunk_size = EPD_TRANSPORT_CHUNK_SIZE;
+    }
+    tp->chunk_size &= ~3u;
+    if (tp->chunk_size < 4) {
+        tp->chunk_size = 4;
+    }
+    
+    for (uint8_t i = 0; i < tp->depth; i++) {
+        tp->bounce[i] = heap_caps_malloc(tp->chunk_size, MALLOC_CAP_DMA);
+        if (!tp->bounce[i]) {
+            ESP_LOGE(TAG, "分配弹跳缓冲区失败");
+            for (uint8_t j = 0; j < i; j++) {
+                heap_caps_free(tp->bounce[j]);
+            }
+            free(tp);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    // 命令列表参数段可长达EPD_CMD_LIST_MAX_BYTES, 与块大小无关
+    tp->cmd_scratch = heap_caps_malloc(EPD_CMD_LIST_MAX_BYTES, MALLOC_CAP_DMA);
+    if (!tp->cmd_scratch) {
+        ESP_LOGE(TAG, "分配命令缓冲区失败");
+        for (uint8_t i = 0; i < tp->depth; i++) {
+            heap_caps_free(tp->bounce[i]);
+        }
+        free(tp);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    tp->dc_cmd.dc_pin = dev->pins.dc_pin;
+    tp->dc_cmd.level = 0;
+    tp->dc_data.dc_pin = dev->pins.dc_pin;
+    tp->dc_data.level = 1;
+    
+    dev->transport = tp;
+    
+    ESP_LOGI(TAG, "传输层就绪: 块大小=%u, 队列深度=%u",
+             (unsigned)tp->chunk_size, tp->depth);
+    
+    return ESP_OK;
+}
+
+// 释放传输层
+void epd_transport_deinit(epd_device_t *dev) {
+    if (!dev || !dev->transport) {
+        return;
+    }
+    
+    struct epd_transport_t *tp = dev->transport;
+    for (uint8_t i = 0; i < tp->depth; i++) {
+        heap_caps_free(tp->bounce[i]);
+    }
+    heap_caps_free(tp->cmd_scratch);
+    free(tp);
+    dev->transport = NULL;
+}
+
+// 轮询发送少量字节
+esp_err_t epd_transport_write(epd_device_t *dev, uint8_t dc,
+                              const uint8_t *data, uint32_t length) {
+    if (!dev || !dev->transport || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    struct epd_transport_t *tp = dev->transport;
+    spi_transaction_t t;
+    memset(&t, 0, sizeof(t));
+    t.length = length * 8;
+    t.user = dc ? &tp->dc_data : &tp->dc_cmd;
+    tp->stats.cmd_transactions++;
+    
+    if (length <= sizeof(t.tx_data)) {
+        t.flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t.tx_data, data, length);
+    } else {
+        t.tx_buffer = data;
+    }
+    
+    return spi_device_polling_transmit(tp->spi, &t);
+}
+
+// 轮询读取少量参数字节: 读命令须已发送, 读取期间D/C保持数据电平
+esp_err_t epd_transport_read(epd_device_t *dev, uint8_t *data, uint32_t length) {
+    if (!dev || !dev->transport || !data || length == 0 || length > 4) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (dev->pins.spi_miso < 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    struct epd_transport_t *tp = dev->transport;
+    spi_transaction_t t;
+    memset(&t, 0, sizeof(t));
+    t.length = length * 8;
+    t.rxlength = length * 8;
+    t.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+    t.user = &tp->dc_data;
+    tp->stats.cmd_transactions++;
+    
+    esp_err_t err = spi_device_polling_transmit(tp->spi, &t);
+    if (err == ESP_OK) {
+        memcpy(data, t.rx_data, length);
+    }
+    return err;
+}
+
+// 开始新的一段, 空间不足时标记溢出
+static bool epd_cmd_list_push(epd_cmd_list_t *list, uint8_t byte, uint8_t dc) {
+    if (list->overflow || list->length >= EPD_CMD_LIST_MAX_BYTES) {
+        list->overflow = true;
+        return false;
+    }
+    
+    epd_cmd_segment_t *last = list->count ? &list->segments[list->count - 1] : NULL;
+    
+    // D/C电平与当前段相同时并入当前段
+    if (!last || last->dc != dc) {
+        if (list->count >= EPD_CMD_LIST_MAX_SEGMENTS) {
+            list->overflow = true;
+            return false;
+        }
+        last = &list->segments[list->count++];
+        last->offset = list->length;
+        last->length = 0;
+        last->dc = dc;
+    }
+    
+    list->data[list->length++] = byte;
+    last->length++;
+    return true;
+}
+
+void epd_cmd_list_init(epd_cmd_list_t *list) {
+    memset(list, 0, sizeof(*list));
+}
+
+void epd_cmd_list_cmd(epd_cmd_list_t *list, uint8_t cmd) {
+    epd_cmd_list_push(list, cmd, 0);
+}
+
+void epd_cmd_list_data(epd_cmd_list_t *list, uint8_t data) {
+    epd_cmd_list_push(list, data, 1);
+}
+
+void epd_cmd_list_data_u16(epd_cmd_list_t *list, uint16_t data) {
+    epd_cmd_list_push(list, data & 0xFF, 1);
+    epd_cmd_list_push(list, data >> 8, 1);
+}
+
+void epd_cmd_list_add(epd_cmd_list_t *list, uint8_t cmd,
+                      const uint8_t *params, uint8_t count) {
+    epd_cmd_list_push(list, cmd, 0);
+    for (uint8_t i = 0; i < count; i++) {
+        epd_cmd_list_push(list, params[i], 1);
+    }
+}
+
+// 提交命令列表: 占用总线期间每段一个轮询事务, 不经过中断和事务队列
+esp_err_t epd_cmd_list_send(epd_device_t *dev, const epd_cmd_list_t *list) {
+    if (!dev || !dev->transport || !list) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (list->overflow) {
+        ESP_LOGE(TAG, "命令列表超出容量");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    if (list->count == 0) {
+        return ESP_OK;
+    }
+    
+    struct epd_transport_t *tp = dev->transport;
+    esp_err_t err = spi_device_acquire_bus(tp->spi, portMAX_DELAY);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    for (uint8_t i = 0; i < list->count; i++) {
+        const epd_cmd_segment_t *seg = &list->segments[i];
+        spi_transaction_t t;
+    
+        // 命令段中每个字节一个事件, 最后一个命令的参数为紧随的数据段
+        if (!seg->dc) {
+            uint8_t params = (i + 1 < list->count) ? list->segments[i + 1].length : 0;
+            for (uint8_t b = 0; b < seg->length; b++) {
+                epd_trace_record(dev, EPD_TRACE_CMD, list->data[seg->offset + b], 0, 0,
+                                 b + 1 == seg->length ? params : 0, 0);
+            }
+        }
+    
+        memset(&t, 0, sizeof(t));
+        t.length = seg->length * 8;
+        t.user = seg->dc ? &tp->dc_data : &tp->dc_cmd;
+    
+        if (seg->length <= sizeof(t.tx_data)) {
+            t.flags = SPI_TRANS_USE_TXDATA;
+            memcpy(t.tx_data, list->data + seg->offset, seg->length);
+        } else {
+            // 列表可能位于栈上, 较长的参数段经DMA命令缓冲区发送
+            memcpy(tp->cmd_scratch, list->data + seg->offset, seg->length);
+            t.tx_buffer = tp->cmd_scratch;
+        }
+    
+        err = spi_device_polling_transmit(tp->spi, &t);
+        if (err != ESP_OK) {
+            break;
+        }
+        tp->stats.cmd_transactions++;
+    }
+    
+    spi_device_release_bus(tp->spi);
+    tp->stats.cmd_lists++;
+    
+    return err;
+}
+
+// 从连续内存拷贝
+static void epd_transport_copy_source(void *ctx, uint8_t *dst,
+                                      uint32_t offset, uint32_t length) {
+    memcpy(dst, (const uint8_t *)ctx + offset, length);
+}
+
+// 填充固定值
+static void epd_transport_fill_source(void *ctx, uint8_t *dst,
+                                      uint32_t offset, uint32_t length) {
+    (void)offset;
+    memset(dst, (int)(uintptr_t)ctx, length);
+}
+
+// 传输核心: direct非NULL时直接发送该内存, 否则由source逐块生成到弹跳缓冲区
+static esp_err_t epd_transport_run(epd_device_t *dev, const uint8_t *direct,
+                                   uint32_t length,
+                                   epd_transport_source_t source, void *ctx) {
+    struct epd_transport_t *tp = dev->transport;
+    
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+    uint32_t offset = 0;
+    uint8_t in_flight = 0;
+    uint8_t slot = 0;
+    
+    while (offset < length) {
+        // 队列已满: 回收最早的事务, 其缓冲区即为下一个可用槽位
+        if (in_flight == tp->depth) {
+            spi_transaction_t *done;
+            err = spi_device_get_trans_result(tp->spi, &done, portMAX_DELAY);
+            if (err != ESP_OK) {
+                break;
+            }
+            in_flight--;
+        }
+    
+        uint32_t n = length - offset;
+        if (n > tp->chunk_size) {
+            n = tp->chunk_size;
+        }
+    
+        spi_transaction_t *t = &tp->trans[slot];
+        memset(t, 0, sizeof(spi_transaction_t));
+        t->length = n * 8;
+        t->user = &tp->dc_data;
+    
+        if (direct) {
+            t->tx_buffer = direct + offset;
+        } else {
+            // 在前面的块通过DMA发送期间准备本块
+            source(ctx, tp->bounce[slot], offset, n);
+            t->tx_buffer = tp->bounce[slot];
+            tp->stats.bounce_copies++;
+        }
+    
+        err = spi_device_queue_trans(tp->spi, t, portMAX_DELAY);
+        if (err != ESP_OK) {
+            break;
+        }
+    
+        in_flight++;
+        tp->stats.total_chunks++;
+        slot = (slot + 1) % tp->depth;
+        offset += n;
+    }
+    
+    // 等待所有在途事务完成, 之后才允许轮询传输
+    while (in_flight > 0) {
+        spi_transaction_t *done;
+        esp_err_t ret = spi_device_get_trans_result(tp->spi, &done, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            if (err == ESP_OK) {
+                err = ret;
+            }
+            break;
+        }
+        in_flight--;
+    }
+    
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    epd_trace_record(dev, EPD_TRACE_DATA, 0, start_us, elapsed_us, offset,
+                     err == ESP_OK ? 0 : EPD_TRACE_FLAG_ERROR);
+    
+    tp->stats.total_transfers++;
+    tp->stats.total_bytes += offset;
+    tp->stats.total_us += elapsed_us;
+    tp->stats.last_bytes = offset;
+    tp->stats.last_us = elapsed_us;
+    tp->stats.last_bytes_per_sec = elapsed_us ?
+        (uint32_t)((uint64_t)offset * 1000000 / elapsed_us) : 0;
+    tp->stats.avg_bytes_per_sec = tp->stats.total_us ?
+        (uint32_t)(tp->stats.total_bytes * 1000000 / tp->stats.total_us) : 0;
+    
+    if (dev->profile) {
+        dev->profile->phase_us[EPD_PHASE_RAM_WRITE] += elapsed_us;
+        dev->profile->ram_bytes += offset;
+    }
+    
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "批量发送失败: %d (已发送 %u/%u 字节)",
+                 err, (unsigned)offset, (unsigned)length);
+    } else {
+        ESP_LOGD(TAG, "发送 %u 字节, 耗时 %u us, %u 字节/秒",
+                 (unsigned)offset, (unsigned)elapsed_us,
+                 (unsigned)tp->stats.last_bytes_per_sec);
+    }
+    
+    return err;
+}
+
+// 批量发送数据 (D/C=1)
+esp_err_t epd_transport_send(epd_device_t *dev, const uint8_t *data, uint32_t length) {
+    if (!dev || !dev->transport || (!data && length)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (length == 0) {
+        return ESP_OK;
+    }
+    
+    // 源数据本身位于DMA可访问内存且字对齐时直接发送, 否则经弹跳缓冲区中转
+    if (esp_ptr_dma_capable(data) && (((uintptr_t)data & 3) == 0)) {
+        return epd_transport_run(dev, data, length, NULL, NULL);
+    }
+    
+    return epd_transport_run(dev, NULL, length, epd_transport_copy_source, (void *)data);
+}
+
+// 发送length个相同字节, 不需要源缓冲区
+esp_err_t epd_transport_fill(epd_device_t *dev, uint8_t value, uint32_t length) {
+    if (!dev || !dev->transport) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (length == 0) {
+        return ESP_OK;
+    }
+    
+    return epd_transport_run(dev, NULL, length, epd_transport_fill_source,
+                             (void *)(uintptr_t)value);
+}
+
+// 由回调逐块生成数据并发送
+esp_err_t epd_transport_send_from(epd_device_t *dev, uint32_t length,
+                                  epd_transport_source_t source, void *ctx) {
+    if (!dev || !dev->transport || !source) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (length == 0) {
+        return ESP_OK;
+    }
+    
+    return epd_transport_run(dev, NULL, length, source, ctx);
+}
+
+// 获取传输统计
+esp_err_t epd_transport_get_stats(epd_device_t *dev, epd_transport_stats_t *stats) {
+    if (!dev || !dev->transport || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    memcpy(stats, &dev->transport->stats, sizeof(epd_transport_stats_t));
+    return ESP_OK;
+}
+
+// 清零传输统计
+void epd_transport_reset_stats(epd_device_t *dev) {
+    if (!dev || !dev->transport) {
+        return;
+    }
+    
+    memset(&dev->transport->stats, 0, sizeof(epd_transport_stats_t));
+}
@@ -0,0 +1,1930 @@
+/**
+ * 主机端冒烟测试与基准
+ * 在虚拟面板上运行SSD1619驱动, 校验面板图像并输出PBM
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "epd_common.h"
+#include "epd_ssd1619.h"
+#include "epd_framebuffer.h"
+#include "epd_profile.h"
+#include "epd_epf.h"
+#include "epd_font.h"
+#include "epd_dither.h"
+#include "epd_pipeline.h"
+#include "epd_group.h"
+#include "epd_dlist.h"
+#include "epd_policy.h"
+#include "epd_trace.h"
+#include "epf_codec.h"
+#include "epd_virtual.h"
+
+#define TAG "EPD_HOST"
+
+#define BENCH_ITERATIONS  20
+
+static int s_failures = 0;
+
+#define HOST_CHECK(cond, fmt, ...) do {                                 \
+        if (!(cond)) {                                                  \
+            ESP_LOGE(TAG, "失败: " fmt, ##__VA_ARGS__);                  \
+            s_failures++;                                               \
+        }                                                               \
+    } while (0)
+
+// 链接时以--wrap截获驱动、移植层和虚拟面板的堆操作 (见CMakeLists.txt)
+static atomic_uint s_heap_ops;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    atomic_fetch_add(&s_heap_ops, 1);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    atomic_fetch_add(&s_heap_ops, 1);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    atomic_fetch_add(&s_heap_ops, 1);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) {
+        atomic_fetch_add(&s_heap_ops, 1);
+    }
+    __real_free(ptr);
+}
+
+// 比较面板显示图像与期望缓冲区
+static bool image_matches(const epd_virtual_panel_t *panel, epd_virtual_plane_t plane,
+                          const uint8_t *expected) {
+    const uint8_t *image = epd_virtual_get_image(panel, plane);
+    return memcmp(image, expected, epd_virtual_get_plane_size(panel)) == 0;
+}
+
+static void test_full_refresh(epd_device_t *dev, epd_virtual_panel_t *panel, epd_fb_t *fb) {
+    epd_virtual_stats_t stats;
+    
+    // 块大小小于一个字时按4字节处理, 不能退化为0而卡在发送循环里
+    epd_transport_config_t tcfg = { .chunk_size = 3, .queue_depth = 0 };
+    epd_transport_stats_t tstats;
+    epd_transport_deinit(dev);
+    HOST_CHECK(epd_transport_init(dev, &tcfg) == ESP_OK, "块大小3初始化失败");
+    epd_transport_reset_stats(dev);
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 8, 8, 32, 8, EPD_COLOR_BLACK, true);
+    dev->display_buffer(dev, fb->buffer, EPD_UPDATE_FULL);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "块大小3时图像不一致");
+    epd_transport_get_stats(dev, &tstats);
+    HOST_CHECK(tstats.total_chunks * 4 >= tstats.total_bytes, "块大小3: %u个事务发送%llu字节",
+               (unsigned)tstats.total_chunks, (unsigned long long)tstats.total_bytes);
+    epd_transport_deinit(dev);
+    epd_transport_init(dev, NULL);
+    
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 8, 8, 120, 60, EPD_COLOR_BLACK, false);
+    epd_draw_circle(fb->buffer, fb->width, fb->height, 220, 64, 40, EPD_COLOR_BLACK, true);
+    epd_draw_text(fb->buffer, fb->width, fb->height, "EPD HOST", 16, 90, EPD_COLOR_BLACK, 2);
+    
+    epd_fb_commit_t path;
+    esp_err_t err = epd_fb_commit(fb, &path);
+    HOST_CHECK(err == ESP_OK, "全刷提交返回 %d", err);
+    HOST_CHECK(path == EPD_FB_COMMIT_FULL, "首次提交应为全刷, 实际 %d", path);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "全刷后面板图像不一致");
+    
+    epd_virtual_get_stats(panel, &stats);
+    HOST_CHECK(stats.out_of_range == 0, "有 %u 字节越过RAM边界", stats.out_of_range);
+}
+
+static void test_partial_refresh(epd_device_t *dev, epd_virtual_panel_t *panel, epd_fb_t *fb) {
+    if (fb->red) {
+        // 三色屏不支持局刷, 由test_red_plane覆盖
+        return;
+    }
+    
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 200, 100, 40, 16, EPD_COLOR_BLACK, true);
+    
+    epd_fb_commit_t path;
+    esp_err_t err = epd_fb_commit(fb, &path);
+    HOST_CHECK(err == ESP_OK, "局刷提交返回 %d", err);
+    HOST_CHECK(path == EPD_FB_COMMIT_PARTIAL, "应为局刷, 实际 %d", path);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "局刷后面板图像不一致");
+    
+    // 相距很远的两个窗口: 是否合并取决于实测总线速度, 不论哪种都只激活一次
+    epd_virtual_stats_t before, after;
+    epd_rect_t rects[2] = {
+        { 0, 0, 16, 8 },
+        { fb->width - 16, fb->height - 8, 16, 8 },
+    };
+    uint8_t percent = fb->full_refresh_percent;
+    fb->full_refresh_percent = 101;   // 合并为整屏窗口时也不转为全刷
+    for (int i = 0; i < 2; i++) {
+        epd_draw_rect(fb->buffer, fb->width, fb->height, rects[i].x, rects[i].y,
+                      rects[i].width, rects[i].height, EPD_COLOR_BLACK, true);
+    }
+    epd_virtual_get_stats(panel, &before);
+    err = epd_fb_commit(fb, &path);
+    epd_virtual_get_stats(panel, &after);
+    fb->full_refresh_percent = percent;
+    HOST_CHECK(err == ESP_OK, "多窗口提交返回 %d", err);
+    HOST_CHECK(path == EPD_FB_COMMIT_MULTI || path == EPD_FB_COMMIT_PARTIAL,
+               "应为局刷, 实际 %d", path);
+    HOST_CHECK(after.activations - before.activations == 1, "多窗口提交激活了 %u 次",
+               after.activations - before.activations);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "多窗口提交后面板图像不一致");
+    
+    // 直接调用display_windows: 两个窗口分别写入RAM, 只激活一次
+    for (int pass = 0; pass < 2; pass++) {
+        epd_color_t color = pass ? EPD_COLOR_BLACK : EPD_COLOR_WHITE;
+        for (int i = 0; i < 2; i++) {
+            epd_draw_rect(fb->buffer, fb->width, fb->height, rects[i].x, rects[i].y,
+                          rects[i].width, rects[i].height, color, true);
+        }
+        epd_virtual_get_stats(panel, &before);
+        err = dev->display_windows(dev, fb->buffer, rects, 2, EPD_UPDATE_PARTIAL);
+        epd_virtual_get_stats(panel, &after);
+        HOST_CHECK(err == ESP_OK, "多窗口局刷返回 %d", err);
+        HOST_CHECK(after.activations - before.activations == 1, "多窗口局刷激活了 %u 次",
+                   after.activations - before.activations);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer),
+                   "多窗口局刷后面板图像不一致");
+    }
+}
+
+// 登记表满时创建失败, 而不是返回一个绘图不记录脏区的帧缓冲区
+static void test_registry(epd_device_t *dev, epd_fb_t *fb) {
+    epd_fb_t *extra[EPD_FB_MAX_INSTANCES];
+    int n = 0;
+    
+    while (n < EPD_FB_MAX_INSTANCES && (extra[n] = epd_fb_create(dev)) != NULL) {
+        HOST_CHECK(epd_fb_from_buffer(extra[n]->buffer) == extra[n], "第%d个帧缓冲区未登记", n);
+        n++;
+    }
+    HOST_CHECK(n == EPD_FB_MAX_INSTANCES - 1, "登记表满后应创建失败, 已有1个时又创建了 %d 个", n);
+    
+    while (n > 0) {
+        epd_fb_destroy(extra[--n]);
+    }
+    HOST_CHECK(epd_fb_from_buffer(fb->buffer) == fb, "原帧缓冲区丢失登记");
+    
+    epd_fb_t *again = epd_fb_create(dev);
+    HOST_CHECK(again != NULL, "释放后无法再创建");
+    epd_fb_destroy(again);
+}
+
+static void test_red_plane(epd_virtual_panel_t *panel, epd_fb_t *fb) {
+    if (!fb->red) {
+        return;
+    }
+    
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 140, 10, 40, 40, EPD_COLOR_RED, true);
+    
+    epd_fb_commit_t path;
+    esp_err_t err = epd_fb_commit(fb, &path);
+    HOST_CHECK(err == ESP_OK, "红色平面提交返回 %d", err);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "黑白平面不一致");
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_RED, fb->red), "红色平面不一致");
+}
+
+// 逐像素参考实现: 顺时针旋转rotation*90度
+static void rotate_reference(const uint8_t *src, uint16_t w, uint16_t h,
+                             uint8_t *dst, uint8_t rotation) {
+    uint16_t dw = (rotation & 1) ? h : w;
+    uint16_t dh = (rotation & 1) ? w : h;
+    
+    memset(dst, 0, (uint32_t)dw * dh / 8);
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x++) {
+            if (!(src[y * (w / 8) + x / 8] & (0x80 >> (x % 8)))) {
+                continue;
+            }
+            uint16_t dx = x, dy = y;
+            switch (rotation) {
+                case 1: dx = h - 1 - y; dy = x; break;
+                case 2: dx = w - 1 - x; dy = h - 1 - y; break;
+                case 3: dx = y; dy = w - 1 - x; break;
+            }
+            dst[dy * (dw / 8) + dx / 8] |= 0x80 >> (dx % 8);
+        }
+    }
+}
+
+static void test_rotation(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    uint32_t size = epd_virtual_get_plane_size(panel);
+    uint8_t *logical = malloc(size);
+    uint8_t *expected = malloc(size);
+    uint8_t *rect = malloc(size);
+    uint8_t *check = malloc(size);
+    if (!logical || !expected || !rect || !check) {
+        HOST_CHECK(false, "内存分配失败");
+        goto done;
+    }
+    
+    for (uint8_t rot = 0; rot < 4; rot++) {
+        esp_err_t err = dev->set_rotation(dev, rot);
+        HOST_CHECK(err == ESP_OK, "set_rotation(%d)返回 %d", rot, err);
+    
+        uint16_t w = dev->info.width;
+        uint16_t h = dev->info.height;
+    
+        // 非对称内容: 左上角实心块 + 文字 + 对角线
+        memset(logical, 0xFF, size);
+        epd_draw_rect(logical, w, h, 0, 0, 24, 16, EPD_COLOR_BLACK, true);
+        epd_draw_text(logical, w, h, "R", 30, 4, EPD_COLOR_BLACK, 1);
+        epd_draw_line(logical, w, h, 0, 0, w - 1, h - 1, EPD_COLOR_BLACK);
+    
+        epd_rotate_buffer(logical, w, h, expected, rot);
+        rotate_reference(logical, w, h, check, rot);
+        HOST_CHECK(memcmp(expected, check, size) == 0, "旋转%d: 转置结果与参考实现不一致", rot);
+    
+        err = dev->display_buffer(dev, logical, EPD_UPDATE_FULL);
+        HOST_CHECK(err == ESP_OK, "旋转%d: display_buffer返回 %d", rot, err);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected), "旋转%d: 全刷图像不一致", rot);
+    
+        // 局刷: x和宽度按字节对齐, y和高度任意
+        uint16_t rx = 16, ry = 21, rw = 40, rh = 13;
+        epd_draw_rect(logical, w, h, rx, ry, rw, rh, EPD_COLOR_BLACK, true);
+        epd_draw_rect(logical, w, h, rx + 4, ry + 3, 8, 4, EPD_COLOR_WHITE, true);
+        for (uint16_t r = 0; r < rh; r++) {
+            memcpy(rect + r * (rw / 8), logical + (ry + r) * (w / 8) + rx / 8, rw / 8);
+        }
+    
+        err = dev->display_partial(dev, rect, rx, ry, rw, rh);
+        HOST_CHECK(err == ESP_OK, "旋转%d: display_partial返回 %d", rot, err);
+        rotate_reference(logical, w, h, expected, rot);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected), "旋转%d: 局刷图像不一致", rot);
+    
+        // 窗口局刷: 直接传整屏缓冲区, 矩形不对齐时向外扩展到字节边界
+        uint16_t wx = 43, wy = 50, ww = 21, wh = 30;
+        epd_draw_rect(logical, w, h, wx, wy, ww, wh, EPD_COLOR_BLACK, false);
+        epd_draw_line(logical, w, h, wx, wy, wx + ww - 1, wy + wh - 1, EPD_COLOR_BLACK);
+        epd_transport_reset_stats(dev);
+    
+        err = dev->display_window(dev, logical, wx, wy, ww, wh, EPD_UPDATE_PARTIAL);
+        HOST_CHECK(err == ESP_OK, "旋转%d: display_window返回 %d", rot, err);
+        rotate_reference(logical, w, h, expected, rot);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected), "旋转%d: 窗口局刷图像不一致", rot);
+    
+        epd_transport_stats_t stats;
+        epd_transport_get_stats(dev, &stats);
+        HOST_CHECK(stats.total_transfers == 1, "旋转%d: 窗口数据分%u次发送",
+                   rot, (unsigned)stats.total_transfers);
+    }
+    
+    // 90/270度RAM镜像: 清屏同步填充镜像; 0度写入后镜像失效, 窗口局刷改为整屏写入
+    for (uint8_t rot = 1; rot < 4; rot += 2) {
+        dev->set_rotation(dev, rot);
+        uint16_t w = dev->info.width;
+        uint16_t h = dev->info.height;
+    
+        dev->clear(dev, EPD_COLOR_BLACK);
+        memset(logical, 0x00, size);
+        epd_draw_rect(logical, w, h, 43, 50, 21, 30, EPD_COLOR_WHITE, true);
+        esp_err_t err = dev->display_window(dev, logical, 43, 50, 21, 30, EPD_UPDATE_PARTIAL);
+        rotate_reference(logical, w, h, expected, rot);
+        HOST_CHECK(err == ESP_OK && image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected),
+                   "旋转%d: 清屏后窗口局刷图像不一致", rot);
+    
+        dev->set_rotation(dev, 0);
+        memset(logical, 0xFF, size);
+        dev->display_buffer(dev, logical, EPD_UPDATE_FULL);
+        dev->set_rotation(dev, rot);
+    
+        epd_draw_rect(logical, w, h, 43, 50, 21, 30, EPD_COLOR_BLACK, true);
+        err = dev->display_partial(dev, rect, 16, 21, 40, 13);
+        HOST_CHECK(err == ESP_ERR_INVALID_STATE, "旋转%d: 镜像失效时不对齐的局刷返回 %d", rot, err);
+        err = dev->display_window(dev, logical, 43, 50, 21, 30, EPD_UPDATE_PARTIAL);
+        rotate_reference(logical, w, h, expected, rot);
+        HOST_CHECK(err == ESP_OK && image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected),
+                   "旋转%d: 镜像失效后窗口局刷图像不一致", rot);
+    }
+    
+    dev->set_rotation(dev, 0);
+    
+done:
+    free(logical);
+    free(expected);
+    free(rect);
+    free(check);
+}
+
+static void test_epf(epd_device_t *dev, epd_virtual_panel_t *panel, epd_fb_t *fb) {
+    // 随机数据(几乎无重复)与长重复混合, 覆盖字面量/短重复/长重复三种编码
+    uint32_t len = fb->size;
+    uint8_t *raw = malloc(len);
+    uint8_t *enc = malloc(epf_encode_bound(len));
+    uint8_t *dec = malloc(len);
+    if (!raw || !enc || !dec) {
+        HOST_CHECK(false, "内存分配失败");
+        goto done;
+    }
+    
+    srand(7);
+    for (uint32_t i = 0; i < len; i++) {
+        raw[i] = (i < len / 3) ? (uint8_t)rand() : (i < len / 2 ? 0xA5 : (i / 97) & 1 ? 0xFF : 0x00);
+    }
+    uint32_t enc_len = epf_encode_plane(raw, len, enc);
+    HOST_CHECK(epd_epf_decode_plane(enc, enc_len, dec, len) == ESP_OK &&
+               memcmp(raw, dec, len) == 0, "EPF编解码往返不一致");
+    
+    // 整帧: 解码直接进入SPI传输
+    for (uint8_t rot = 0; rot < 4; rot += 2) {
+        dev->set_rotation(dev, rot);
+    
+        uint32_t frame_size;
+        uint8_t *frame = epf_encode_frame(fb->width, fb->height, fb->buffer, fb->red, &frame_size);
+        HOST_CHECK(frame != NULL, "EPF编码失败");
+        if (!frame) {
+            break;
+        }
+    
+        esp_err_t err = epd_display_epf(dev, frame, frame_size, EPD_UPDATE_FULL);
+        HOST_CHECK(err == ESP_OK, "epd_display_epf返回 %d", err);
+    
+        epd_rotate_buffer(fb->buffer, fb->width, fb->height, dec, rot);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, dec), "旋转%d: EPF黑白平面不一致", rot);
+        if (fb->red) {
+            epd_rotate_buffer(fb->red, fb->width, fb->height, dec, rot);
+            HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_RED, dec), "旋转%d: EPF红色平面不一致", rot);
+        }
+    
+        if (rot == 0) {
+            printf("EPF: %u -> %u 字节\n", (unsigned)(fb->size * (fb->red ? 2 : 1)),
+                   (unsigned)frame_size);
+        }
+    
+        // 截断的数据必须在发送前被拒绝
+        err = epd_display_epf(dev, frame, frame_size - 1, EPD_UPDATE_FULL);
+        HOST_CHECK(err != ESP_OK, "截断的EPF未被拒绝");
+        free(frame);
+    }
+    
+    dev->set_rotation(dev, 0);
+    
+done:
+    free(raw);
+    free(enc);
+    free(dec);
+}
+
+// 逐像素参考实现: 与epd_font_draw的行合并结果对比
+static void font_reference(uint8_t *buf, uint16_t w, uint16_t h, const epd_font_t *font,
+                           const char *text, uint32_t x, uint32_t y, bool ink_white,
+                           uint8_t scale) {
+    for (const char *p = text; *p; p++) {
+        uint8_t code = (uint8_t)*p;
+        if (code < font->first_char || code > font->last_char) {
+            code = font->default_char;
+        }
+        uint8_t idx = code - font->first_char;
+        epd_font_glyph_t g = font->glyphs ? font->glyphs[idx] : (epd_font_glyph_t){
+            .offset = idx * font->height * font->row_bytes,
+            .width = font->fixed_width, .advance = font->fixed_advance };
+    
+        for (uint32_t r = 0; r < (uint32_t)font->height * scale; r++) {
+            const uint8_t *row = font->bitmap + g.offset + (r / scale) * font->row_bytes;
+            for (uint32_t c = 0; c < (uint32_t)g.width * scale; c++) {
+                uint32_t sx = g.left + c / scale;
+                uint32_t px = x + c, py = y + r;
+                if (!(row[sx / 8] & (0x80 >> (sx % 8))) || px >= w || py >= h) {
+                    continue;
+                }
+                if (ink_white) {
+                    buf[py * (w / 8) + px / 8] |= 0x80 >> (px % 8);
+                } else {
+                    buf[py * (w / 8) + px / 8] &= ~(0x80 >> (px % 8));
+                }
+            }
+        }
+        x += (uint32_t)g.advance * scale;
+    }
+}
+
+// 多个任务同时绘制文字: 共享的字形缓存不断淘汰时, 每个任务画出的字形仍应正确
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint8_t scale;
+    const char *text;
+    const uint8_t *expected;
+    int mismatches;
+    SemaphoreHandle_t done;
+} font_task_ctx_t;
+
+static void font_task(void *arg) {
+    font_task_ctx_t *ctx = (font_task_ctx_t *)arg;
+    uint32_t size = (uint32_t)ctx->width * ctx->height / 8;
+    uint8_t *buf = malloc(size);
+    
+    for (int i = 0; buf && i < 200; i++) {
+        memset(buf, 0xFF, size);
+        epd_font_draw(buf, ctx->width, ctx->height, &epd_font_5x7_prop, ctx->text, 3, 5,
+                      EPD_COLOR_BLACK, ctx->scale);
+        if (memcmp(buf, ctx->expected, size) != 0) {
+            ctx->mismatches++;
+        }
+    }
+    free(buf);
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+static void test_font(epd_device_t *dev) {
+    uint16_t w = dev->info.width;
+    uint16_t h = dev->info.height;
+    uint32_t size = (uint32_t)w * h / 8;
+    uint8_t *a = malloc(size);
+    uint8_t *b = malloc(size);
+    if (!a || !b) {
+        HOST_CHECK(false, "内存分配失败");
+        goto done;
+    }
+    
+    // 对齐/非对齐x、越过右边和下边界、黑白两色
+    static const struct { uint16_t x, y; uint8_t scale; } cases[] = {
+        { 0, 0, 1 }, { 8, 10, 2 }, { 13, 40, 1 }, { 27, 60, 3 },
+        { 250, 100, 4 }, { 5, 120, 2 }, { 91, 3, 9 },
+    };
+    const char *text = "Proportional {Wj} 0123";
+    
+    for (int f = 0; f < 2; f++) {
+        const epd_font_t *font = f ? &epd_font_5x7_prop : &epd_font_5x7;
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            for (int white = 0; white < 2; white++) {
+                memset(a, white ? 0x00 : 0xFF, size);
+                memset(b, white ? 0x00 : 0xFF, size);
+                epd_font_draw(a, w, h, font, text, cases[i].x, cases[i].y,
+                              white ? EPD_COLOR_WHITE : EPD_COLOR_BLACK, cases[i].scale);
+                font_reference(b, w, h, font, text, cases[i].x, cases[i].y, white,
+                               cases[i].scale);
+                HOST_CHECK(memcmp(a, b, size) == 0, "字体%s x=%u 倍数%u: 与参考实现不一致",
+                           font->name, cases[i].x, cases[i].scale);
+            }
+        }
+    }
+    
+    uint16_t line_h;
+    HOST_CHECK(epd_font_measure(&epd_font_5x7, "Hello", 2, &line_h) == 58 && line_h == 14,
+               "等宽字体测量结果错误");
+    HOST_CHECK(epd_font_measure(&epd_font_5x7_prop, "il ", 1, NULL) == 7,
+               "比例字体测量结果错误");
+    
+    // 重复绘制相同文字应全部命中缓存
+    epd_font_cache_stats_t before, after;
+    epd_font_cache_clear();
+    epd_font_draw(a, w, h, &epd_font_5x7_prop, "cache", 0, 0, EPD_COLOR_BLACK, 2);
+    epd_font_cache_get_stats(&before);
+    
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < 100; i++) {
+        epd_font_draw(a, w, h, &epd_font_5x7_prop, "cache", (uint16_t)(i % 37), 20,
+                      EPD_COLOR_BLACK, 2);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    epd_font_cache_get_stats(&after);
+    
+    HOST_CHECK(after.misses == before.misses && after.hits - before.hits == 500,
+               "缓存命中 %u, 未命中 %u", (unsigned)(after.hits - before.hits),
+               (unsigned)(after.misses - before.misses));
+    printf("字体: 100行缓存文字 %lld us, 缓存 %u 个字形\n", (long long)elapsed, after.entries);
+    
+    // 两个任务的字形合计超过缓存容量, 查找、填充和淘汰交错进行
+    font_task_ctx_t ctx[2] = {
+        { w, h, 2, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", a, 0, xSemaphoreCreateBinary() },
+        { w, h, 3, "abcdefghijklmnopqrstuvwxyz", b, 0, xSemaphoreCreateBinary() },
+    };
+    for (int i = 0; i < 2; i++) {
+        uint8_t *expected = i ? b : a;
+        memset(expected, 0xFF, size);
+        font_reference(expected, w, h, &epd_font_5x7_prop, ctx[i].text, 3, 5, false,
+                       ctx[i].scale);
+    }
+    for (int i = 0; i < 2; i++) {
+        xTaskCreate(font_task, "font_task", 4096, &ctx[i], 5, NULL);
+    }
+    for (int i = 0; i < 2; i++) {
+        xSemaphoreTake(ctx[i].done, portMAX_DELAY);
+        vSemaphoreDelete(ctx[i].done);
+        HOST_CHECK(ctx[i].mismatches == 0, "并发绘制: 任务%d有 %d 次结果错误", i,
+                   ctx[i].mismatches);
+    }
+    
+done:
+    free(a);
+    free(b);
+}
+
+// 温度补偿: 区间选择、区间未变时不重新装载波形、自定义区间LUT和外部温度
+static void test_temperature(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    HOST_CHECK(dev->info.capabilities & EPD_CAP_TEMP_COMPENSATION, "未声明温度补偿能力");
+    
+    // 没有MISO时读不到控制器温度, 只有提供外部温度后才声明温度补偿
+    epd_virtual_config_t cfg;
+    epd_virtual_default_config(&cfg);
+    cfg.pins.spi_miso = -1;
+    cfg.pins.spi_cs = 25;
+    cfg.pins.dc_pin = 32;
+    cfg.pins.rst_pin = 14;
+    cfg.pins.busy_pin = 34;
+    epd_virtual_panel_t *no_miso_panel = NULL;
+    epd_device_t *no_miso = epd_virtual_create(&cfg, &no_miso_panel);
+    if (no_miso && no_miso->init(no_miso) == ESP_OK) {
+        HOST_CHECK(!(no_miso->info.capabilities & EPD_CAP_TEMP_COMPENSATION),
+                   "无MISO时不应声明温度补偿");
+        no_miso->set_temperature(no_miso, 10);
+        HOST_CHECK(no_miso->info.capabilities & EPD_CAP_TEMP_COMPENSATION,
+                   "提供外部温度后应声明温度补偿");
+        no_miso->set_temperature(no_miso, EPD_TEMP_AUTO);
+        HOST_CHECK(!(no_miso->info.capabilities & EPD_CAP_TEMP_COMPENSATION),
+                   "恢复自动测量后不应声明温度补偿");
+    } else {
+        HOST_CHECK(false, "无MISO面板初始化失败");
+    }
+    epd_virtual_destroy(no_miso, no_miso_panel);
+    
+    uint32_t size = epd_virtual_get_plane_size(panel);
+    uint8_t *frame = malloc(size);
+    if (!frame) {
+        HOST_CHECK(false, "内存分配失败");
+        return;
+    }
+    memset(frame, 0xAA, size);
+    
+    int8_t temp = 0;
+    epd_virtual_stats_t before, after;
+    
+    // 默认区间: 25度与18度同属一个区间, 不重新装载波形
+    epd_virtual_set_temperature(panel, 25);
+    esp_err_t err = dev->read_temperature(dev, &temp);
+    HOST_CHECK(err == ESP_OK && temp == 25, "读取温度返回 %d, 温度 %d", err, temp);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    
+    epd_virtual_set_temperature(panel, 18);
+    dev->read_temperature(dev, &temp);
+    epd_virtual_get_stats(panel, &before);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    dev->display_buffer(dev, frame, EPD_UPDATE_PARTIAL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.otp_lut_loads == before.otp_lut_loads && after.lut_writes == before.lut_writes,
+               "同一温度区间内重新装载了波形");
+    
+    // 低温: 切换区间, 按代表温度从OTP装载
+    epd_virtual_set_temperature(panel, -3);
+    dev->read_temperature(dev, &temp);
+    HOST_CHECK(temp == -3, "负温度读数为 %d", temp);
+    epd_virtual_get_stats(panel, &before);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.otp_lut_loads - before.otp_lut_loads == 1 && after.waveform_temp_c == 0,
+               "低温区间: 装载 %u 次, 波形温度 %d",
+               after.otp_lut_loads - before.otp_lut_loads, after.waveform_temp_c);
+    
+    epd_temp_band_stats_t cold, room;
+    dev->get_temp_band_stats(dev, 0, &cold);
+    dev->get_temp_band_stats(dev, 2, &room);
+    HOST_CHECK(cold.refreshes == 2 && cold.lut_loads == 1 && room.refreshes >= 3,
+               "区间统计: 低温 %u 次, 常温 %u 次", (unsigned)cold.refreshes,
+               (unsigned)room.refreshes);
+    
+    // 自定义区间: 低温使用专用LUT, 外部温度代替测量
+    static const uint8_t cold_lut[30] = { 0x48, 0x48, [20] = 0x22 };
+    const epd_temp_band_t bands[] = {
+        { .min_c = -40, .lut = cold_lut },
+        { .min_c = 10, .lut_temp_c = 25 },
+    };
+    err = dev->set_temp_bands(dev, bands, 2);
+    HOST_CHECK(err == ESP_OK, "set_temp_bands返回 %d", err);
+    const epd_temp_band_t unsorted[] = { { .min_c = 10 }, { .min_c = 0 } };
+    HOST_CHECK(dev->set_temp_bands(dev, unsorted, 2) == ESP_ERR_INVALID_ARG, "未排序的区间被接受");
+    
+    dev->set_temperature(dev, 2);
+    epd_virtual_get_stats(panel, &before);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.lut_writes - before.lut_writes == 1 &&
+               after.custom_lut_updates - before.custom_lut_updates == 2,
+               "自定义低温LUT: 写入 %u 次, 刷新 %u 次", after.lut_writes - before.lut_writes,
+               after.custom_lut_updates - before.custom_lut_updates);
+    
+    dev->set_temperature(dev, 20);
+    epd_virtual_get_stats(panel, &before);
+    dev->display_buffer(dev, frame, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.custom_lut_updates == before.custom_lut_updates &&
+               after.otp_lut_loads - before.otp_lut_loads == 1 && after.waveform_temp_c == 25,
+               "离开自定义LUT区间后未恢复OTP波形");
+    
+    for (uint8_t b = 0; b < 2; b++) {
+        epd_temp_band_stats_t st;
+        dev->get_temp_band_stats(dev, b, &st);
+        printf("温度区间 >=%d度: 装载 %u 次, 刷新 %u 次, 平均 %u us\n", st.min_c,
+               (unsigned)st.lut_loads, (unsigned)st.refreshes, (unsigned)st.avg_us);
+    }
+    
+    // 恢复默认区间和温度测量
+    dev->set_temp_bands(dev, NULL, 0);
+    dev->set_temperature(dev, EPD_TEMP_AUTO);
+    epd_virtual_set_temperature(panel, 25);
+    free(frame);
+}
+
+// 4级灰度: 各次激活的位平面、自定义LUT的装载与恢复、刷新代价统计
+static void test_gray(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    if (!(dev->info.capabilities & EPD_CAP_GRAYSCALE)) {
+        HOST_CHECK(dev->set_display_mode(dev, EPD_DISPLAY_GRAY4) == ESP_ERR_NOT_SUPPORTED,
+                   "不支持灰度的面板接受了GRAY4模式");
+        return;
+    }
+    
+    uint16_t w = dev->info.width;
+    uint16_t h = dev->info.height;
+    uint32_t size = (uint32_t)w * h / 8;
+    uint8_t *gray = malloc(EPD_GRAY4_BUFFER_SIZE(w, h));
+    uint8_t *plane = malloc(size);
+    uint8_t *expected = malloc(size);
+    if (!gray || !plane || !expected) {
+        HOST_CHECK(false, "内存分配失败");
+        goto done;
+    }
+    
+    // 4个竖条, 从左到右由黑到白, 左上角一个白块用于区分方向
+    memset(gray, 0, EPD_GRAY4_BUFFER_SIZE(w, h));
+    memset(plane, 0xFF, size);
+    for (uint16_t y = 0; y < h; y++) {
+        for (uint16_t x = 0; x < w; x++) {
+            uint8_t level = (x < 16 && y < 8) ? 3 : (uint32_t)x * EPD_GRAY4_LEVELS / w;
+            gray[(y * w + x) / 4] |= level << (6 - 2 * (x % 4));
+            if (level < 2) {
+                plane[(y * w + x) / 8] &= ~(0x80 >> (x % 8));
+            }
+        }
+    }
+    
+    esp_err_t err = dev->set_display_mode(dev, EPD_DISPLAY_GRAY4);
+    HOST_CHECK(err == ESP_OK, "set_display_mode(GRAY4)返回 %d", err);
+    HOST_CHECK(dev->display_partial(dev, plane, 0, 0, 8, 8) == ESP_ERR_INVALID_STATE,
+               "灰度模式下局刷未被拒绝");
+    
+    for (uint8_t rot = 0; rot < 4; rot += 2) {
+        dev->set_rotation(dev, rot);
+    
+        epd_virtual_stats_t before, after;
+        epd_virtual_get_stats(panel, &before);
+        err = dev->display_buffer(dev, gray, EPD_UPDATE_FULL);
+        epd_virtual_get_stats(panel, &after);
+    
+        // 最后一次激活的位平面为灰度>=2
+        rotate_reference(plane, w, h, expected, rot);
+        HOST_CHECK(err == ESP_OK, "旋转%d: 灰度显示返回 %d", rot, err);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected),
+                   "旋转%d: 灰度最后一个位平面不一致", rot);
+        HOST_CHECK(after.custom_lut_updates - before.custom_lut_updates == 2 &&
+                   after.lut_writes - before.lut_writes == 1,
+                   "旋转%d: 自定义LUT刷新 %u 次, 写入LUT %u 次", rot,
+                   after.custom_lut_updates - before.custom_lut_updates,
+                   after.lut_writes - before.lut_writes);
+    }
+    
+    // 块大小小于LUT长度: 30字节的LUT参数段不能写出传输层的缓冲区
+    epd_transport_config_t tcfg = { .chunk_size = 16, .queue_depth = 0 };
+    epd_virtual_stats_t before, after;
+    epd_transport_deinit(dev);
+    HOST_CHECK(epd_transport_init(dev, &tcfg) == ESP_OK, "块大小16初始化失败");
+    epd_virtual_get_stats(panel, &before);
+    err = dev->display_buffer(dev, gray, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(err == ESP_OK && image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected),
+               "块大小16: 灰度显示返回 %d 或图像不一致", err);
+    HOST_CHECK(after.lut_writes - before.lut_writes == 1, "块大小16: 写入LUT %u 次",
+               after.lut_writes - before.lut_writes);
+    epd_transport_deinit(dev);
+    epd_transport_init(dev, NULL);
+    
+    epd_refresh_cost_t cost;
+    dev->get_refresh_cost(dev, EPD_DISPLAY_GRAY4, &cost);
+    HOST_CHECK(cost.refreshes == 3 && cost.passes == 3 && cost.ram_bytes == 3 * size,
+               "灰度刷新代价: %u次, 每帧%u次激活 %u字节", (unsigned)cost.refreshes,
+               cost.passes, (unsigned)cost.ram_bytes);
+    
+    // 回到1bpp: 普通刷新前必须恢复OTP波形
+    dev->set_rotation(dev, 0);
+    err = dev->set_display_mode(dev, EPD_DISPLAY_1BPP);
+    HOST_CHECK(err == ESP_OK, "set_display_mode(1BPP)返回 %d", err);
+    
+    epd_virtual_get_stats(panel, &before);
+    err = dev->display_buffer(dev, plane, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(err == ESP_OK && image_matches(panel, EPD_VIRTUAL_PLANE_BW, plane),
+               "恢复1bpp后显示不一致");
+    HOST_CHECK(after.custom_lut_updates == before.custom_lut_updates,
+               "恢复1bpp后仍使用自定义LUT刷新");
+    
+    epd_refresh_cost_t mono;
+    dev->get_refresh_cost(dev, EPD_DISPLAY_1BPP, &mono);
+    printf("刷新代价: 1bpp %u us (%u 字节), 4级灰度 %u us (%u次激活, %u 字节)\n",
+           (unsigned)mono.last_us, (unsigned)mono.ram_bytes, (unsigned)cost.avg_us,
+           cost.passes, (unsigned)cost.ram_bytes);
+    
+done:
+    free(gray);
+    free(plane);
+    free(expected);
+}
+
+// 抖动输入: value < 256时为常量灰度, 否则为RGB渐变 (R随x, G随y)
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint16_t value;
+    bool rgb;
+} dither_input_t;
+
+static void dither_read_row(void *ctx, uint16_t y, uint8_t *dst) {
+    const dither_input_t *in = (const dither_input_t *)ctx;
+    
+    for (uint16_t x = 0; x < in->width; x++) {
+        uint8_t r = in->value < 256 ? in->value : (uint32_t)x * 255 / (in->width - 1);
+        uint8_t g = in->value < 256 ? in->value : (uint32_t)y * 255 / (in->height - 1);
+        uint8_t b = in->value < 256 ? in->value : 128;
+        if (in->rgb) {
+            dst[x * 3] = r;
+            dst[x * 3 + 1] = g;
+            dst[x * 3 + 2] = b;
+        } else {
+            dst[x] = (r + g) / 2;
+        }
+    }
+}
+
+static uint32_t count_white(const uint8_t *buf, uint32_t size) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        n += __builtin_popcount(buf[i]);
+    }
+    return n;
+}
+
+// 抖动: 流式显示与整幅结果一致, 常量灰度保持平均亮度
+static void test_dither(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    static const epd_dither_method_t methods[] = {
+        EPD_DITHER_THRESHOLD, EPD_DITHER_BAYER, EPD_DITHER_FLOYD_STEINBERG, EPD_DITHER_ATKINSON,
+    };
+    uint16_t w = dev->info.width;
+    uint16_t h = dev->info.height;
+    uint32_t size = (uint32_t)w * h / 8;
+    uint8_t *bw = malloc(size);
+    uint8_t *red = malloc(size);
+    if (!bw || !red) {
+        HOST_CHECK(false, "内存分配失败");
+        goto done;
+    }
+    
+    for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+        for (int bwr = 0; bwr < 2; bwr++) {
+            dither_input_t input = { .width = w, .height = h, .value = 256, .rgb = bwr };
+            epd_dither_config_t config = {
+                .width = w,
+                .height = h,
+                .method = methods[m],
+                .format = bwr ? EPD_DITHER_RGB888 : EPD_DITHER_GRAY8,
+                .palette = bwr ? EPD_DITHER_PALETTE_BWR : EPD_DITHER_PALETTE_BW,
+                .read_row = dither_read_row,
+                .ctx = &input,
+            };
+            epd_dither_t *dither = epd_dither_create(&config);
+            HOST_CHECK(dither != NULL, "创建抖动器失败");
+            if (!dither) {
+                continue;
+            }
+    
+            epd_dither_to_buffer(dither, bw, red);
+    
+            unsigned heap_ops = atomic_load(&s_heap_ops);
+            esp_err_t err = epd_display_dithered(dev, dither, EPD_UPDATE_FULL);
+            heap_ops = atomic_load(&s_heap_ops) - heap_ops;
+    
+            HOST_CHECK(err == ESP_OK, "算法%d: epd_display_dithered返回 %d", methods[m], err);
+            HOST_CHECK(heap_ops == 0, "算法%d: 流式抖动发生 %u 次堆操作", methods[m], heap_ops);
+            HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, bw),
+                       "算法%d 调色板%d: 流式黑白平面与整幅结果不一致", methods[m], bwr);
+            if (bwr && dev->info.color_mode == EPD_MODE_3C) {
+                HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_RED, red),
+                           "算法%d: 流式红色平面与整幅结果不一致", methods[m]);
+            }
+    
+            // 纯黑/纯白不应产生噪点; Bayer和Floyd-Steinberg的白点比例接近灰度值
+            // (Atkinson只扩散6/8的误差, 不保持平均亮度)
+            static const uint8_t levels[] = { 0, 64, 128, 192, 255 };
+            for (size_t l = 0; !bwr && l < sizeof(levels) / sizeof(levels[0]); l++) {
+                input.value = levels[l];
+                epd_dither_to_buffer(dither, bw, NULL);
+                uint32_t white = count_white(bw, size);
+                if (levels[l] == 0 || levels[l] == 255) {
+                    HOST_CHECK(white == (levels[l] ? size * 8 : 0),
+                               "算法%d: 灰度%u产生 %u 个错误像素", methods[m], levels[l],
+                               (unsigned)(levels[l] ? size * 8 - white : white));
+                } else if (methods[m] == EPD_DITHER_BAYER ||
+                           methods[m] == EPD_DITHER_FLOYD_STEINBERG) {
+                    uint32_t expected = (uint64_t)size * 8 * levels[l] / 255;
+                    uint32_t diff = white > expected ? white - expected : expected - white;
+                    HOST_CHECK(diff * 50 <= size * 8, "算法%d: 灰度%u白点 %u, 期望约 %u",
+                               methods[m], levels[l], (unsigned)white, (unsigned)expected);
+                }
+            }
+    
+            epd_dither_destroy(dither);
+        }
+    }
+    
+done:
+    free(bw);
+    free(red);
+}
+
+// 命令列表: 编码合并与局刷设置阶段的SPI事务数
+static void test_cmd_list(epd_device_t *dev) {
+    static const uint8_t window[] = { 0x00, 0x01 };
+    epd_cmd_list_t list;
+    
+    epd_cmd_list_init(&list);
+    epd_cmd_list_add(&list, 0x44, window, sizeof(window));
+    epd_cmd_list_data_u16(&list, 0x0127);
+    epd_cmd_list_cmd(&list, 0x22);
+    epd_cmd_list_cmd(&list, 0x20);
+    HOST_CHECK(list.count == 3 && list.length == 7, "命令列表编码: %u段 %u字节",
+               list.count, list.length);
+    HOST_CHECK(list.data[3] == 0x27 && list.data[4] == 0x01, "16位参数应低字节在前");
+    
+    for (int i = 0; i <= EPD_CMD_LIST_MAX_BYTES; i++) {
+        epd_cmd_list_data(&list, 0);
+    }
+    HOST_CHECK(list.overflow && epd_cmd_list_send(dev, &list) == ESP_ERR_INVALID_SIZE,
+               "溢出的命令列表未被拒绝");
+    
+    // 局刷: 窗口设置 (入口模式、X/Y范围、X/Y指针、写RAM) 与刷新触发各一个列表
+    static uint8_t patch[2 * 16];
+    memset(patch, 0x0F, sizeof(patch));
+    epd_transport_reset_stats(dev);
+    
+    esp_err_t err = dev->display_partial(dev, patch, 16, 16, 16, 16);
+    HOST_CHECK(err == ESP_OK, "display_partial返回 %d", err);
+    
+    epd_transport_stats_t stats;
+    epd_transport_get_stats(dev, &stats);
+    HOST_CHECK(stats.cmd_lists == 2 && stats.cmd_transactions == 14,
+               "局刷设置: %u个列表 %u个事务", (unsigned)stats.cmd_lists,
+               (unsigned)stats.cmd_transactions);
+    printf("局刷设置: %u个命令列表, %u个命令/参数事务\n",
+           (unsigned)stats.cmd_lists, (unsigned)stats.cmd_transactions);
+}
+
+// 帧缓冲池: 借用/归还以及同步、异步刷新路径上不应有任何堆操作
+static void test_pool(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    epd_pool_stats_t before, after;
+    esp_err_t err = epd_pool_get_stats(dev, &before);
+    HOST_CHECK(err == ESP_OK, "帧缓冲池未创建");
+    if (err != ESP_OK) {
+        return;
+    }
+    
+    unsigned heap_ops = atomic_load(&s_heap_ops);
+    
+    uint8_t *bw = epd_pool_borrow(dev, 0);
+    uint8_t *red = epd_pool_borrow(dev, 0);
+    HOST_CHECK(bw && red, "借用帧缓冲区失败");
+    HOST_CHECK(epd_pool_borrow(dev, 0) == NULL || before.count > 2, "池已耗尽时仍借出缓冲区");
+    if (!bw || !red) {
+        return;
+    }
+    
+    uint16_t w = dev->info.width;
+    uint16_t h = dev->info.height;
+    
+    memset(bw, 0xFF, before.buffer_size);
+    memset(red, 0x00, before.buffer_size);
+    epd_draw_rect(bw, w, h, 10, 10, 80, 40, EPD_COLOR_BLACK, true);
+    epd_draw_rect(red, w, h, 120, 20, 40, 40, EPD_COLOR_BLACK, false);
+    
+    err = dev->clear(dev, EPD_COLOR_WHITE);
+    HOST_CHECK(err == ESP_OK, "clear返回 %d", err);
+    HOST_CHECK(memchr(epd_virtual_get_image(panel, EPD_VIRTUAL_PLANE_BW), 0x00,
+                      before.buffer_size) == NULL, "清屏后仍有黑色像素");
+    
+    for (int i = 0; i < 3; i++) {
+        err = dev->display_buffer(dev, bw, EPD_UPDATE_FULL);
+        HOST_CHECK(err == ESP_OK, "display_buffer返回 %d", err);
+    }
+    
+    if (dev->info.color_mode == EPD_MODE_3C) {
+        err = dev->display_planes(dev, bw, red, EPD_UPDATE_FULL);
+        HOST_CHECK(err == ESP_OK, "display_planes返回 %d", err);
+    } else {
+        err = dev->display_window(dev, bw, 8, 8, 96, 48, EPD_UPDATE_PARTIAL);
+        HOST_CHECK(err == ESP_OK, "display_window返回 %d", err);
+    }
+    
+    epd_async_handle_t handle;
+    err = dev->display_buffer_async(dev, bw, EPD_UPDATE_FULL, NULL, NULL, &handle);
+    if (err == ESP_OK) {
+        err = epd_async_wait(handle, EPD_WAIT_FOREVER);
+    }
+    HOST_CHECK(err == ESP_OK, "异步刷新返回 %d", err);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, bw), "池缓冲区刷新后图像不一致");
+    
+    epd_pool_return(dev, bw);
+    epd_pool_return(dev, red);
+    HOST_CHECK(epd_pool_return(dev, bw) != ESP_OK, "重复归还未被拒绝");
+    
+    unsigned hot_ops = atomic_load(&s_heap_ops) - heap_ops;
+    epd_pool_get_stats(dev, &after);
+    
+    HOST_CHECK(hot_ops == 0, "刷新路径发生 %u 次堆操作", hot_ops);
+    HOST_CHECK(after.heap_allocs == before.heap_allocs, "池在借用期间分配了内存");
+    HOST_CHECK(after.in_use == 0 && after.borrows == after.returns, "缓冲区未全部归还");
+    
+    printf("帧缓冲池: %u x %u 字节, 借用 %u, 峰值 %u, 刷新路径堆操作 %u\n",
+           after.count, (unsigned)after.buffer_size, (unsigned)after.borrows,
+           after.peak_in_use, hot_ops);
+}
+
+// 同步调用与异步工作任务并发访问同一设备: 由设备锁串行化, 控制器忙时不应收到数据
+typedef struct {
+    epd_device_t *dev;
+    const uint8_t *buffer;
+    int count;
+    SemaphoreHandle_t done;
+} async_sync_ctx_t;
+
+static void async_sync_task(void *arg) {
+    async_sync_ctx_t *ctx = (async_sync_ctx_t *)arg;
+    
+    for (int i = 0; i < ctx->count; i++) {
+        ctx->dev->display_buffer(ctx->dev, ctx->buffer, EPD_UPDATE_FULL);
+    }
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+static void test_async(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    uint32_t size = epd_virtual_get_plane_size(panel);
+    uint8_t *a = malloc(size);
+    uint8_t *b = malloc(size);
+    epd_virtual_stats_t before, after;
+    
+    if (!a || !b) {
+        HOST_CHECK(false, "分配缓冲区失败");
+        free(a);
+        free(b);
+        return;
+    }
+    memset(a, 0xFF, size);
+    memset(b, 0xFF, size);
+    epd_draw_rect(a, dev->info.width, dev->info.height, 4, 4, 40, 40, EPD_COLOR_BLACK, true);
+    epd_draw_rect(b, dev->info.width, dev->info.height, 60, 4, 40, 40, EPD_COLOR_BLACK, true);
+    epd_virtual_get_stats(panel, &before);
+    
+    // 超时的flush不能占住槽位: 超时次数超过队列长度后提交仍不阻塞
+    for (int i = 0; i < EPD_ASYNC_QUEUE_LEN + 2; i++) {
+        esp_err_t err = dev->display_buffer_async(dev, a, EPD_UPDATE_FULL, NULL, NULL, NULL);
+        HOST_CHECK(err == ESP_OK, "第%d次异步提交返回 %d", i, err);
+        err = epd_async_flush(dev, 0);
+        HOST_CHECK(err == ESP_OK || err == ESP_ERR_TIMEOUT, "flush返回 %d", err);
+    }
+    HOST_CHECK(epd_async_flush(dev, EPD_WAIT_FOREVER) == ESP_OK, "flush失败");
+    
+    // 另一任务同步刷新的同时提交异步刷新
+    async_sync_ctx_t ctx = { .dev = dev, .buffer = b, .count = 4,
+                             .done = xSemaphoreCreateBinary() };
+    xTaskCreate(async_sync_task, "async_sync", 4096, &ctx, 5, NULL);
+    for (int i = 0; i < 4; i++) {
+        dev->display_buffer_async(dev, a, EPD_UPDATE_FULL, NULL, NULL, NULL);
+    }
+    xSemaphoreTake(ctx.done, portMAX_DELAY);
+    vSemaphoreDelete(ctx.done);
+    HOST_CHECK(epd_async_flush(dev, EPD_WAIT_FOREVER) == ESP_OK, "flush失败");
+    
+    dev->display_buffer(dev, b, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, b), "并发刷新后图像不一致");
+    HOST_CHECK(after.written_while_busy == before.written_while_busy,
+               "并发刷新时BUSY期间收到 %u 字节", after.written_while_busy - before.written_while_busy);
+    HOST_CHECK(after.full_updates - before.full_updates == EPD_ASYNC_QUEUE_LEN + 2 + 4 + 4 + 1,
+               "全刷次数 %u", after.full_updates - before.full_updates);
+    
+    free(a);
+    free(b);
+}
+
+// 流水线渲染回调: 每帧填充与序号对应的图案
+typedef struct {
+    uint32_t buffer_size;
+    uint32_t render_ms;         // 模拟渲染耗时
+} pipeline_render_t;
+
+static uint8_t pipeline_pattern(uint32_t seq) {
+    return (uint8_t)(seq * 37 + 1);
+}
+
+static esp_err_t pipeline_render(void *arg, uint8_t *frame, uint32_t seq) {
+    pipeline_render_t *r = (pipeline_render_t *)arg;
+    if (r->render_ms) {
+        vTaskDelay(pdMS_TO_TICKS(r->render_ms));
+    }
+    memset(frame, pipeline_pattern(seq), r->buffer_size);
+    return ESP_OK;
+}
+
+static void test_pipeline(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    static const char *names[] = { "BLOCK", "DROP", "COALESCE" };
+    const uint32_t frames = 12;
+    uint32_t size = epd_virtual_get_plane_size(panel);
+    uint8_t *expected = malloc(size);
+    if (!expected) {
+        HOST_CHECK(false, "内存分配失败");
+        return;
+    }
+    
+    // 渲染耗时与面板刷新相当, 流水线应让两者重叠
+    pipeline_render_t render = { .buffer_size = size, .render_ms = 2 };
+    
+    for (int policy = EPD_PIPELINE_BLOCK; policy <= EPD_PIPELINE_COALESCE; policy++) {
+        epd_pipeline_config_t config = {
+            .render = pipeline_render,
+            .ctx = &render,
+            .ring_size = 2,
+            .policy = policy,
+            .mode = EPD_UPDATE_FULL,
+            .period_ms = policy == EPD_PIPELINE_DROP ? 1 : 0,
+            .max_frames = frames,
+        };
+        render.render_ms = policy == EPD_PIPELINE_BLOCK ? 2 : 0;
+    
+        epd_pipeline_t *pipeline = NULL;
+        int64_t start = esp_timer_get_time();
+        esp_err_t err = epd_pipeline_start(dev, &config, &pipeline);
+        HOST_CHECK(err == ESP_OK, "%s: epd_pipeline_start返回 %d", names[policy], err);
+        if (err != ESP_OK) {
+            continue;
+        }
+    
+        err = epd_pipeline_wait_idle(pipeline, 5000);
+        int64_t elapsed = esp_timer_get_time() - start;
+        HOST_CHECK(err == ESP_OK, "%s: 等待流水线空闲超时", names[policy]);
+    
+        epd_pipeline_stats_t stats;
+        epd_pipeline_get_stats(pipeline, &stats);
+        epd_pipeline_stop(pipeline);
+    
+        HOST_CHECK(stats.rendered == frames, "%s: 提交 %u 帧", names[policy],
+                   (unsigned)stats.rendered);
+        HOST_CHECK(stats.displayed + stats.coalesced == stats.rendered,
+                   "%s: 显示 %u + 合并 %u != 提交 %u", names[policy], (unsigned)stats.displayed,
+                   (unsigned)stats.coalesced, (unsigned)stats.rendered);
+        HOST_CHECK(policy == EPD_PIPELINE_COALESCE || stats.coalesced == 0,
+                   "%s: 出现合并帧", names[policy]);
+        HOST_CHECK(policy == EPD_PIPELINE_DROP || stats.dropped == 0,
+                   "%s: 出现丢弃周期", names[policy]);
+        HOST_CHECK(stats.render_core == EPD_PIPELINE_RENDER_CORE &&
+                   stats.tx_core == EPD_PIPELINE_TX_CORE,
+                   "%s: 任务运行在核 %d/%d", names[policy], stats.render_core, stats.tx_core);
+        HOST_CHECK(stats.render_errors == 0 && stats.display_errors == 0,
+                   "%s: 渲染错误 %u, 刷新错误 %u", names[policy],
+                   (unsigned)stats.render_errors, (unsigned)stats.display_errors);
+    
+        // 最后提交的帧不会被合并, 面板上必须是它
+        memset(expected, pipeline_pattern(frames - 1), size);
+        HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, expected),
+                   "%s: 最终图像不是最后一帧", names[policy]);
+    
+        uint32_t serial_us = stats.avg_render_us + stats.avg_display_us;
+        HOST_CHECK(policy != EPD_PIPELINE_BLOCK ||
+                   (uint64_t)stats.updates_x100 * serial_us > 100000000ULL,
+                   "渲染与刷新没有重叠: %u 次/秒×100, 串行每帧 %u us",
+                   (unsigned)stats.updates_x100, (unsigned)serial_us);
+        printf("流水线 %-8s: %u帧 %lld us, 显示 %u, 丢弃 %u, 合并 %u, 渲染等待 %u, "
+               "发送空闲 %u, %u.%02u次/秒 (串行约 %u次/秒)\n",
+               names[policy], (unsigned)frames, (long long)elapsed, (unsigned)stats.displayed,
+               (unsigned)stats.dropped, (unsigned)stats.coalesced, (unsigned)stats.render_waits,
+               (unsigned)stats.tx_starved, (unsigned)(stats.updates_x100 / 100),
+               (unsigned)(stats.updates_x100 % 100),
+               serial_us ? (unsigned)(1000000 / serial_us) : 0);
+    }
+    
+    // 不限帧数运行后停止, 缓冲区必须全部归还
+    epd_pipeline_config_t config = {
+        .render = pipeline_render,
+        .ctx = &render,
+        .policy = EPD_PIPELINE_COALESCE,
+        .mode = EPD_UPDATE_PARTIAL,
+    };
+    epd_pipeline_t *pipeline = NULL;
+    esp_err_t err = epd_pipeline_start(dev, &config, &pipeline);
+    HOST_CHECK(err == ESP_OK, "epd_pipeline_start返回 %d", err);
+    if (err == ESP_OK) {
+        HOST_CHECK(epd_pipeline_wait_idle(pipeline, 20) == ESP_ERR_TIMEOUT,
+                   "不限帧数时流水线提前结束");
+        epd_pipeline_stop(pipeline);
+    }
+    
+    epd_pool_stats_t pool;
+    epd_pool_get_stats(dev, &pool);
+    HOST_CHECK(pool.in_use == 0, "流水线停止后仍有 %u 个缓冲区未归还", pool.in_use);
+    
+    free(expected);
+}
+
+// 多屏刷新组: 三块面板共用SPI主机, 引脚与主测试面板互不冲突
+#define GROUP_PANELS      3
+#define GROUP_BUSY_MS     40
+
+static void test_group(void) {
+    static const int8_t cs[GROUP_PANELS] = { 25, 26, 27 };
+    static const int8_t dc[GROUP_PANELS] = { 32, 33, 13 };
+    static const int8_t rst[GROUP_PANELS] = { 14, 12, 15 };
+    static const int8_t busy[GROUP_PANELS] = { 34, 35, 36 };
+    
+    epd_virtual_panel_t *panels[GROUP_PANELS] = { 0 };
+    epd_device_t *devs[GROUP_PANELS] = { 0 };
+    uint8_t *frames[GROUP_PANELS] = { 0 };
+    epd_group_t *group = NULL;
+    epd_group_t *serial = NULL;
+    
+    for (int i = 0; i < GROUP_PANELS; i++) {
+        epd_virtual_config_t cfg;
+        epd_virtual_default_config(&cfg);
+        cfg.color_mode = EPD_MODE_1C;
+        cfg.full_busy_ms = GROUP_BUSY_MS;
+        cfg.pins.spi_cs = cs[i];
+        cfg.pins.dc_pin = dc[i];
+        cfg.pins.rst_pin = rst[i];
+        cfg.pins.busy_pin = busy[i];
+    
+        devs[i] = epd_virtual_create(&cfg, &panels[i]);
+        if (!devs[i] || devs[i]->init(devs[i]) != ESP_OK) {
+            HOST_CHECK(false, "面板%d初始化失败", i);
+            goto cleanup;
+        }
+        frames[i] = malloc(epd_virtual_get_plane_size(panels[i]));
+        if (!frames[i]) {
+            HOST_CHECK(false, "内存分配失败");
+            goto cleanup;
+        }
+        memset(frames[i], 0x0F << i, epd_virtual_get_plane_size(panels[i]));
+    }
+    
+    HOST_CHECK(devs[0]->finish_update(devs[0], 0) == ESP_ERR_INVALID_STATE,
+               "未开始分段刷新时finish_update未被拒绝");
+    
+    group = epd_group_create(NULL);
+    epd_group_config_t serial_cfg = { .max_active = 1 };
+    serial = epd_group_create(&serial_cfg);
+    if (!group || !serial) {
+        HOST_CHECK(false, "创建刷新组失败");
+        goto cleanup;
+    }
+    for (int i = 0; i < GROUP_PANELS; i++) {
+        HOST_CHECK(epd_group_add(group, devs[i], NULL) == ESP_OK, "加入面板%d失败", i);
+        HOST_CHECK(epd_group_add(serial, devs[i], NULL) == ESP_OK, "加入面板%d失败", i);
+    }
+    HOST_CHECK(epd_group_add(group, devs[0], NULL) == ESP_ERR_INVALID_ARG, "重复加入面板未被拒绝");
+    
+    // 交错刷新: 总耗时应接近一次刷新, 而不是三次
+    const uint8_t *const buffers[GROUP_PANELS] = { frames[0], frames[1], frames[2] };
+    esp_err_t err = epd_group_display(group, buffers, EPD_UPDATE_FULL);
+    HOST_CHECK(err == ESP_OK, "epd_group_display返回 %d", err);
+    for (int i = 0; i < GROUP_PANELS; i++) {
+        HOST_CHECK(image_matches(panels[i], EPD_VIRTUAL_PLANE_BW, frames[i]),
+                   "面板%d图像不一致", i);
+    }
+    
+    epd_group_stats_t stats;
+    epd_group_get_stats(group, &stats);
+    HOST_CHECK(stats.max_overlap == GROUP_PANELS, "同时刷新的面板数 %u", (unsigned)stats.max_overlap);
+    HOST_CHECK(stats.last_us * 10 < stats.last_serial_us * 6,
+               "交错刷新 %u us, 逐块 %u us", (unsigned)stats.last_us,
+               (unsigned)stats.last_serial_us);
+    printf("刷新组: %d块面板 %u us, 逐块 %u us, 各面板传输 %u/%u/%u us\n", GROUP_PANELS,
+           (unsigned)stats.last_us, (unsigned)stats.last_serial_us,
+           (unsigned)stats.transfer_us[0], (unsigned)stats.transfer_us[1],
+           (unsigned)stats.transfer_us[2]);
+    
+    // 只刷新部分面板, 其余保持原图
+    uint8_t *kept = malloc(epd_virtual_get_plane_size(panels[1]));
+    if (kept) {
+        memcpy(kept, frames[1], epd_virtual_get_plane_size(panels[1]));
+        memset(frames[0], 0xAA, epd_virtual_get_plane_size(panels[0]));
+        memset(frames[1], 0x00, epd_virtual_get_plane_size(panels[1]));
+        const uint8_t *const some[GROUP_PANELS] = { frames[0], NULL, frames[2] };
+        err = epd_group_display(group, some, EPD_UPDATE_FULL);
+        HOST_CHECK(err == ESP_OK, "epd_group_display返回 %d", err);
+        HOST_CHECK(image_matches(panels[0], EPD_VIRTUAL_PLANE_BW, frames[0]), "面板0未更新");
+        HOST_CHECK(image_matches(panels[1], EPD_VIRTUAL_PLANE_BW, kept), "未选中的面板被刷新");
+        free(kept);
+    }
+    
+    // 并发上限为1时逐块刷新
+    err = epd_group_display(serial, buffers, EPD_UPDATE_FULL);
+    HOST_CHECK(err == ESP_OK, "epd_group_display返回 %d", err);
+    epd_group_get_stats(serial, &stats);
+    HOST_CHECK(stats.max_overlap == 1 && stats.last_us >= GROUP_PANELS * GROUP_BUSY_MS * 900,
+               "并发上限未生效: 峰值 %u, %u us", (unsigned)stats.max_overlap,
+               (unsigned)stats.last_us);
+    printf("刷新组 (并发上限1): %u us\n", (unsigned)stats.last_us);
+    
+cleanup:
+    epd_group_destroy(group);
+    epd_group_destroy(serial);
+    for (int i = 0; i < GROUP_PANELS; i++) {
+        free(frames[i]);
+        if (devs[i] || panels[i]) {
+            epd_virtual_destroy(devs[i], panels[i]);
+        }
+    }
+}
+
+// 条带渲染图案: 0白 1黑 2红
+static int band_pattern(uint16_t x, uint16_t y) {
+    if ((x / 8 + y / 5) % 3 == 0) {
+        return 1;
+    }
+    return ((x + y) / 16) % 5 == 0 ? 2 : 0;
+}
+
+// 按图案填充从y0开始的rows行, red为NULL时红色像素按白色处理
+static void band_fill(uint8_t *bw, uint8_t *red, uint16_t width, uint16_t y0, uint16_t rows) {
+    uint16_t stride = width / 8;
+    
+    for (uint16_t r = 0; r < rows; r++) {
+        for (uint16_t x = 0; x < width; x++) {
+            int c = band_pattern(x, y0 + r);
+            uint8_t bit = 0x80 >> (x % 8);
+            if (c == 1) {
+                bw[r * stride + x / 8] &= ~bit;
+            } else if (c == 2 && red) {
+                red[r * stride + x / 8] |= bit;
+            }
+        }
+    }
+}
+
+typedef struct {
+    uint16_t width;
+    uint16_t calls;
+    uint16_t next_y;            // 条带须按顺序、无间隙地提供
+    bool ordered;
+} band_ctx_t;
+
+static esp_err_t band_draw(void *arg, uint8_t *bw, uint8_t *red, uint16_t y0, uint16_t rows) {
+    band_ctx_t *ctx = (band_ctx_t *)arg;
+    ctx->ordered = ctx->ordered && (y0 == ctx->next_y);
+    ctx->next_y = y0 + rows;
+    ctx->calls++;
+    band_fill(bw, red, ctx->width, y0, rows);
+    return ESP_OK;
+}
+
+// 条带渲染: 结果须与整屏缓冲区刷新逐位一致
+static void test_bands(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    static const uint16_t heights[] = { 1, 8, 0, 50, 128, 500 };
+    uint16_t w = dev->info.width;
+    uint16_t h = dev->info.height;
+    uint32_t size = epd_virtual_get_plane_size(panel);
+    bool three_color = dev->info.color_mode == EPD_MODE_3C;
+    uint8_t *bw = malloc(size);
+    uint8_t *red = malloc(size);
+    uint8_t *ref_bw = malloc(size);
+    uint8_t *ref_red = malloc(size);
+    if (!bw || !red || !ref_bw || !ref_red) {
+        HOST_CHECK(false, "内存分配失败");
+        goto done;
+    }
+    
+    memset(bw, 0xFF, size);
+    memset(red, 0x00, size);
+    band_fill(bw, three_color ? red : NULL, w, 0, h);
+    
+    for (uint8_t rotation = 0; rotation <= 2; rotation += 2) {
+        dev->set_rotation(dev, rotation);
+    
+        // 参考图像: 整屏缓冲区刷新
+        esp_err_t err = three_color ? dev->display_planes(dev, bw, red, EPD_UPDATE_FULL)
+                                    : dev->display_buffer(dev, bw, EPD_UPDATE_FULL);
+        HOST_CHECK(err == ESP_OK, "参考刷新返回 %d", err);
+        memcpy(ref_bw, epd_virtual_get_image(panel, EPD_VIRTUAL_PLANE_BW), size);
+        memcpy(ref_red, epd_virtual_get_image(panel, EPD_VIRTUAL_PLANE_RED), size);
+    
+        for (size_t i = 0; i < sizeof(heights) / sizeof(heights[0]); i++) {
+            dev->clear(dev, EPD_COLOR_WHITE);
+    
+            band_ctx_t ctx = { .width = w, .ordered = true };
+            epd_band_stats_t stats;
+            err = dev->display_bands(dev, heights[i], band_draw, &ctx, EPD_UPDATE_FULL, &stats);
+            HOST_CHECK(err == ESP_OK, "条带高度%u: display_bands返回 %d", heights[i], err);
+    
+            uint16_t bh = heights[i] ? (heights[i] < h ? heights[i] : h) : EPD_BAND_HEIGHT;
+            HOST_CHECK(ctx.ordered && ctx.next_y == h && ctx.calls == (h + bh - 1) / bh &&
+                       stats.bands == ctx.calls, "条带高度%u: 条带 %u 次, 覆盖到第%u行",
+                       heights[i], ctx.calls, ctx.next_y);
+            HOST_CHECK(stats.buffer_bytes == (uint32_t)bh * w / 8 * (three_color ? 2 : 1),
+                       "条带高度%u: 缓冲区 %u 字节", heights[i], (unsigned)stats.buffer_bytes);
+            HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, ref_bw),
+                       "旋转%u 条带高度%u: 黑白图像不一致", rotation, heights[i]);
+            HOST_CHECK(!three_color || image_matches(panel, EPD_VIRTUAL_PLANE_RED, ref_red),
+                       "旋转%u 条带高度%u: 红色图像不一致", rotation, heights[i]);
+        }
+    }
+    
+    dev->set_rotation(dev, 1);
+    band_ctx_t ctx = { .width = dev->info.width, .ordered = true };
+    HOST_CHECK(dev->display_bands(dev, 0, band_draw, &ctx, EPD_UPDATE_FULL, NULL) ==
+               ESP_ERR_NOT_SUPPORTED, "90度旋转时条带渲染未被拒绝");
+    dev->set_rotation(dev, 0);
+    
+done:
+    free(bw);
+    free(red);
+    free(ref_bw);
+    free(ref_red);
+}
+
+// 裁剪区绘图: 裁剪区内与无裁剪绘制一致, 区外像素和脏区不受影响
+static void test_clip(epd_fb_t *fb) {
+    uint8_t *full = malloc(fb->size);
+    uint8_t *ref = malloc(fb->size);
+    if (!full || !ref) {
+        HOST_CHECK(false, "分配参考缓冲区失败");
+        free(full);
+        free(ref);
+        return;
+    }
+    
+    // 非字节对齐的裁剪边界, 图形和文字都跨越裁剪边界
+    epd_rect_t clip = { 19, 20, 27, 11 };
+    
+    memset(full, 0xFF, fb->size);
+    epd_draw_circle(full, fb->width, fb->height, 24, 24, 9, EPD_COLOR_BLACK, false);
+    epd_draw_line(full, fb->width, fb->height, 10, 34, 60, 18, EPD_COLOR_BLACK);
+    epd_draw_text(full, fb->width, fb->height, "CLIP", 13, 18, EPD_COLOR_BLACK, 2);
+    
+    // 参考图像: 只保留裁剪区内的像素
+    memset(ref, 0xFF, fb->size);
+    for (uint16_t y = clip.y; y < clip.y + clip.height; y++) {
+        for (uint16_t x = clip.x; x < clip.x + clip.width; x++) {
+            uint32_t idx = (uint32_t)y * fb->stride + x / 8;
+            uint8_t mask = 0x80 >> (x % 8);
+            ref[idx] = (ref[idx] & ~mask) | (full[idx] & mask);
+        }
+    }
+    
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    fb->dirty_count = 0;
+    epd_fb_set_clip(fb, &clip);
+    epd_draw_circle(fb->buffer, fb->width, fb->height, 24, 24, 9, EPD_COLOR_BLACK, false);
+    epd_draw_line(fb->buffer, fb->width, fb->height, 10, 34, 60, 18, EPD_COLOR_BLACK);
+    epd_draw_text(fb->buffer, fb->width, fb->height, "CLIP", 13, 18, EPD_COLOR_BLACK, 2);
+    epd_fb_set_clip(fb, NULL);
+    
+    HOST_CHECK(memcmp(fb->buffer, ref, fb->size) == 0, "裁剪绘制与参考图像不一致");
+    HOST_CHECK(fb->dirty_count == 1 && fb->dirty[0].x == clip.x && fb->dirty[0].y == clip.y &&
+               fb->dirty[0].width == clip.width && fb->dirty[0].height == clip.height,
+               "脏区超出裁剪区");
+    
+    free(full);
+    free(ref);
+}
+
+// 显示列表的测试场景
+typedef struct {
+    char value[8];
+    uint16_t dot_x;
+    bool icon_visible;
+} dlist_scene_t;
+
+static const uint8_t s_dlist_icon[16] = {
+    0x3C, 0x00, 0x42, 0x00, 0x81, 0x00, 0xA5, 0x00,
+    0x81, 0x00, 0x99, 0x00, 0x42, 0x00, 0x3C, 0x00,
+};
+
+// 按场景在普通缓冲区中完整绘制一遍, 作为增量重绘的参考
+static void dlist_reference(uint8_t *buf, uint16_t w, uint16_t h, const dlist_scene_t *scene) {
+    memset(buf, 0xFF, (uint32_t)w / 8 * h);
+    epd_draw_rect(buf, w, h, 4, 4, w - 8, h - 8, EPD_COLOR_BLACK, false);
+    epd_font_draw(buf, w, h, &epd_font_5x7_prop, "STATUS", 12, 10, EPD_COLOR_BLACK, 2);
+    epd_draw_line(buf, w, h, 12, 30, w - 12, 30, EPD_COLOR_BLACK);
+    epd_font_draw(buf, w, h, &epd_font_5x7, scene->value, 12, 40, EPD_COLOR_BLACK, 3);
+    epd_draw_circle(buf, w, h, scene->dot_x, 90, 10, EPD_COLOR_BLACK, true);
+    if (scene->icon_visible) {
+        epd_draw_bitmap(buf, w, h, 203, 41, s_dlist_icon, 8, 8, EPD_COLOR_BLACK);
+    }
+}
+
+// 显示列表: 修改单个节点只重绘其包围盒并局刷, 结果与整屏重绘一致
+static void test_dlist(epd_virtual_panel_t *panel, epd_fb_t *fb) {
+    uint16_t w = fb->width;
+    uint16_t h = fb->height;
+    uint8_t *ref = malloc(fb->size);
+    epd_dlist_t *dl = epd_dlist_create(fb, EPD_COLOR_WHITE);
+    if (!ref || !dl) {
+        HOST_CHECK(false, "创建显示列表失败");
+        free(ref);
+        epd_dlist_destroy(dl);
+        return;
+    }
+    
+    dlist_scene_t scene = { "17", 150, true };
+    uint8_t value_id = 0;
+    uint8_t dot_id = 0;
+    uint8_t icon_id = 0;
+    epd_fb_commit_t path;
+    epd_dlist_stats_t stats;
+    
+    epd_dlist_add_rect(dl, 4, 4, w - 8, h - 8, EPD_COLOR_BLACK, false, NULL);
+    epd_dlist_add_text(dl, &epd_font_5x7_prop, "STATUS", 12, 10, EPD_COLOR_BLACK, 2, NULL);
+    epd_dlist_add_line(dl, 12, 30, w - 12, 30, EPD_COLOR_BLACK, NULL);
+    epd_dlist_add_text(dl, &epd_font_5x7, scene.value, 12, 40, EPD_COLOR_BLACK, 3, &value_id);
+    epd_dlist_add_circle(dl, scene.dot_x, 90, 10, EPD_COLOR_BLACK, true, &dot_id);
+    epd_dlist_add_bitmap(dl, s_dlist_icon, 203, 41, 8, 8, EPD_COLOR_BLACK, &icon_id);
+    
+    esp_err_t err = epd_dlist_commit(dl, &path);
+    dlist_reference(ref, w, h, &scene);
+    HOST_CHECK(err == ESP_OK, "显示列表首次提交返回 %d", err);
+    HOST_CHECK(memcmp(fb->buffer, ref, fb->size) == 0, "首次提交的图像与整屏绘制不一致");
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, ref), "首次提交后面板图像不一致");
+    
+    // 只改数值文字: 重绘区域限于新旧文字包围盒, 单窗口局刷
+    epd_dlist_get_stats(dl, &stats);
+    uint64_t pixels_before = stats.pixels_redrawn;
+    uint32_t skipped_before = stats.nodes_skipped;
+    
+    strcpy(scene.value, "1024");
+    epd_dlist_set_text(dl, value_id, scene.value);
+    err = epd_dlist_commit(dl, &path);
+    dlist_reference(ref, w, h, &scene);
+    epd_dlist_get_stats(dl, &stats);
+    HOST_CHECK(err == ESP_OK, "文字更新提交返回 %d", err);
+    HOST_CHECK(fb->red || path == EPD_FB_COMMIT_PARTIAL, "文字更新应为单窗口局刷, 实际 %d", path);
+    HOST_CHECK(memcmp(fb->buffer, ref, fb->size) == 0, "文字更新后图像与整屏绘制不一致");
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, ref), "文字更新后面板图像不一致");
+    HOST_CHECK(stats.pixels_redrawn - pixels_before < (uint32_t)w * h / 10,
+               "文字更新重绘了 %llu 像素",
+               (unsigned long long)(stats.pixels_redrawn - pixels_before));
+    HOST_CHECK(stats.nodes_skipped > skipped_before, "不相交的节点未被跳过");
+    
+    // 移动圆点并隐藏图标
+    scene.dot_x = 170;
+    scene.icon_visible = false;
+    epd_dlist_move(dl, dot_id, scene.dot_x, 90);
+    epd_dlist_set_visible(dl, icon_id, false);
+    err = epd_dlist_commit(dl, &path);
+    dlist_reference(ref, w, h, &scene);
+    HOST_CHECK(err == ESP_OK, "移动节点提交返回 %d", err);
+    HOST_CHECK(memcmp(fb->buffer, ref, fb->size) == 0, "移动节点后图像与整屏绘制不一致");
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, ref), "移动节点后面板图像不一致");
+    
+    // 内容相同的修改不产生刷新
+    epd_dlist_set_text(dl, value_id, scene.value);
+    err = epd_dlist_commit(dl, &path);
+    HOST_CHECK(err == ESP_OK && path == EPD_FB_COMMIT_NONE, "无变化提交应跳过, 实际 %d", path);
+    
+    epd_dlist_get_stats(dl, &stats);
+    printf("显示列表: 提交 %u, 重绘区域 %u, 节点重绘 %u / 跳过 %u, 重绘 %llu 像素\n",
+           stats.commits, stats.regions, stats.nodes_drawn, stats.nodes_skipped,
+           (unsigned long long)stats.pixels_redrawn);
+    
+    epd_dlist_destroy(dl);
+    free(ref);
+}
+
+// 刷新策略: 局刷次数或覆盖面积超出预算时升级为全刷, 空闲时补全刷
+static void test_policy(epd_device_t *dev, epd_virtual_panel_t *panel, epd_fb_t *fb) {
+    if (fb->red) {
+        // 三色屏不支持局刷
+        return;
+    }
+    
+    uint16_t w = fb->width;
+    uint16_t h = fb->height;
+    epd_virtual_stats_t before, after;
+    epd_policy_stats_t stats;
+    bool refreshed = false;
+    
+    // 次数预算: 第4次局刷升级为全刷
+    epd_policy_config_t cfg = { .max_partials = 3, .max_area_percent = 0, .idle_full_ms = 30 };
+    HOST_CHECK(epd_policy_attach(dev, &cfg) == ESP_OK, "挂接刷新策略失败");
+    
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    dev->display_buffer(dev, fb->buffer, EPD_UPDATE_FULL);
+    epd_virtual_get_stats(panel, &before);
+    for (int i = 0; i < 4; i++) {
+        epd_draw_rect(fb->buffer, w, h, 8 + i * 16, 8, 8, 8, EPD_COLOR_BLACK, true);
+        dev->display_window(dev, fb->buffer, 8 + i * 16, 8, 8, 8, EPD_UPDATE_PARTIAL);
+    }
+    epd_virtual_get_stats(panel, &after);
+    epd_policy_get_stats(dev, &stats);
+    HOST_CHECK(after.partial_updates - before.partial_updates == 3 &&
+               after.full_updates - before.full_updates == 1,
+               "局刷 %u / 全刷 %u, 应为3 / 1", after.partial_updates - before.partial_updates,
+               after.full_updates - before.full_updates);
+    HOST_CHECK(stats.promoted == 1 && stats.partial == 3 && stats.full == 2 && stats.since_full == 0,
+               "策略统计错误: 升级 %u, 局刷 %u, 全刷 %u", stats.promoted, stats.partial, stats.full);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "升级全刷后面板图像不一致");
+    HOST_CHECK(stats.saved_us > 0, "未统计局刷节省的时间");
+    
+    // 空闲补刷: 有残影且空闲超过idle_full_ms后才刷新, 刷新后不再重复
+    dev->display_window(dev, fb->buffer, 8, 8, 8, 8, EPD_UPDATE_FAST);
+    epd_policy_service(dev, &refreshed);
+    HOST_CHECK(!refreshed, "未到空闲时间就补刷");
+    vTaskDelay(pdMS_TO_TICKS(40));
+    HOST_CHECK(epd_policy_service(dev, &refreshed) == ESP_OK && refreshed, "空闲后未补刷");
+    epd_policy_service(dev, &refreshed);
+    HOST_CHECK(!refreshed, "补刷后重复刷新");
+    epd_policy_get_stats(dev, &stats);
+    HOST_CHECK(stats.idle_full == 1 && stats.fast == 1, "空闲补刷 %u, 快刷 %u", stats.idle_full,
+               stats.fast);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "补刷后面板图像不一致");
+    
+    // 面积预算: 两次半屏局刷用完100%, 第三次升级
+    cfg.max_partials = 0;
+    cfg.max_area_percent = 100;
+    epd_policy_attach(dev, &cfg);
+    for (int i = 0; i < 3; i++) {
+        dev->display_window(dev, fb->buffer, 0, 0, w, h / 2, EPD_UPDATE_PARTIAL);
+    }
+    epd_policy_get_stats(dev, &stats);
+    HOST_CHECK(stats.partial == 2 && stats.promoted == 1, "面积预算: 局刷 %u, 升级 %u",
+               stats.partial, stats.promoted);
+    
+    printf("刷新策略: 全刷平均 %u us, 局刷平均 %u us\n", stats.avg_full_us, stats.avg_partial_us);
+    
+    epd_policy_attach(dev, NULL);
+    epd_fb_invalidate(fb);
+}
+
+// 睡眠唤醒与MCU深度睡眠恢复: 面板RAM保持, 唤醒后不重新初始化, 首次提交即可局刷
+static void test_resume(void) {
+    epd_virtual_config_t cfg;
+    epd_virtual_default_config(&cfg);
+    cfg.color_mode = EPD_MODE_1C;
+    cfg.full_busy_ms = 2;
+    cfg.partial_busy_ms = 1;
+    cfg.pins.spi_cs = 25;
+    cfg.pins.dc_pin = 32;
+    cfg.pins.rst_pin = 14;
+    cfg.pins.busy_pin = 34;
+    
+    epd_virtual_panel_t *panel = NULL;
+    epd_device_t *dev = epd_virtual_create(&cfg, &panel);
+    HOST_CHECK(dev && dev->init(dev) == ESP_OK, "创建恢复测试面板失败");
+    if (!dev) {
+        return;
+    }
+    
+    epd_fb_t *fb = epd_fb_create(dev);
+    epd_fb_commit_t path = EPD_FB_COMMIT_NONE;
+    epd_virtual_stats_t before, after;
+    
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 16, 16, 64, 32, EPD_COLOR_BLACK, true);
+    epd_fb_commit(fb, &path);
+    HOST_CHECK(path == EPD_FB_COMMIT_FULL, "首次提交应全刷");
+    
+    // 同一次启动内睡眠唤醒: 只复位并重发配置, 没有初始化激活
+    dev->sleep(dev);
+    epd_virtual_get_stats(panel, &before);
+    HOST_CHECK(dev->wakeup(dev) == ESP_OK, "唤醒失败");
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.activations == before.activations && after.resets == before.resets + 1,
+               "唤醒: 激活 %u, 复位 %u", after.activations - before.activations,
+               after.resets - before.resets);
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 96, 16, 16, 16, EPD_COLOR_BLACK, true);
+    epd_fb_commit(fb, &path);
+    HOST_CHECK(path == EPD_FB_COMMIT_PARTIAL, "唤醒后提交路径 %d, 应为局刷", path);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "唤醒后面板图像不一致");
+    
+    // 模拟MCU深度睡眠: 保留面板内容后释放全部驱动状态, 以新设备恢复
+    HOST_CHECK(epd_fb_retain(fb) == ESP_OK, "保留面板内容失败");
+    epd_fb_destroy(fb);
+    dev->deinit(dev);
+    free(dev);
+    
+    dev = epd_ssd1619_create(&cfg.pins, cfg.width, cfg.height, cfg.color_mode);
+    epd_virtual_get_stats(panel, &before);
+    int64_t t0 = esp_timer_get_time();
+    HOST_CHECK(dev->resume(dev) == ESP_OK, "深度睡眠恢复失败");
+    int64_t resume_us = esp_timer_get_time() - t0;
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.activations == before.activations, "恢复时执行了初始化激活");
+    
+    fb = epd_fb_create(dev);
+    HOST_CHECK(epd_fb_restore(fb) == ESP_OK, "恢复面板内容失败");
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "恢复的内容与面板不一致");
+    epd_draw_rect(fb->buffer, fb->width, fb->height, 128, 16, 16, 16, EPD_COLOR_BLACK, true);
+    epd_fb_commit(fb, &path);
+    HOST_CHECK(path == EPD_FB_COMMIT_PARTIAL, "恢复后提交路径 %d, 应为局刷", path);
+    HOST_CHECK(image_matches(panel, EPD_VIRTUAL_PLANE_BW, fb->buffer), "恢复后面板图像不一致");
+    
+    // 90度旋转的RAM镜像无法保留, 退化为完整初始化
+    dev->set_rotation(dev, 1);
+    epd_fb_destroy(fb);
+    dev->deinit(dev);
+    free(dev);
+    
+    dev = epd_ssd1619_create(&cfg.pins, cfg.width, cfg.height, cfg.color_mode);
+    epd_virtual_get_stats(panel, &before);
+    t0 = esp_timer_get_time();
+    HOST_CHECK(dev->resume(dev) == ESP_OK, "退化初始化失败");
+    int64_t init_us = esp_timer_get_time() - t0;
+    epd_virtual_get_stats(panel, &after);
+    HOST_CHECK(after.activations == before.activations + 1, "旋转90度时应完整初始化");
+    
+    printf("深度睡眠恢复: %lld us, 完整初始化: %lld us\n", (long long)resume_us, (long long)init_us);
+    
+    epd_virtual_destroy(dev, panel);
+}
+
+// 跟踪环: 一次全刷应记录主激活命令、整屏RAM写入、BUSY等待和刷新跨度; 可导出给epd_trace_json
+static void test_trace(epd_device_t *dev, epd_virtual_panel_t *panel, epd_fb_t *fb,
+                       const char *trace_path) {
+    uint32_t plane_size = epd_virtual_get_plane_size(panel);
+    epd_trace_event_t events[EPD_TRACE_CAPACITY];
+    uint32_t dropped;
+    
+    epd_trace_clear();
+    epd_trace_mark(1, 0);
+    dev->display_buffer(dev, fb->buffer, EPD_UPDATE_FULL);
+    uint32_t count = epd_trace_snapshot(events, EPD_TRACE_CAPACITY, &dropped);
+    
+    bool activation = false, busy = false, refresh = false, display = false;
+    uint32_t data_bytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const epd_trace_event_t *e = &events[i];
+        if (e->dev != -1) {
+            HOST_CHECK(e->dev == dev->pins.spi_cs, "事件%u设备为%d", i, e->dev);
+        }
+        switch (e->type) {
+            case EPD_TRACE_CMD:
+                activation |= e->code == 0x20;
+                break;
+            case EPD_TRACE_DATA:
+                data_bytes += e->value;
+                break;
+            case EPD_TRACE_BUSY:
+                busy = true;
+                break;
+            case EPD_TRACE_REFRESH:
+                refresh |= e->code == EPD_UPDATE_FULL && e->dur_us > 0;
+                break;
+            case EPD_TRACE_DISPLAY:
+                display = true;
+                break;
+            default:
+                break;
+        }
+    }
+    HOST_CHECK(count > 0 && events[0].type == EPD_TRACE_MARK && events[0].dev == -1,
+               "应用标记未记录");
+    HOST_CHECK(activation && busy && refresh && display,
+               "全刷事件不完整: 激活 %d, BUSY %d, 刷新 %d, 显示 %d", activation, busy, refresh,
+               display);
+    HOST_CHECK(data_bytes >= plane_size, "RAM写入 %u 字节, 应至少 %u", data_bytes, plane_size);
+    HOST_CHECK(dropped == 0, "单次全刷不应覆盖事件 (%u)", dropped);
+    
+    // 暂停时不记录
+    epd_trace_set_enabled(false);
+    epd_trace_mark(2, 0);
+    HOST_CHECK(epd_trace_snapshot(events, EPD_TRACE_CAPACITY, NULL) == count, "暂停后仍在记录");
+    epd_trace_set_enabled(true);
+    
+    // 记录开销
+    const int marks = 10000;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < marks; i++) {
+        epd_trace_mark(3, i);
+    }
+    int64_t us = esp_timer_get_time() - start;
+    epd_trace_snapshot(events, 1, &dropped);
+    HOST_CHECK(dropped == count + marks - EPD_TRACE_CAPACITY, "覆盖计数 %u 错误", dropped);
+    printf("跟踪环: 全刷 %u 个事件, 每次记录 %lld ns\n", count, (long long)(us * 1000 / marks));
+    
+    // 导出最后一次全刷供转换工具使用
+    if (trace_path) {
+        epd_trace_clear();
+        dev->display_buffer(dev, fb->buffer, EPD_UPDATE_FULL);
+        FILE *f = fopen(trace_path, "w");
+        HOST_CHECK(f && epd_trace_dump(f) == ESP_OK, "写入 %s 失败", trace_path);
+        if (f) {
+            fclose(f);
+        }
+    }
+}
+
+// 大尺寸面板的条带渲染: 峰值内存与吞吐量随条带高度的变化
+static void bench_bands(void) {
+    epd_virtual_config_t cfg;
+    epd_virtual_default_config(&cfg);
+    cfg.width = 800;
+    cfg.height = 480;
+    cfg.pins.spi_cs = 25;
+    cfg.pins.dc_pin = 32;
+    cfg.pins.rst_pin = 14;
+    cfg.pins.busy_pin = 34;
+    
+    epd_virtual_panel_t *panel = NULL;
+    epd_device_t *dev = epd_virtual_create(&cfg, &panel);
+    if (!dev || dev->init(dev) != ESP_OK) {
+        HOST_CHECK(false, "800x480面板初始化失败");
+        epd_virtual_destroy(dev, panel);
+        return;
+    }
+    
+    static const uint16_t heights[] = { 8, 16, 32, 64, 480 };
+    for (size_t i = 0; i < sizeof(heights) / sizeof(heights[0]); i++) {
+        band_ctx_t ctx = { .width = cfg.width, .ordered = true };
+        epd_band_stats_t stats;
+        esp_err_t err = dev->display_bands(dev, heights[i], band_draw, &ctx,
+                                           EPD_UPDATE_FULL, &stats);
+        HOST_CHECK(err == ESP_OK, "800x480 条带高度%u: display_bands返回 %d", heights[i], err);
+        printf("条带 800x480 三色 高度%-3u: %2u条, 缓冲区 %6u / 整屏 %u 字节, "
+               "绘制 %6u us, 写入 %5u us, %8u 字节/秒\n",
+               heights[i], stats.bands, (unsigned)stats.buffer_bytes,
+               (unsigned)stats.frame_bytes, (unsigned)stats.draw_us,
+               (unsigned)stats.transfer_us, (unsigned)stats.bytes_per_sec);
+    }
+    
+    epd_virtual_destroy(dev, panel);
+}
+
+static void bench_display(epd_device_t *dev, epd_fb_t *fb) {
+    static const epd_update_mode_t modes[] = { EPD_UPDATE_FULL, EPD_UPDATE_PARTIAL };
+    
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        epd_profile_report_t report;
+        uint32_t heap_ops = atomic_load(&s_heap_ops);
+        esp_err_t err = epd_profile_run(dev, fb->buffer, modes[m], BENCH_ITERATIONS, &report);
+        HOST_CHECK(err == ESP_OK, "epd_profile_run返回 %d", err);
+        HOST_CHECK(atomic_load(&s_heap_ops) == heap_ops, "epd_profile_run期间有 %u 次堆操作",
+                   (unsigned)(atomic_load(&s_heap_ops) - heap_ops));
+        HOST_CHECK(report.samples_us[EPD_PHASE_TOTAL][0] == report.phase[EPD_PHASE_TOTAL].min_us,
+                   "原始数据未排序");
+        HOST_CHECK(report.ram_bytes >= fb->size, "RAM写入字节数 %u 小于帧大小",
+                   (unsigned)report.ram_bytes);
+    
+        printf("模式 %d: %u次, 每次 %u 字节, SPI %u 字节/秒\n", modes[m],
+               (unsigned)report.iterations, (unsigned)report.ram_bytes,
+               (unsigned)report.spi_bytes_per_sec);
+        for (int p = 0; p < EPD_PHASE_MAX; p++) {
+            printf("  %-8s 最小 %6u  中位 %6u  P95 %6u  最大 %6u us\n", epd_phase_name(p),
+                   (unsigned)report.phase[p].min_us, (unsigned)report.phase[p].median_us,
+                   (unsigned)report.phase[p].p95_us, (unsigned)report.phase[p].max_us);
+        }
+    }
+}
+
+static void bench_dither(void) {
+    static const struct { uint16_t w, h; } sizes[] = { { 296, 128 }, { 400, 300 }, { 800, 480 } };
+    static const char *names[] = { "Threshold", "Bayer", "Floyd-Steinberg", "Atkinson" };
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        uint16_t w = sizes[s].w;
+        uint16_t h = sizes[s].h;
+        uint8_t *bw = malloc((uint32_t)w * h / 8);
+        uint8_t *red = malloc((uint32_t)w * h / 8);
+        if (!bw || !red) {
+            HOST_CHECK(false, "内存分配失败");
+            free(bw);
+            free(red);
+            return;
+        }
+    
+        for (int bwr = 0; bwr < 2; bwr++) {
+            for (int m = EPD_DITHER_THRESHOLD; m <= EPD_DITHER_ATKINSON; m++) {
+                dither_input_t input = { .width = w, .height = h, .value = 256, .rgb = bwr };
+                epd_dither_config_t config = {
+                    .width = w,
+                    .height = h,
+                    .method = m,
+                    .format = bwr ? EPD_DITHER_RGB888 : EPD_DITHER_GRAY8,
+                    .palette = bwr ? EPD_DITHER_PALETTE_BWR : EPD_DITHER_PALETTE_BW,
+                    .read_row = dither_read_row,
+                    .ctx = &input,
+                };
+                epd_dither_t *dither = epd_dither_create(&config);
+                if (!dither) {
+                    HOST_CHECK(false, "创建抖动器失败");
+                    continue;
+                }
+    
+                int64_t start = esp_timer_get_time();
+                for (int i = 0; i < BENCH_ITERATIONS; i++) {
+                    epd_dither_to_buffer(dither, bw, bwr ? red : NULL);
+                }
+                int64_t elapsed = esp_timer_get_time() - start;
+                epd_dither_destroy(dither);
+    
+                double mpix = (double)w * h * BENCH_ITERATIONS / (elapsed > 0 ? elapsed : 1);
+                printf("抖动 %3ux%-3u %-3s %-16s %7.1f us/帧, %6.2f Mpix/s\n", w, h,
+                       bwr ? "BWR" : "BW", names[m], (double)elapsed / BENCH_ITERATIONS, mpix);
+            }
+        }
+    
+        free(bw);
+        free(red);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *pbm_path = argc > 1 ? argv[1] : NULL;
+    bool three_color = argc > 2 && strcmp(argv[2], "3c") == 0;
+    const char *trace_path = argc > 3 ? argv[3] : NULL;
+    
+    epd_virtual_config_t cfg;
+    epd_virtual_default_config(&cfg);
+    cfg.color_mode = three_color ? EPD_MODE_3C : EPD_MODE_1C;
+    cfg.full_busy_ms = 2;
+    cfg.partial_busy_ms = 1;
+    
+    epd_virtual_panel_t *panel = NULL;
+    epd_device_t *dev = epd_virtual_create(&cfg, &panel);
+    if (!dev) {
+        ESP_LOGE(TAG, "创建虚拟设备失败");
+        return 1;
+    }
+    
+    esp_err_t err = dev->init(dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "初始化失败: %d", err);
+        epd_virtual_destroy(dev, panel);
+        return 1;
+    }
+    
+    epd_fb_t *fb = epd_fb_create(dev);
+    if (!fb) {
+        ESP_LOGE(TAG, "创建帧缓冲区失败");
+        epd_virtual_destroy(dev, panel);
+        return 1;
+    }
+    
+    test_full_refresh(dev, panel, fb);
+    test_partial_refresh(dev, panel, fb);
+    test_registry(dev, fb);
+    test_red_plane(panel, fb);
+    test_rotation(dev, panel);
+    test_epf(dev, panel, fb);
+    test_font(dev);
+    test_cmd_list(dev);
+    test_pool(dev, panel);
+    test_async(dev, panel);
+    test_gray(dev, panel);
+    test_temperature(dev, panel);
+    test_pipeline(dev, panel);
+    test_group();
+    test_bands(dev, panel);
+    test_clip(fb);
+    test_dlist(panel, fb);
+    test_policy(dev, panel, fb);
+    test_resume();
+    test_trace(dev, panel, fb, trace_path);
+    test_dither(dev, panel);
+    bench_display(dev, fb);
+    bench_dither();
+    bench_bands();
+    
+    if (pbm_path) {
+        err = epd_virtual_dump_pbm(panel, EPD_VIRTUAL_PLANE_BW, pbm_path);
+        HOST_CHECK(err == ESP_OK, "写入 %s 失败", pbm_path);
+    }
+    
+    epd_virtual_stats_t stats;
+    epd_virtual_get_stats(panel, &stats);
+    printf("虚拟面板: 命令 %u, 激活 %u (全刷 %u / 局刷 %u), BW %llu 字节, RED %llu 字节\n",
+           stats.commands, stats.activations, stats.full_updates, stats.partial_updates,
+           (unsigned long long)stats.ram_bytes[EPD_VIRTUAL_PLANE_BW],
+           (unsigned long long)stats.ram_bytes[EPD_VIRTUAL_PLANE_RED]);
+    
+    epd_fb_destroy(fb);
+    epd_virtual_destroy(dev, panel);
+    
+    HOST_CHECK(stats.written_while_busy == 0, "BUSY期间收到 %u 字节", stats.written_while_busy);
+    
+    printf("%s (%d个失败)\n", s_failures ? "FAIL" : "PASS", s_failures);
+    return s_failures ? 1 : 0;
+}
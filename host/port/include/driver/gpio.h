@@ -0,0 +1,58 @@
+/**
+ * 主机端移植: GPIO驱动
+ */
+
+#ifndef __HOST_DRIVER_GPIO_H__
+#define __HOST_DRIVER_GPIO_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define GPIO_NUM_MAX  64
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+    GPIO_MODE_INPUT_OUTPUT,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+typedef void (*gpio_isr_t)(void *arg);
+
+#define ESP_INTR_FLAG_IRAM  (1 << 10)
+
+esp_err_t gpio_reset_pin(gpio_num_t pin);
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level);
+int gpio_get_level(gpio_num_t pin);
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type);
+esp_err_t gpio_intr_enable(gpio_num_t pin);
+esp_err_t gpio_intr_disable(gpio_num_t pin);
+esp_err_t gpio_install_isr_service(int flags);
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void *arg);
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin);
+
+// ---- 主机端仿真钩子 ----
+
+// 输入引脚电平回调 (返回-1表示使用默认电平)
+typedef int (*host_gpio_input_cb_t)(gpio_num_t pin, void *ctx);
+// 输出引脚电平变化回调
+typedef void (*host_gpio_output_cb_t)(gpio_num_t pin, uint32_t level, void *ctx);
+
+void host_gpio_set_input_hook(gpio_num_t pin, host_gpio_input_cb_t cb, void *ctx);
+void host_gpio_set_output_hook(gpio_num_t pin, host_gpio_output_cb_t cb, void *ctx);
+// 模拟一次引脚边沿, 按中断类型触发已注册的ISR
+void host_gpio_signal_edge(gpio_num_t pin, uint32_t new_level);
+
+#endif // __HOST_DRIVER_GPIO_H__
@@ -0,0 +1,101 @@
+/**
+ * 主机端移植: SPI主机驱动
+ * 所有事务同步执行并交给仿真器 (见 host_spi_set_sink)
+ */
+
+#ifndef __HOST_DRIVER_SPI_MASTER_H__
+#define __HOST_DRIVER_SPI_MASTER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+    SPI_HOST_MAX,
+} spi_host_device_t;
+
+#define SPI_DMA_DISABLED   0
+#define SPI_DMA_CH_AUTO    3
+
+#define SPI_TRANS_USE_RXDATA   (1 << 2)
+#define SPI_TRANS_USE_TXDATA   (1 << 3)
+
+#define SPI_DEVICE_3WIRE       (1 << 2)
+#define SPI_DEVICE_HALFDUPLEX  (1 << 4)
+#define SPI_DEVICE_NO_DUMMY    (1 << 6)
+
+typedef struct spi_transaction_t spi_transaction_t;
+typedef void (*transaction_cb_t)(spi_transaction_t *trans);
+
+struct spi_transaction_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;       // 总位数
+    size_t rxlength;     // 接收位数
+    void *user;
+    union {
+        const void *tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union {
+        void *rx_buffer;
+        uint8_t rx_data[4];
+    };
+};
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+} spi_bus_config_t;
+
+typedef struct {
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    int clock_speed_hz;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+typedef struct host_spi_device_t *spi_device_handle_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *cfg, int dma_chan);
+esp_err_t spi_bus_free(spi_host_device_t host);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *cfg,
+                             spi_device_handle_t *handle);
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle);
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans,
+                                 TickType_t ticks);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans,
+                                      TickType_t ticks);
+esp_err_t spi_device_acquire_bus(spi_device_handle_t handle, TickType_t wait);
+void spi_device_release_bus(spi_device_handle_t handle);
+
+// ---- 主机端仿真钩子 ----
+
+// 数据接收回调: cs_pin用于区分同一总线上的多个设备
+typedef void (*host_spi_sink_t)(int cs_pin, const uint8_t *tx, uint8_t *rx,
+                                size_t len, void *ctx);
+
+void host_spi_set_sink(int cs_pin, host_spi_sink_t sink, void *ctx);
+// 总线累计统计 (字节数 / 事务数)
+void host_spi_get_stats(uint64_t *bytes, uint32_t *transactions);
+
+#endif // __HOST_DRIVER_SPI_MASTER_H__
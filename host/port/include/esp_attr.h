@@ -0,0 +1,13 @@
+/**
+ * 主机端移植: esp_attr.h
+ */
+
+#ifndef __HOST_ESP_ATTR_H__
+#define __HOST_ESP_ATTR_H__
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif // __HOST_ESP_ATTR_H__
@@ -0,0 +1,36 @@
+/**
+ * 主机端移植: esp_heap_caps.h
+ */
+
+#ifndef __HOST_ESP_HEAP_CAPS_H__
+#define __HOST_ESP_HEAP_CAPS_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_DMA       (1 << 3)
+#define MALLOC_CAP_8BIT      (1 << 2)
+#define MALLOC_CAP_32BIT     (1 << 1)
+#define MALLOC_CAP_INTERNAL  (1 << 11)
+#define MALLOC_CAP_DEFAULT   (1 << 12)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    (void)caps;
+    return calloc(n, size);
+}
+
+static inline void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+static inline size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    return 0;
+}
+
+#endif // __HOST_ESP_HEAP_CAPS_H__
@@ -0,0 +1,41 @@
+/**
+ * 主机端移植: esp_log.h
+ */
+
+#ifndef __HOST_ESP_LOG_H__
+#define __HOST_ESP_LOG_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+// 主机端日志级别 (可通过 host_log_set_level 修改)
+extern esp_log_level_t g_host_log_level;
+uint32_t esp_log_timestamp(void);
+
+static inline void host_log_set_level(esp_log_level_t level) {
+    g_host_log_level = level;
+}
+
+#define HOST_LOG_(level, letter, tag, fmt, ...) do {                    \
+        if (g_host_log_level >= (level)) {                              \
+            fprintf(stderr, letter " (%u) %s: " fmt "\n",               \
+                    (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__); \
+        }                                                               \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG_(ESP_LOG_ERROR, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG_(ESP_LOG_WARN, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG_(ESP_LOG_INFO, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG_(ESP_LOG_DEBUG, "D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) HOST_LOG_(ESP_LOG_VERBOSE, "V", tag, fmt, ##__VA_ARGS__)
+
+#endif // __HOST_ESP_LOG_H__
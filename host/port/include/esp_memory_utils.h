@@ -0,0 +1,15 @@
+/**
+ * 主机端移植: esp_memory_utils.h
+ */
+
+#ifndef __HOST_ESP_MEMORY_UTILS_H__
+#define __HOST_ESP_MEMORY_UTILS_H__
+
+#include <stdbool.h>
+
+// 主机端所有内存都视为可DMA
+static inline bool esp_ptr_dma_capable(const void *p) {
+    return p != NULL;
+}
+
+#endif // __HOST_ESP_MEMORY_UTILS_H__
@@ -0,0 +1,16 @@
+/**
+ * 主机端移植: esp_system.h
+ */
+
+#ifndef __HOST_ESP_SYSTEM_H__
+#define __HOST_ESP_SYSTEM_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// 主机端不跟踪堆使用量
+static inline uint32_t esp_get_free_heap_size(void) {
+    return 0;
+}
+
+#endif // __HOST_ESP_SYSTEM_H__
@@ -0,0 +1,12 @@
+/**
+ * 主机端移植: esp_timer.h
+ */
+
+#ifndef __HOST_ESP_TIMER_H__
+#define __HOST_ESP_TIMER_H__
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // __HOST_ESP_TIMER_H__
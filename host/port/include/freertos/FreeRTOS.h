@@ -0,0 +1,48 @@
+/**
+ * 主机端移植: FreeRTOS基础类型 (基于pthread实现)
+ */
+
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE      1
+#define pdFALSE     0
+#define pdPASS      1
+#define pdFAIL      0
+#define errQUEUE_FULL  0
+#define errQUEUE_EMPTY 0
+
+// 与sdkconfig.defaults中的CONFIG_FREERTOS_HZ=1000保持一致
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define configMAX_PRIORITIES    25
+#define portNUM_PROCESSORS      2
+
+// 临界区 (主机端使用全局互斥锁)
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void host_port_enter_critical(void);
+void host_port_exit_critical(void);
+
+#define portENTER_CRITICAL(mux)         do { (void)(mux); host_port_enter_critical(); } while (0)
+#define portEXIT_CRITICAL(mux)          do { (void)(mux); host_port_exit_critical(); } while (0)
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR(...)         do { } while (0)
+
+#endif // __HOST_FREERTOS_H__
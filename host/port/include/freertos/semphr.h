@@ -0,0 +1,31 @@
+/**
+ * 主机端移植: FreeRTOS信号量API
+ */
+
+#ifndef __HOST_FREERTOS_SEMPHR_H__
+#define __HOST_FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_sem_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t host_sem_create(uint32_t max, uint32_t initial);
+BaseType_t host_sem_take(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t host_sem_give(SemaphoreHandle_t sem);
+void host_sem_delete(SemaphoreHandle_t sem);
+SemaphoreHandle_t host_mutex_create_recursive(void);
+BaseType_t host_mutex_take_recursive(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t host_mutex_give_recursive(SemaphoreHandle_t mutex);
+
+#define xSemaphoreCreateBinary()                 host_sem_create(1, 0)
+#define xSemaphoreCreateMutex()                  host_sem_create(1, 1)
+#define xSemaphoreCreateCounting(max, initial)   host_sem_create((max), (initial))
+#define xSemaphoreTake(sem, ticks)               host_sem_take((sem), (ticks))
+#define xSemaphoreGive(sem)                      host_sem_give(sem)
+#define xSemaphoreGiveFromISR(sem, woken)        (((void)(woken)), host_sem_give(sem))
+#define vSemaphoreDelete(sem)                    host_sem_delete(sem)
+#define xSemaphoreCreateRecursiveMutex()         host_mutex_create_recursive()
+#define xSemaphoreTakeRecursive(mutex, ticks)    host_mutex_take_recursive((mutex), (ticks))
+#define xSemaphoreGiveRecursive(mutex)           host_mutex_give_recursive(mutex)
+
+#endif // __HOST_FREERTOS_SEMPHR_H__
@@ -0,0 +1,383 @@
+/**
+ * 主机端移植: 日志/定时器/GPIO/SPI
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+esp_log_level_t g_host_log_level = ESP_LOG_WARN;
+
+// ==================== 时间 ====================
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// ==================== GPIO ====================
+
+typedef struct {
+    gpio_mode_t mode;
+    uint32_t level;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    gpio_isr_t isr;
+    void *isr_arg;
+    host_gpio_input_cb_t input_cb;
+    void *input_ctx;
+    host_gpio_output_cb_t output_cb;
+    void *output_ctx;
+} host_gpio_t;
+
+static host_gpio_t s_gpio[GPIO_NUM_MAX];
+static bool s_isr_service_installed;
+
+static host_gpio_t *host_gpio(gpio_num_t pin) {
+    if (pin < 0 || pin >= GPIO_NUM_MAX) {
+        return NULL;
+    }
+    return &s_gpio[pin];
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t pin) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->mode = GPIO_MODE_DISABLE;
+    g->intr_type = GPIO_INTR_DISABLE;
+    g->intr_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->level = level ? 1 : 0;
+    if (g->output_cb) {
+        g->output_cb(pin, g->level, g->output_ctx);
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return 0;
+    }
+    if (g->input_cb) {
+        int level = g->input_cb(pin, g->input_ctx);
+        if (level >= 0) {
+            return level;
+        }
+    }
+    return (int)g->level;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->intr_type = type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t pin) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->intr_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->intr_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int flags) {
+    (void)flags;
+    if (s_isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_isr_service_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void *arg) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g || !s_isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    g->isr = handler;
+    g->isr_arg = arg;
+    g->intr_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    g->isr = NULL;
+    g->isr_arg = NULL;
+    return ESP_OK;
+}
+
+void host_gpio_set_input_hook(gpio_num_t pin, host_gpio_input_cb_t cb, void *ctx) {
+    host_gpio_t *g = host_gpio(pin);
+    if (g) {
+        g->input_cb = cb;
+        g->input_ctx = ctx;
+    }
+}
+
+void host_gpio_set_output_hook(gpio_num_t pin, host_gpio_output_cb_t cb, void *ctx) {
+    host_gpio_t *g = host_gpio(pin);
+    if (g) {
+        g->output_cb = cb;
+        g->output_ctx = ctx;
+    }
+}
+
+void host_gpio_signal_edge(gpio_num_t pin, uint32_t new_level) {
+    host_gpio_t *g = host_gpio(pin);
+    if (!g || !g->isr || !g->intr_enabled) {
+        return;
+    }
+    bool fire = false;
+    switch (g->intr_type) {
+        case GPIO_INTR_POSEDGE:    fire = new_level != 0; break;
+        case GPIO_INTR_NEGEDGE:    fire = new_level == 0; break;
+        case GPIO_INTR_ANYEDGE:    fire = true; break;
+        case GPIO_INTR_LOW_LEVEL:  fire = new_level == 0; break;
+        case GPIO_INTR_HIGH_LEVEL: fire = new_level != 0; break;
+        default: break;
+    }
+    if (fire) {
+        g->isr(g->isr_arg);
+    }
+}
+
+// ==================== SPI ====================
+
+#define HOST_SPI_MAX_SINKS  8
+
+struct host_spi_device_t {
+    spi_host_device_t host;
+    spi_device_interface_config_t cfg;
+    spi_transaction_t **done;     // 已完成事务FIFO
+    int done_head;
+    int done_count;
+};
+
+typedef struct {
+    int cs_pin;
+    host_spi_sink_t sink;
+    void *ctx;
+} host_spi_sink_entry_t;
+
+static bool s_bus_initialized[SPI_HOST_MAX];
+static host_spi_sink_entry_t s_sinks[HOST_SPI_MAX_SINKS];
+static pthread_mutex_t s_spi_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t s_spi_bytes;
+static uint32_t s_spi_transactions;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *cfg, int dma_chan) {
+    (void)cfg;
+    (void)dma_chan;
+    if (host >= SPI_HOST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_bus_initialized[host]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_bus_initialized[host] = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host) {
+    if (host >= SPI_HOST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_bus_initialized[host] = false;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *cfg,
+                             spi_device_handle_t *handle) {
+    if (host >= SPI_HOST_MAX || !s_bus_initialized[host] || !cfg || !handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct host_spi_device_t *dev = calloc(1, sizeof(*dev));
+    if (!dev) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->host = host;
+    dev->cfg = *cfg;
+    int depth = cfg->queue_size > 0 ? cfg->queue_size : 1;
+    dev->done = calloc(depth, sizeof(spi_transaction_t *));
+    if (!dev->done) {
+        free(dev);
+        return ESP_ERR_NO_MEM;
+    }
+    dev->cfg.queue_size = depth;
+    *handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle) {
+    if (!handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    free(handle->done);
+    free(handle);
+    return ESP_OK;
+}
+
+static void host_spi_execute(spi_device_handle_t handle, spi_transaction_t *t) {
+    if (handle->cfg.pre_cb) {
+        handle->cfg.pre_cb(t);
+    }
+    
+    size_t len = (t->length + 7) / 8;
+    const uint8_t *tx = (t->flags & SPI_TRANS_USE_TXDATA) ? t->tx_data : t->tx_buffer;
+    uint8_t *rx = (t->flags & SPI_TRANS_USE_RXDATA) ? t->rx_data : t->rx_buffer;
+    size_t rx_len = t->rxlength ? (t->rxlength + 7) / 8 : len;
+    if (rx && rx_len) {
+        memset(rx, 0, rx_len);
+    }
+    
+    pthread_mutex_lock(&s_spi_lock);
+    s_spi_bytes += len;
+    s_spi_transactions++;
+    for (int i = 0; i < HOST_SPI_MAX_SINKS; i++) {
+        if (s_sinks[i].sink && s_sinks[i].cs_pin == handle->cfg.spics_io_num) {
+            s_sinks[i].sink(s_sinks[i].cs_pin, tx, rx, tx ? len : rx_len, s_sinks[i].ctx);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_spi_lock);
+    
+    if (handle->cfg.post_cb) {
+        handle->cfg.post_cb(t);
+    }
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans) {
+    if (!handle || !trans) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->done_count) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    host_spi_execute(handle, trans);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans) {
+    return spi_device_polling_transmit(handle, trans);
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans,
+                                 TickType_t ticks) {
+    (void)ticks;
+    if (!handle || !trans) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->done_count >= handle->cfg.queue_size) {
+        return ESP_ERR_TIMEOUT;
+    }
+    host_spi_execute(handle, trans);
+    int slot = (handle->done_head + handle->done_count) % handle->cfg.queue_size;
+    handle->done[slot] = trans;
+    handle->done_count++;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans,
+                                      TickType_t ticks) {
+    (void)ticks;
+    if (!handle || !trans) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->done_count == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    *trans = handle->done[handle->done_head];
+    handle->done_head = (handle->done_head + 1) % handle->cfg.queue_size;
+    handle->done_count--;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t handle, TickType_t wait) {
+    (void)handle;
+    (void)wait;
+    return ESP_OK;
+}
+
+void spi_device_release_bus(spi_device_handle_t handle) {
+    (void)handle;
+}
+
+void host_spi_set_sink(int cs_pin, host_spi_sink_t sink, void *ctx) {
+    pthread_mutex_lock(&s_spi_lock);
+    int free_slot = -1;
+    for (int i = 0; i < HOST_SPI_MAX_SINKS; i++) {
+        if (s_sinks[i].sink && s_sinks[i].cs_pin == cs_pin) {
+            free_slot = i;
+            break;
+        }
+        if (!s_sinks[i].sink && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+    if (free_slot >= 0) {
+        s_sinks[free_slot].cs_pin = cs_pin;
+        s_sinks[free_slot].sink = sink;
+        s_sinks[free_slot].ctx = ctx;
+    }
+    pthread_mutex_unlock(&s_spi_lock);
+}
+
+void host_spi_get_stats(uint64_t *bytes, uint32_t *transactions) {
+    pthread_mutex_lock(&s_spi_lock);
+    if (bytes) {
+        *bytes = s_spi_bytes;
+    }
+    if (transactions) {
+        *transactions = s_spi_transactions;
+    }
+    pthread_mutex_unlock(&s_spi_lock);
+}
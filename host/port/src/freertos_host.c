@@ -0,0 +1,427 @@
+/**
+ * 主机端移植: 基于pthread的FreeRTOS子集
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+static pthread_mutex_t s_critical = PTHREAD_MUTEX_INITIALIZER;
+
+void host_port_enter_critical(void) {
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_port_exit_critical(void) {
+    pthread_mutex_unlock(&s_critical);
+}
+
+// 计算超时对应的绝对时间
+static void host_deadline(TickType_t ticks, struct timespec *ts) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    uint64_t ns = (uint64_t)ticks * (1000000000ull / configTICK_RATE_HZ);
+    ts->tv_sec += ns / 1000000000ull;
+    ts->tv_nsec += ns % 1000000000ull;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// 在条件变量上等待, ticks为portMAX_DELAY时无限等待
+static int host_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex,
+                          const struct timespec *deadline) {
+    if (!deadline) {
+        return pthread_cond_wait(cond, mutex);
+    }
+    return pthread_cond_timedwait(cond, mutex, deadline);
+}
+
+// ==================== 任务 ====================
+
+struct host_task_t {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    BaseType_t core_id;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+};
+
+static __thread struct host_task_t *s_current_task;
+static struct host_task_t s_main_task = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+// 任务结束 (返回、自删除或被vTaskDelete取消) 时释放任务控制块
+static void host_task_cleanup(void *arg) {
+    s_current_task = NULL;
+    free(arg);
+}
+
+static void *host_task_entry(void *arg) {
+    struct host_task_t *task = arg;
+    
+    // 等待创建者写完task->thread, 之后任务随时可能结束并释放task
+    pthread_mutex_lock(&task->lock);
+    pthread_mutex_unlock(&task->lock);
+    
+    s_current_task = task;
+    pthread_cleanup_push(host_task_cleanup, task);
+    task->fn(task->arg);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name,
+                                   uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core_id) {
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    
+    struct host_task_t *task = calloc(1, sizeof(*task));
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->core_id = core_id;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    
+    if (handle) {
+        *handle = task;
+    }
+    
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_mutex_lock(&task->lock);
+    int err = pthread_create(&task->thread, &attr, host_task_entry, task);
+    pthread_mutex_unlock(&task->lock);
+    pthread_attr_destroy(&attr);
+    
+    if (err != 0) {
+        free(task);
+        if (handle) {
+            *handle = NULL;
+        }
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (!task || task == s_current_task) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(task->thread);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = {
+        .tv_sec = ticks / configTICK_RATE_HZ,
+        .tv_nsec = (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ),
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * configTICK_RATE_HZ +
+                        ts.tv_nsec / (1000000000L / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return s_current_task ? s_current_task : &s_main_task;
+}
+
+BaseType_t xPortGetCoreID(void) {
+    struct host_task_t *task = s_current_task;
+    if (task && task->core_id != tskNO_AFFINITY) {
+        return task->core_id;
+    }
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    xTaskNotifyGive(task);
+    if (woken) {
+        *woken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct host_task_t *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY) {
+        host_deadline(ticks, &deadline);
+    }
+    
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0 && ticks != 0) {
+        if (host_cond_wait(&task->cond, &task->lock,
+                           ticks == portMAX_DELAY ? NULL : &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    uint32_t value = task->notify;
+    if (value) {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+// ==================== 信号量 ====================
+
+struct host_sem_t {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max;
+    TaskHandle_t owner;         // 递归互斥量的持有者
+    uint32_t depth;             // 递归互斥量的嵌套深度
+};
+
+SemaphoreHandle_t host_sem_create(uint32_t max, uint32_t initial) {
+    struct host_sem_t *sem = calloc(1, sizeof(*sem));
+    if (!sem) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->max = max;
+    sem->count = initial;
+    return sem;
+}
+
+BaseType_t host_sem_take(SemaphoreHandle_t sem, TickType_t ticks) {
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY) {
+        host_deadline(ticks, &deadline);
+    }
+    
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (ticks == 0 ||
+            host_cond_wait(&sem->cond, &sem->lock,
+                           ticks == portMAX_DELAY ? NULL : &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    BaseType_t ok = pdFALSE;
+    if (sem->count > 0) {
+        sem->count--;
+        ok = pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok;
+}
+
+BaseType_t host_sem_give(SemaphoreHandle_t sem) {
+    BaseType_t ok = pdFALSE;
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max) {
+        sem->count++;
+        ok = pdTRUE;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok;
+}
+
+void host_sem_delete(SemaphoreHandle_t sem) {
+    if (!sem) {
+        return;
+    }
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->cond);
+    free(sem);
+}
+
+// 递归互斥量: 持有者可重复获取, 释放相同次数后才让出
+SemaphoreHandle_t host_mutex_create_recursive(void) {
+    return host_sem_create(1, 1);
+}
+
+BaseType_t host_mutex_take_recursive(SemaphoreHandle_t mutex, TickType_t ticks) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    
+    pthread_mutex_lock(&mutex->lock);
+    bool owned = mutex->owner == self;
+    if (owned) {
+        mutex->depth++;
+    }
+    pthread_mutex_unlock(&mutex->lock);
+    if (owned) {
+        return pdTRUE;
+    }
+    
+    if (host_sem_take(mutex, ticks) != pdTRUE) {
+        return pdFALSE;
+    }
+    pthread_mutex_lock(&mutex->lock);
+    mutex->owner = self;
+    mutex->depth = 1;
+    pthread_mutex_unlock(&mutex->lock);
+    return pdTRUE;
+}
+
+BaseType_t host_mutex_give_recursive(SemaphoreHandle_t mutex) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    
+    pthread_mutex_lock(&mutex->lock);
+    if (mutex->owner != self) {
+        pthread_mutex_unlock(&mutex->lock);
+        return pdFALSE;
+    }
+    bool release = --mutex->depth == 0;
+    if (release) {
+        mutex->owner = NULL;
+    }
+    pthread_mutex_unlock(&mutex->lock);
+    
+    return release ? host_sem_give(mutex) : pdTRUE;
+}
+
+// ==================== 队列 ====================
+
+struct host_queue_t {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct host_queue_t *q = calloc(1, sizeof(*q));
+    if (!q) {
+        return NULL;
+    }
+    q->storage = calloc(length, item_size);
+    if (!q->storage) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    if (!q) {
+        return;
+    }
+    free(q->storage);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q);
+}
+
+static BaseType_t host_queue_put(QueueHandle_t q, const void *item,
+                                 TickType_t ticks, bool front) {
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY) {
+        host_deadline(ticks, &deadline);
+    }
+    
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (ticks == 0 ||
+            host_cond_wait(&q->not_full, &q->lock,
+                           ticks == portMAX_DELAY ? NULL : &deadline) == ETIMEDOUT) {
+            pthread_mutex_unlock(&q->lock);
+            return errQUEUE_FULL;
+        }
+    }
+    UBaseType_t slot;
+    if (front) {
+        q->head = (q->head + q->length - 1) % q->length;
+        slot = q->head;
+    } else {
+        slot = (q->head + q->count) % q->length;
+    }
+    memcpy(q->storage + slot * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    return host_queue_put(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks) {
+    return host_queue_put(q, item, ticks, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY) {
+        host_deadline(ticks, &deadline);
+    }
+    
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (ticks == 0 ||
+            host_cond_wait(&q->not_empty, &q->lock,
+                           ticks == portMAX_DELAY ? NULL : &deadline) == ETIMEDOUT) {
+            pthread_mutex_unlock(&q->lock);
+            return errQUEUE_EMPTY;
+        }
+    }
+    memcpy(item, q->storage + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    pthread_mutex_lock(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
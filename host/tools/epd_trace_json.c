@@ -0,0 +1,297 @@
+/**
+ * 跟踪环转换工具
+ *   epd_trace_json 串口日志 输出.json
+ * 从日志中找出最后一段完整的EPD_TRACE导出 (格式见 epd_trace.h), 校验后转换为
+ * Chrome trace事件格式, 可在 chrome://tracing 或 ui.perfetto.dev 中打开;
+ * 每块面板 (CS引脚) 为一条轨道
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "epd_common.h"
+#include "epd_trace.h"
+
+#define LINE_MAX_LEN    512
+
+typedef struct {
+    epd_trace_event_t e;
+    int64_t ts;                 // 展开回绕后的开始时间(微秒)
+} trace_item_t;
+
+// SSD1619命令名称
+static const struct {
+    uint8_t cmd;
+    const char *name;
+} s_cmd_names[] = {
+    { 0x01, "DRIVER_OUTPUT" },
+    { 0x03, "GATE_VOLTAGE" },
+    { 0x04, "SOURCE_VOLTAGE" },
+    { 0x0C, "BOOSTER_SOFTSTART" },
+    { 0x10, "DEEP_SLEEP" },
+    { 0x11, "DATA_ENTRY_MODE" },
+    { 0x12, "SW_RESET" },
+    { 0x18, "TEMP_SENSOR" },
+    { 0x1A, "TEMP_WRITE" },
+    { 0x1B, "TEMP_READ" },
+    { 0x20, "MASTER_ACTIVATION" },
+    { 0x21, "UPDATE_CTRL1" },
+    { 0x22, "UPDATE_CTRL2" },
+    { 0x24, "WRITE_RAM_BW" },
+    { 0x26, "WRITE_RAM_RED" },
+    { 0x32, "WRITE_LUT" },
+    { 0x3C, "BORDER_WAVEFORM" },
+    { 0x44, "RAM_X_RANGE" },
+    { 0x45, "RAM_Y_RANGE" },
+    { 0x4E, "RAM_X_COUNTER" },
+    { 0x4F, "RAM_Y_COUNTER" },
+};
+
+static const char *mode_name(uint8_t mode) {
+    switch (mode) {
+        case EPD_UPDATE_FULL:
+            return "FULL";
+        case EPD_UPDATE_PARTIAL:
+            return "PARTIAL";
+        case EPD_UPDATE_FAST:
+            return "FAST";
+        default:
+            return "?";
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 解析一行事件数据, 失败返回-1
+static int parse_event(const char *hex, epd_trace_event_t *e, uint32_t *hash) {
+    uint8_t b[EPD_TRACE_EVENT_SIZE];
+    
+    for (int i = 0; i < EPD_TRACE_EVENT_SIZE; i++) {
+        int hi = hex_value(hex[i * 2]);
+        int lo = hi < 0 ? -1 : hex_value(hex[i * 2 + 1]);
+        if (lo < 0) {
+            return -1;
+        }
+        b[i] = (uint8_t)(hi << 4 | lo);
+        *hash = (*hash ^ b[i]) * 16777619u;
+    }
+    
+    e->ts_us = read_u32(b);
+    e->dur_us = read_u32(b + 4);
+    e->value = read_u32(b + 8);
+    e->type = b[12];
+    e->code = b[13];
+    e->dev = (int8_t)b[14];
+    e->flags = b[15];
+    return 0;
+}
+
+// 读取日志中最后一段完整且校验通过的导出
+static trace_item_t *load_dump(FILE *f, uint32_t *out_count, uint32_t *out_dropped) {
+    char line[LINE_MAX_LEN];
+    trace_item_t *items = NULL;
+    trace_item_t *best = NULL;
+    uint32_t count = 0, expected = 0, dropped = 0, hash = 0;
+    bool in_dump = false;
+    
+    while (fgets(line, sizeof(line), f)) {
+        char *p;
+    
+        if ((p = strstr(line, EPD_TRACE_DUMP_PREFIX "_BEGIN "))) {
+            unsigned n, d;
+            if (sscanf(p, EPD_TRACE_DUMP_PREFIX "_BEGIN v1 count=%u dropped=%u", &n, &d) != 2) {
+                continue;
+            }
+            free(items);
+            items = calloc(n ? n : 1, sizeof(trace_item_t));
+            if (!items) {
+                break;
+            }
+            expected = n;
+            dropped = d;
+            count = 0;
+            hash = 2166136261u;
+            in_dump = true;
+        } else if ((p = strstr(line, EPD_TRACE_DUMP_PREFIX "_END "))) {
+            unsigned fnv;
+            if (in_dump && sscanf(p, EPD_TRACE_DUMP_PREFIX "_END fnv=%x", &fnv) == 1 &&
+                count == expected && fnv == hash) {
+                free(best);
+                best = items;
+                items = NULL;
+                *out_count = count;
+                *out_dropped = dropped;
+            } else if (in_dump) {
+                fprintf(stderr, "跳过不完整或校验失败的导出 (%u/%u个事件)\n", count, expected);
+            }
+            in_dump = false;
+        } else if (in_dump && (p = strstr(line, EPD_TRACE_DUMP_PREFIX " "))) {
+            p += strlen(EPD_TRACE_DUMP_PREFIX " ");
+            if (count < expected && parse_event(p, &items[count].e, &hash) == 0) {
+                count++;
+            }
+        }
+    }
+    
+    free(items);
+    return best;
+}
+
+// 32位时间戳展开: 相邻事件相差不超过约35分钟
+static void unwrap_timestamps(trace_item_t *items, uint32_t count) {
+    int64_t last = 0;
+    int64_t min = 0;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t prev = i ? items[i - 1].e.ts_us : items[0].e.ts_us;
+        last += (int32_t)(items[i].e.ts_us - prev);
+        items[i].ts = last;
+        if (i == 0 || last < min) {
+            min = last;
+        }
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        items[i].ts -= min;
+    }
+}
+
+static void write_event(FILE *out, const trace_item_t *item, bool first) {
+    const epd_trace_event_t *e = &item->e;
+    char name[48];
+    bool span = e->dur_us > 0 || e->type == EPD_TRACE_BUSY || e->type == EPD_TRACE_DATA ||
+                e->type == EPD_TRACE_REFRESH || e->type == EPD_TRACE_DISPLAY;
+    
+    switch (e->type) {
+        case EPD_TRACE_CMD:
+            snprintf(name, sizeof(name), "CMD 0x%02X", e->code);
+            for (size_t i = 0; i < sizeof(s_cmd_names) / sizeof(s_cmd_names[0]); i++) {
+                if (s_cmd_names[i].cmd == e->code) {
+                    snprintf(name, sizeof(name), "0x%02X %s", e->code, s_cmd_names[i].name);
+                    break;
+                }
+            }
+            break;
+        case EPD_TRACE_DATA:
+            snprintf(name, sizeof(name), "RAM write");
+            break;
+        case EPD_TRACE_BUSY:
+            snprintf(name, sizeof(name), "BUSY");
+            break;
+        case EPD_TRACE_REFRESH:
+            snprintf(name, sizeof(name), "refresh %s", mode_name(e->code));
+            break;
+        case EPD_TRACE_DISPLAY:
+            snprintf(name, sizeof(name), "display %s", mode_name(e->code));
+            break;
+        case EPD_TRACE_RESET:
+            snprintf(name, sizeof(name), "reset");
+            break;
+        case EPD_TRACE_MARK:
+            snprintf(name, sizeof(name), "mark %u", e->code);
+            break;
+        default:
+            snprintf(name, sizeof(name), "type %u", e->type);
+            break;
+    }
+    
+    fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"epd\",\"pid\":1,\"tid\":%d,\"ts\":%lld",
+            first ? "" : ",", name, e->dev, (long long)item->ts);
+    if (span) {
+        fprintf(out, ",\"ph\":\"X\",\"dur\":%u", e->dur_us);
+    } else {
+        fprintf(out, ",\"ph\":\"i\",\"s\":\"t\"");
+    }
+    
+    fprintf(out, ",\"args\":{\"value\":%u", e->value);
+    if (e->type == EPD_TRACE_DATA && e->dur_us) {
+        fprintf(out, ",\"bytes_per_sec\":%llu",
+                (unsigned long long)e->value * 1000000 / e->dur_us);
+    }
+    if (e->flags & EPD_TRACE_FLAG_ERROR) {
+        fprintf(out, ",\"error\":true");
+    }
+    fprintf(out, "}}");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "用法: %s 串口日志 输出.json\n", argv[0]);
+        return 2;
+    }
+    
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        fprintf(stderr, "无法打开 %s\n", argv[1]);
+        return 1;
+    }
+    
+    uint32_t count = 0, dropped = 0;
+    trace_item_t *items = load_dump(in, &count, &dropped);
+    fclose(in);
+    
+    if (!items) {
+        fprintf(stderr, "%s 中没有完整的跟踪导出\n", argv[1]);
+        return 1;
+    }
+    
+    unwrap_timestamps(items, count);
+    
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "无法写入 %s\n", argv[2]);
+        free(items);
+        return 1;
+    }
+    
+    // 轨道名称: 每个出现过的CS引脚一条, -1为应用标记
+    bool seen[256] = { false };
+    bool first = true;
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t tid = (uint8_t)items[i].e.dev;
+        if (seen[tid]) {
+            continue;
+        }
+        seen[tid] = true;
+        if (items[i].e.dev < 0) {
+            fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"name\":\"app\"}}", first ? "" : ",", items[i].e.dev);
+        } else {
+            fprintf(out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"name\":\"panel CS%d\"}}", first ? "" : ",",
+                    items[i].e.dev, items[i].e.dev);
+        }
+        first = false;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        write_event(out, &items[i], first);
+        first = false;
+    }
+    fprintf(out, "\n]}\n");
+    
+    int ret = fclose(out) == 0 ? 0 : 1;
+    printf("%u个事件 (环中被覆盖 %u 个) -> %s\n", count, dropped, argv[2]);
+    
+    free(items);
+    return ret;
+}
@@ -0,0 +1,101 @@
+/**
+ * EPF压缩帧编码实现
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "epd_epf.h"
+#include "epf_codec.h"
+
+// 从src[i]开始的相同字节数
+static uint32_t epf_run_length(const uint8_t *src, uint32_t i, uint32_t len) {
+    uint32_t n = 1;
+    while (i + n < len && src[i + n] == src[i] && n < EPD_EPF_MAX_LONG_RUN) {
+        n++;
+    }
+    return n;
+}
+
+uint32_t epf_encode_bound(uint32_t len) {
+    // 最坏情况: 全部为字面量, 每128字节一个控制字节
+    return len + (len + EPD_EPF_MAX_LITERAL - 1) / EPD_EPF_MAX_LITERAL;
+}
+
+uint32_t epf_encode_plane(const uint8_t *src, uint32_t len, uint8_t *dst) {
+    uint32_t out = 0;
+    uint32_t i = 0;
+    
+    while (i < len) {
+        uint32_t run = epf_run_length(src, i, len);
+        
+        if (run >= 3) {
+            if (run > EPD_EPF_MAX_SHORT_RUN) {
+                dst[out++] = EPD_EPF_OP_LONG_RUN;
+                dst[out++] = run & 0xFF;
+                dst[out++] = (run >> 8) & 0xFF;
+            } else {
+                dst[out++] = (uint8_t)(257 - run);
+            }
+            dst[out++] = src[i];
+            i += run;
+            continue;
+        }
+        
+        // 字面量段: 直到出现长度>=3的重复或达到128字节
+        uint32_t start = i;
+        while (i < len && i - start < EPD_EPF_MAX_LITERAL) {
+            if (epf_run_length(src, i, len) >= 3) {
+                break;
+            }
+            i++;
+        }
+        
+        uint32_t n = i - start;
+        dst[out++] = (uint8_t)(n - 1);
+        memcpy(dst + out, src + start, n);
+        out += n;
+    }
+    
+    return out;
+}
+
+static void epf_put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void epf_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+uint8_t* epf_encode_frame(uint16_t width, uint16_t height,
+                          const uint8_t *bw, const uint8_t *red, uint32_t *out_size) {
+    if (!bw || !out_size || (width % 8)) {
+        return NULL;
+    }
+    
+    uint32_t plane_size = (uint32_t)width * height / 8;
+    uint32_t bound = EPD_EPF_HEADER_SIZE + epf_encode_bound(plane_size) * (red ? 2 : 1);
+    uint8_t *out = calloc(1, bound);
+    if (!out) {
+        return NULL;
+    }
+    
+    uint8_t *payload = out + EPD_EPF_HEADER_SIZE;
+    uint32_t bw_len = epf_encode_plane(bw, plane_size, payload);
+    uint32_t red_len = red ? epf_encode_plane(red, plane_size, payload + bw_len) : 0;
+    
+    memcpy(out, EPD_EPF_MAGIC, 4);
+    epf_put_u16(out + 4, width);
+    epf_put_u16(out + 6, height);
+    out[8] = red ? EPD_EPF_FLAG_RED : 0;
+    epf_put_u32(out + 12, bw_len);
+    epf_put_u32(out + 16, red_len);
+    
+    *out_size = EPD_EPF_HEADER_SIZE + bw_len + red_len;
+    return out;
+}
@@ -0,0 +1,21 @@
+/**
+ * EPF压缩帧编码 (主机端)
+ * 格式定义见 epd_epf.h
+ */
+
+#ifndef __EPF_CODEC_H__
+#define __EPF_CODEC_H__
+
+#include <stdint.h>
+
+// 单个平面编码结果的最大长度
+uint32_t epf_encode_bound(uint32_t len);
+
+// 编码一个平面, 返回写入dst的字节数, dst容量至少为epf_encode_bound(len)
+uint32_t epf_encode_plane(const uint8_t *src, uint32_t len, uint8_t *dst);
+
+// 编码完整帧 (含文件头), red可为NULL; 返回malloc分配的数据, 由调用者free
+uint8_t* epf_encode_frame(uint16_t width, uint16_t height,
+                          const uint8_t *bw, const uint8_t *red, uint32_t *out_size);
+
+#endif // __EPF_CODEC_H__
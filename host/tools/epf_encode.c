@@ -0,0 +1,165 @@
+/**
+ * EPF离线编码工具
+ *   epf_encode [-r red.pbm] [-c 符号名] bw.pbm 输出文件
+ * 输入为PBM(P4), 黑白图中黑色像素为1, 红色图中红色像素为1;
+ * 指定-c时输出C源文件, 否则输出二进制.epf
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "epf_codec.h"
+
+// 读取PBM头中的一个整数, 跳过空白和注释
+static int pbm_read_int(FILE *f, int *value) {
+    int c;
+    
+    for (;;) {
+        c = fgetc(f);
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = fgetc(f);
+            }
+        } else if (!isspace(c)) {
+            break;
+        }
+    }
+    
+    if (!isdigit(c)) {
+        return -1;
+    }
+    
+    *value = 0;
+    while (isdigit(c)) {
+        *value = *value * 10 + (c - '0');
+        c = fgetc(f);
+    }
+    return 0;
+}
+
+// 读取PBM为1bpp缓冲区, invert为true时按墨水屏约定(1为白)取反
+static uint8_t *pbm_load(const char *path, int *width, int *height, int invert) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "无法打开 %s\n", path);
+        return NULL;
+    }
+    
+    char magic[2];
+    if (fread(magic, 1, 2, f) != 2 || magic[0] != 'P' || magic[1] != '4' ||
+        pbm_read_int(f, width) || pbm_read_int(f, height) || (*width % 8)) {
+        fprintf(stderr, "%s: 需要宽度为8的倍数的P4格式PBM\n", path);
+        fclose(f);
+        return NULL;
+    }
+    
+    size_t size = (size_t)*width * *height / 8;
+    uint8_t *buf = malloc(size);
+    if (!buf || fread(buf, 1, size, f) != size) {
+        fprintf(stderr, "%s: 像素数据不完整\n", path);
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    
+    if (invert) {
+        for (size_t i = 0; i < size; i++) {
+            buf[i] = ~buf[i];
+        }
+    }
+    return buf;
+}
+
+static int write_c_source(const char *path, const char *name,
+                          const uint8_t *data, uint32_t size) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return -1;
+    }
+    
+    fprintf(f, "// 由epf_encode生成, 请勿手工修改\n");
+    fprintf(f, "#include <stdint.h>\n\n");
+    fprintf(f, "const uint32_t %s_size = %u;\n", name, (unsigned)size);
+    fprintf(f, "const uint8_t %s[%u] = {", name, (unsigned)size);
+    for (uint32_t i = 0; i < size; i++) {
+        fprintf(f, "%s0x%02X,", (i % 16) ? " " : "\n    ", data[i]);
+    }
+    fprintf(f, "\n};\n");
+    
+    return fclose(f);
+}
+
+int main(int argc, char **argv) {
+    const char *red_path = NULL;
+    const char *c_name = NULL;
+    int argi = 1;
+    
+    while (argi < argc && argv[argi][0] == '-') {
+        if (!strcmp(argv[argi], "-r") && argi + 1 < argc) {
+            red_path = argv[argi + 1];
+        } else if (!strcmp(argv[argi], "-c") && argi + 1 < argc) {
+            c_name = argv[argi + 1];
+        } else {
+            break;
+        }
+        argi += 2;
+    }
+    
+    if (argc - argi != 2) {
+        fprintf(stderr, "用法: %s [-r red.pbm] [-c 符号名] bw.pbm 输出文件\n", argv[0]);
+        return 2;
+    }
+    
+    int width, height, rw, rh;
+    uint8_t *bw = pbm_load(argv[argi], &width, &height, 1);
+    uint8_t *red = NULL;
+    if (!bw) {
+        return 1;
+    }
+    
+    if (red_path) {
+        red = pbm_load(red_path, &rw, &rh, 0);
+        if (!red || rw != width || rh != height) {
+            fprintf(stderr, "红色平面尺寸与黑白平面不符\n");
+            free(bw);
+            free(red);
+            return 1;
+        }
+    }
+    
+    uint32_t size;
+    uint8_t *frame = epf_encode_frame(width, height, bw, red, &size);
+    if (!frame) {
+        fprintf(stderr, "编码失败\n");
+        free(bw);
+        free(red);
+        return 1;
+    }
+    
+    int ret;
+    if (c_name) {
+        ret = write_c_source(argv[argi + 1], c_name, frame, size);
+    } else {
+        FILE *f = fopen(argv[argi + 1], "wb");
+        ret = (!f || fwrite(frame, 1, size, f) != size) ? -1 : 0;
+        if (f && fclose(f) != 0) {
+            ret = -1;
+        }
+    }
+    
+    uint32_t raw = (uint32_t)width * height / 8 * (red ? 2 : 1);
+    if (ret == 0) {
+        printf("%dx%d%s: %u -> %u 字节 (%.1f%%)\n", width, height, red ? " 双平面" : "",
+               (unsigned)raw, (unsigned)size, 100.0 * size / raw);
+    } else {
+        fprintf(stderr, "写入 %s 失败\n", argv[argi + 1]);
+    }
+    
+    free(frame);
+    free(bw);
+    free(red);
+    return ret ? 1 : 0;
+}
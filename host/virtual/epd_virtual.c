@@ -0,0 +1,547 @@
+/**
+ * 主机端虚拟墨水屏实现
+ * 挂接在SPI/GPIO仿真层上, 按SSD1619协议解码命令流
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+#include "epd_common.h"
+#include "epd_ssd1619.h"
+#include "epd_virtual.h"
+
+#define TAG "EPD_VIRTUAL"
+
+// 解码用到的SSD1619命令
+#define VCMD_DEEP_SLEEP          0x10
+#define VCMD_DATA_ENTRY_MODE     0x11
+#define VCMD_SW_RESET            0x12
+#define VCMD_TEMP_WRITE          0x1A
+#define VCMD_TEMP_READ           0x1B
+#define VCMD_MASTER_ACTIVATION   0x20
+#define VCMD_DISP_UPDATE_CTRL2   0x22
+#define VCMD_WRITE_RAM_BW        0x24
+#define VCMD_WRITE_RAM_RED       0x26
+#define VCMD_WRITE_LUT           0x32
+#define VCMD_RAM_X_START_END     0x44
+#define VCMD_RAM_Y_START_END     0x45
+#define VCMD_RAM_X_COUNTER       0x4E
+#define VCMD_RAM_Y_COUNTER       0x4F
+
+// 0x22更新控制位
+#define VCTRL_ENABLE_CLOCK       0x80
+#define VCTRL_LOAD_TEMP          0x20
+#define VCTRL_LOAD_LUT           0x10
+#define VCTRL_DISPLAY            0x04
+
+struct epd_virtual_panel_t {
+    epd_virtual_config_t cfg;
+    uint16_t stride;                // 每行字节数
+    uint32_t plane_size;
+    uint8_t *ram[EPD_VIRTUAL_PLANE_MAX];
+    uint8_t *image[EPD_VIRTUAL_PLANE_MAX];
+    
+    // 命令解码状态
+    uint8_t dc;                     // 当前DC电平
+    uint8_t cmd;                    // 当前命令
+    uint32_t param_idx;             // 当前命令已收到的参数字节数
+    uint8_t entry_mode;             // 0x11: bit0 X增量, bit1 Y增量, bit2 Y方向优先
+    uint16_t x_start, x_end;        // 0x44 (字节单位)
+    uint16_t y_start, y_end;        // 0x45
+    uint16_t x, y;                  // 0x4E/0x4F 地址计数器
+    uint8_t update_ctrl;            // 0x22
+    bool custom_lut;                // 0x32写入的LUT生效中 (装载OTP LUT或复位后清除)
+    int16_t temp_reg;               // 温度寄存器 (1/16摄氏度), 0x1A写入或0x22测量
+    bool sleeping;
+    
+    // BUSY仿真
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    volatile int busy;
+    int64_t busy_until;
+    
+    epd_virtual_stats_t stats;
+};
+
+void epd_virtual_default_config(epd_virtual_config_t *cfg) {
+    if (!cfg) {
+        return;
+    }
+    
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->width = 296;
+    cfg->height = 128;
+    cfg->color_mode = EPD_MODE_3C;
+    cfg->temperature_c = 25;
+    cfg->pins = (epd_pins_t){
+        .spi_miso = 19,
+        .spi_mosi = 23,
+        .spi_clk = 18,
+        .spi_cs = 5,
+        .dc_pin = 17,
+        .rst_pin = 16,
+        .busy_pin = 4,
+        .pwr_en_pin = -1,
+    };
+}
+
+// 恢复复位后的寄存器默认值
+static void vpanel_reset_registers(epd_virtual_panel_t *p) {
+    p->cmd = 0;
+    p->param_idx = 0;
+    p->entry_mode = 0x03;
+    p->x_start = 0;
+    p->x_end = p->stride - 1;
+    p->y_start = 0;
+    p->y_end = p->cfg.height - 1;
+    p->x = 0;
+    p->y = 0;
+    p->update_ctrl = 0;
+    p->custom_lut = false;
+    p->temp_reg = 25 * 16;
+}
+
+// 拉高BUSY并在duration_ms后由后台线程产生下降沿
+static void vpanel_start_busy(epd_virtual_panel_t *p, uint32_t duration_ms) {
+    if (duration_ms == 0) {
+        return;
+    }
+    
+    pthread_mutex_lock(&p->lock);
+    p->busy = 1;
+    p->busy_until = esp_timer_get_time() + (int64_t)duration_ms * 1000;
+    pthread_cond_signal(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+}
+
+static void *vpanel_busy_thread(void *arg) {
+    epd_virtual_panel_t *p = (epd_virtual_panel_t *)arg;
+    
+    pthread_mutex_lock(&p->lock);
+    while (p->running) {
+        if (!p->busy) {
+            pthread_cond_wait(&p->cond, &p->lock);
+            continue;
+        }
+    
+        int64_t remain = p->busy_until - esp_timer_get_time();
+        if (remain > 0) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += remain / 1000000;
+            ts.tv_nsec += (remain % 1000000) * 1000;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&p->cond, &p->lock, &ts);
+            continue;
+        }
+    
+        // 先更新电平再触发边沿, 与硬件时序一致
+        p->busy = 0;
+        pthread_mutex_unlock(&p->lock);
+        host_gpio_signal_edge(p->cfg.pins.busy_pin, 0);
+        pthread_mutex_lock(&p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+    
+    return NULL;
+}
+
+static int vpanel_busy_level(gpio_num_t pin, void *ctx) {
+    epd_virtual_panel_t *p = (epd_virtual_panel_t *)ctx;
+    (void)pin;
+    return p->busy;
+}
+
+static void vpanel_dc_changed(gpio_num_t pin, uint32_t level, void *ctx) {
+    epd_virtual_panel_t *p = (epd_virtual_panel_t *)ctx;
+    (void)pin;
+    p->dc = level ? 1 : 0;
+}
+
+static void vpanel_rst_changed(gpio_num_t pin, uint32_t level, void *ctx) {
+    epd_virtual_panel_t *p = (epd_virtual_panel_t *)ctx;
+    (void)pin;
+    
+    // 低电平有效, 在下降沿复位, RAM内容保持不变
+    if (level == 0) {
+        p->sleeping = false;
+        vpanel_reset_registers(p);
+        p->stats.resets++;
+    }
+}
+
+// 地址计数器前进一步, 到达窗口终点时回到起点并返回true
+static bool vpanel_step(uint16_t *counter, uint16_t start, uint16_t end, bool inc) {
+    if (*counter == end) {
+        *counter = start;
+        return true;
+    }
+    
+    if (inc) {
+        (*counter)++;
+    } else {
+        (*counter)--;
+    }
+    return false;
+}
+
+static void vpanel_write_ram(epd_virtual_panel_t *p, epd_virtual_plane_t plane, uint8_t value) {
+    if (p->x < p->stride && p->y < p->cfg.height) {
+        p->ram[plane][(uint32_t)p->y * p->stride + p->x] = value;
+        p->stats.ram_bytes[plane]++;
+    } else {
+        p->stats.out_of_range++;
+    }
+    
+    bool x_inc = p->entry_mode & 0x01;
+    bool y_inc = p->entry_mode & 0x02;
+    
+    if (p->entry_mode & 0x04) {
+        if (vpanel_step(&p->y, p->y_start, p->y_end, y_inc)) {
+            vpanel_step(&p->x, p->x_start, p->x_end, x_inc);
+        }
+    } else {
+        if (vpanel_step(&p->x, p->x_start, p->x_end, x_inc)) {
+            vpanel_step(&p->y, p->y_start, p->y_end, y_inc);
+        }
+    }
+}
+
+// 主激活: 显示位置位时把RAM锁存为显示图像
+static void vpanel_activate(epd_virtual_panel_t *p) {
+    p->stats.activations++;
+    
+    if (p->update_ctrl & VCTRL_LOAD_TEMP) {
+        p->temp_reg = p->cfg.temperature_c * 16;
+    }
+    
+    if (p->update_ctrl & VCTRL_LOAD_LUT) {
+        p->custom_lut = false;
+        p->stats.otp_lut_loads++;
+        p->stats.waveform_temp_c = (int8_t)(p->temp_reg >> 4);
+    }
+    
+    if (!(p->update_ctrl & VCTRL_DISPLAY)) {
+        return;
+    }
+    
+    for (int i = 0; i < EPD_VIRTUAL_PLANE_MAX; i++) {
+        memcpy(p->image[i], p->ram[i], p->plane_size);
+    }
+    
+    if (p->custom_lut) {
+        p->stats.custom_lut_updates++;
+    }
+    
+    if (p->update_ctrl & VCTRL_ENABLE_CLOCK) {
+        p->stats.full_updates++;
+        vpanel_start_busy(p, p->cfg.full_busy_ms);
+    } else {
+        p->stats.partial_updates++;
+        vpanel_start_busy(p, p->cfg.partial_busy_ms);
+    }
+}
+
+static void vpanel_command(epd_virtual_panel_t *p, uint8_t cmd) {
+    p->cmd = cmd;
+    p->param_idx = 0;
+    p->stats.commands++;
+    
+    switch (cmd) {
+        case VCMD_SW_RESET:
+            vpanel_reset_registers(p);
+            vpanel_start_busy(p, p->cfg.reset_busy_ms);
+            break;
+        case VCMD_MASTER_ACTIVATION:
+            vpanel_activate(p);
+            break;
+        case VCMD_WRITE_LUT:
+            p->custom_lut = true;
+            p->stats.lut_writes++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void vpanel_data(epd_virtual_panel_t *p, uint8_t value) {
+    uint32_t idx = p->param_idx++;
+    
+    switch (p->cmd) {
+        case VCMD_DEEP_SLEEP:
+            if (idx == 0 && (value & 0x03)) {
+                p->sleeping = true;
+            }
+            break;
+        case VCMD_DATA_ENTRY_MODE:
+            if (idx == 0) {
+                p->entry_mode = value & 0x07;
+            }
+            break;
+        case VCMD_DISP_UPDATE_CTRL2:
+            if (idx == 0) {
+                p->update_ctrl = value;
+            }
+            break;
+        case VCMD_TEMP_WRITE:
+            // 12位补码, 高8位在前
+            if (idx == 0) {
+                p->temp_reg = (int16_t)((uint16_t)value << 8) >> 4;
+            } else if (idx == 1) {
+                p->temp_reg = (p->temp_reg & ~0x0F) | (value >> 4);
+            }
+            break;
+        case VCMD_RAM_X_START_END:
+            if (idx == 0) {
+                p->x_start = value;
+            } else if (idx == 1) {
+                p->x_end = value;
+            }
+            break;
+        case VCMD_RAM_Y_START_END:
+            if (idx == 0) {
+                p->y_start = (p->y_start & 0xFF00) | value;
+            } else if (idx == 1) {
+                p->y_start = (p->y_start & 0x00FF) | ((uint16_t)value << 8);
+            } else if (idx == 2) {
+                p->y_end = (p->y_end & 0xFF00) | value;
+            } else if (idx == 3) {
+                p->y_end = (p->y_end & 0x00FF) | ((uint16_t)value << 8);
+            }
+            break;
+        case VCMD_RAM_X_COUNTER:
+            if (idx == 0) {
+                p->x = value;
+            }
+            break;
+        case VCMD_RAM_Y_COUNTER:
+            if (idx == 0) {
+                p->y = (p->y & 0xFF00) | value;
+            } else if (idx == 1) {
+                p->y = (p->y & 0x00FF) | ((uint16_t)value << 8);
+            }
+            break;
+        case VCMD_WRITE_RAM_BW:
+            vpanel_write_ram(p, EPD_VIRTUAL_PLANE_BW, value);
+            break;
+        case VCMD_WRITE_RAM_RED:
+            vpanel_write_ram(p, EPD_VIRTUAL_PLANE_RED, value);
+            break;
+        default:
+            break;
+    }
+}
+
+// SPI数据接收: DC电平在事务开始前由pre_cb设置
+static void vpanel_spi_sink(int cs_pin, const uint8_t *tx, uint8_t *rx,
+                            size_t len, void *ctx) {
+    epd_virtual_panel_t *p = (epd_virtual_panel_t *)ctx;
+    (void)cs_pin;   // 每块面板单独注册, ctx已区分
+    
+    if (!tx) {
+        return;
+    }
+    
+    if (p->sleeping) {
+        p->stats.ignored_in_sleep += len;
+        return;
+    }
+    
+    if (p->busy) {
+        p->stats.written_while_busy += len;
+    }
+    
+    for (size_t i = 0; i < len; i++) {
+        // 读温度寄存器: 12位补码, 高8位在前
+        if (p->dc && p->cmd == VCMD_TEMP_READ && rx) {
+            uint16_t raw = (uint16_t)p->temp_reg << 4;
+            rx[i] = (p->param_idx++ == 0) ? raw >> 8 : raw & 0xF0;
+            continue;
+        }
+        if (p->dc) {
+            vpanel_data(p, tx[i]);
+        } else {
+            vpanel_command(p, tx[i]);
+        }
+    }
+}
+
+epd_virtual_panel_t* epd_virtual_panel_create(const epd_virtual_config_t *cfg) {
+    if (!cfg || cfg->width == 0 || cfg->height == 0) {
+        return NULL;
+    }
+    
+    epd_virtual_panel_t *p = calloc(1, sizeof(epd_virtual_panel_t));
+    if (!p) {
+        return NULL;
+    }
+    
+    p->cfg = *cfg;
+    p->stride = (cfg->width + 7) / 8;
+    p->plane_size = (uint32_t)p->stride * cfg->height;
+    
+    for (int i = 0; i < EPD_VIRTUAL_PLANE_MAX; i++) {
+        p->ram[i] = calloc(1, p->plane_size);
+        p->image[i] = calloc(1, p->plane_size);
+        if (!p->ram[i] || !p->image[i]) {
+            epd_virtual_panel_destroy(p);
+            return NULL;
+        }
+    }
+    
+    vpanel_reset_registers(p);
+    
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->cond, NULL);
+    p->running = true;
+    if (pthread_create(&p->thread, NULL, vpanel_busy_thread, p) != 0) {
+        p->running = false;
+        epd_virtual_panel_destroy(p);
+        return NULL;
+    }
+    
+    host_spi_set_sink(cfg->pins.spi_cs, vpanel_spi_sink, p);
+    host_gpio_set_output_hook(cfg->pins.dc_pin, vpanel_dc_changed, p);
+    host_gpio_set_output_hook(cfg->pins.rst_pin, vpanel_rst_changed, p);
+    host_gpio_set_input_hook(cfg->pins.busy_pin, vpanel_busy_level, p);
+    
+    ESP_LOGI(TAG, "虚拟面板: %dx%d, CS=%d", cfg->width, cfg->height, cfg->pins.spi_cs);
+    return p;
+}
+
+void epd_virtual_panel_destroy(epd_virtual_panel_t *panel) {
+    if (!panel) {
+        return;
+    }
+    
+    if (panel->running) {
+        host_spi_set_sink(panel->cfg.pins.spi_cs, NULL, NULL);
+        host_gpio_set_output_hook(panel->cfg.pins.dc_pin, NULL, NULL);
+        host_gpio_set_output_hook(panel->cfg.pins.rst_pin, NULL, NULL);
+        host_gpio_set_input_hook(panel->cfg.pins.busy_pin, NULL, NULL);
+    
+        pthread_mutex_lock(&panel->lock);
+        panel->running = false;
+        pthread_cond_signal(&panel->cond);
+        pthread_mutex_unlock(&panel->lock);
+        pthread_join(panel->thread, NULL);
+        pthread_mutex_destroy(&panel->lock);
+        pthread_cond_destroy(&panel->cond);
+    }
+    
+    for (int i = 0; i < EPD_VIRTUAL_PLANE_MAX; i++) {
+        free(panel->ram[i]);
+        free(panel->image[i]);
+    }
+    free(panel);
+}
+
+epd_device_t* epd_virtual_create(const epd_virtual_config_t *cfg,
+                                 epd_virtual_panel_t **panel) {
+    epd_virtual_panel_t *p = epd_virtual_panel_create(cfg);
+    if (!p) {
+        return NULL;
+    }
+    
+    epd_device_t *dev = epd_ssd1619_create(&cfg->pins, cfg->width, cfg->height,
+                                           cfg->color_mode);
+    if (!dev) {
+        epd_virtual_panel_destroy(p);
+        return NULL;
+    }
+    
+    if (panel) {
+        *panel = p;
+    }
+    return dev;
+}
+
+void epd_virtual_destroy(epd_device_t *dev, epd_virtual_panel_t *panel) {
+    if (dev) {
+        if (dev->priv) {
+            dev->deinit(dev);
+        }
+        free(dev);
+    }
+    epd_virtual_panel_destroy(panel);
+}
+
+void epd_virtual_set_temperature(epd_virtual_panel_t *panel, int8_t temp_c) {
+    if (panel) {
+        panel->cfg.temperature_c = temp_c;
+    }
+}
+
+const uint8_t* epd_virtual_get_image(const epd_virtual_panel_t *panel,
+                                     epd_virtual_plane_t plane) {
+    if (!panel || plane >= EPD_VIRTUAL_PLANE_MAX) {
+        return NULL;
+    }
+    return panel->image[plane];
+}
+
+const uint8_t* epd_virtual_get_ram(const epd_virtual_panel_t *panel,
+                                   epd_virtual_plane_t plane) {
+    if (!panel || plane >= EPD_VIRTUAL_PLANE_MAX) {
+        return NULL;
+    }
+    return panel->ram[plane];
+}
+
+uint32_t epd_virtual_get_plane_size(const epd_virtual_panel_t *panel) {
+    return panel ? panel->plane_size : 0;
+}
+
+void epd_virtual_get_stats(const epd_virtual_panel_t *panel, epd_virtual_stats_t *stats) {
+    if (panel && stats) {
+        *stats = panel->stats;
+    }
+}
+
+void epd_virtual_reset_stats(epd_virtual_panel_t *panel) {
+    if (panel) {
+        memset(&panel->stats, 0, sizeof(panel->stats));
+    }
+}
+
+esp_err_t epd_virtual_dump_pbm(const epd_virtual_panel_t *panel,
+                               epd_virtual_plane_t plane, const char *path) {
+    if (!panel || plane >= EPD_VIRTUAL_PLANE_MAX || !path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "无法创建文件: %s", path);
+        return ESP_FAIL;
+    }
+    
+    fprintf(f, "P4\n%d %d\n", panel->cfg.width, panel->cfg.height);
+    
+    // PBM中1为黑色: 黑白平面需要取反, 红色平面直接输出
+    uint8_t invert = (plane == EPD_VIRTUAL_PLANE_BW) ? 0xFF : 0x00;
+    const uint8_t *src = panel->image[plane];
+    bool ok = true;
+    
+    for (uint32_t i = 0; i < panel->plane_size && ok; i++) {
+        ok = fputc(src[i] ^ invert, f) != EOF;
+    }
+    
+    if (fclose(f) != 0 || !ok) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
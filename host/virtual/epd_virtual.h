@@ -0,0 +1,82 @@
+/**
+ * 主机端虚拟墨水屏
+ * 解码SSD1619命令流并维护内存中的面板图像
+ */
+
+#ifndef __EPD_VIRTUAL_H__
+#define __EPD_VIRTUAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+// 面板RAM平面
+typedef enum {
+    EPD_VIRTUAL_PLANE_BW = 0,   // 0x24 黑白RAM (1 = 白)
+    EPD_VIRTUAL_PLANE_RED,      // 0x26 红色RAM (1 = 红)
+    EPD_VIRTUAL_PLANE_MAX
+} epd_virtual_plane_t;
+
+// 虚拟面板配置
+typedef struct {
+    uint16_t width;             // 宽度(像素), 对应RAM X方向
+    uint16_t height;            // 高度(像素), 对应RAM Y方向
+    epd_color_mode_t color_mode;
+    epd_pins_t pins;            // 仅使用spi_cs/dc_pin/rst_pin/busy_pin, spi_miso<0时驱动无法读取温度
+    uint32_t reset_busy_ms;     // 软复位后BUSY保持时间
+    uint32_t full_busy_ms;      // 全刷BUSY保持时间
+    uint32_t partial_busy_ms;   // 局刷/快刷BUSY保持时间
+    int8_t temperature_c;       // 内部温度传感器读数
+} epd_virtual_config_t;
+
+// 虚拟面板统计
+typedef struct {
+    uint32_t commands;          // 收到的命令数
+    uint64_t ram_bytes[EPD_VIRTUAL_PLANE_MAX];  // 写入各平面RAM的字节数
+    uint32_t out_of_range;      // 越过RAM边界被丢弃的字节数
+    uint32_t activations;       // 主激活次数
+    uint32_t full_updates;      // 其中全刷次数
+    uint32_t partial_updates;   // 其中局刷/快刷次数
+    uint32_t lut_writes;        // 0x32写入自定义LUT的次数
+    uint32_t custom_lut_updates; // 使用自定义LUT的刷新次数
+    uint32_t otp_lut_loads;     // 从OTP装载波形的次数
+    int8_t waveform_temp_c;     // 最近一次从OTP装载波形时温度寄存器的值
+    uint32_t resets;            // 硬件复位次数
+    uint32_t ignored_in_sleep;  // 深度睡眠期间被忽略的字节数
+    uint32_t written_while_busy; // BUSY期间收到的字节数 (控制器忙时不应访问)
+} epd_virtual_stats_t;
+
+typedef struct epd_virtual_panel_t epd_virtual_panel_t;
+
+// 默认配置: 296x128三色, BUSY时间为0 (CI中毫秒级完成)
+void epd_virtual_default_config(epd_virtual_config_t *cfg);
+
+// 创建虚拟面板并挂接到SPI/GPIO仿真层
+epd_virtual_panel_t* epd_virtual_panel_create(const epd_virtual_config_t *cfg);
+void epd_virtual_panel_destroy(epd_virtual_panel_t *panel);
+
+// 创建虚拟面板与连接到它的SSD1619设备, panel可为NULL
+epd_device_t* epd_virtual_create(const epd_virtual_config_t *cfg,
+                                 epd_virtual_panel_t **panel);
+void epd_virtual_destroy(epd_device_t *dev, epd_virtual_panel_t *panel);
+
+// 修改内部温度传感器读数
+void epd_virtual_set_temperature(epd_virtual_panel_t *panel, int8_t temp_c);
+
+// 最近一次主激活时显示的图像 (与驱动缓冲区格式相同)
+const uint8_t* epd_virtual_get_image(const epd_virtual_panel_t *panel,
+                                     epd_virtual_plane_t plane);
+// 当前RAM内容
+const uint8_t* epd_virtual_get_ram(const epd_virtual_panel_t *panel,
+                                   epd_virtual_plane_t plane);
+uint32_t epd_virtual_get_plane_size(const epd_virtual_panel_t *panel);
+
+void epd_virtual_get_stats(const epd_virtual_panel_t *panel, epd_virtual_stats_t *stats);
+void epd_virtual_reset_stats(epd_virtual_panel_t *panel);
+
+// 将显示图像保存为PBM(P4)文件, 黑白平面中黑色像素为1, 红色平面中红色像素为1
+esp_err_t epd_virtual_dump_pbm(const epd_virtual_panel_t *panel,
+                               epd_virtual_plane_t plane, const char *path);
+
+#endif // __EPD_VIRTUAL_H__
@@ -42,12 +42,92 @@ typedef enum {
     EPD_UPDATE_FAST,      // 快速刷新
 } epd_update_mode_t;
 
+// 显示模式
+typedef enum {
+    EPD_DISPLAY_1BPP = 0,   // 每像素1位 (三色屏另有红色平面)
+    EPD_DISPLAY_GRAY4,      // 4级灰度, 每像素2位, 多次激活完成一帧
+    EPD_DISPLAY_MODE_MAX
+} epd_display_mode_t;
+
+// 4级灰度缓冲区: 每字节4个像素, 高位在左, 0为黑, 3为白
+#define EPD_GRAY4_LEVELS            4
+#define EPD_GRAY4_BUFFER_SIZE(w, h) ((uint32_t)(w) * (h) / 4)
+
+// 整屏刷新代价 (display_buffer), 按显示模式分别统计
+typedef struct {
+    uint8_t passes;             // 每帧主激活次数
+    uint32_t ram_bytes;         // 每帧写入RAM的字节数
+    uint32_t refreshes;         // 已完成的刷新次数
+    uint32_t last_us;           // 最近一次耗时 (含RAM写入和BUSY等待)
+    uint32_t avg_us;
+    uint32_t max_us;
+} epd_refresh_cost_t;
+
+// 温度补偿: 按控制器温度选择波形区间, 区间变化时才重新装载波形
+#define EPD_TEMP_MAX_BANDS          8
+#define EPD_TEMP_AUTO               INT8_MIN    // set_temperature: 恢复使用控制器温度传感器
+#ifndef EPD_TEMP_READ_INTERVAL_MS
+#define EPD_TEMP_READ_INTERVAL_MS   60000       // 温度读数有效期, 期间刷新不再重新测量
+#endif
+#ifndef EPD_TEMP_DEFAULT_C
+#define EPD_TEMP_DEFAULT_C          25          // 无法读取温度时假定的温度
+#endif
+
+// 温度区间, 按min_c升序排列, 区间上限为下一区间的下限
+typedef struct {
+    int8_t min_c;               // 区间下限(摄氏度, 含)
+    int8_t lut_temp_c;          // lut为NULL时写入温度寄存器的代表温度, 控制器据此从OTP选择波形
+    const uint8_t *lut;         // 非NULL时直接写入该LUT (格式由驱动定义)
+    uint32_t busy_timeout_ms;   // 该区间的BUSY等待超时, 0表示默认值
+} epd_temp_band_t;
+
+// 温度区间统计 (刷新耗时为主激活到BUSY结束)
+typedef struct {
+    int8_t min_c;
+    uint32_t lut_loads;         // 切换到该区间时装载波形的次数
+    uint32_t refreshes;         // 在该区间完成的刷新次数
+    uint32_t last_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+} epd_temp_band_stats_t;
+
+// 条带渲染: 大尺寸面板按水平条带逐条绘制并写入RAM窗口, 不需要整屏缓冲区
+#ifndef EPD_BAND_HEIGHT
+#define EPD_BAND_HEIGHT             16          // 默认条带高度(行)
+#endif
+
+// 条带绘制回调: 绘制逻辑坐标第y0行起的rows行, bw行跨度为width/8 (调用前填充为白),
+// red为三色屏的红色条带 (已清零, 1为红), 单色屏为NULL; 返回非ESP_OK时放弃本帧
+typedef esp_err_t (*epd_band_draw_t)(void *ctx, uint8_t *bw, uint8_t *red,
+                                     uint16_t y0, uint16_t rows);
+
+// 条带渲染统计 (最近一帧)
+typedef struct {
+    uint16_t band_height;
+    uint16_t bands;             // 条带数
+    uint32_t buffer_bytes;      // 条带缓冲区字节数, 即渲染所需的峰值内存
+    uint32_t frame_bytes;       // 同样内容使用整屏缓冲区所需的字节数
+    uint32_t draw_us;           // 绘制回调累计耗时
+    uint32_t transfer_us;       // RAM窗口设置与写入累计耗时
+    uint32_t total_us;          // 整个调用耗时 (含刷新)
+    uint32_t bytes_per_sec;     // RAM写入吞吐量
+} epd_band_stats_t;
+
+// 矩形区域
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+} epd_rect_t;
+
 // 设备能力标志
 #define EPD_CAP_PARTIAL_REFRESH   (1 << 0)  // 支持局部刷新
 #define EPD_CAP_FAST_REFRESH      (1 << 1)  // 支持快速刷新
 #define EPD_CAP_POWER_CONTROL     (1 << 2)  // 支持电源控制
-#define EPD_CAP_TEMP_COMPENSATION (1 << 3)  // 支持温度补偿
+#define EPD_CAP_TEMP_COMPENSATION (1 << 3)  // 支持温度补偿 (能读取控制器温度或已提供外部温度)
 #define EPD_CAP_ROTATION          (1 << 4)  // 支持旋转
+#define EPD_CAP_GRAYSCALE         (1 << 5)  // 支持4级灰度 (EPD_DISPLAY_GRAY4)
 
 // 引脚配置结构体
 typedef struct {
@@ -72,9 +152,126 @@ typedef struct {
     uint32_t version;         // 驱动版本
 } epd_info_t;
 
+// SPI传输层默认参数
+#ifndef EPD_TRANSPORT_CHUNK_SIZE
+#define EPD_TRANSPORT_CHUNK_SIZE   4092     // 单个DMA事务最大字节数
+#endif
+#ifndef EPD_TRANSPORT_QUEUE_DEPTH
+#define EPD_TRANSPORT_QUEUE_DEPTH  3        // 同时排队的事务数(弹跳缓冲区数量)
+#endif
+#define EPD_TRANSPORT_MAX_DEPTH    4
+
+// SPI传输层配置
+typedef struct {
+    uint32_t chunk_size;      // 单个事务字节数 (0表示默认值)
+    uint8_t queue_depth;      // 在途事务数量 (0表示默认值, 最大EPD_TRANSPORT_MAX_DEPTH)
+} epd_transport_config_t;
+
+// SPI传输层统计
+typedef struct {
+    uint64_t total_bytes;         // 累计发送字节数
+    uint64_t total_us;            // 累计发送耗时(微秒)
+    uint32_t total_transfers;     // 批量发送次数
+    uint32_t total_chunks;        // 排队的SPI事务数
+    uint32_t bounce_copies;       // 经由弹跳缓冲区拷贝的事务数
+    uint32_t cmd_lists;           // 提交的命令列表数
+    uint32_t cmd_transactions;    // 命令/参数事务数 (含单独发送的命令和参数)
+    uint32_t last_bytes;          // 最近一次批量发送字节数
+    uint32_t last_us;             // 最近一次批量发送耗时(微秒)
+    uint32_t last_bytes_per_sec;  // 最近一次吞吐量(字节/秒)
+    uint32_t avg_bytes_per_sec;   // 平均吞吐量(字节/秒)
+} epd_transport_stats_t;
+
+// 命令列表: 将"命令 + 参数"序列编码到一个缓冲区后一次提交,
+// D/C电平相同的连续字节合并为一个SPI事务
+#define EPD_CMD_LIST_MAX_BYTES     64
+#define EPD_CMD_LIST_MAX_SEGMENTS  24
+
+typedef struct {
+    uint8_t offset;
+    uint8_t length;
+    uint8_t dc;                 // 0-命令 1-参数
+} epd_cmd_segment_t;
+
+typedef struct {
+    uint8_t data[EPD_CMD_LIST_MAX_BYTES];
+    epd_cmd_segment_t segments[EPD_CMD_LIST_MAX_SEGMENTS];
+    uint8_t length;             // 已编码字节数
+    uint8_t count;              // 段数
+    bool overflow;              // 超出容量, 提交时返回ESP_ERR_INVALID_SIZE
+} epd_cmd_list_t;
+
+// 传输数据源: 向dst写入第offset字节起的length字节, 在弹跳缓冲区空闲时调用
+typedef void (*epd_transport_source_t)(void *ctx, uint8_t *dst,
+                                       uint32_t offset, uint32_t length);
+
+// BUSY等待默认超时(毫秒), 三色屏全刷可达十余秒
+#ifndef EPD_BUSY_TIMEOUT_MS
+#define EPD_BUSY_TIMEOUT_MS        30000
+#endif
+
+// 刷新阶段
+typedef enum {
+    EPD_PHASE_SETUP = 0,    // 命令与窗口设置 (总耗时扣除RAM写入和BUSY等待)
+    EPD_PHASE_RAM_WRITE,    // 批量写入显示RAM
+    EPD_PHASE_BUSY,         // 主激活后等待BUSY变低
+    EPD_PHASE_TOTAL,        // 整个显示调用
+    EPD_PHASE_MAX
+} epd_phase_t;
+
+// 单次刷新的分阶段耗时(微秒), 挂接到dev->profile期间由传输层和BUSY等待累加
+typedef struct {
+    int64_t start_us;
+    uint32_t phase_us[EPD_PHASE_MAX];
+    uint32_t ram_bytes;
+} epd_profile_sample_t;
+
 // 设备操作结构体（函数指针表）
 struct epd_device_t;
 typedef struct epd_device_t epd_device_t;
+struct epd_transport_t;
+struct epd_busy_waiter_t;
+struct epd_async_t;
+struct epd_pool_t;
+struct epd_policy_t;
+
+// 异步刷新
+#ifndef EPD_ASYNC_QUEUE_LEN
+#define EPD_ASYNC_QUEUE_LEN        4        // 最多排队的刷新请求数
+#endif
+#ifndef EPD_ASYNC_TASK_STACK
+#define EPD_ASYNC_TASK_STACK       4096
+#endif
+#ifndef EPD_ASYNC_TASK_PRIO
+#define EPD_ASYNC_TASK_PRIO        5
+#endif
+
+// 无限等待
+#define EPD_WAIT_FOREVER           0xFFFFFFFFu
+
+// 帧缓冲池
+#ifndef EPD_POOL_BUFFERS
+#define EPD_POOL_BUFFERS           2        // init时分配的整屏平面缓冲区数量, 0表示不创建池
+#endif
+#define EPD_POOL_MAX_BUFFERS       8
+
+// 帧缓冲池统计
+typedef struct {
+    uint32_t buffer_size;       // 每个缓冲区的字节数 (整屏单平面)
+    uint8_t count;              // 缓冲区总数
+    uint8_t in_use;             // 当前借出数量
+    uint8_t peak_in_use;        // 借出数量峰值
+    uint32_t borrows;           // 成功借用次数
+    uint32_t returns;           // 归还次数
+    uint32_t timeouts;          // 借用超时次数
+    uint32_t heap_allocs;       // 池的堆分配次数, 仅在epd_pool_init中发生
+} epd_pool_stats_t;
+
+// 异步请求句柄, 必须通过epd_async_wait释放
+typedef struct epd_async_job_t *epd_async_handle_t;
+
+// 异步完成回调, 在驱动工作任务中执行
+typedef void (*epd_async_cb_t)(epd_device_t *dev, esp_err_t result, void *user_ctx);
 
 struct epd_device_t {
     // 设备信息
@@ -83,6 +280,13 @@ struct epd_device_t {
     // 硬件接口
     spi_device_handle_t spi_dev;
     epd_pins_t pins;
+    struct epd_transport_t *transport;  // SPI传输层 (由epd_spi_init创建)
+    struct epd_busy_waiter_t *busy_waiter; // BUSY下降沿通知 (由epd_busy_init创建)
+    uint32_t busy_timeout_ms;           // BUSY等待超时, 0表示EPD_BUSY_TIMEOUT_MS
+    struct epd_async_t *async;          // 异步刷新工作任务 (由epd_async_start创建)
+    epd_profile_sample_t *profile;      // 分阶段计时 (由epd_profile_begin挂接, 平时为NULL)
+    struct epd_pool_t *pool;            // DMA帧缓冲池 (由epd_pool_init创建)
+    struct epd_policy_t *policy;        // 刷新策略 (由epd_policy_attach创建, 见epd_policy.h)
     
     // 基本操作
     esp_err_t (*init)(epd_device_t *dev);
@@ -96,10 +300,63 @@ struct epd_device_t {
     esp_err_t (*display_partial)(epd_device_t *dev, const uint8_t *buffer,
                                 uint16_t x, uint16_t y, 
                                 uint16_t width, uint16_t height);
+    // 窗口局刷: framebuffer为整屏缓冲区(非打包的子缓冲区), 矩形向外扩展到
+    // 字节边界, 各行直接从帧缓冲区收集后一次流式发送
+    esp_err_t (*display_window)(epd_device_t *dev, const uint8_t *framebuffer,
+                               uint16_t x, uint16_t y,
+                               uint16_t width, uint16_t height,
+                               epd_update_mode_t mode);
+    // 多窗口局刷: 各矩形按display_window的规则写入RAM后只触发一次刷新,
+    // N个窗口只需一次激活和一次BUSY等待
+    esp_err_t (*display_windows)(epd_device_t *dev, const uint8_t *framebuffer,
+                                const epd_rect_t *rects, uint8_t count,
+                                epd_update_mode_t mode);
+    // 双平面显示 (三色屏): 为NULL的平面表示自上次刷新后未变化, 不重新发送
+    esp_err_t (*display_planes)(epd_device_t *dev, const uint8_t *bw,
+                               const uint8_t *red, epd_update_mode_t mode);
+    
+    // 流式显示: 由数据源按顺序生成整屏平面字节, 无需整屏缓冲区;
+    // red为NULL时红色平面清空 (同display_buffer)
+    esp_err_t (*display_stream)(epd_device_t *dev,
+                               epd_transport_source_t bw, void *bw_ctx,
+                               epd_transport_source_t red, void *red_ctx,
+                               epd_update_mode_t mode);
+    
+    // 条带渲染: 按band_height行 (0表示EPD_BAND_HEIGHT) 逐条调用draw, 每个条带绘制后
+    // 直接写入对应的RAM窗口, 全部写完后刷新; 条带缓冲区在首次使用时分配并在设备内重用,
+    // stats可为NULL; 仅支持0/180度旋转
+    esp_err_t (*display_bands)(epd_device_t *dev, uint16_t band_height,
+                              epd_band_draw_t draw, void *ctx,
+                              epd_update_mode_t mode, epd_band_stats_t *stats);
+    
+    // 分段刷新 (多屏交错): begin_update写入整屏RAM并触发刷新后立即返回,
+    // finish_update等待BUSY结束 (timeout_ms为0时使用温度区间的超时; 指定的超时到期后可再次等待);
+    // 两者之间不得对该设备发起其他操作, 但共享同一SPI总线的其他设备可以传输数据
+    esp_err_t (*begin_update)(epd_device_t *dev, const uint8_t *buffer,
+                             epd_update_mode_t mode);
+    esp_err_t (*finish_update)(epd_device_t *dev, uint32_t timeout_ms);
+    
+    // 以显示RAM中的现有内容重新刷新 (不传输图像数据), 用于清除局刷残影
+    esp_err_t (*refresh)(epd_device_t *dev, epd_update_mode_t mode);
+    
+    // 异步显示操作: 立即返回, 由驱动工作任务完成SPI传输和BUSY等待
+    // 完成前缓冲区不得修改; handle非NULL时需调用epd_async_wait释放
+    esp_err_t (*display_buffer_async)(epd_device_t *dev, const uint8_t *buffer,
+                                     epd_update_mode_t mode,
+                                     epd_async_cb_t cb, void *user_ctx,
+                                     epd_async_handle_t *handle);
+    esp_err_t (*display_partial_async)(epd_device_t *dev, const uint8_t *buffer,
+                                      uint16_t x, uint16_t y,
+                                      uint16_t width, uint16_t height,
+                                      epd_async_cb_t cb, void *user_ctx,
+                                      epd_async_handle_t *handle);
     
     // 电源管理
     esp_err_t (*sleep)(epd_device_t *dev);
     esp_err_t (*wakeup)(epd_device_t *dev);
+    // MCU从深度睡眠启动后代替init调用: 面板睡眠前的配置仍在RTC内存中时
+    // 只恢复控制器寄存器, 面板RAM保持原内容; 否则执行完整初始化
+    esp_err_t (*resume)(epd_device_t *dev);
     esp_err_t (*power_on)(epd_device_t *dev);
     esp_err_t (*power_off)(epd_device_t *dev);
     
@@ -108,6 +365,23 @@ struct epd_device_t {
     esp_err_t (*invert)(epd_device_t *dev, bool invert);
     esp_err_t (*get_info)(epd_device_t *dev, epd_info_t *info);
     
+    // 显示模式: GRAY4下display_buffer接收每像素2位的缓冲区,
+    // 局刷、窗口和流式显示返回ESP_ERR_INVALID_STATE
+    esp_err_t (*set_display_mode)(epd_device_t *dev, epd_display_mode_t mode);
+    esp_err_t (*get_refresh_cost)(epd_device_t *dev, epd_display_mode_t mode,
+                                  epd_refresh_cost_t *cost);
+    
+    // 温度补偿: read_temperature立即测量并返回当前使用的温度 (无法读取控制器时
+    // 返回ESP_ERR_NOT_SUPPORTED); set_temperature以外部传感器读数代替测量,
+    // EPD_TEMP_AUTO恢复测量; set_temp_bands的bands为NULL时恢复驱动默认区间,
+    // 区间表被复制, 其中的LUT须保持有效
+    esp_err_t (*read_temperature)(epd_device_t *dev, int8_t *temp_c);
+    esp_err_t (*set_temperature)(epd_device_t *dev, int8_t temp_c);
+    esp_err_t (*set_temp_bands)(epd_device_t *dev, const epd_temp_band_t *bands,
+                                uint8_t count);
+    esp_err_t (*get_temp_band_stats)(epd_device_t *dev, uint8_t band,
+                                     epd_temp_band_stats_t *stats);
+    
     // 私有数据
     void *priv;
 };
@@ -116,11 +390,63 @@ struct epd_device_t {
 esp_err_t epd_spi_init(epd_device_t *dev, spi_host_device_t host, int clock_speed);
 void epd_delay_ms(uint32_t ms);
 bool epd_is_busy(epd_device_t *dev);
+
+// BUSY等待: 由GPIO中断在下降沿释放信号量, 等待期间任务处于阻塞状态
+// timeout_ms为0时使用dev->busy_timeout_ms, 超时返回ESP_ERR_TIMEOUT
+esp_err_t epd_busy_init(epd_device_t *dev);
+void epd_busy_deinit(epd_device_t *dev);
+esp_err_t epd_wait_busy(epd_device_t *dev, uint32_t timeout_ms);
+
+// 异步刷新: 工作任务按提交顺序串行执行设备的同步显示操作
+esp_err_t epd_async_start(epd_device_t *dev);
+void epd_async_stop(epd_device_t *dev);
+esp_err_t epd_async_display_buffer(epd_device_t *dev, const uint8_t *buffer,
+                                   epd_update_mode_t mode,
+                                   epd_async_cb_t cb, void *user_ctx,
+                                   epd_async_handle_t *handle);
+esp_err_t epd_async_display_partial(epd_device_t *dev, const uint8_t *buffer,
+                                    uint16_t x, uint16_t y,
+                                    uint16_t width, uint16_t height,
+                                    epd_async_cb_t cb, void *user_ctx,
+                                    epd_async_handle_t *handle);
+esp_err_t epd_async_wait(epd_async_handle_t handle, uint32_t timeout_ms);
+esp_err_t epd_async_flush(epd_device_t *dev, uint32_t timeout_ms);
+
+// 帧缓冲池: 借出的缓冲区内容未定义, 用完后必须归还
+esp_err_t epd_pool_init(epd_device_t *dev, uint8_t count);
+void epd_pool_deinit(epd_device_t *dev);
+uint8_t *epd_pool_borrow(epd_device_t *dev, uint32_t timeout_ms);
+esp_err_t epd_pool_return(epd_device_t *dev, uint8_t *buffer);
+esp_err_t epd_pool_get_stats(epd_device_t *dev, epd_pool_stats_t *stats);
+
+// 命令列表构建与提交, 列表可在栈上构建
+void epd_cmd_list_init(epd_cmd_list_t *list);
+void epd_cmd_list_cmd(epd_cmd_list_t *list, uint8_t cmd);
+void epd_cmd_list_data(epd_cmd_list_t *list, uint8_t data);
+void epd_cmd_list_data_u16(epd_cmd_list_t *list, uint16_t data);  // 低字节在前
+void epd_cmd_list_add(epd_cmd_list_t *list, uint8_t cmd,
+                      const uint8_t *params, uint8_t count);
+esp_err_t epd_cmd_list_send(epd_device_t *dev, const epd_cmd_list_t *list);
+
 void epd_send_command(epd_device_t *dev, uint8_t cmd);
 void epd_send_data(epd_device_t *dev, uint8_t data);
 void epd_send_data_buffer(epd_device_t *dev, const uint8_t *data, uint32_t length);
 
+// SPI传输层: 大块数据按DMA块切分, 多个事务同时排队, 保持总线连续工作
+esp_err_t epd_transport_init(epd_device_t *dev, const epd_transport_config_t *config);
+void epd_transport_deinit(epd_device_t *dev);
+esp_err_t epd_transport_send(epd_device_t *dev, const uint8_t *data, uint32_t length);
+esp_err_t epd_transport_fill(epd_device_t *dev, uint8_t value, uint32_t length);
+// 轮询读取最多4个参数字节 (如温度寄存器), 未配置MISO时返回ESP_ERR_NOT_SUPPORTED
+esp_err_t epd_transport_read(epd_device_t *dev, uint8_t *data, uint32_t length);
+esp_err_t epd_transport_send_from(epd_device_t *dev, uint32_t length,
+                                  epd_transport_source_t source, void *ctx);
+esp_err_t epd_transport_get_stats(epd_device_t *dev, epd_transport_stats_t *stats);
+void epd_transport_reset_stats(epd_device_t *dev);
+
 // 绘图函数
+// 每次调用都会记录一次脏区: 在托管帧缓冲区上逐点绘制大量像素时,
+// 应直接写buffer, 最后对整个区域调用一次epd_fb_mark_dirty
 void epd_draw_pixel(uint8_t *buffer, uint16_t width, uint16_t height,
                    uint16_t x, uint16_t y, epd_color_t color);
 void epd_draw_line(uint8_t *buffer, uint16_t width, uint16_t height,
@@ -129,16 +455,32 @@ void epd_draw_line(uint8_t *buffer, uint16_t width, uint16_t height,
 void epd_draw_rect(uint8_t *buffer, uint16_t width, uint16_t height,
                   uint16_t x, uint16_t y, uint16_t w, uint16_t h,
                   epd_color_t color, bool filled);
+void epd_draw_hline(uint8_t *buffer, uint16_t width, uint16_t height,
+                    uint16_t x, uint16_t y, uint16_t w, epd_color_t color);
+void epd_draw_vline(uint8_t *buffer, uint16_t width, uint16_t height,
+                    uint16_t x, uint16_t y, uint16_t h, epd_color_t color);
+void epd_fill_pattern(uint8_t *buffer, uint16_t width, uint16_t height,
+                      uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint8_t *pattern, uint8_t pattern_rows);
 void epd_draw_circle(uint8_t *buffer, uint16_t width, uint16_t height,
                     uint16_t x0, uint16_t y0, uint16_t r, 
                     epd_color_t color, bool filled);
 void epd_draw_text(uint8_t *buffer, uint16_t width, uint16_t height,
                   const char *text, uint16_t x, uint16_t y,
                   epd_color_t color, uint8_t scale);
+void epd_draw_bitmap(uint8_t *buffer, uint16_t width, uint16_t height,
+                     uint16_t x, uint16_t y, const uint8_t *bitmap,
+                     uint16_t bw, uint16_t bh, epd_color_t color);
+
+// 缓冲区旋转: 将src(width x height)顺时针旋转rotation*90度写入dst
+// 90/270度时dst尺寸为height x width, 宽高都需为8的倍数
+esp_err_t epd_rotate_buffer(const uint8_t *src, uint16_t width, uint16_t height,
+                            uint8_t *dst, uint8_t rotation);
 
 // 测试图案生成
 esp_err_t test_checkerboard_pattern(epd_device_t *dev, uint8_t block_size);
 esp_err_t test_gradient_pattern(epd_device_t *dev);
+esp_err_t test_gray_pattern(epd_device_t *dev);
 esp_err_t test_line_pattern(epd_device_t *dev);
 esp_err_t test_shape_pattern(epd_device_t *dev);
 
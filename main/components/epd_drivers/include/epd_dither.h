@@ -0,0 +1,69 @@
+/**
+ * 逐行抖动
+ * 把8位灰度或RGB888图像转换为1bpp黑白或黑白红双平面。输入由回调逐行提供,
+ * 误差扩散只保留两到三行定点误差, 结果可以写入整屏缓冲区,
+ * 也可以作为传输数据源在RAM写入期间直接生成, 不需要整屏的输入或输出缓冲区
+ */
+
+#ifndef __EPD_DITHER_H__
+#define __EPD_DITHER_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+// 抖动算法
+typedef enum {
+    EPD_DITHER_THRESHOLD,       // 固定阈值 (不抖动)
+    EPD_DITHER_BAYER,           // 8x8有序抖动, 无误差行
+    EPD_DITHER_FLOYD_STEINBERG, // 误差扩散到右侧和下一行 (7/16, 3/16, 5/16, 1/16)
+    EPD_DITHER_ATKINSON,        // 误差的6/8扩散到后两行, 对比度更高
+} epd_dither_method_t;
+
+// 输入像素格式
+typedef enum {
+    EPD_DITHER_GRAY8,           // 每像素1字节, 0为黑, 255为白
+    EPD_DITHER_RGB888,          // 每像素3字节, R、G、B
+} epd_dither_format_t;
+
+// 输出调色板
+typedef enum {
+    EPD_DITHER_PALETTE_BW,      // 黑、白
+    EPD_DITHER_PALETTE_BWR,     // 黑、白、红 (三色屏), 按RGB距离选取最近的颜色
+} epd_dither_palette_t;
+
+// 输入行回调: 向dst写入第y行的width个像素
+typedef void (*epd_dither_read_row_t)(void *ctx, uint16_t y, uint8_t *dst);
+
+// 抖动配置
+typedef struct {
+    uint16_t width;             // 必须为8的倍数
+    uint16_t height;
+    epd_dither_method_t method;
+    epd_dither_format_t format;
+    epd_dither_palette_t palette;
+    epd_dither_read_row_t read_row;
+    void *ctx;
+} epd_dither_config_t;
+
+typedef struct epd_dither_t epd_dither_t;
+
+// 创建/销毁: 行缓冲区和误差行在创建时一次分配, 逐帧重用
+epd_dither_t *epd_dither_create(const epd_dither_config_t *config);
+void epd_dither_destroy(epd_dither_t *dither);
+
+// 回到第0行并清空误差
+void epd_dither_reset(epd_dither_t *dither);
+
+// 处理下一行: 写入width/8字节的黑白行(1为白)和红色行(1为红, 可为NULL)
+esp_err_t epd_dither_next_row(epd_dither_t *dither, uint8_t *bw_row, uint8_t *red_row);
+
+// 整幅抖动到缓冲区 (行跨度width/8), red可为NULL; 托管帧缓冲区会记录整屏脏区
+esp_err_t epd_dither_to_buffer(epd_dither_t *dither, uint8_t *bw, uint8_t *red);
+
+// 直接显示: 抖动结果作为传输数据源写入面板RAM;
+// 三色调色板时红色平面再抖动一遍 (结果相同), 仍不需要整屏缓冲区
+esp_err_t epd_display_dithered(epd_device_t *dev, epd_dither_t *dither,
+                               epd_update_mode_t mode);
+
+#endif // __EPD_DITHER_H__
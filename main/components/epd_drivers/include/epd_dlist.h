@@ -0,0 +1,70 @@
+/**
+ * 保留模式显示列表
+ * 界面由一组图元 (矩形、直线、圆、文字、位图) 描述, 每个节点记录包围盒;
+ * 修改节点只记录新旧包围盒为损坏区, 提交时在裁剪区内重绘背景和与之相交的节点,
+ * 再由托管帧缓冲区比较送屏副本, 只局刷实际变化的窗口
+ */
+
+#ifndef __EPD_DLIST_H__
+#define __EPD_DLIST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "epd_common.h"
+#include "epd_font.h"
+#include "epd_framebuffer.h"
+
+#ifndef EPD_DL_MAX_NODES
+#define EPD_DL_MAX_NODES           32       // 节点数量上限
+#endif
+#define EPD_DL_TEXT_MAX            32       // 文字节点的最大长度 (含结束符)
+#define EPD_DL_MAX_DAMAGE          8        // 损坏区列表容量, 超出时合并
+
+// 显示列表统计
+typedef struct {
+    uint32_t commits;           // 提交次数
+    uint32_t regions;           // 重绘的损坏区总数
+    uint32_t nodes_drawn;       // 在损坏区内重绘的节点总数
+    uint32_t nodes_skipped;     // 与损坏区不相交而跳过的节点总数
+    uint64_t pixels_redrawn;    // 重绘的像素总数
+    uint32_t last_raster_us;    // 最近一次提交的重绘耗时 (不含送屏)
+} epd_dlist_stats_t;
+
+typedef struct epd_dlist_t epd_dlist_t;
+
+// 创建/销毁显示列表: fb为绘制目标, bg为背景色; 首次提交重绘整屏
+epd_dlist_t *epd_dlist_create(epd_fb_t *fb, epd_color_t bg);
+void epd_dlist_destroy(epd_dlist_t *dl);
+
+// 添加节点, id返回节点编号 (可为NULL); 节点按编号顺序绘制, 删除后的编号会被复用
+esp_err_t epd_dlist_add_rect(epd_dlist_t *dl, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                             epd_color_t color, bool filled, uint8_t *id);
+esp_err_t epd_dlist_add_line(epd_dlist_t *dl, uint16_t x1, uint16_t y1,
+                             uint16_t x2, uint16_t y2, epd_color_t color, uint8_t *id);
+esp_err_t epd_dlist_add_circle(epd_dlist_t *dl, uint16_t cx, uint16_t cy, uint16_t r,
+                               epd_color_t color, bool filled, uint8_t *id);
+// 文字被复制到节点中, 超过EPD_DL_TEXT_MAX - 1的部分被截断
+esp_err_t epd_dlist_add_text(epd_dlist_t *dl, const epd_font_t *font, const char *text,
+                             uint16_t x, uint16_t y, epd_color_t color, uint8_t scale,
+                             uint8_t *id);
+// 位图只保存指针, 内容改变后调用epd_dlist_touch
+esp_err_t epd_dlist_add_bitmap(epd_dlist_t *dl, const uint8_t *bitmap, uint16_t x, uint16_t y,
+                               uint16_t w, uint16_t h, epd_color_t color, uint8_t *id);
+
+// 修改节点 (内容相同时不产生损坏区)
+esp_err_t epd_dlist_set_text(epd_dlist_t *dl, uint8_t id, const char *text);
+esp_err_t epd_dlist_set_color(epd_dlist_t *dl, uint8_t id, epd_color_t color);
+esp_err_t epd_dlist_set_visible(epd_dlist_t *dl, uint8_t id, bool visible);
+// 移动节点: 矩形/文字/位图为左上角, 圆为圆心, 直线整体平移使起点位于(x, y)
+esp_err_t epd_dlist_move(epd_dlist_t *dl, uint8_t id, uint16_t x, uint16_t y);
+esp_err_t epd_dlist_remove(epd_dlist_t *dl, uint8_t id);
+// 标记节点需要重绘 (位图内容改变时使用)
+esp_err_t epd_dlist_touch(epd_dlist_t *dl, uint8_t id);
+
+// 重绘损坏区并提交帧缓冲区, path可为NULL; 提交期间占用帧缓冲区的裁剪区
+esp_err_t epd_dlist_commit(epd_dlist_t *dl, epd_fb_commit_t *path);
+
+esp_err_t epd_dlist_get_stats(epd_dlist_t *dl, epd_dlist_stats_t *stats);
+
+#endif // __EPD_DLIST_H__
@@ -0,0 +1,78 @@
+/**
+ * EPF压缩帧格式
+ * 面向1bpp黑白/双平面图像的PackBits变体, 解码器在RAM写入期间
+ * 直接把像素字节生成到SPI弹跳缓冲区, 不需要整屏解压缓冲区
+ *
+ * 文件布局 (小端):
+ *   0  "EPF1"
+ *   4  uint16 宽度
+ *   6  uint16 高度
+ *   8  uint8  标志 (EPD_EPF_FLAG_*)
+ *   9  3字节保留
+ *   12 uint32 黑白平面编码长度
+ *   16 uint32 红色平面编码长度 (无红色平面时为0)
+ *   20 黑白平面编码数据, 随后为红色平面编码数据
+ *
+ * 平面编码, 每组以控制字节c开头:
+ *   0x00-0x7F  其后c+1个字节原样输出
+ *   0x81-0xFF  其后1个字节重复257-c次 (2-128次)
+ *   0x80       其后uint16计数n和1个字节, 重复n次 (整行/整屏的白色或黑色)
+ */
+
+#ifndef __EPD_EPF_H__
+#define __EPD_EPF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#define EPD_EPF_MAGIC               "EPF1"
+#define EPD_EPF_HEADER_SIZE         20
+
+#define EPD_EPF_FLAG_RED            (1 << 0)  // 包含红色平面
+
+#define EPD_EPF_OP_LONG_RUN         0x80
+#define EPD_EPF_MAX_LITERAL         128
+#define EPD_EPF_MAX_SHORT_RUN       128
+#define EPD_EPF_MAX_LONG_RUN        0xFFFF
+
+// 解析后的帧信息, 平面指针指向原始数据(可位于flash)
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint8_t flags;
+    const uint8_t *bw;
+    uint32_t bw_len;
+    const uint8_t *red;         // 无红色平面时为NULL
+    uint32_t red_len;
+} epd_epf_info_t;
+
+// 流式解码器状态
+typedef struct {
+    const uint8_t *src;
+    const uint8_t *end;
+    uint32_t run;               // 当前重复段剩余字节数
+    uint32_t literal;           // 当前字面量段剩余字节数
+    uint8_t value;              // 重复段的字节值
+} epd_epf_decoder_t;
+
+// 解析并校验帧: 两个平面都必须恰好解码为width*height/8字节
+esp_err_t epd_epf_parse(const uint8_t *data, uint32_t size, epd_epf_info_t *info);
+
+// 流式解码: 每次最多生成length字节, 返回实际生成的字节数
+void epd_epf_decoder_init(epd_epf_decoder_t *dec, const uint8_t *src, uint32_t len);
+uint32_t epd_epf_decode(epd_epf_decoder_t *dec, uint8_t *dst, uint32_t length);
+
+// 传输数据源, ctx为epd_epf_decoder_t
+void epd_epf_source(void *ctx, uint8_t *dst, uint32_t offset, uint32_t length);
+
+// 解码到内存 (需要随机访问像素时使用)
+esp_err_t epd_epf_decode_plane(const uint8_t *src, uint32_t src_len,
+                               uint8_t *dst, uint32_t dst_len);
+
+// 显示压缩帧: 解码结果直接进入SPI传输, 不分配整屏缓冲区
+esp_err_t epd_display_epf(epd_device_t *dev, const uint8_t *data, uint32_t size,
+                          epd_update_mode_t mode);
+
+#endif // __EPD_EPF_H__
@@ -0,0 +1,74 @@
+/**
+ * 位图字体
+ * 字体为只读数据(可位于flash): 行优先位图, 每字节高位在左, 位为1表示笔画,
+ * 支持比例宽度 (无字距调整)。放大后的字形保存在一个小型LRU缓存中,
+ * 绘制时按行合并到缓冲区: x按字节对齐时逐字节合并, 否则按移位后的32位字合并
+ *
+ * 字形缓存由所有任务共享, 查找和插入在短暂的临界区内完成;
+ * 绘制使用字形的私有副本, 可在多个任务中同时绘制文字
+ */
+
+#ifndef __EPD_FONT_H__
+#define __EPD_FONT_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#ifndef EPD_FONT_CACHE_ENTRIES
+#define EPD_FONT_CACHE_ENTRIES      16      // 缓存的放大字形数量
+#endif
+#ifndef EPD_FONT_CACHE_GLYPH_BYTES
+#define EPD_FONT_CACHE_GLYPH_BYTES  256     // 单个缓存字形的最大位图字节数, 更大的字形不缓存
+#endif
+#define EPD_FONT_MAX_ROW_BYTES      32      // 放大后单行最多256像素
+
+// 字形信息
+typedef struct {
+    uint16_t offset;            // 位图在font->bitmap中的字节偏移
+    uint8_t left;               // 笔画在位图行内的起始列
+    uint8_t width;              // 笔画宽度(像素), 0表示空白字形
+    uint8_t advance;            // 光标前进量(像素), 含字间距
+} epd_font_glyph_t;
+
+// 字体
+typedef struct {
+    const char *name;
+    uint8_t height;             // 字形高度(像素)
+    uint8_t row_bytes;          // 位图每行字节数
+    uint8_t first_char;
+    uint8_t last_char;
+    uint8_t default_char;       // 范围外的字符以此字符代替
+    const uint8_t *bitmap;      // 每个字形height * row_bytes字节
+    const epd_font_glyph_t *glyphs; // 比例字体的字形表, NULL表示等宽字体
+    uint8_t fixed_width;        // 等宽字体: 笔画宽度
+    uint8_t fixed_advance;      // 等宽字体: 光标前进量
+} epd_font_t;
+
+// 字形缓存统计
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;            // 未命中后放大并缓存
+    uint32_t evictions;         // 淘汰最久未用的字形
+    uint32_t uncached;          // 放大后超出EPD_FONT_CACHE_GLYPH_BYTES, 逐行直接绘制
+    uint8_t entries;            // 当前缓存的字形数
+} epd_font_cache_stats_t;
+
+// 内置5x7字体 (0x20-0x7E): 等宽版本与epd_draw_text的排版一致, 比例版本更紧凑
+extern const epd_font_t epd_font_5x7;
+extern const epd_font_t epd_font_5x7_prop;
+
+// 绘制文字, 返回绘制后的光标x坐标; 超出缓冲区的部分被裁剪
+uint32_t epd_font_draw(uint8_t *buffer, uint16_t width, uint16_t height,
+                       const epd_font_t *font, const char *text,
+                       uint16_t x, uint16_t y, epd_color_t color, uint8_t scale);
+
+// 测量文字: 返回笔画范围的宽度(不含末尾字间距), height非NULL时返回行高
+uint32_t epd_font_measure(const epd_font_t *font, const char *text, uint8_t scale,
+                          uint16_t *height);
+
+// 字形缓存
+void epd_font_cache_clear(void);
+void epd_font_cache_get_stats(epd_font_cache_stats_t *stats);
+
+#endif // __EPD_FONT_H__
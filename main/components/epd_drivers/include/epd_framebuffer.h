@@ -0,0 +1,107 @@
+/**
+ * 托管帧缓冲区
+ * 记录epd_draw_*绘制过的脏区, 提交时与上次送屏的帧比较,
+ * 自动选择不刷新、单窗口局刷、多窗口局刷或全刷
+ * 三色设备带有红色平面, 只在红色内容变化时才重新发送红色平面
+ */
+
+#ifndef __EPD_FRAMEBUFFER_H__
+#define __EPD_FRAMEBUFFER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#define EPD_FB_MAX_DIRTY            8     // 脏区列表容量, 超出时合并
+#ifndef EPD_FB_MAX_INSTANCES
+#define EPD_FB_MAX_INSTANCES        4     // 同时存在的托管帧缓冲区数量, 超出时epd_fb_create失败
+#endif
+
+#ifndef EPD_FB_FULL_REFRESH_PERCENT
+#define EPD_FB_FULL_REFRESH_PERCENT 60    // 变化面积超过屏幕此比例时改为全刷
+#endif
+#ifndef EPD_FB_RETAIN_BYTES
+#define EPD_FB_RETAIN_BYTES         4096  // RTC内存中保留面板内容的容量 (压缩后)
+#endif
+#ifndef EPD_FB_WINDOW_SETUP_US
+#define EPD_FB_WINDOW_SETUP_US      200   // 多窗口共用一次激活时, 每个窗口设置RAM区域的开销
+#endif
+#ifndef EPD_FB_PARTIAL_REFRESH_US
+#define EPD_FB_PARTIAL_REFRESH_US   300000 // 一次局刷激活耗时的初始估计, 提交后按实测更新
+#endif
+
+// 提交结果
+typedef enum {
+    EPD_FB_COMMIT_NONE,       // 内容无变化, 未刷新
+    EPD_FB_COMMIT_PARTIAL,    // 单个合并窗口局刷
+    EPD_FB_COMMIT_MULTI,      // 多个窗口局刷 (设备支持display_windows时只激活一次)
+    EPD_FB_COMMIT_FULL,       // 全刷
+} epd_fb_commit_t;
+
+// 提交统计
+typedef struct {
+    uint32_t commits;          // 提交次数
+    uint32_t skipped;          // 无变化跳过次数
+    uint32_t full_refreshes;   // 全刷次数
+    uint32_t partial_windows;  // 局刷窗口总数
+    uint64_t bytes_sent;       // 实际发送的像素字节数
+    uint64_t bytes_saved;      // 相比每次全屏发送节省的字节数
+    uint32_t red_planes_sent;     // 发送红色平面的次数
+    uint32_t red_planes_skipped;  // 红色平面未变化而跳过的次数
+} epd_fb_stats_t;
+
+// 托管帧缓冲区
+typedef struct {
+    epd_device_t *dev;
+    uint16_t width;
+    uint16_t height;
+    uint16_t stride;           // 每行字节数
+    uint32_t size;             // 单个平面字节数
+    uint8_t *buffer;           // 黑白平面 (绘图缓冲区, 可直接传给epd_draw_*)
+    uint8_t *red;              // 红色平面, 位为1表示红色 (仅三色设备, 否则为NULL)
+    uint8_t *shadow;           // 最近一次送屏的黑白平面
+    uint8_t *red_shadow;       // 最近一次送屏的红色平面
+    uint8_t *scratch;          // 局刷窗口打包缓冲区 (设备支持display_window时为NULL)
+    bool shadow_valid;         // 首次提交前面板内容未知, 必须全刷
+    uint8_t full_refresh_percent;
+    uint32_t partial_refresh_us;  // 一次局刷激活的耗时 (实测, 决定窗口是否合并)
+    epd_rect_t dirty[EPD_FB_MAX_DIRTY];
+    uint8_t dirty_count;
+    epd_rect_t clip;           // 绘图裁剪区, clip_enabled为false时不裁剪
+    bool clip_enabled;
+    epd_fb_stats_t stats;
+} epd_fb_t;
+
+// 创建/销毁 (尺寸取自设备当前信息)
+epd_fb_t *epd_fb_create(epd_device_t *dev);
+void epd_fb_destroy(epd_fb_t *fb);
+
+// 用颜色填满并标记整屏为脏 (EPD_COLOR_RED仅对三色设备有效)
+void epd_fb_clear(epd_fb_t *fb, epd_color_t color);
+
+// 手动标记脏区 (直接修改buffer时使用, 批量写像素后整体标记一次比逐点epd_draw_pixel快)
+void epd_fb_mark_dirty(epd_fb_t *fb, uint16_t x, uint16_t y,
+                       uint16_t width, uint16_t height);
+
+// 设置绘图裁剪区: 之后epd_draw_*/epd_font_draw只写入并标记该区域内的像素, NULL取消裁剪
+void epd_fb_set_clip(epd_fb_t *fb, const epd_rect_t *clip);
+
+// 使面板内容失效, 下次提交强制全刷
+void epd_fb_invalidate(epd_fb_t *fb);
+
+// MCU深度睡眠前保存最近一次送屏的内容到RTC内存 (压缩, 同一时间只保留一份);
+// 尚未送屏时返回ESP_ERR_INVALID_STATE, 压缩后超过EPD_FB_RETAIN_BYTES时返回ESP_ERR_NO_MEM
+esp_err_t epd_fb_retain(epd_fb_t *fb);
+
+// 唤醒后以保留的内容作为面板当前内容和绘图缓冲区的初值, 之后的提交只局刷变化部分;
+// 需配合dev->resume使用 (面板RAM保持睡眠前的内容). 没有有效的保留内容时返回ESP_ERR_NOT_FOUND
+esp_err_t epd_fb_restore(epd_fb_t *fb);
+
+// 提交到面板, path可为NULL
+esp_err_t epd_fb_commit(epd_fb_t *fb, epd_fb_commit_t *path);
+
+// 查找buffer所属的托管帧缓冲区, 不存在时返回NULL
+epd_fb_t *epd_fb_from_buffer(const uint8_t *buffer);
+
+#endif // __EPD_FRAMEBUFFER_H__
@@ -0,0 +1,53 @@
+/**
+ * 多屏刷新组
+ * 同一SPI主机上的多块面板 (各自的CS/DC/RST/BUSY引脚) 交错刷新:
+ * 一块面板刷新等待BUSY期间, 总线已经在向下一块面板写入RAM,
+ * 总耗时接近 max(刷新) + sum(传输), 而不是 sum(刷新)
+ */
+
+#ifndef __EPD_GROUP_H__
+#define __EPD_GROUP_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#define EPD_GROUP_MAX_PANELS       4
+
+// 刷新组配置
+typedef struct {
+    uint8_t max_active;         // 同时刷新的面板上限 (限制升压电路的峰值电流), 0表示不限
+    uint32_t busy_timeout_ms;   // 每块面板的BUSY超时, 0表示使用驱动的温度区间超时
+} epd_group_config_t;
+
+// 刷新组统计 (各面板数组按加入顺序)
+typedef struct {
+    uint8_t count;              // 面板数量
+    uint32_t updates;           // 组刷新次数
+    uint32_t errors;            // 失败的面板刷新次数
+    uint32_t last_us;           // 最近一次组刷新总耗时
+    uint32_t last_serial_us;    // 最近一次各面板传输与刷新耗时之和 (逐块刷新的耗时)
+    uint32_t max_overlap;       // 同时处于刷新中的面板数峰值
+    uint32_t transfer_us[EPD_GROUP_MAX_PANELS];  // 最近一次写入RAM并触发刷新的耗时
+    uint32_t refresh_us[EPD_GROUP_MAX_PANELS];   // 最近一次从触发到BUSY结束的耗时
+    esp_err_t result[EPD_GROUP_MAX_PANELS];      // 最近一次刷新结果
+} epd_group_stats_t;
+
+typedef struct epd_group_t epd_group_t;
+
+// 创建/销毁刷新组, config可为NULL; 面板仍由调用方初始化和释放
+epd_group_t *epd_group_create(const epd_group_config_t *config);
+void epd_group_destroy(epd_group_t *group);
+
+// 加入已初始化的面板: 须支持分段刷新, 与组内其他面板共用MOSI/CLK,
+// CS和BUSY引脚各不相同; index返回面板在组内的下标 (可为NULL)
+esp_err_t epd_group_add(epd_group_t *group, epd_device_t *dev, uint8_t *index);
+
+// 刷新组内面板: buffers按加入顺序给出各面板的整屏缓冲区, 为NULL的面板不刷新;
+// 任一面板失败时返回第一个错误, 其余面板仍会完成刷新
+esp_err_t epd_group_display(epd_group_t *group, const uint8_t *const buffers[],
+                            epd_update_mode_t mode);
+
+esp_err_t epd_group_get_stats(epd_group_t *group, epd_group_stats_t *stats);
+
+#endif // __EPD_GROUP_H__
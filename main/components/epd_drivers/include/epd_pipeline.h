@@ -0,0 +1,86 @@
+/**
+ * 双核渲染/发送流水线
+ * 渲染任务和发送任务分别固定在两个核上, 通过从帧缓冲池借用的小型帧环交接整屏缓冲区:
+ * 面板刷新并等待BUSY期间, 另一个核已经在空闲帧中渲染下一帧
+ */
+
+#ifndef __EPD_PIPELINE_H__
+#define __EPD_PIPELINE_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#define EPD_PIPELINE_RING_MAX      4        // 帧环最多的缓冲区数量
+
+#ifndef EPD_PIPELINE_RENDER_CORE
+#if CONFIG_FREERTOS_UNICORE
+#define EPD_PIPELINE_RENDER_CORE   0
+#else
+#define EPD_PIPELINE_RENDER_CORE   1        // APP核渲染
+#endif
+#endif
+#ifndef EPD_PIPELINE_TX_CORE
+#define EPD_PIPELINE_TX_CORE       0        // PRO核发送, 与SPI中断在同一核
+#endif
+#ifndef EPD_PIPELINE_TASK_STACK
+#define EPD_PIPELINE_TASK_STACK    4096
+#endif
+#ifndef EPD_PIPELINE_TASK_PRIO
+#define EPD_PIPELINE_TASK_PRIO     5
+#endif
+
+// 帧环已满 (所有帧都在等待发送或正在发送) 时的渲染策略
+typedef enum {
+    EPD_PIPELINE_BLOCK,         // 等待空闲帧 (背压), 每一帧都会显示
+    EPD_PIPELINE_DROP,          // 跳过本次渲染周期, 计入dropped; period_ms为0时同BLOCK
+    EPD_PIPELINE_COALESCE,      // 收回最早的待发送帧渲染最新内容, 被替换的帧计入coalesced
+} epd_pipeline_policy_t;
+
+// 渲染回调: 在frame (整屏1bpp) 中绘制第seq帧, 在渲染任务中执行;
+// 返回ESP_OK提交发送, ESP_ERR_NOT_FINISHED表示没有新内容 (帧放回空闲), 其他值计为渲染错误
+typedef esp_err_t (*epd_pipeline_render_t)(void *ctx, uint8_t *frame, uint32_t seq);
+
+// 流水线配置
+typedef struct {
+    epd_pipeline_render_t render;
+    void *ctx;
+    uint8_t ring_size;          // 帧环大小 (2..EPD_PIPELINE_RING_MAX), 0表示2
+    epd_pipeline_policy_t policy;
+    epd_update_mode_t mode;     // 每帧的刷新模式
+    uint32_t period_ms;         // 渲染周期, 0表示发送一空出帧就渲染
+    uint32_t max_frames;        // 提交该数量的帧后停止渲染, 0表示直到epd_pipeline_stop
+} epd_pipeline_config_t;
+
+// 流水线统计
+typedef struct {
+    uint32_t rendered;          // 提交发送的帧数
+    uint32_t displayed;         // 完成刷新的帧数
+    uint32_t dropped;           // DROP: 帧环已满而跳过的渲染周期
+    uint32_t coalesced;         // COALESCE: 被更新的帧替换而未显示的帧
+    uint32_t render_waits;      // 渲染等待空闲帧的次数 (受面板限制)
+    uint32_t tx_starved;        // 发送任务等待新帧的次数 (受渲染限制)
+    uint32_t render_errors;
+    uint32_t display_errors;
+    uint32_t avg_render_us;
+    uint32_t avg_display_us;
+    uint32_t updates_x100;      // 持续刷新率 (次/秒 ×100), 从第一帧开始发送起计算
+    int8_t render_core;         // 渲染任务实际运行的核
+    int8_t tx_core;             // 发送任务实际运行的核
+} epd_pipeline_stats_t;
+
+typedef struct epd_pipeline_t epd_pipeline_t;
+
+// 借用帧缓冲区并启动两个任务; 需要先调用epd_pool_init
+esp_err_t epd_pipeline_start(epd_device_t *dev, const epd_pipeline_config_t *config,
+                             epd_pipeline_t **pipeline);
+
+// 等待渲染结束 (达到max_frames) 且所有已提交的帧显示完毕
+esp_err_t epd_pipeline_wait_idle(epd_pipeline_t *pipeline, uint32_t timeout_ms);
+
+// 停止渲染, 已提交的帧发送完后退出任务, 归还帧缓冲区
+void epd_pipeline_stop(epd_pipeline_t *pipeline);
+
+esp_err_t epd_pipeline_get_stats(epd_pipeline_t *pipeline, epd_pipeline_stats_t *stats);
+
+#endif // __EPD_PIPELINE_H__
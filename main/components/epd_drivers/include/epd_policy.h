@@ -0,0 +1,63 @@
+/**
+ * 刷新策略
+ * 每个设备记录自上次全刷以来的局刷/快刷次数和累计覆盖面积 (残影预算),
+ * 预算耗尽时驱动把请求的局刷/快刷自动升级为全刷; 设备空闲且有残影时
+ * epd_policy_service以RAM中的现有内容补一次全刷。调用方因此可以默认使用局刷
+ */
+
+#ifndef __EPD_POLICY_H__
+#define __EPD_POLICY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#ifndef EPD_POLICY_ENABLE
+#define EPD_POLICY_ENABLE            1        // 驱动init时挂接默认策略
+#endif
+#ifndef EPD_POLICY_MAX_PARTIALS
+#define EPD_POLICY_MAX_PARTIALS      10       // 两次全刷之间最多的局刷/快刷次数
+#endif
+#ifndef EPD_POLICY_MAX_AREA_PERCENT
+#define EPD_POLICY_MAX_AREA_PERCENT  400      // 两次全刷之间局刷累计覆盖面积上限 (屏幕百分比)
+#endif
+#ifndef EPD_POLICY_IDLE_FULL_MS
+#define EPD_POLICY_IDLE_FULL_MS      60000    // 空闲多久后允许epd_policy_service补全刷
+#endif
+
+// 策略配置, 各项为0表示不启用该条件
+typedef struct {
+    uint16_t max_partials;      // 两次全刷之间最多的局刷/快刷次数
+    uint16_t max_area_percent;  // 两次全刷之间局刷累计覆盖面积上限 (屏幕百分比, 可超过100)
+    uint32_t idle_full_ms;      // 距最近一次刷新超过该时间后, epd_policy_service补全刷
+} epd_policy_config_t;
+
+// 策略统计
+typedef struct {
+    uint32_t full;              // 全刷次数 (含升级和空闲补刷)
+    uint32_t partial;           // 局刷次数
+    uint32_t fast;              // 快刷次数
+    uint32_t promoted;          // 残影预算耗尽, 局刷/快刷升级为全刷的次数
+    uint32_t idle_full;         // 空闲时补刷的全刷次数
+    uint32_t since_full;        // 自上次全刷以来的局刷/快刷次数
+    uint32_t area_percent;      // 自上次全刷以来局刷累计覆盖面积 (屏幕百分比)
+    uint32_t avg_full_us;       // 全刷平均耗时 (触发到BUSY结束)
+    uint32_t avg_partial_us;    // 局刷和快刷平均耗时
+    uint64_t saved_us;          // 局刷/快刷相比平均全刷节省的累计时间
+} epd_policy_stats_t;
+
+// 默认配置 (EPD_POLICY_*宏)
+void epd_policy_default_config(epd_policy_config_t *config);
+
+// 挂接策略, config为NULL时使用默认配置; 已挂接时替换配置并清空预算和统计
+esp_err_t epd_policy_attach(epd_device_t *dev, const epd_policy_config_t *config);
+void epd_policy_detach(epd_device_t *dev);
+
+// 设备空闲且有残影时补一次全刷, refreshed返回是否刷新 (可为NULL);
+// 不得与该设备的其他显示操作同时调用, 设备不支持refresh时返回ESP_ERR_NOT_SUPPORTED
+esp_err_t epd_policy_service(epd_device_t *dev, bool *refreshed);
+
+esp_err_t epd_policy_get_stats(epd_device_t *dev, epd_policy_stats_t *stats);
+
+#endif // __EPD_POLICY_H__
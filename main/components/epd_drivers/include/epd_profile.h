@@ -0,0 +1,49 @@
+/**
+ * 刷新性能分析
+ * 以esp_timer微秒计时, 将一次刷新拆分为命令设置、RAM写入、BUSY等待三个阶段,
+ * 多次迭代后给出各阶段的最小值/中位数/P95/最大值和有效SPI吞吐量
+ */
+
+#ifndef __EPD_PROFILE_H__
+#define __EPD_PROFILE_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "epd_common.h"
+
+#define EPD_PROFILE_MAX_ITERATIONS  64    // 单次运行的最大迭代次数
+
+// 单个阶段的分布统计(微秒)
+typedef struct {
+    uint32_t min_us;
+    uint32_t median_us;
+    uint32_t p95_us;
+    uint32_t max_us;
+} epd_profile_stat_t;
+
+// 分析报告
+typedef struct {
+    epd_update_mode_t mode;
+    uint32_t iterations;
+    epd_profile_stat_t phase[EPD_PHASE_MAX];
+    uint32_t ram_bytes;           // 每次刷新写入RAM的字节数
+    uint32_t spi_bytes_per_sec;   // 按RAM写入阶段中位数计算的有效吞吐量
+    // 各阶段每次迭代的耗时(微秒), 前iterations个有效, 已按升序排列;
+    // 随报告由调用方提供, 计时期间不分配内存
+    uint32_t samples_us[EPD_PHASE_MAX][EPD_PROFILE_MAX_ITERATIONS];
+} epd_profile_report_t;
+
+// 手动计时: 在begin/end之间执行任意显示操作, 结果写入sample
+esp_err_t epd_profile_begin(epd_device_t *dev, epd_profile_sample_t *sample);
+void epd_profile_end(epd_device_t *dev);
+
+// 以指定模式连续刷新iterations次并统计
+esp_err_t epd_profile_run(epd_device_t *dev, const uint8_t *buffer,
+                          epd_update_mode_t mode, uint32_t iterations,
+                          epd_profile_report_t *report);
+
+// 输出报告
+void epd_profile_log(const epd_profile_report_t *report);
+const char* epd_phase_name(epd_phase_t phase);
+
+#endif // __EPD_PROFILE_H__
@@ -0,0 +1,17 @@
+/**
+ * SSD1619 驱动接口
+ * 适用于黑白/三色墨水屏
+ */
+
+#ifndef __EPD_SSD1619_H__
+#define __EPD_SSD1619_H__
+
+#include "epd_common.h"
+
+// 创建SSD1619设备实例, 需调用dev->init完成硬件初始化
+epd_device_t* epd_ssd1619_create(const epd_pins_t *pins,
+                                 uint16_t width,
+                                 uint16_t height,
+                                 epd_color_mode_t color_mode);
+
+#endif // __EPD_SSD1619_H__
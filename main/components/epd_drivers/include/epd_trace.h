@@ -0,0 +1,70 @@
+/**
+ * 二进制跟踪环
+ * 驱动在命令发送、RAM写入、BUSY等待和刷新各阶段记录定长事件到固定大小的环形缓冲区,
+ * 记录只取一次时间戳并在短临界区内写入16字节, 可在量产固件中常开;
+ * 现场刷新变慢时冻结跟踪并经串口导出, 由主机工具 epd_trace_json 转换为
+ * Chrome trace / Perfetto 可打开的JSON
+ *
+ * 串口导出格式 (每行一条, 可夹杂在其他日志之间):
+ *   EPD_TRACE_BEGIN v1 count=<n> dropped=<d>
+ *   EPD_TRACE <32个十六进制字符, 即一个事件的16字节小端编码>
+ *   EPD_TRACE_END fnv=<所有事件字节的FNV-1a, 8位十六进制>
+ */
+
+#ifndef __EPD_TRACE_H__
+#define __EPD_TRACE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifndef EPD_TRACE_ENABLE
+#define EPD_TRACE_ENABLE            1        // 0时记录调用在编译期去除
+#endif
+#ifndef EPD_TRACE_CAPACITY
+#define EPD_TRACE_CAPACITY          256      // 环形缓冲区事件数, 须为2的幂
+#endif
+
+#define EPD_TRACE_EVENT_SIZE        16       // 导出时每个事件的字节数
+#define EPD_TRACE_DUMP_PREFIX       "EPD_TRACE"
+
+// 事件类型
+typedef enum {
+    EPD_TRACE_CMD = 1,          // 命令字节: code为命令, value为随后的参数字节数
+    EPD_TRACE_DATA,             // 批量写入RAM: value为字节数
+    EPD_TRACE_BUSY,             // BUSY等待
+    EPD_TRACE_REFRESH,          // 主激活到刷新完成: code为epd_update_mode_t, value为覆盖像素数 (0为整屏)
+    EPD_TRACE_DISPLAY,          // 一次显示调用 (设置+RAM写入+刷新): code为epd_update_mode_t
+    EPD_TRACE_RESET,            // 硬件复位
+    EPD_TRACE_MARK,             // 应用标记 (epd_trace_mark)
+} epd_trace_type_t;
+
+#define EPD_TRACE_FLAG_ERROR        (1 << 0) // 操作返回错误或超时
+
+// 跟踪事件
+typedef struct {
+    uint32_t ts_us;             // 开始时间 (esp_timer低32位, 约71分钟回绕)
+    uint32_t dur_us;            // 持续时间, 瞬时事件为0
+    uint32_t value;             // 含义随类型而定
+    uint8_t type;               // epd_trace_type_t
+    uint8_t code;
+    int8_t dev;                 // 设备的CS引脚, 区分多块面板; 应用标记为-1
+    uint8_t flags;              // EPD_TRACE_FLAG_*
+} epd_trace_event_t;
+
+// 应用标记, 例如在业务事件发生处打点以便与驱动事件对齐
+void epd_trace_mark(uint8_t code, uint32_t value);
+
+// 暂停/恢复记录: 发现异常后暂停, 保留异常前的事件以便导出
+void epd_trace_set_enabled(bool enabled);
+void epd_trace_clear(void);
+
+// 按时间顺序复制最近的事件, 返回复制的数量; dropped返回被覆盖的事件数 (可为NULL)
+uint32_t epd_trace_snapshot(epd_trace_event_t *events, uint32_t max, uint32_t *dropped);
+
+// 按上述文本格式输出环中的全部事件, 固件上out传stdout即经控制台串口输出;
+// 输出期间暂停记录. EPD_TRACE_ENABLE为0时返回ESP_ERR_NOT_SUPPORTED
+esp_err_t epd_trace_dump(FILE *out);
+
+#endif // __EPD_TRACE_H__
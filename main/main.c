@@ -1,20 +1,31 @@
 /**
  * 墨水屏驱动测试框架 - 主程序
  * 支持多款墨水屏驱动芯片
- * 版本: 2.0
+ * 版本: 2.1
  */
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "nvs_flash.h"
 
 #include "epd_common.h"
+#include "epd_framebuffer.h"
+#include "epd_profile.h"
+#include "epd_epf.h"
+#include "epd_font.h"
+#include "epd_pipeline.h"
+#include "epd_dlist.h"
+#include "epd_policy.h"
+#include "epd_trace.h"
 #include "epd_ssd1619.h"
 #include "epd_il3820.h"
 #include "epd_uc8151.h"
@@ -28,6 +39,30 @@
 #define CONFIG_EPD_SPI_HOST     SPI2_HOST      // SPI主机
 #define CONFIG_EPD_SPI_SPEED    4000000        // SPI时钟频率(Hz)
 
+// 性能测试迭代次数
+#define PERF_ITERATIONS_FULL    3
+#define PERF_ITERATIONS_PARTIAL 5
+#define PIPELINE_FRAMES         10
+
+// 从设备帧缓冲池借用缓冲区的等待时间
+#define POOL_BORROW_TIMEOUT_MS  1000
+
+// 每个显示步骤后保持画面的时间, 供人工目视检查; 产线上为0, 步骤之间只等待刷新完成
+#ifndef TEST_VIEW_MS
+#define TEST_VIEW_MS            0
+#endif
+
+// 用例超时按黑白屏刷新时间给出, 三色屏全刷约慢5倍
+#ifndef TEST_TIMEOUT_SCALE_3C
+#define TEST_TIMEOUT_SCALE_3C   5
+#endif
+
+// 用例工作任务的栈大小
+#define TEST_TASK_STACK         8192
+
+// 结果行前缀, 上位机按此前缀从串口日志中提取JSON
+#define TEST_JSON_TAG           "EPD_TEST_JSON"
+
 // 硬件引脚配置 (根据你的驱动板修改)
 static const epd_pins_t g_epd_pins = {
     .spi_miso = -1,        // 通常不需要
@@ -45,10 +80,20 @@ static const char *TAG = "EPD_TEST";
 static epd_device_t *g_epd = NULL;
 static TaskHandle_t g_test_task = NULL;
 
+// 用例结果状态
+typedef enum {
+    TEST_PASS,
+    TEST_FAIL,
+    TEST_SKIP,          // 设备不支持该功能
+    TEST_TIMEOUT,       // 超过timeout_ms未返回
+    TEST_ABORTED,       // 前序用例超时, 设备状态未知, 未运行
+} test_status_t;
+
 // 测试结果结构体
 typedef struct {
     const char *test_name;
-    bool passed;
+    test_status_t status;
+    bool skipped;              // 用例调用test_skip后置位
     uint32_t duration_ms;
     const char *message;
 } test_result_t;
@@ -57,9 +102,23 @@ typedef struct {
 typedef struct {
     const char *name;
     bool (*func)(epd_device_t *epd, test_result_t *result);
-    uint32_t timeout_ms;
+    uint32_t timeout_ms;       // 黑白屏上的超时, 三色屏乘以TEST_TIMEOUT_SCALE_3C
 } test_case_t;
 
+// 设备不支持被测功能: 记为跳过而不是通过
+static bool test_skip(test_result_t *result, const char *message) {
+    result->skipped = true;
+    result->message = message;
+    return true;
+}
+
+// 目视检查的保持时间, TEST_VIEW_MS为0时不等待
+static void test_view(void) {
+    if (TEST_VIEW_MS > 0) {
+        vTaskDelay(pdMS_TO_TICKS(TEST_VIEW_MS));
+    }
+}
+
 // ==================== 测试用例实现 ====================
 
 // 测试1: 基础通信测试
@@ -68,9 +127,8 @@ static bool test_basic_comm(epd_device_t *epd, test_result_t *result) {
     
     ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
     
-    // 测试硬件复位
+    // 测试硬件复位 (复位返回时BUSY已释放)
     epd->reset(epd);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
     
     // 测试初始化
     err = epd->init(epd);
@@ -103,14 +161,14 @@ static bool test_clear_screen(epd_device_t *epd, test_result_t *result) {
         result->message = "清屏(白色)失败";
         return false;
     }
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    test_view();
     
     // 清屏为黑色
     if (epd->clear(epd, EPD_COLOR_BLACK) != ESP_OK) {
         result->message = "清屏(黑色)失败";
         return false;
     }
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    test_view();
     
     // 恢复白色
     epd->clear(epd, EPD_COLOR_WHITE);
@@ -128,28 +186,37 @@ static bool test_patterns(epd_device_t *epd, test_result_t *result) {
         result->message = "棋盘格图案显示失败";
         return false;
     }
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
+    test_view();
     
     // 测试渐变
     if (test_gradient_pattern(epd) != ESP_OK) {
         result->message = "渐变图案显示失败";
         return false;
     }
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
+    test_view();
+    
+    // 测试4级灰度 (黑白屏)
+    if (epd->info.capabilities & EPD_CAP_GRAYSCALE) {
+        if (test_gray_pattern(epd) != ESP_OK) {
+            result->message = "灰度色阶显示失败";
+            return false;
+        }
+        test_view();
+    }
     
     // 测试线条
     if (test_line_pattern(epd) != ESP_OK) {
         result->message = "线条图案显示失败";
         return false;
     }
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
+    test_view();
     
     // 测试圆和矩形
     if (test_shape_pattern(epd) != ESP_OK) {
         result->message = "几何形状显示失败";
         return false;
     }
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
+    test_view();
     
     // 清理屏幕
     epd->clear(epd, EPD_COLOR_WHITE);
@@ -162,10 +229,10 @@ static bool test_patterns(epd_device_t *epd, test_result_t *result) {
 static bool test_text_display(epd_device_t *epd, test_result_t *result) {
     ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
     
-    // 创建测试缓冲区
-    uint8_t *buffer = malloc(epd->info.width * epd->info.height / 8);
+    // 从帧缓冲池借用测试缓冲区
+    uint8_t *buffer = epd_pool_borrow(epd, POOL_BORROW_TIMEOUT_MS);
     if (!buffer) {
-        result->message = "内存分配失败";
+        result->message = "借用帧缓冲区失败";
         return false;
     }
     
@@ -178,15 +245,22 @@ static bool test_text_display(epd_device_t *epd, test_result_t *result) {
     epd_draw_text(buffer, epd->info.width, epd->info.height,
                   "Hello World!", 20, 60, EPD_COLOR_BLACK, 1);
     
+    // 比例字体, 按测量宽度水平居中
+    const char *line = "Proportional font";
+    uint32_t text_w = epd_font_measure(&epd_font_5x7_prop, line, 2, NULL);
+    uint16_t text_x = text_w < epd->info.width ? (epd->info.width - text_w) / 2 : 0;
+    epd_font_draw(buffer, epd->info.width, epd->info.height, &epd_font_5x7_prop,
+                  line, text_x, 85, EPD_COLOR_BLACK, 2);
+    
     // 显示文字
     if (epd->display_buffer(epd, buffer, EPD_UPDATE_FULL) != ESP_OK) {
-        free(buffer);
+        epd_pool_return(epd, buffer);
         result->message = "文字显示失败";
         return false;
     }
     
-    free(buffer);
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
+    epd_pool_return(epd, buffer);
+    test_view();
     
     result->message = "文字显示正常";
     return true;
@@ -196,107 +270,520 @@ static bool test_text_display(epd_device_t *epd, test_result_t *result) {
 static bool test_partial_refresh(epd_device_t *epd, test_result_t *result) {
     // 检查是否支持局部刷新
     if (!(epd->info.capabilities & EPD_CAP_PARTIAL_REFRESH)) {
-        result->message = "设备不支持局部刷新";
-        return true;  // 不是错误，只是跳过
+        return test_skip(result, "设备不支持局部刷新");
     }
     
     ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
     
-    // 创建缓冲区
-    uint8_t *buffer = malloc(epd->info.width * epd->info.height / 8);
-    if (!buffer) {
+    // 托管帧缓冲区: 绘图自动记录脏区, 提交时自动选择刷新方式
+    epd_fb_t *fb = epd_fb_create(epd);
+    if (!fb) {
         result->message = "内存分配失败";
         return false;
     }
     
-    // 初始清屏
-    memset(buffer, 0xFF, epd->info.width * epd->info.height / 8);
-    epd->display_buffer(epd, buffer, EPD_UPDATE_FULL);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-    
-    // 局部更新一个小方块
-    uint16_t x = epd->info.width / 4;
-    uint16_t y = epd->info.height / 4;
-    uint16_t w = epd->info.width / 2;
-    uint16_t h = epd->info.height / 2;
-    
-    // 绘制黑色方块
-    for (uint16_t i = y; i < y + h; i++) {
-        for (uint16_t j = x; j < x + w; j++) {
-            uint32_t idx = i * (epd->info.width / 8) + (j / 8);
-            uint8_t bit = 0x80 >> (j % 8);
-            buffer[idx] &= ~bit;
-        }
-    }
+    // 初始清屏 (首次提交总是全刷)
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    epd_fb_commit(fb, NULL);
+    test_view();
     
-    // 局部刷新
-    if (epd->display_partial(epd, buffer, x, y, w, h) != ESP_OK) {
-        free(buffer);
+    // 绘制黑色方块, 只有方块区域会被局刷
+    epd_draw_rect(fb->buffer, fb->width, fb->height,
+                  fb->width / 4, fb->height / 4,
+                  fb->width / 2, fb->height / 2,
+                  EPD_COLOR_BLACK, true);
+    
+    epd_fb_commit_t path;
+    if (epd_fb_commit(fb, &path) != ESP_OK) {
+        epd_fb_destroy(fb);
         result->message = "局部刷新失败";
         return false;
     }
     
-    free(buffer);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    // 三色屏不支持局刷, 有变化时总是全刷
+    epd_fb_commit_t expected = fb->red ? EPD_FB_COMMIT_FULL : EPD_FB_COMMIT_PARTIAL;
+    if (path != expected) {
+        epd_fb_destroy(fb);
+        result->message = "刷新方式选择错误";
+        return false;
+    }
+    
+    // 内容未变化时不应刷新
+    epd_fb_commit(fb, &path);
+    epd_fb_destroy(fb);
+    
+    if (path != EPD_FB_COMMIT_NONE) {
+        result->message = "无变化时仍然刷新";
+        return false;
+    }
+    
+    test_view();
     
     result->message = "局部刷新功能正常";
     return true;
 }
 
+// 测试: 三色显示测试
+static bool test_red_plane(epd_device_t *epd, test_result_t *result) {
+    if (epd->info.color_mode != EPD_MODE_3C) {
+        return test_skip(result, "非三色屏");
+    }
+    
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    epd_fb_t *fb = epd_fb_create(epd);
+    if (!fb) {
+        result->message = "内存分配失败";
+        return false;
+    }
+    
+    // 黑色和红色文字
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    epd_draw_text(fb->buffer, fb->width, fb->height,
+                  "BLACK", 20, 30, EPD_COLOR_BLACK, 2);
+    epd_draw_text(fb->buffer, fb->width, fb->height,
+                  "RED", 20, 60, EPD_COLOR_RED, 2);
+    
+    if (epd_fb_commit(fb, NULL) != ESP_OK) {
+        epd_fb_destroy(fb);
+        result->message = "三色显示失败";
+        return false;
+    }
+    test_view();
+    
+    // 只修改黑白内容, 红色平面不应重新发送
+    epd_draw_rect(fb->buffer, fb->width, fb->height,
+                  fb->width - 40, 10, 30, 30, EPD_COLOR_BLACK, true);
+    esp_err_t err = epd_fb_commit(fb, NULL);
+    uint32_t skipped = fb->stats.red_planes_skipped;
+    epd_fb_destroy(fb);
+    
+    if (err != ESP_OK) {
+        result->message = "三色显示失败";
+        return false;
+    }
+    
+    if (skipped != 1) {
+        result->message = "红色平面未变化时仍被发送";
+        return false;
+    }
+    
+    result->message = "三色显示功能正常";
+    return true;
+}
+
+// 测试: 压缩帧显示 (上半屏黑色、下半屏白色, 按行交替的条纹作为字面量段)
+static bool test_epf_display(epd_device_t *epd, test_result_t *result) {
+    if (!epd->display_stream) {
+        return test_skip(result, "设备不支持流式显示");
+    }
+    
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    uint16_t stride = epd->info.width / 8;
+    uint32_t half = (uint32_t)stride * (epd->info.height / 2);
+    uint32_t rest = (uint32_t)stride * epd->info.height - half;
+    
+    // 文件头 + 两个长重复段
+    uint8_t frame[EPD_EPF_HEADER_SIZE + 8] = { 'E', 'P', 'F', '1' };
+    frame[4] = epd->info.width & 0xFF;
+    frame[5] = epd->info.width >> 8;
+    frame[6] = epd->info.height & 0xFF;
+    frame[7] = epd->info.height >> 8;
+    frame[12] = 8;  // 黑白平面编码长度
+    
+    uint8_t *p = frame + EPD_EPF_HEADER_SIZE;
+    *p++ = EPD_EPF_OP_LONG_RUN;
+    *p++ = half & 0xFF;
+    *p++ = (half >> 8) & 0xFF;
+    *p++ = 0x00;
+    *p++ = EPD_EPF_OP_LONG_RUN;
+    *p++ = rest & 0xFF;
+    *p++ = (rest >> 8) & 0xFF;
+    *p++ = 0xFF;
+    
+    uint32_t heap_before = esp_get_free_heap_size();
+    esp_err_t err = epd_display_epf(epd, frame, sizeof(frame), EPD_UPDATE_FULL);
+    uint32_t heap_after = esp_get_free_heap_size();
+    
+    if (err != ESP_OK) {
+        result->message = "压缩帧显示失败";
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "压缩帧 %u 字节, 显示前后空闲堆 %u / %u",
+             (unsigned)sizeof(frame), (unsigned)heap_before, (unsigned)heap_after);
+    
+    result->message = "压缩帧显示正常";
+    return true;
+}
+
 // 测试6: 性能测试
 static bool test_performance(epd_device_t *epd, test_result_t *result) {
     ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
     
-    uint8_t *buffer = malloc(epd->info.width * epd->info.height / 8);
+    uint8_t *buffer = epd_pool_borrow(epd, POOL_BORROW_TIMEOUT_MS);
     if (!buffer) {
-        result->message = "内存分配失败";
+        result->message = "借用帧缓冲区失败";
         return false;
     }
     
     // 生成测试图案
     memset(buffer, 0xAA, epd->info.width * epd->info.height / 8);
     
-    // 测试全刷时间
-    uint32_t start_time = esp_log_timestamp();
-    esp_err_t err = epd->display_buffer(epd, buffer, EPD_UPDATE_FULL);
-    uint32_t end_time = esp_log_timestamp();
+    // 刷新期间的堆变化: 驱动热路径不应分配或释放内存
+    epd_pool_stats_t pool_before, pool_after;
+    epd_pool_get_stats(epd, &pool_before);
+    uint32_t heap_before = esp_get_free_heap_size();
     
+    // 全刷: 分阶段统计; 报告带有各次迭代的原始数据, 全刷和局刷共用一份
+    epd_profile_report_t report;
+    esp_err_t err = epd_profile_run(epd, buffer, EPD_UPDATE_FULL,
+                                    PERF_ITERATIONS_FULL, &report);
     if (err != ESP_OK) {
-        free(buffer);
+        epd_pool_return(epd, buffer);
         result->message = "性能测试失败";
         return false;
     }
+    epd_profile_log(&report);
     
-    uint32_t full_refresh_time = end_time - start_time;
-    
-    ESP_LOGI(TAG, "全刷时间: %d ms", full_refresh_time);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    static char msg[64];
+    snprintf(msg, sizeof(msg), "全刷中位数: %u ms, SPI %u KB/s",
+             (unsigned)(report.phase[EPD_PHASE_TOTAL].median_us / 1000),
+             (unsigned)(report.spi_bytes_per_sec / 1024));
     
-    // 测试局刷时间（如果支持）
+    // 局刷（如果支持）
     if (epd->info.capabilities & EPD_CAP_PARTIAL_REFRESH) {
         // 修改部分数据
         memset(buffer + 100, 0x55, 50);
-        
-        start_time = esp_log_timestamp();
-        err = epd->display_buffer(epd, buffer, EPD_UPDATE_PARTIAL);
-        end_time = esp_log_timestamp();
-        
+    
+        err = epd_profile_run(epd, buffer, EPD_UPDATE_PARTIAL,
+                              PERF_ITERATIONS_PARTIAL, &report);
         if (err == ESP_OK) {
-            uint32_t partial_refresh_time = end_time - start_time;
-            ESP_LOGI(TAG, "局刷时间: %d ms", partial_refresh_time);
+            epd_profile_log(&report);
         }
     }
     
-    free(buffer);
+    uint32_t heap_after = esp_get_free_heap_size();
+    epd_pool_get_stats(epd, &pool_after);
+    epd_pool_return(epd, buffer);
+    
+    ESP_LOGI(TAG, "刷新前后空闲堆 %u / %u, 池堆分配 %u -> %u, 借出峰值 %u/%u",
+             (unsigned)heap_before, (unsigned)heap_after,
+             (unsigned)pool_before.heap_allocs, (unsigned)pool_after.heap_allocs,
+             pool_after.peak_in_use, pool_after.count);
+    
+    // 温度补偿: 各温度区间的刷新耗时
+    int8_t temp_c;
+    if (epd->read_temperature(epd, &temp_c) == ESP_OK) {
+        ESP_LOGI(TAG, "控制器温度: %d度", temp_c);
+    }
+    for (uint8_t band = 0; band < EPD_TEMP_MAX_BANDS; band++) {
+        epd_temp_band_stats_t stats;
+        if (epd->get_temp_band_stats(epd, band, &stats) != ESP_OK) {
+            break;
+        }
+        if (stats.refreshes) {
+            ESP_LOGI(TAG, "温度区间 >=%d度: 刷新 %u 次, 平均 %u ms, 最大 %u ms", stats.min_c,
+                     (unsigned)stats.refreshes, (unsigned)(stats.avg_us / 1000),
+                     (unsigned)(stats.max_us / 1000));
+        }
+    }
     
     // 记录结果
-    char msg[64];
-    snprintf(msg, sizeof(msg), "全刷耗时: %d ms", full_refresh_time);
     result->message = msg;
     
     return true;
 }
 
+// 归还借用的帧缓冲区 (跳过借用失败的NULL)
+static void release_frames(epd_device_t *epd, uint8_t **frames, int count) {
+    for (int i = 0; i < count; i++) {
+        if (frames[i]) {
+            epd_pool_return(epd, frames[i]);
+        }
+    }
+}
+
+// 测试: 异步刷新测试 (渲染下一帧与面板刷新重叠)
+static bool test_async_display(epd_device_t *epd, test_result_t *result) {
+    if (!epd->display_buffer_async) {
+        return test_skip(result, "设备不支持异步刷新");
+    }
+    
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    uint32_t buffer_size = epd->info.width * epd->info.height / 8;
+    uint8_t *frames[2] = {
+        epd_pool_borrow(epd, POOL_BORROW_TIMEOUT_MS),
+        epd_pool_borrow(epd, POOL_BORROW_TIMEOUT_MS)
+    };
+    if (!frames[0] || !frames[1]) {
+        release_frames(epd, frames, 2);
+        result->message = "借用帧缓冲区失败";
+        return false;
+    }
+    
+    // 第一帧
+    memset(frames[0], 0xFF, buffer_size);
+    epd_draw_text(frames[0], epd->info.width, epd->info.height,
+                  "FRAME 1", 20, 30, EPD_COLOR_BLACK, 2);
+    
+    epd_async_handle_t handle;
+    uint32_t start_time = esp_log_timestamp();
+    if (epd->display_buffer_async(epd, frames[0], EPD_UPDATE_FULL,
+                                  NULL, NULL, &handle) != ESP_OK) {
+        release_frames(epd, frames, 2);
+        result->message = "提交异步刷新失败";
+        return false;
+    }
+    uint32_t submit_time = esp_log_timestamp() - start_time;
+    
+    // 面板刷新期间渲染第二帧
+    memset(frames[1], 0xFF, buffer_size);
+    epd_draw_text(frames[1], epd->info.width, epd->info.height,
+                  "FRAME 2", 20, 60, EPD_COLOR_BLACK, 2);
+    
+    esp_err_t err = epd_async_wait(handle, EPD_WAIT_FOREVER);
+    if (err == ESP_OK) {
+        err = epd->display_buffer_async(epd, frames[1], EPD_UPDATE_FULL,
+                                        NULL, NULL, &handle);
+        if (err == ESP_OK) {
+            err = epd_async_wait(handle, EPD_WAIT_FOREVER);
+        }
+    }
+    
+    release_frames(epd, frames, 2);
+    
+    if (err != ESP_OK) {
+        result->message = "异步刷新失败";
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "提交耗时: %d ms, 两帧总耗时: %d ms",
+             submit_time, esp_log_timestamp() - start_time);
+    
+    result->message = "异步刷新功能正常";
+    return true;
+}
+
+// 流水线渲染: 计数器文字和移动的方块
+static esp_err_t pipeline_render_frame(void *ctx, uint8_t *frame, uint32_t seq) {
+    epd_device_t *epd = (epd_device_t *)ctx;
+    uint16_t w = epd->info.width;
+    uint16_t h = epd->info.height;
+    char text[16];
+    
+    memset(frame, 0xFF, w * h / 8);
+    snprintf(text, sizeof(text), "FRAME %u", (unsigned)seq + 1);
+    epd_draw_text(frame, w, h, text, 20, 30, EPD_COLOR_BLACK, 2);
+    epd_draw_rect(frame, w, h, (seq * 24) % (w - 24), h - 32, 24, 24, EPD_COLOR_BLACK, true);
+    return ESP_OK;
+}
+
+// 测试: 双核流水线 (渲染核绘制下一帧, 发送核刷新面板)
+static bool test_pipeline_display(epd_device_t *epd, test_result_t *result) {
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    epd_pipeline_config_t config = {
+        .render = pipeline_render_frame,
+        .ctx = epd,
+        .ring_size = 2,
+        .policy = EPD_PIPELINE_BLOCK,
+        .mode = (epd->info.capabilities & EPD_CAP_PARTIAL_REFRESH) ?
+                EPD_UPDATE_PARTIAL : EPD_UPDATE_FULL,
+        .max_frames = PIPELINE_FRAMES,
+    };
+    
+    epd_pipeline_t *pipeline = NULL;
+    if (epd_pipeline_start(epd, &config, &pipeline) != ESP_OK) {
+        result->message = "启动流水线失败";
+        return false;
+    }
+    
+    esp_err_t err = epd_pipeline_wait_idle(pipeline, EPD_WAIT_FOREVER);
+    epd_pipeline_stats_t stats;
+    epd_pipeline_get_stats(pipeline, &stats);
+    epd_pipeline_stop(pipeline);
+    
+    if (err != ESP_OK || stats.display_errors || stats.displayed != PIPELINE_FRAMES) {
+        result->message = "流水线刷新失败";
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "渲染核%d 平均 %u us, 发送核%d 平均 %u ms, 渲染等待 %u, 发送空闲 %u",
+             stats.render_core, (unsigned)stats.avg_render_us, stats.tx_core,
+             (unsigned)(stats.avg_display_us / 1000), (unsigned)stats.render_waits,
+             (unsigned)stats.tx_starved);
+    
+    static char msg[64];
+    snprintf(msg, sizeof(msg), "持续刷新率: %u.%02u 次/秒",
+             (unsigned)(stats.updates_x100 / 100), (unsigned)(stats.updates_x100 % 100));
+    result->message = msg;
+    return true;
+}
+
+// 条带绘制: 每16行交替的横纹, 三色屏上每隔一条横纹为红色
+static esp_err_t band_draw_stripes(void *ctx, uint8_t *bw, uint8_t *red,
+                                   uint16_t y0, uint16_t rows) {
+    uint16_t width = *(const uint16_t *)ctx;
+    
+    for (uint16_t r = 0; r < rows; r++) {
+        uint16_t y = y0 + r;
+        if ((y / 16) % 2 == 0) {
+            continue;
+        }
+        if (red && (y / 32) % 2) {
+            memset(red + r * width / 8, 0xFF, width / 8);   // 红色平面1为红
+        } else {
+            memset(bw + r * width / 8, 0x00, width / 8);
+        }
+    }
+    return ESP_OK;
+}
+
+// 测试: 条带渲染 (不使用整屏缓冲区)
+static bool test_band_display(epd_device_t *epd, test_result_t *result) {
+    if (!epd->display_bands) {
+        return test_skip(result, "设备不支持条带渲染");
+    }
+    
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    uint16_t width = epd->info.width;
+    epd_band_stats_t stats;
+    esp_err_t err = epd->display_bands(epd, 0, band_draw_stripes, &width,
+                                       EPD_UPDATE_FULL, &stats);
+    if (err != ESP_OK) {
+        result->message = "条带渲染失败";
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "%u个条带 x %u行, 缓冲区 %u 字节 (整屏 %u), 写入 %u us, %u 字节/秒",
+             stats.bands, stats.band_height, (unsigned)stats.buffer_bytes,
+             (unsigned)stats.frame_bytes, (unsigned)stats.transfer_us,
+             (unsigned)stats.bytes_per_sec);
+    
+    static char msg[64];
+    snprintf(msg, sizeof(msg), "峰值内存 %u 字节, 总耗时 %u ms",
+             (unsigned)stats.buffer_bytes, (unsigned)(stats.total_us / 1000));
+    result->message = msg;
+    return true;
+}
+
+// 测试: 显示列表 (状态屏, 每次只更新计数文字)
+static bool test_dlist_display(epd_device_t *epd, test_result_t *result) {
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    epd_fb_t *fb = epd_fb_create(epd);
+    epd_dlist_t *dl = fb ? epd_dlist_create(fb, EPD_COLOR_WHITE) : NULL;
+    if (!dl) {
+        epd_fb_destroy(fb);
+        result->message = "内存分配失败";
+        return false;
+    }
+    
+    uint8_t count_id = 0;
+    epd_dlist_add_rect(dl, 2, 2, fb->width - 4, fb->height - 4, EPD_COLOR_BLACK, false, NULL);
+    epd_dlist_add_text(dl, &epd_font_5x7_prop, "STATUS", 10, 10, EPD_COLOR_BLACK, 2, NULL);
+    epd_dlist_add_line(dl, 10, 28, fb->width - 10, 28, EPD_COLOR_BLACK, NULL);
+    epd_dlist_add_text(dl, &epd_font_5x7, "0", 10, 40, EPD_COLOR_BLACK, 3, &count_id);
+    
+    esp_err_t err = epd_dlist_commit(dl, NULL);
+    
+    epd_fb_commit_t path = EPD_FB_COMMIT_NONE;
+    char text[8];
+    for (int i = 1; i <= 3 && err == ESP_OK; i++) {
+        test_view();
+        snprintf(text, sizeof(text), "%d", i * 7);
+        epd_dlist_set_text(dl, count_id, text);
+        err = epd_dlist_commit(dl, &path);
+    }
+    
+    // 三色屏或不支持局刷的设备, 有变化时总是全刷
+    epd_fb_commit_t expected = (fb->red || !(epd->info.capabilities & EPD_CAP_PARTIAL_REFRESH)) ?
+                               EPD_FB_COMMIT_FULL : EPD_FB_COMMIT_PARTIAL;
+    epd_dlist_stats_t stats;
+    epd_dlist_get_stats(dl, &stats);
+    epd_dlist_destroy(dl);
+    epd_fb_destroy(fb);
+    
+    if (err != ESP_OK) {
+        result->message = "显示列表提交失败";
+        return false;
+    }
+    
+    if (path != expected) {
+        result->message = "刷新方式选择错误";
+        return false;
+    }
+    
+    static char msg[64];
+    snprintf(msg, sizeof(msg), "提交 %u 次, 重绘 %u 像素, 最近重绘 %u us",
+             (unsigned)stats.commits, (unsigned)stats.pixels_redrawn,
+             (unsigned)stats.last_raster_us);
+    result->message = msg;
+    return true;
+}
+
+// 测试: 刷新策略 (连续局刷后自动插入全刷, 空闲后补刷)
+static bool test_refresh_policy(epd_device_t *epd, test_result_t *result) {
+    if (!(epd->info.capabilities & EPD_CAP_PARTIAL_REFRESH) || epd->info.color_mode != EPD_MODE_1C) {
+        return test_skip(result, "设备不支持局部刷新");
+    }
+    
+    ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
+    
+    epd_fb_t *fb = epd_fb_create(epd);
+    if (!fb) {
+        result->message = "内存分配失败";
+        return false;
+    }
+    
+    epd_policy_config_t cfg = { .max_partials = 3, .max_area_percent = 0, .idle_full_ms = 200 };
+    epd_policy_attach(epd, &cfg);
+    
+    epd_fb_clear(fb, EPD_COLOR_WHITE);
+    esp_err_t err = epd_fb_commit(fb, NULL);
+    
+    // 5次计数局刷: 第4次被升级为全刷
+    char text[8];
+    for (int i = 1; i <= 5 && err == ESP_OK; i++) {
+        snprintf(text, sizeof(text), "%d", i);
+        epd_draw_rect(fb->buffer, fb->width, fb->height, 10, 10, 40, 24, EPD_COLOR_WHITE, true);
+        epd_draw_text(fb->buffer, fb->width, fb->height, text, 10, 10, EPD_COLOR_BLACK, 3);
+        err = epd_fb_commit(fb, NULL);
+    }
+    
+    bool refreshed = false;
+    if (err == ESP_OK) {
+        // 空闲补刷以时间为条件, 只等待配置的空闲时间
+        vTaskDelay(pdMS_TO_TICKS(cfg.idle_full_ms + 20));
+        err = epd_policy_service(epd, &refreshed);
+    }
+    
+    epd_policy_stats_t stats;
+    epd_policy_get_stats(epd, &stats);
+    epd_policy_attach(epd, NULL);
+    epd_fb_destroy(fb);
+    
+    if (err != ESP_OK) {
+        result->message = "刷新失败";
+        return false;
+    }
+    
+    if (stats.promoted != 1 || !refreshed) {
+        result->message = "未按预算插入全刷";
+        return false;
+    }
+    
+    static char msg[64];
+    snprintf(msg, sizeof(msg), "局刷 %u 次, 节省 %u ms",
+             (unsigned)stats.partial, (unsigned)(stats.saved_us / 1000));
+    result->message = msg;
+    return true;
+}
+
 // 测试7: 睡眠和唤醒测试
 static bool test_sleep_wakeup(epd_device_t *epd, test_result_t *result) {
     ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
@@ -307,29 +794,25 @@ static bool test_sleep_wakeup(epd_device_t *epd, test_result_t *result) {
         return false;
     }
     
-    ESP_LOGI(TAG, "设备已进入睡眠，等待3秒...");
-    vTaskDelay(3000 / portTICK_PERIOD_MS);
+    ESP_LOGI(TAG, "设备已进入睡眠");
+    test_view();
     
-    // 唤醒设备
+    // 唤醒设备: 驱动状态和面板RAM都还在, 不需要重新初始化
+    int64_t start = esp_timer_get_time();
     if (epd->wakeup(epd) != ESP_OK) {
         result->message = "唤醒设备失败";
         return false;
     }
-    
-    // 重新初始化
-    if (epd->init(epd) != ESP_OK) {
-        result->message = "唤醒后初始化失败";
-        return false;
-    }
+    ESP_LOGI(TAG, "唤醒耗时: %lld us", (long long)(esp_timer_get_time() - start));
     
     // 显示测试图案确认正常工作
     epd->clear(epd, EPD_COLOR_WHITE);
-    uint8_t test_buffer[100];
-    memset(test_buffer, 0x00, 50);
-    memset(test_buffer + 50, 0xFF, 50);
+    uint8_t test_buffer[(48 / 8) * 10];
+    memset(test_buffer, 0x00, sizeof(test_buffer) / 2);
+    memset(test_buffer + sizeof(test_buffer) / 2, 0xFF, sizeof(test_buffer) / 2);
     
     // 显示一个小方块
-    epd->display_partial(epd, test_buffer, 50, 50, 50, 10);
+    epd->display_partial(epd, test_buffer, 48, 48, 48, 10);
     
     result->message = "睡眠唤醒功能正常";
     return true;
@@ -339,8 +822,7 @@ static bool test_sleep_wakeup(epd_device_t *epd, test_result_t *result) {
 static bool test_power_management(epd_device_t *epd, test_result_t *result) {
     // 检查是否支持电源控制
     if (!(epd->info.capabilities & EPD_CAP_POWER_CONTROL)) {
-        result->message = "设备不支持电源控制";
-        return true;  // 不是错误
+        return test_skip(result, "设备不支持电源控制");
     }
     
     ESP_LOGI(TAG, "[%s] 开始测试", result->test_name);
@@ -356,11 +838,18 @@ static bool test_power_management(epd_device_t *epd, test_result_t *result) {
 
 static test_case_t g_test_suite[] = {
     {"基础通信", test_basic_comm, 5000},
-    {"清屏测试", test_clear_screen, 5000},
-    {"图案显示", test_patterns, 10000},
-    {"文字显示", test_text_display, 5000},
-    {"局部刷新", test_partial_refresh, 5000},
-    {"性能测试", test_performance, 10000},
+    {"清屏测试", test_clear_screen, 15000},
+    {"图案显示", test_patterns, 40000},
+    {"文字显示", test_text_display, 8000},
+    {"局部刷新", test_partial_refresh, 8000},
+    {"三色显示", test_red_plane, 8000},
+    {"压缩图像", test_epf_display, 20000},
+    {"性能测试", test_performance, 120000},
+    {"异步刷新", test_async_display, 20000},
+    {"流水线刷新", test_pipeline_display, 60000},
+    {"条带渲染", test_band_display, 20000},
+    {"显示列表", test_dlist_display, 20000},
+    {"刷新策略", test_refresh_policy, 30000},
     {"睡眠唤醒", test_sleep_wakeup, 8000},
     {"电源管理", test_power_management, 3000},
 };
@@ -369,11 +858,119 @@ static test_case_t g_test_suite[] = {
 
 // ==================== 测试运行器 ====================
 
+static const char *const s_status_names[] = { "PASS", "FAIL", "SKIP", "TIMEOUT", "ABORTED" };
+
+// 在工作任务中运行的用例
+typedef struct {
+    const test_case_t *tc;
+    epd_device_t *epd;
+    test_result_t result;
+    bool ret;
+    SemaphoreHandle_t done;
+} test_run_t;
+
+static void test_worker(void *arg) {
+    test_run_t *run = (test_run_t *)arg;
+    
+    run->ret = run->tc->func(run->epd, &run->result);
+    xSemaphoreGive(run->done);
+    
+    // 由运行器删除, 这样无论超时与否删除都只发生一次
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+// 在独立任务中运行用例, 超过timeout_ms未返回时删除该任务并记为超时;
+// 被删除的任务可能停在驱动内部, 持有设备锁、池中的缓冲区或帧缓冲区登记, 之后设备不再可用
+static void test_run_case(const test_case_t *tc, epd_device_t *epd, test_result_t *result) {
+    test_run_t *run = calloc(1, sizeof(test_run_t));
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    TaskHandle_t worker = NULL;
+    
+    if (!run || !done) {
+        free(run);
+        if (done) {
+            vSemaphoreDelete(done);
+        }
+        result->status = TEST_FAIL;
+        result->message = "内存分配失败";
+        return;
+    }
+    
+    run->tc = tc;
+    run->epd = epd;
+    run->result = *result;
+    run->done = done;
+    
+    uint32_t start_time = esp_log_timestamp();
+    if (xTaskCreate(test_worker, "epd_test_case", TEST_TASK_STACK, run, 5, &worker) != pdPASS) {
+        vSemaphoreDelete(done);
+        free(run);
+        result->status = TEST_FAIL;
+        result->message = "创建用例任务失败";
+        return;
+    }
+    
+    uint32_t timeout_ms = tc->timeout_ms;
+    if (epd->info.color_mode == EPD_MODE_3C) {
+        timeout_ms *= TEST_TIMEOUT_SCALE_3C;
+    }
+    
+    bool finished = xSemaphoreTake(done, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    result->duration_ms = esp_log_timestamp() - start_time;
+    vTaskDelete(worker);
+    vSemaphoreDelete(done);
+    
+    if (!finished) {
+        result->status = TEST_TIMEOUT;
+        result->message = "超时";
+    } else {
+        result->message = run->result.message;
+        if (!run->ret) {
+            result->status = TEST_FAIL;
+        } else if (run->result.skipped) {
+            result->status = TEST_SKIP;
+        } else {
+            result->status = TEST_PASS;
+        }
+    }
+    
+    // 超时的用例可能仍在使用run, 删除任务后才能释放
+    free(run);
+}
+
+// 输出JSON字符串 (转义引号、反斜杠和控制字符)
+static void test_json_string(const char *str) {
+    putchar('"');
+    for (const char *p = str ? str : ""; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            printf("\\%c", c);
+        } else if (c < 0x20) {
+            printf("\\u%04x", c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+// 每个用例一行JSON结果
+static void test_json_case(int index, const test_result_t *result) {
+    printf(TEST_JSON_TAG " {\"index\":%d,\"name\":", index);
+    test_json_string(result->test_name);
+    printf(",\"status\":\"%s\",\"ms\":%u,\"message\":",
+           s_status_names[result->status], (unsigned)result->duration_ms);
+    test_json_string(result->message);
+    printf("}\n");
+}
+
 static void run_test_suite(void *arg) {
     epd_device_t *epd = (epd_device_t *)arg;
     
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "   墨水屏驱动测试套件 v2.0");
+    ESP_LOGI(TAG, "   墨水屏驱动测试套件 v2.1");
     ESP_LOGI(TAG, "   驱动类型: %s", epd->info.chip_name);
     ESP_LOGI(TAG, "   屏幕分辨率: %dx%d", epd->info.width, epd->info.height);
     ESP_LOGI(TAG, "========================================");
@@ -381,42 +978,70 @@ static void run_test_suite(void *arg) {
     uint32_t total_passed = 0;
     uint32_t total_failed = 0;
     uint32_t total_skipped = 0;
+    uint32_t total_timeout = 0;
+    uint32_t total_aborted = 0;
     uint32_t total_time = 0;
+    bool aborted = false;
     
     // 运行所有测试用例
     for (int i = 0; i < TEST_COUNT; i++) {
         test_result_t result = {
             .test_name = g_test_suite[i].name,
-            .passed = false,
+            .status = TEST_SKIP,
+            .skipped = false,
             .duration_ms = 0,
             .message = ""
         };
-        
+    
         ESP_LOGI(TAG, "\n[测试 %d/%d] %s", i + 1, TEST_COUNT, result.test_name);
         ESP_LOGI(TAG, "----------------------------------------");
-        
-        uint32_t start_time = esp_log_timestamp();
-        bool test_result = g_test_suite[i].func(epd, &result);
-        uint32_t end_time = esp_log_timestamp();
-        
-        result.duration_ms = end_time - start_time;
-        result.passed = test_result;
-        
-        // 记录结果
-        if (test_result) {
-            total_passed++;
-            ESP_LOGI(TAG, "✓ 通过 (%d ms)", result.duration_ms);
+    
+        if (aborted) {
+            result.status = TEST_ABORTED;
+            result.message = "前序用例超时, 未运行";
         } else {
-            total_failed++;
-            ESP_LOGE(TAG, "✗ 失败 (%d ms): %s", result.duration_ms, result.message);
+            epd_trace_clear();
+            test_run_case(&g_test_suite[i], epd, &result);
+        }
+    
+        // 记录结果
+        switch (result.status) {
+            case TEST_PASS:
+                total_passed++;
+                ESP_LOGI(TAG, "✓ 通过 (%d ms)", result.duration_ms);
+                break;
+            case TEST_SKIP:
+                total_skipped++;
+                ESP_LOGW(TAG, "- 跳过: %s", result.message);
+                break;
+            case TEST_TIMEOUT:
+                total_timeout++;
+                ESP_LOGE(TAG, "✗ 超时 (%d ms)", result.duration_ms);
+                break;
+            case TEST_ABORTED:
+                total_aborted++;
+                ESP_LOGW(TAG, "- 中止: %s", result.message);
+                break;
+            default:
+                total_failed++;
+                ESP_LOGE(TAG, "✗ 失败 (%d ms): %s", result.duration_ms, result.message);
+                break;
         }
-        
+    
         ESP_LOGI(TAG, "   消息: %s", result.message);
-        
+        test_json_case(i + 1, &result);
+    
+        // 失败或超时时导出本用例的驱动跟踪, 用 host/tools/epd_trace_json 转换后查看
+        if (!aborted && (result.status == TEST_FAIL || result.status == TEST_TIMEOUT)) {
+            epd_trace_dump(stdout);
+        }
+    
         total_time += result.duration_ms;
-        
-        // 测试间延迟
-        vTaskDelay(500 / portTICK_PERIOD_MS);
+    
+        // 被删除的用例可能停在任意位置, 之后的结果不再独立, 剩余用例记为中止
+        if (result.status == TEST_TIMEOUT) {
+            aborted = true;
+        }
     }
     
     // 输出摘要
@@ -427,19 +1052,29 @@ static void run_test_suite(void *arg) {
     ESP_LOGI(TAG, "通过: %d", total_passed);
     ESP_LOGI(TAG, "失败: %d", total_failed);
     ESP_LOGI(TAG, "跳过: %d", total_skipped);
+    ESP_LOGI(TAG, "超时: %d", total_timeout);
+    ESP_LOGI(TAG, "中止: %d", total_aborted);
     ESP_LOGI(TAG, "总耗时: %d ms", total_time);
     ESP_LOGI(TAG, "========================================\n");
     
-    // 最终清屏
-    epd->clear(epd, EPD_COLOR_WHITE);
-    epd->sleep(epd);
+    printf(TEST_JSON_TAG " {\"summary\":true,\"chip\":");
+    test_json_string(epd->info.chip_name);
+    printf(",\"total\":%d,\"passed\":%u,\"failed\":%u,\"skipped\":%u,\"timeout\":%u,"
+           "\"aborted\":%u,\"ms\":%u,\"result\":\"%s\"}\n",
+           (int)TEST_COUNT, (unsigned)total_passed, (unsigned)total_failed,
+           (unsigned)total_skipped, (unsigned)total_timeout, (unsigned)total_aborted,
+           (unsigned)total_time, (total_failed || total_timeout) ? "FAIL" : "PASS");
+    
+    // 最终清屏; 中止时设备可能被删除的用例锁住, 不再访问
+    if (!aborted) {
+        epd->clear(epd, EPD_COLOR_WHITE);
+        epd->sleep(epd);
     
-    // 等待一段时间后重启（可选）
-    ESP_LOGI(TAG, "所有测试完成，5秒后进入深度睡眠...");
-    vTaskDelay(5000 / portTICK_PERIOD_MS);
+        // 清理资源
+        epd->deinit(epd);
+    }
     
-    // 清理资源
-    epd->deinit(epd);
+    ESP_LOGI(TAG, "所有测试完成");
     
     // 删除任务
     g_test_task = NULL;
@@ -472,7 +1107,7 @@ void app_main(void) {
                                      CONFIG_EPD_HEIGHT,
                                      CONFIG_EPD_COLOR_MODE);
             break;
-            
+    
         case EPD_IL3820:
             ESP_LOGI(TAG, "使用IL3820驱动");
             epd = epd_il3820_create(&g_epd_pins,
@@ -480,7 +1115,7 @@ void app_main(void) {
                                    CONFIG_EPD_HEIGHT,
                                    CONFIG_EPD_COLOR_MODE);
             break;
-            
+    
         case EPD_UC8151:
             ESP_LOGI(TAG, "使用UC8151驱动");
             epd = epd_uc8151_create(&g_epd_pins,
@@ -488,7 +1123,7 @@ void app_main(void) {
                                    CONFIG_EPD_HEIGHT,
                                    CONFIG_EPD_COLOR_MODE);
             break;
-            
+    
         default:
             ESP_LOGE(TAG, "不支持的驱动类型: %d", CONFIG_EPD_TYPE);
             return;
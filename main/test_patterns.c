@@ -6,9 +6,13 @@
 #include <stdlib.h>
 #include "esp_log.h"
 #include "epd_common.h"
+#include "epd_dither.h"
 
 #define TAG "EPD_TEST_PATTERNS"
 
+// 从设备帧缓冲池借用缓冲区的等待时间
+#define PATTERN_BORROW_TIMEOUT_MS   1000
+
 // 生成棋盘格图案
 esp_err_t test_checkerboard_pattern(epd_device_t *dev, uint8_t block_size) {
     if (!dev) {
@@ -17,85 +21,123 @@ esp_err_t test_checkerboard_pattern(epd_device_t *dev, uint8_t block_size) {
     
     ESP_LOGI(TAG, "生成棋盘格图案，块大小: %d", block_size);
     
-    uint32_t buffer_size = dev->info.width * dev->info.height / 8;
-    uint8_t *buffer = malloc(buffer_size);
+    uint8_t *buffer = epd_pool_borrow(dev, PATTERN_BORROW_TIMEOUT_MS);
     if (!buffer) {
         return ESP_ERR_NO_MEM;
     }
     
-    // 生成棋盘格
+    // 生成棋盘格: 每行按块宽度切成交替的黑白行段
+    if (block_size == 0) {
+        block_size = 1;
+    }
     for (uint16_t y = 0; y < dev->info.height; y++) {
-        for (uint16_t x = 0; x < dev->info.width; x++) {
-            bool is_black = ((x / block_size) + (y / block_size)) % 2 == 0;
-            
-            if (is_black) {
-                // 设置像素为黑色
-                uint32_t byte_idx = y * (dev->info.width / 8) + (x / 8);
-                uint8_t bit_mask = 0x80 >> (x % 8);
-                buffer[byte_idx] &= ~bit_mask;
-            } else {
-                // 设置像素为白色
-                uint32_t byte_idx = y * (dev->info.width / 8) + (x / 8);
-                uint8_t bit_mask = 0x80 >> (x % 8);
-                buffer[byte_idx] |= bit_mask;
-            }
+        bool is_black = ((y / block_size) % 2) == 0;
+        for (uint16_t x = 0; x < dev->info.width; x += block_size) {
+            epd_draw_hline(buffer, dev->info.width, dev->info.height,
+                          x, y, block_size,
+                          is_black ? EPD_COLOR_BLACK : EPD_COLOR_WHITE);
+            is_black = !is_black;
         }
     }
     
     // 显示图案
     esp_err_t err = dev->display_buffer(dev, buffer, EPD_UPDATE_FULL);
     
-    free(buffer);
+    epd_pool_return(dev, buffer);
     return err;
 }
 
+// 渐变输入行: 从左到右由黑到白
+static void gradient_row(void *ctx, uint16_t y, uint8_t *dst) {
+    uint16_t width = *(const uint16_t *)ctx;
+    
+    for (uint16_t x = 0; x < width; x++) {
+        dst[x] = (uint32_t)x * 255 / (width - 1);
+    }
+}
+
 // 生成渐变图案
 esp_err_t test_gradient_pattern(epd_device_t *dev) {
     if (!dev) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    ESP_LOGI(TAG, "生成渐变图案");
+    ESP_LOGI(TAG, "生成渐变图案 (Floyd-Steinberg抖动)");
     
-    uint32_t buffer_size = dev->info.width * dev->info.height / 8;
-    uint8_t *buffer = malloc(buffer_size);
+    uint16_t width = dev->info.width;
+    epd_dither_config_t config = {
+        .width = width,
+        .height = dev->info.height,
+        .method = EPD_DITHER_FLOYD_STEINBERG,
+        .format = EPD_DITHER_GRAY8,
+        .palette = EPD_DITHER_PALETTE_BW,
+        .read_row = gradient_row,
+        .ctx = &width,
+    };
+    
+    epd_dither_t *dither = epd_dither_create(&config);
+    if (!dither) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    uint8_t *buffer = epd_pool_borrow(dev, PATTERN_BORROW_TIMEOUT_MS);
     if (!buffer) {
+        epd_dither_destroy(dither);
         return ESP_ERR_NO_MEM;
     }
     
-    // 定义8种灰度级别
-    uint8_t patterns[8] = {
-        0x00,  // 黑色
-        0x11,  // 深灰
-        0x22,  // 中灰
-        0x44,  // 灰
-        0x88,  // 浅灰
-        0xAA,  // 更浅灰
-        0xDD,  // 极浅灰
-        0xFF   // 白色
-    };
+    esp_err_t err = epd_dither_to_buffer(dither, buffer, NULL);
+    if (err == ESP_OK) {
+        err = dev->display_buffer(dev, buffer, EPD_UPDATE_FULL);
+    }
+    
+    epd_pool_return(dev, buffer);
+    epd_dither_destroy(dither);
+    return err;
+}
+
+// 生成4级灰度色阶 (仅支持灰度的面板)
+esp_err_t test_gray_pattern(epd_device_t *dev) {
+    if (!dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (!(dev->info.capabilities & EPD_CAP_GRAYSCALE)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
     
-    // 计算每个灰度块的高度
-    uint16_t block_height = dev->info.height / 8;
-    
-    // 填充渐变
-    for (uint8_t pattern_idx = 0; pattern_idx < 8; pattern_idx++) {
-        for (uint16_t y = 0; y < block_height; y++) {
-            if (pattern_idx * block_height + y >= dev->info.height) {
-                break;
-            }
-            
-            for (uint16_t x_byte = 0; x_byte < dev->info.width / 8; x_byte++) {
-                uint32_t byte_idx = (pattern_idx * block_height + y) * 
-                                   (dev->info.width / 8) + x_byte;
-                buffer[byte_idx] = patterns[pattern_idx];
-            }
+    ESP_LOGI(TAG, "生成4级灰度色阶");
+    
+    uint16_t width = dev->info.width;
+    uint16_t height = dev->info.height;
+    uint8_t *gray = malloc(EPD_GRAY4_BUFFER_SIZE(width, height));
+    if (!gray) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 4个竖条, 从左到右由黑到白; 每字节4个像素, 同一灰度的字节为0x55的倍数
+    for (uint16_t y = 0; y < height; y++) {
+        uint8_t *row = gray + (uint32_t)y * (width / 4);
+        for (uint16_t bx = 0; bx < width / 4; bx++) {
+            row[bx] = 0x55 * ((uint32_t)bx * 4 * EPD_GRAY4_LEVELS / width);
         }
     }
     
-    esp_err_t err = dev->display_buffer(dev, buffer, EPD_UPDATE_FULL);
+    esp_err_t err = dev->set_display_mode(dev, EPD_DISPLAY_GRAY4);
+    if (err == ESP_OK) {
+        err = dev->display_buffer(dev, gray, EPD_UPDATE_FULL);
+        dev->set_display_mode(dev, EPD_DISPLAY_1BPP);
+    }
     
-    free(buffer);
+    epd_refresh_cost_t mono, gray4;
+    if (err == ESP_OK && dev->get_refresh_cost(dev, EPD_DISPLAY_1BPP, &mono) == ESP_OK &&
+        dev->get_refresh_cost(dev, EPD_DISPLAY_GRAY4, &gray4) == ESP_OK) {
+        ESP_LOGI(TAG, "刷新耗时: 1bpp %lu ms, 4级灰度 %lu ms (%d次激活)",
+                 (unsigned long)(mono.last_us / 1000), (unsigned long)(gray4.last_us / 1000),
+                 gray4.passes);
+    }
+    
+    free(gray);
     return err;
 }
 
@@ -108,7 +150,7 @@ esp_err_t test_line_pattern(epd_device_t *dev) {
     ESP_LOGI(TAG, "生成线条图案");
     
     uint32_t buffer_size = dev->info.width * dev->info.height / 8;
-    uint8_t *buffer = malloc(buffer_size);
+    uint8_t *buffer = epd_pool_borrow(dev, PATTERN_BORROW_TIMEOUT_MS);
     if (!buffer) {
         return ESP_ERR_NO_MEM;
     }
@@ -118,45 +160,28 @@ esp_err_t test_line_pattern(epd_device_t *dev) {
     
     // 绘制水平线
     for (uint16_t y = 0; y < dev->info.height; y += 20) {
-        for (uint16_t x = 0; x < dev->info.width; x++) {
-            uint32_t byte_idx = y * (dev->info.width / 8) + (x / 8);
-            uint8_t bit_mask = 0x80 >> (x % 8);
-            buffer[byte_idx] &= ~bit_mask;  // 黑色
-        }
+        epd_draw_hline(buffer, dev->info.width, dev->info.height,
+                      0, y, dev->info.width, EPD_COLOR_BLACK);
     }
     
     // 绘制垂直线
     for (uint16_t x = 0; x < dev->info.width; x += 20) {
-        for (uint16_t y = 0; y < dev->info.height; y++) {
-            uint32_t byte_idx = y * (dev->info.width / 8) + (x / 8);
-            uint8_t bit_mask = 0x80 >> (x % 8);
-            buffer[byte_idx] &= ~bit_mask;  // 黑色
-        }
+        epd_draw_vline(buffer, dev->info.width, dev->info.height,
+                      x, 0, dev->info.height, EPD_COLOR_BLACK);
     }
     
     // 绘制对角线
-    for (uint16_t i = 0; i < dev->info.width && i < dev->info.height; i++) {
-        uint16_t x = i;
-        uint16_t y = i;
-        
-        uint32_t byte_idx = y * (dev->info.width / 8) + (x / 8);
-        uint8_t bit_mask = 0x80 >> (x % 8);
-        buffer[byte_idx] &= ~bit_mask;
-    }
+    uint16_t diag = dev->info.width < dev->info.height ? dev->info.width : dev->info.height;
+    epd_draw_line(buffer, dev->info.width, dev->info.height,
+                 0, 0, diag - 1, diag - 1, EPD_COLOR_BLACK);
     
     // 绘制另一条对角线
-    for (uint16_t i = 0; i < dev->info.width && i < dev->info.height; i++) {
-        uint16_t x = dev->info.width - i - 1;
-        uint16_t y = i;
-        
-        uint32_t byte_idx = y * (dev->info.width / 8) + (x / 8);
-        uint8_t bit_mask = 0x80 >> (x % 8);
-        buffer[byte_idx] &= ~bit_mask;
-    }
+    epd_draw_line(buffer, dev->info.width, dev->info.height,
+                 dev->info.width - 1, 0, dev->info.width - diag, diag - 1, EPD_COLOR_BLACK);
     
     esp_err_t err = dev->display_buffer(dev, buffer, EPD_UPDATE_FULL);
     
-    free(buffer);
+    epd_pool_return(dev, buffer);
     return err;
 }
 
@@ -169,7 +194,7 @@ esp_err_t test_shape_pattern(epd_device_t *dev) {
     ESP_LOGI(TAG, "生成几何形状图案");
     
     uint32_t buffer_size = dev->info.width * dev->info.height / 8;
-    uint8_t *buffer = malloc(buffer_size);
+    uint8_t *buffer = epd_pool_borrow(dev, PATTERN_BORROW_TIMEOUT_MS);
     if (!buffer) {
         return ESP_ERR_NO_MEM;
     }
@@ -183,53 +208,16 @@ esp_err_t test_shape_pattern(epd_device_t *dev) {
     uint16_t rect_w = dev->info.width / 2;
     uint16_t rect_h = dev->info.height / 2;
     
-    // 上边
-    for (uint16_t x = rect_x; x < rect_x + rect_w; x++) {
-        uint32_t byte_idx = rect_y * (dev->info.width / 8) + (x / 8);
-        uint8_t bit_mask = 0x80 >> (x % 8);
-        buffer[byte_idx] &= ~bit_mask;
-    }
-    
-    // 下边
-    for (uint16_t x = rect_x; x < rect_x + rect_w; x++) {
-        uint32_t byte_idx = (rect_y + rect_h - 1) * (dev->info.width / 8) + (x / 8);
-        uint8_t bit_mask = 0x80 >> (x % 8);
-        buffer[byte_idx] &= ~bit_mask;
-    }
-    
-    // 左边
-    for (uint16_t y = rect_y; y < rect_y + rect_h; y++) {
-        uint32_t byte_idx = y * (dev->info.width / 8) + (rect_x / 8);
-        uint8_t bit_mask = 0x80 >> (rect_x % 8);
-        buffer[byte_idx] &= ~bit_mask;
-    }
-    
-    // 右边
-    for (uint16_t y = rect_y; y < rect_y + rect_h; y++) {
-        uint32_t byte_idx = y * (dev->info.width / 8) + ((rect_x + rect_w - 1) / 8);
-        uint8_t bit_mask = 0x80 >> ((rect_x + rect_w - 1) % 8);
-        buffer[byte_idx] &= ~bit_mask;
-    }
+    epd_draw_rect(buffer, dev->info.width, dev->info.height,
+                 rect_x, rect_y, rect_w, rect_h, EPD_COLOR_BLACK, false);
     
     // 绘制圆形
     uint16_t center_x = dev->info.width / 2;
     uint16_t center_y = dev->info.height / 2;
     uint16_t radius = dev->info.height / 8;
     
-    for (int16_t y = -radius; y <= radius; y++) {
-        for (int16_t x = -radius; x <= radius; x++) {
-            if (x * x + y * y <= radius * radius) {
-                uint16_t px = center_x + x;
-                uint16_t py = center_y + y;
-                
-                if (px < dev->info.width && py < dev->info.height) {
-                    uint32_t byte_idx = py * (dev->info.width / 8) + (px / 8);
-                    uint8_t bit_mask = 0x80 >> (px % 8);
-                    buffer[byte_idx] &= ~bit_mask;
-                }
-            }
-        }
-    }
+    epd_draw_circle(buffer, dev->info.width, dev->info.height,
+                   center_x, center_y, radius, EPD_COLOR_BLACK, true);
     
     // 绘制三角形
     uint16_t tri_x1 = dev->info.width / 8;
@@ -249,6 +237,6 @@ esp_err_t test_shape_pattern(epd_device_t *dev) {
     
     esp_err_t err = dev->display_buffer(dev, buffer, EPD_UPDATE_FULL);
     
-    free(buffer);
+    epd_pool_return(dev, buffer);
     return err;
 }